@@ -22,10 +22,12 @@
  * SOFTWARE.
  */
 
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
 #include <cstring>
 #include <array>
+#include <optional>
 
 #include <vulkan/vk_layer.h>
 #include <vulkan/vulkan.h>
@@ -34,11 +36,18 @@
 #include "surface_api.hpp"
 #include "swapchain_api.hpp"
 #include "swapchain_maintenance_api.hpp"
+#include "wsi_layer_statistics.hpp"
 #include "util/extension_list.hpp"
 #include "util/custom_allocator.hpp"
+#include "wsi/present_capture.hpp"
+#include "wsi/synchronization.hpp"
 #include "wsi/wsi_factory.hpp"
 #include "util/log.hpp"
 #include "util/macros.hpp"
+#include "util/trace.hpp"
+#include "util/instrumented_mutex.hpp"
+#include "util/memory_accounting.hpp"
+#include "util/perfect_hash.hpp"
 #include "util/helpers.hpp"
 
 #if VULKAN_WSI_LAYER_EXPERIMENTAL
@@ -100,6 +109,126 @@ static T get_device_proc_addr(PFN_vkGetDeviceProcAddr fp_get_device_proc_addr, c
    return func;
 }
 
+/**
+ * @brief Add a queue for the layer's own synchronization submissions to the queues requested by the application.
+ *
+ * The queue is taken from the first queue family that can execute queue submissions and has more queues than the
+ * application requested, so that the layer's submissions do not queue up behind the application's work. It gets the
+ * lowest priority of the application's queues: a lower priority could let the application's work starve the
+ * submissions the presents wait for.
+ *
+ * @param instance                 The instance private data of the physical device.
+ * @param physical_device          The physical device the device is created for.
+ * @param create_info              The device create info passed by the application.
+ * @param allocator                The allocator to use for temporary allocations.
+ * @param[out] queue_create_infos  The queue create infos to pass down the chain, with the layer's queue added.
+ * @param[out] queue_priorities    Storage for the priorities of the queue create info of the layer's queue.
+ * @param[out] sync_queue          Queue family index and queue index of the layer's queue, empty if no queue is
+ *                                 available.
+ *
+ * @return VK_SUCCESS if successful, including when no queue is available, otherwise an error.
+ */
+static VkResult reserve_sync_queue(instance_private_data &instance, VkPhysicalDevice physical_device,
+                                   const VkDeviceCreateInfo &create_info, const util::allocator &allocator,
+                                   util::vector<VkDeviceQueueCreateInfo> &queue_create_infos,
+                                   util::vector<float> &queue_priorities,
+                                   std::optional<std::pair<uint32_t, uint32_t>> &sync_queue)
+{
+   uint32_t family_count = 0;
+   instance.disp.GetPhysicalDeviceQueueFamilyProperties(physical_device, &family_count, nullptr);
+   util::vector<VkQueueFamilyProperties> families{ allocator };
+   if (!families.try_resize(family_count))
+   {
+      return VK_ERROR_OUT_OF_HOST_MEMORY;
+   }
+   instance.disp.GetPhysicalDeviceQueueFamilyProperties(physical_device, &family_count, families.data());
+
+   float priority = 1.0f;
+   for (uint32_t i = 0; i < create_info.queueCreateInfoCount; i++)
+   {
+      const VkDeviceQueueCreateInfo &info = create_info.pQueueCreateInfos[i];
+      for (uint32_t j = 0; j < info.queueCount; j++)
+      {
+         priority = std::min(priority, info.pQueuePriorities[j]);
+      }
+   }
+
+   constexpr VkQueueFlags submit_queue_flags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT;
+   for (uint32_t family_index = 0; family_index < family_count; family_index++)
+   {
+      if ((families[family_index].queueFlags & submit_queue_flags) == 0)
+      {
+         continue;
+      }
+
+      uint32_t requested_count = 0;
+      const VkDeviceQueueCreateInfo *unprotected_info = nullptr;
+      for (uint32_t i = 0; i < create_info.queueCreateInfoCount; i++)
+      {
+         const VkDeviceQueueCreateInfo &info = create_info.pQueueCreateInfos[i];
+         if (info.queueFamilyIndex == family_index)
+         {
+            requested_count += info.queueCount;
+            if (info.flags == 0)
+            {
+               unprotected_info = &info;
+            }
+         }
+      }
+      if (requested_count >= families[family_index].queueCount)
+      {
+         continue;
+      }
+
+      /* The layer's queue is the last queue of the family's unprotected queues. */
+      uint32_t queue_index = 0;
+      if (unprotected_info != nullptr)
+      {
+         queue_index = unprotected_info->queueCount;
+         if (!queue_priorities.try_resize(queue_index + 1, priority))
+         {
+            return VK_ERROR_OUT_OF_HOST_MEMORY;
+         }
+         std::copy(unprotected_info->pQueuePriorities, unprotected_info->pQueuePriorities + queue_index,
+                   queue_priorities.begin());
+      }
+      else if (!queue_priorities.try_push_back(priority))
+      {
+         return VK_ERROR_OUT_OF_HOST_MEMORY;
+      }
+
+      for (uint32_t i = 0; i < create_info.queueCreateInfoCount; i++)
+      {
+         if (!queue_create_infos.try_push_back(create_info.pQueueCreateInfos[i]))
+         {
+            return VK_ERROR_OUT_OF_HOST_MEMORY;
+         }
+         if (&create_info.pQueueCreateInfos[i] == unprotected_info)
+         {
+            queue_create_infos.back().queueCount = queue_index + 1;
+            queue_create_infos.back().pQueuePriorities = queue_priorities.data();
+         }
+      }
+      if (unprotected_info == nullptr)
+      {
+         VkDeviceQueueCreateInfo info = {};
+         info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+         info.queueFamilyIndex = family_index;
+         info.queueCount = 1;
+         info.pQueuePriorities = queue_priorities.data();
+         if (!queue_create_infos.try_push_back(info))
+         {
+            return VK_ERROR_OUT_OF_HOST_MEMORY;
+         }
+      }
+
+      sync_queue = std::make_pair(family_index, queue_index);
+      return VK_SUCCESS;
+   }
+
+   return VK_SUCCESS;
+}
+
 /* This is where the layer is initialised and the instance dispatch table is constructed. */
 VKAPI_ATTR VkResult create_instance(const VkInstanceCreateInfo *pCreateInfo, const VkAllocationCallbacks *pAllocator,
                                     VkInstance *pInstance)
@@ -175,7 +304,8 @@ VKAPI_ATTR VkResult create_instance(const VkInstanceCreateInfo *pCreateInfo, con
    /* Following the spec: use the callbacks provided to vkCreateInstance() if not nullptr,
     * otherwise use the default callbacks.
     */
-   util::allocator instance_allocator{ VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE, pAllocator };
+   util::allocator instance_allocator{ VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE, pAllocator,
+                                       util::memory_subsystem::instance };
    std::optional<instance_dispatch_table> table = instance_dispatch_table::create(instance_allocator);
    if (!table.has_value())
    {
@@ -262,6 +392,25 @@ VKAPI_ATTR VkResult create_device(VkPhysicalDevice physicalDevice, const VkDevic
       modified_info.enabledExtensionCount = modified_enabled_extensions.size();
    }
 
+   /* Without sync FD imports, acquires signal their fences and semaphores with a queue submission. Give the layer a
+    * queue of its own for these so they do not have to wait for the application's work. */
+   util::vector<VkDeviceQueueCreateInfo> modified_queue_create_infos{ allocator };
+   util::vector<float> sync_queue_priorities{ allocator };
+   std::optional<std::pair<uint32_t, uint32_t>> sync_queue;
+   if (!enabled_platforms.empty() &&
+       !(enabled_extensions.contains(VK_KHR_EXTERNAL_FENCE_FD_EXTENSION_NAME) &&
+         enabled_extensions.contains(VK_KHR_EXTERNAL_SEMAPHORE_FD_EXTENSION_NAME) &&
+         wsi::is_sync_fd_import_supported(inst_data, physicalDevice)))
+   {
+      TRY_LOG_CALL(reserve_sync_queue(inst_data, physicalDevice, *pCreateInfo, allocator, modified_queue_create_infos,
+                                      sync_queue_priorities, sync_queue));
+      if (sync_queue.has_value())
+      {
+         modified_info.pQueueCreateInfos = modified_queue_create_infos.data();
+         modified_info.queueCreateInfoCount = modified_queue_create_infos.size();
+      }
+   }
+
    bool should_layer_handle_frame_boundary_events = false;
    VkPhysicalDeviceFrameBoundaryFeaturesEXT frame_boundary;
 
@@ -295,7 +444,8 @@ VKAPI_ATTR VkResult create_device(VkPhysicalDevice physicalDevice, const VkDevic
    /* Following the spec: use the callbacks provided to vkCreateDevice() if not nullptr, otherwise use the callbacks
     * provided to the instance (if no allocator callbacks was provided to the instance, it will use default ones).
     */
-   util::allocator device_allocator{ inst_data.get_allocator(), VK_SYSTEM_ALLOCATION_SCOPE_DEVICE, pAllocator };
+   util::allocator device_allocator{ inst_data.get_allocator(), VK_SYSTEM_ALLOCATION_SCOPE_DEVICE, pAllocator,
+                                    util::memory_subsystem::device };
    std::optional<device_dispatch_table> table = device_dispatch_table::create(device_allocator);
    if (!table.has_value())
    {
@@ -329,6 +479,20 @@ VKAPI_ATTR VkResult create_device(VkPhysicalDevice physicalDevice, const VkDevic
 
    result = device_data.set_device_enabled_extensions(modified_info.ppEnabledExtensionNames,
                                                       modified_info.enabledExtensionCount);
+   if (result == VK_SUCCESS)
+   {
+      result = device_data.set_device_queues(pCreateInfo->pQueueCreateInfos, pCreateInfo->queueCreateInfoCount);
+   }
+   if (result == VK_SUCCESS && sync_queue.has_value())
+   {
+      VkQueue queue = VK_NULL_HANDLE;
+      device_data.disp.GetDeviceQueue(*pDevice, sync_queue->first, sync_queue->second, &queue);
+      result = device_data.SetDeviceLoaderData(*pDevice, queue);
+      if (result == VK_SUCCESS)
+      {
+         device_data.set_sync_queue(queue);
+      }
+   }
    if (result != VK_SUCCESS)
    {
       layer::device_private_data::disassociate(*pDevice);
@@ -354,6 +518,14 @@ VKAPI_ATTR VkResult create_device(VkPhysicalDevice physicalDevice, const VkDevic
       device_data.set_present_id_feature_enabled(present_id_features->presentId);
    }
 
+   const auto *timeline_semaphore_features = util::find_extension<VkPhysicalDeviceTimelineSemaphoreFeatures>(
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES, pCreateInfo->pNext);
+   const auto *vulkan_12_features = util::find_extension<VkPhysicalDeviceVulkan12Features>(
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES, pCreateInfo->pNext);
+   device_data.set_timeline_semaphore_enabled(
+      (timeline_semaphore_features != nullptr && timeline_semaphore_features->timelineSemaphore) ||
+      (vulkan_12_features != nullptr && vulkan_12_features->timelineSemaphore));
+
 #if VULKAN_WSI_LAYER_EXPERIMENTAL
    auto *physical_device_swapchain_maintenance1_features =
       util::find_extension<VkPhysicalDeviceSwapchainMaintenance1FeaturesEXT>(
@@ -385,8 +557,11 @@ wsi_layer_vkDestroyInstance(VkInstance instance, const VkAllocationCallbacks *pA
       return;
    }
 
-   auto fn_destroy_instance =
-      layer::instance_private_data::get(instance).disp.get_fn<PFN_vkDestroyInstance>("vkDestroyInstance");
+   auto &instance_data = layer::instance_private_data::get(instance);
+   auto fn_destroy_instance = instance_data.disp.get_fn<PFN_vkDestroyInstance>("vkDestroyInstance");
+
+   /* The surface query caches are keyed by physical device, which may be reused by the next instance. */
+   wsi::invalidate_surface_query_caches(instance_data.get_enabled_platforms());
 
    /* Call disassociate() before doing vkDestroyInstance as an instance may be created by a different thread
     * just after we call vkDestroyInstance() and it could get the same address if we are unlucky.
@@ -414,6 +589,12 @@ wsi_layer_vkDestroyDevice(VkDevice device, const VkAllocationCallbacks *pAllocat
 
    assert(fn_destroy_device.has_value());
    (*fn_destroy_device)(device, pAllocator);
+
+   /* Write the events recorded so far, as some applications exit without unloading the layer. */
+   util::trace::flush();
+   wsi::capture::flush();
+   util::report_lock_statistics();
+   util::memory_accounting::log_summary();
 }
 
 VWL_VKAPI_CALL(VkResult)
@@ -497,78 +678,130 @@ wsi_layer_vkGetPhysicalDeviceFeatures2KHR(VkPhysicalDevice physicalDevice,
 #endif
 }
 
-#define GET_PROC_ADDR(func)      \
-   if (!strcmp(funcName, #func)) \
-      return (PFN_vkVoidFunction)&wsi_layer_##func;
+/*
+ * Entrypoints intercepted by the layer. Each entry gives the name of the entrypoint, the layer function implementing it
+ * and up to two extensions that must be enabled for the layer to expose it (nullptr when there is no requirement).
+ */
+#define DEVICE_PROC_LIST(PROC)                                                                                       \
+   PROC(vkCreateSwapchainKHR, vkCreateSwapchainKHR, VK_KHR_SWAPCHAIN_EXTENSION_NAME, nullptr)                       \
+   PROC(vkDestroySwapchainKHR, vkDestroySwapchainKHR, VK_KHR_SWAPCHAIN_EXTENSION_NAME, nullptr)                     \
+   PROC(vkGetSwapchainImagesKHR, vkGetSwapchainImagesKHR, VK_KHR_SWAPCHAIN_EXTENSION_NAME, nullptr)                 \
+   PROC(vkAcquireNextImageKHR, vkAcquireNextImageKHR, VK_KHR_SWAPCHAIN_EXTENSION_NAME, nullptr)                     \
+   PROC(vkQueuePresentKHR, vkQueuePresentKHR, VK_KHR_SWAPCHAIN_EXTENSION_NAME, nullptr)                             \
+   PROC(vkAcquireNextImage2KHR, vkAcquireNextImage2KHR, VK_KHR_SWAPCHAIN_EXTENSION_NAME, nullptr)                   \
+   PROC(vkGetDeviceGroupPresentCapabilitiesKHR, vkGetDeviceGroupPresentCapabilitiesKHR,                             \
+        VK_KHR_SWAPCHAIN_EXTENSION_NAME, nullptr)                                                                    \
+   PROC(vkGetDeviceGroupSurfacePresentModesKHR, vkGetDeviceGroupSurfacePresentModesKHR,                             \
+        VK_KHR_SWAPCHAIN_EXTENSION_NAME, nullptr)                                                                    \
+   PROC(vkGetSwapchainStatusKHR, vkGetSwapchainStatusKHR, VK_KHR_SHARED_PRESENTABLE_IMAGE_EXTENSION_NAME, nullptr)  \
+   PROC(vkGetSwapchainStatisticsWSI, vkGetSwapchainStatisticsWSI, VK_WSI_SWAPCHAIN_STATISTICS_EXTENSION_NAME,       \
+        nullptr)                                                                                                     \
+   PROC(vkDestroyDevice, vkDestroyDevice, nullptr, nullptr)                                                         \
+   PROC(vkCreateImage, vkCreateImage, nullptr, nullptr)                                                             \
+   PROC(vkBindImageMemory2, vkBindImageMemory2, nullptr, nullptr)
 
-VWL_VKAPI_CALL(PFN_vkVoidFunction)
-wsi_layer_vkGetDeviceProcAddr(VkDevice device, const char *funcName) VWL_API_POST
-{
-   if (layer::device_private_data::get(device).is_device_extension_enabled(VK_KHR_SWAPCHAIN_EXTENSION_NAME))
-   {
-      GET_PROC_ADDR(vkCreateSwapchainKHR);
-      GET_PROC_ADDR(vkDestroySwapchainKHR);
-      GET_PROC_ADDR(vkGetSwapchainImagesKHR);
-      GET_PROC_ADDR(vkAcquireNextImageKHR);
-      GET_PROC_ADDR(vkQueuePresentKHR);
-      GET_PROC_ADDR(vkAcquireNextImage2KHR);
-      GET_PROC_ADDR(vkGetDeviceGroupPresentCapabilitiesKHR);
-      GET_PROC_ADDR(vkGetDeviceGroupSurfacePresentModesKHR);
-   }
-   if (layer::device_private_data::get(device).is_device_extension_enabled(
-          VK_KHR_SHARED_PRESENTABLE_IMAGE_EXTENSION_NAME))
-   {
-      GET_PROC_ADDR(vkGetSwapchainStatusKHR);
-   }
 #if VULKAN_WSI_LAYER_EXPERIMENTAL
-   if (layer::device_private_data::get(device).is_device_extension_enabled(VK_KHR_PRESENT_TIMING_EXTENSION_NAME))
-   {
-      GET_PROC_ADDR(vkSetSwapchainPresentTimingQueueSizeEXT);
-      GET_PROC_ADDR(vkGetSwapchainTimingPropertiesEXT);
-      GET_PROC_ADDR(vkGetSwapchainTimeDomainPropertiesEXT);
-      GET_PROC_ADDR(vkGetPastPresentationTimingEXT);
-   }
+#define DEVICE_EXPERIMENTAL_PROC_LIST(PROC)                                                                          \
+   PROC(vkSetSwapchainPresentTimingQueueSizeEXT, vkSetSwapchainPresentTimingQueueSizeEXT,                           \
+        VK_KHR_PRESENT_TIMING_EXTENSION_NAME, nullptr)                                                               \
+   PROC(vkGetSwapchainTimingPropertiesEXT, vkGetSwapchainTimingPropertiesEXT, VK_KHR_PRESENT_TIMING_EXTENSION_NAME, \
+        nullptr)                                                                                                     \
+   PROC(vkGetSwapchainTimeDomainPropertiesEXT, vkGetSwapchainTimeDomainPropertiesEXT,                               \
+        VK_KHR_PRESENT_TIMING_EXTENSION_NAME, nullptr)                                                               \
+   PROC(vkGetPastPresentationTimingEXT, vkGetPastPresentationTimingEXT, VK_KHR_PRESENT_TIMING_EXTENSION_NAME,       \
+        nullptr)                                                                                                     \
+   PROC(vkReleaseSwapchainImagesEXT, vkReleaseSwapchainImagesEXT, VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME,    \
+        nullptr)
+#else
+#define DEVICE_EXPERIMENTAL_PROC_LIST(PROC)
 #endif
-   GET_PROC_ADDR(vkDestroyDevice);
 
-   GET_PROC_ADDR(vkCreateImage);
-   GET_PROC_ADDR(vkBindImageMemory2);
+/* The surface entrypoints are only exposed if the WSI backends do not implement them. */
+#define INSTANCE_PROC_LIST(PROC)                                                                                     \
+   PROC(vkGetDeviceProcAddr, vkGetDeviceProcAddr, nullptr, nullptr)                                                 \
+   PROC(vkGetInstanceProcAddr, vkGetInstanceProcAddr, nullptr, nullptr)                                             \
+   PROC(vkCreateInstance, vkCreateInstance, nullptr, nullptr)                                                       \
+   PROC(vkDestroyInstance, vkDestroyInstance, nullptr, nullptr)                                                     \
+   PROC(vkCreateDevice, vkCreateDevice, nullptr, nullptr)                                                           \
+   PROC(vkGetPhysicalDevicePresentRectanglesKHR, vkGetPhysicalDevicePresentRectanglesKHR, nullptr, nullptr)         \
+   PROC(vkGetPhysicalDeviceFeatures2, vkGetPhysicalDeviceFeatures2KHR, nullptr, nullptr)                            \
+   PROC(vkGetPhysicalDeviceFeatures2KHR, vkGetPhysicalDeviceFeatures2KHR,                                           \
+        VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME, nullptr)                                             \
+   PROC(vkGetPhysicalDeviceSurfaceSupportKHR, vkGetPhysicalDeviceSurfaceSupportKHR, VK_KHR_SURFACE_EXTENSION_NAME,  \
+        nullptr)                                                                                                     \
+   PROC(vkGetPhysicalDeviceSurfaceCapabilitiesKHR, vkGetPhysicalDeviceSurfaceCapabilitiesKHR,                       \
+        VK_KHR_SURFACE_EXTENSION_NAME, nullptr)                                                                      \
+   PROC(vkGetPhysicalDeviceSurfaceFormatsKHR, vkGetPhysicalDeviceSurfaceFormatsKHR, VK_KHR_SURFACE_EXTENSION_NAME,  \
+        nullptr)                                                                                                     \
+   PROC(vkGetPhysicalDeviceSurfacePresentModesKHR, vkGetPhysicalDeviceSurfacePresentModesKHR,                       \
+        VK_KHR_SURFACE_EXTENSION_NAME, nullptr)                                                                      \
+   PROC(vkDestroySurfaceKHR, vkDestroySurfaceKHR, VK_KHR_SURFACE_EXTENSION_NAME, nullptr)                           \
+   PROC(vkGetPhysicalDeviceSurfaceCapabilities2KHR, vkGetPhysicalDeviceSurfaceCapabilities2KHR,                     \
+        VK_KHR_SURFACE_EXTENSION_NAME, VK_KHR_GET_SURFACE_CAPABILITIES_2_EXTENSION_NAME)                             \
+   PROC(vkGetPhysicalDeviceSurfaceFormats2KHR, vkGetPhysicalDeviceSurfaceFormats2KHR, VK_KHR_SURFACE_EXTENSION_NAME, \
+        VK_KHR_GET_SURFACE_CAPABILITIES_2_EXTENSION_NAME)
+
+#define PROC_NAME(name, func, ext_name, ext_name2) #name,
+#define PROC_ENTRY(name, func, ext_name, ext_name2) \
+   { reinterpret_cast<PFN_vkVoidFunction>(&wsi_layer_##func), ext_name, ext_name2 },
+
+namespace
+{
+/**
+ * @brief Entrypoint intercepted by the layer.
+ */
+struct proc_entry
+{
+   PFN_vkVoidFunction fn;
+   const char *ext_name;
+   const char *ext_name2;
+};
+
+constexpr const char *device_proc_names[] = { DEVICE_PROC_LIST(PROC_NAME) DEVICE_EXPERIMENTAL_PROC_LIST(PROC_NAME) };
+constexpr util::perfect_hash<std::size(device_proc_names)> device_proc_hash{ device_proc_names };
+static_assert(device_proc_hash.valid(), "No perfect hash found for the device entrypoints");
+const proc_entry device_procs[] = { DEVICE_PROC_LIST(PROC_ENTRY) DEVICE_EXPERIMENTAL_PROC_LIST(PROC_ENTRY) };
 
-#if VULKAN_WSI_LAYER_EXPERIMENTAL
-   /* VK_EXT_swapchain_maintenance1 */
-   if (layer::device_private_data::get(device).is_device_extension_enabled(
-          VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME))
+constexpr const char *instance_proc_names[] = { INSTANCE_PROC_LIST(PROC_NAME) };
+constexpr util::perfect_hash<std::size(instance_proc_names)> instance_proc_hash{ instance_proc_names };
+static_assert(instance_proc_hash.valid(), "No perfect hash found for the instance entrypoints");
+const proc_entry instance_procs[] = { INSTANCE_PROC_LIST(PROC_ENTRY) };
+} /* namespace */
+
+#undef PROC_NAME
+#undef PROC_ENTRY
+
+VWL_VKAPI_CALL(PFN_vkVoidFunction)
+wsi_layer_vkGetDeviceProcAddr(VkDevice device, const char *funcName) VWL_API_POST
+{
+   auto &device_data = layer::device_private_data::get(device);
+
+   size_t index = device_proc_hash.find(funcName);
+   if (index != device_proc_hash.NOT_FOUND)
    {
-      GET_PROC_ADDR(vkReleaseSwapchainImagesEXT);
+      const proc_entry &entry = device_procs[index];
+      if ((entry.ext_name == nullptr || device_data.is_device_extension_enabled(entry.ext_name)) &&
+          (entry.ext_name2 == nullptr || device_data.is_device_extension_enabled(entry.ext_name2)))
+      {
+         return entry.fn;
+      }
    }
-#endif
 
-   return layer::device_private_data::get(device).disp.get_user_enabled_entrypoint(
-      device, layer::device_private_data::get(device).instance_data.api_version, funcName);
+   return device_data.disp.get_user_enabled_entrypoint(device, device_data.instance_data.api_version, funcName);
 }
 
 VWL_VKAPI_CALL(PFN_vkVoidFunction)
 wsi_layer_vkGetInstanceProcAddr(VkInstance instance, const char *funcName) VWL_API_POST
 {
-   GET_PROC_ADDR(vkGetDeviceProcAddr);
-   GET_PROC_ADDR(vkGetInstanceProcAddr);
-   GET_PROC_ADDR(vkCreateInstance);
-   GET_PROC_ADDR(vkDestroyInstance);
-   GET_PROC_ADDR(vkCreateDevice);
-   GET_PROC_ADDR(vkGetPhysicalDevicePresentRectanglesKHR);
-
-   if (!strcmp(funcName, "vkGetPhysicalDeviceFeatures2"))
+   size_t index = instance_proc_hash.find(funcName);
+   const proc_entry *entry = index != instance_proc_hash.NOT_FOUND ? &instance_procs[index] : nullptr;
+   if (entry != nullptr && entry->ext_name == nullptr)
    {
-      return (PFN_vkVoidFunction)wsi_layer_vkGetPhysicalDeviceFeatures2KHR;
+      return entry->fn;
    }
 
    auto &instance_data = layer::instance_private_data::get(instance);
 
-   if (instance_data.is_instance_extension_enabled(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME))
-   {
-      GET_PROC_ADDR(vkGetPhysicalDeviceFeatures2KHR);
-   }
-
    if (instance_data.is_instance_extension_enabled(VK_KHR_SURFACE_EXTENSION_NAME))
    {
       PFN_vkVoidFunction wsi_func = wsi::get_proc_addr(funcName, instance_data);
@@ -576,18 +809,12 @@ wsi_layer_vkGetInstanceProcAddr(VkInstance instance, const char *funcName) VWL_A
       {
          return wsi_func;
       }
+   }
 
-      GET_PROC_ADDR(vkGetPhysicalDeviceSurfaceSupportKHR);
-      GET_PROC_ADDR(vkGetPhysicalDeviceSurfaceCapabilitiesKHR);
-      GET_PROC_ADDR(vkGetPhysicalDeviceSurfaceFormatsKHR);
-      GET_PROC_ADDR(vkGetPhysicalDeviceSurfacePresentModesKHR);
-      GET_PROC_ADDR(vkDestroySurfaceKHR);
-
-      if (instance_data.is_instance_extension_enabled(VK_KHR_GET_SURFACE_CAPABILITIES_2_EXTENSION_NAME))
-      {
-         GET_PROC_ADDR(vkGetPhysicalDeviceSurfaceCapabilities2KHR);
-         GET_PROC_ADDR(vkGetPhysicalDeviceSurfaceFormats2KHR);
-      }
+   if (entry != nullptr && instance_data.is_instance_extension_enabled(entry->ext_name) &&
+       (entry->ext_name2 == nullptr || instance_data.is_instance_extension_enabled(entry->ext_name2)))
+   {
+      return entry->fn;
    }
 
    return instance_data.disp.get_user_enabled_entrypoint(instance, instance_data.api_version, funcName);
@@ -27,47 +27,65 @@
 #include "private_data.hpp"
 #include "wsi/wsi_factory.hpp"
 #include "wsi/surface.hpp"
-#include "util/unordered_map.hpp"
+#include "util/flat_map.hpp"
 #include "util/log.hpp"
 #include "util/helpers.hpp"
 
 namespace layer
 {
 
-static std::mutex g_data_lock;
+static util::mutex g_data_lock{ "g_data_lock" };
 
 /* The dictionaries below use plain pointers to store the instance/device private data objects.
  * This means that these objects are leaked if the application terminates without calling vkDestroyInstance
  * or vkDestroyDevice. This is fine as it is the application's responsibility to call these.
  */
-static util::unordered_map<void *, instance_private_data *> g_instance_data{ util::allocator::get_generic() };
-static util::unordered_map<void *, device_private_data *> g_device_data{ util::allocator::get_generic() };
+static util::flat_map<void *, instance_private_data *> g_instance_data{ util::allocator::get_generic() };
+static util::flat_map<void *, device_private_data *> g_device_data{ util::allocator::get_generic() };
 
-VkResult instance_dispatch_table::populate(VkInstance instance, PFN_vkGetInstanceProcAddr get_proc)
+VKAPI_ATTR void VKAPI_CALL unresolved_entrypoint()
 {
-   static constexpr entrypoint entrypoints_init[] = {
-#define DISPATCH_TABLE_ENTRY(name, ext_name, api_version, required) \
-   { "vk" #name, ext_name, nullptr, api_version, false, required },
-      INSTANCE_ENTRYPOINTS_LIST(DISPATCH_TABLE_ENTRY)
-#undef DISPATCH_TABLE_ENTRY
-   };
-   static constexpr auto num_entrypoints = std::distance(std::begin(entrypoints_init), std::end(entrypoints_init));
+   assert(false);
+}
+
+VkResult dispatch_table::populate_entrypoints(const entrypoint *entrypoints, size_t num_entrypoints,
+                                              const char *const *eager_names, size_t num_eager_names)
+{
+   if (!m_entrypoints->try_reserve(m_entrypoints->size() + num_entrypoints))
+   {
+      WSI_LOG_ERROR("Failed to allocate memory for dispatch table entries.");
+      return VK_ERROR_OUT_OF_HOST_MEMORY;
+   }
 
    for (size_t i = 0; i < num_entrypoints; i++)
    {
-      const entrypoint *entrypoint = &entrypoints_init[i];
-      PFN_vkVoidFunction ret = get_proc(instance, entrypoint->name);
-      if (!ret && entrypoint->required)
+      struct entrypoint e = entrypoints[i];
+      e.user_visible = false;
+
+      /* Required entrypoints are always resolved so that a missing one fails creation. */
+      bool eager = !WSI_LAZY_ENTRYPOINTS || e.required;
+      for (size_t j = 0; j < num_eager_names && !eager; j++)
       {
-         return VK_ERROR_INITIALIZATION_FAILED;
+         eager = strcmp(e.name, eager_names[j]) == 0;
+      }
+
+      if (eager)
+      {
+         PFN_vkVoidFunction ret = m_resolver(m_handle, m_get_proc, e.name);
+         if (!ret && e.required)
+         {
+            return VK_ERROR_INITIALIZATION_FAILED;
+         }
+         e.fn = ret;
+      }
+      else
+      {
+         e.fn = unresolved_entrypoint;
       }
-      struct entrypoint e = *entrypoint;
-      e.fn = ret;
-      e.user_visible = false;
 
       if (!m_entrypoints->try_insert(std::make_pair(e.name, e)).has_value())
       {
-         WSI_LOG_ERROR("Failed to allocate memory for instance dispatch table entry.");
+         WSI_LOG_ERROR("Failed to allocate memory for dispatch table entry.");
          return VK_ERROR_OUT_OF_HOST_MEMORY;
       }
    }
@@ -75,6 +93,37 @@ VkResult instance_dispatch_table::populate(VkInstance instance, PFN_vkGetInstanc
    return VK_SUCCESS;
 }
 
+PFN_vkVoidFunction dispatch_table::resolve_slow(const entrypoint &entry) const
+{
+   /* Concurrent resolutions of the same entrypoint publish the same pointer. */
+   PFN_vkVoidFunction fn = m_resolver(m_handle, m_get_proc, entry.name);
+   entry.fn.store(fn);
+   return fn;
+}
+
+VkResult instance_dispatch_table::populate(VkInstance instance, PFN_vkGetInstanceProcAddr get_proc)
+{
+   static constexpr entrypoint entrypoints_init[] = {
+#define DISPATCH_TABLE_ENTRY(name, ext_name, api_version, required) \
+   { "vk" #name, ext_name, nullptr, api_version, false, required },
+      INSTANCE_ENTRYPOINTS_LIST(DISPATCH_TABLE_ENTRY)
+#undef DISPATCH_TABLE_ENTRY
+   };
+   static constexpr const char *eager_names[] = {
+#define EAGER_ENTRY(name) "vk" #name,
+      INSTANCE_EAGER_ENTRYPOINTS_LIST(EAGER_ENTRY)
+#undef EAGER_ENTRY
+   };
+
+   set_resolver(
+      [](void *handle, PFN_vkVoidFunction get_proc, const char *name) {
+         return reinterpret_cast<PFN_vkGetInstanceProcAddr>(get_proc)(reinterpret_cast<VkInstance>(handle), name);
+      },
+      reinterpret_cast<void *>(instance), reinterpret_cast<PFN_vkVoidFunction>(get_proc));
+
+   return populate_entrypoints(entrypoints_init, std::size(entrypoints_init), eager_names, std::size(eager_names));
+}
+
 void dispatch_table::set_user_enabled_extensions(const char *const *extension_names, size_t extension_count)
 {
    for (size_t i = 0; i < extension_count; i++)
@@ -100,7 +149,7 @@ PFN_vkVoidFunction instance_dispatch_table::get_user_enabled_entrypoint(VkInstan
       if (item->second.user_visible || item->second.api_version <= api_version ||
           item->second.api_version == VK_API_VERSION_1_0)
       {
-         return item->second.fn;
+         return resolve(item->second);
       }
       else
       {
@@ -119,28 +168,19 @@ VkResult device_dispatch_table::populate(VkDevice dev, PFN_vkGetDeviceProcAddr g
       DEVICE_ENTRYPOINTS_LIST(DISPATCH_TABLE_ENTRY)
 #undef DISPATCH_TABLE_ENTRY
    };
-   static constexpr auto num_entrypoints = std::distance(std::begin(entrypoints_init), std::end(entrypoints_init));
-
-   for (size_t i = 0; i < num_entrypoints; i++)
-   {
-      const entrypoint entrypoint = entrypoints_init[i];
-      PFN_vkVoidFunction ret = get_proc_fn(dev, entrypoint.name);
-      if (!ret && entrypoint.required)
-      {
-         return VK_ERROR_INITIALIZATION_FAILED;
-      }
-      struct entrypoint e = entrypoint;
-      e.fn = ret;
-      e.user_visible = false;
+   static constexpr const char *eager_names[] = {
+#define EAGER_ENTRY(name) "vk" #name,
+      DEVICE_EAGER_ENTRYPOINTS_LIST(EAGER_ENTRY)
+#undef EAGER_ENTRY
+   };
 
-      if (!m_entrypoints->try_insert(std::make_pair(e.name, e)).has_value())
-      {
-         WSI_LOG_ERROR("Failed to allocate memory for device dispatch table entry.");
-         return VK_ERROR_OUT_OF_HOST_MEMORY;
-      }
-   }
+   set_resolver(
+      [](void *handle, PFN_vkVoidFunction get_proc, const char *name) {
+         return reinterpret_cast<PFN_vkGetDeviceProcAddr>(get_proc)(reinterpret_cast<VkDevice>(handle), name);
+      },
+      reinterpret_cast<void *>(dev), reinterpret_cast<PFN_vkVoidFunction>(get_proc_fn));
 
-   return VK_SUCCESS;
+   return populate_entrypoints(entrypoints_init, std::size(entrypoints_init), eager_names, std::size(eager_names));
 }
 
 PFN_vkVoidFunction device_dispatch_table::get_user_enabled_entrypoint(VkDevice device, uint32_t api_version,
@@ -154,7 +194,7 @@ PFN_vkVoidFunction device_dispatch_table::get_user_enabled_entrypoint(VkDevice d
       if (item->second.user_visible || item->second.api_version <= api_version ||
           item->second.api_version == VK_API_VERSION_1_0)
       {
-         return item->second.fn;
+         return resolve(item->second);
       }
       else
       {
@@ -175,9 +215,18 @@ instance_private_data::instance_private_data(instance_dispatch_table table, PFN_
    , allocator{ alloc }
    , surfaces{ alloc }
    , enabled_extensions{ allocator }
+   , available_device_extensions{ alloc }
 {
 }
 
+instance_private_data::~instance_private_data()
+{
+   for (auto &entry : available_device_extensions)
+   {
+      allocator.destroy<util::extension_list>(1, entry.second);
+   }
+}
+
 /**
  * @brief Obtain the loader's dispatch table for the given dispatchable object.
  * @note Dispatchable objects are structures that have a VkLayerDispatchTable as their first member.
@@ -281,11 +330,12 @@ VkResult instance_private_data::add_surface(VkSurfaceKHR vk_surface, util::uniqu
       surfaces.erase(it);
    }
 
-   auto result = surfaces.try_insert(std::make_pair(vk_surface, nullptr));
+   auto result = surfaces.try_insert(std::make_pair(vk_surface, surface_entry{}));
    if (result.has_value())
    {
       assert(result->second);
-      result->first->second = wsi_surface.release();
+      result->first->second.object_size = wsi_surface.get_deleter().get_object_size();
+      result->first->second.surface = wsi_surface.release();
       return VK_SUCCESS;
    }
 
@@ -298,7 +348,7 @@ wsi::surface *instance_private_data::get_surface(VkSurfaceKHR vk_surface)
    auto it = surfaces.find(vk_surface);
    if (it != surfaces.end())
    {
-      return it->second;
+      return it->second.surface;
    }
 
    return nullptr;
@@ -310,7 +360,7 @@ void instance_private_data::remove_surface(VkSurfaceKHR vk_surface, const util::
    auto it = surfaces.find(vk_surface);
    if (it != surfaces.end())
    {
-      alloc.destroy<wsi::surface>(1, it->second);
+      alloc.destroy_sized<wsi::surface>(it->second.surface, it->second.object_size);
       surfaces.erase(it);
    }
    /* Failing to find a surface is not an error. It could have been created by a WSI extension, which is not handled
@@ -382,6 +432,47 @@ bool instance_private_data::has_frame_boundary_support(VkPhysicalDevice phys_dev
    return frame_boundary.frameBoundary != VK_FALSE;
 }
 
+VkResult instance_private_data::get_available_device_extensions(VkPhysicalDevice phys_dev,
+                                                                const util::extension_list **extensions)
+{
+   scoped_mutex lock(available_device_extensions_lock);
+   auto it = available_device_extensions.find(phys_dev);
+   if (it != available_device_extensions.end())
+   {
+      *extensions = it->second;
+      return VK_SUCCESS;
+   }
+
+   util::allocator command_allocator{ allocator, VK_SYSTEM_ALLOCATION_SCOPE_COMMAND };
+   util::vector<VkExtensionProperties> properties{ command_allocator };
+   uint32_t count = 0;
+   TRY_LOG(disp.EnumerateDeviceExtensionProperties(phys_dev, nullptr, &count, nullptr),
+           "Failed to enumurate properties of available physical device extensions");
+
+   if (!properties.try_resize(count))
+   {
+      return VK_ERROR_OUT_OF_HOST_MEMORY;
+   }
+
+   TRY_LOG(disp.EnumerateDeviceExtensionProperties(phys_dev, nullptr, &count, properties.data()),
+           "Failed to enumurate properties of available physical device extensions");
+
+   auto available = allocator.make_unique<util::extension_list>(allocator);
+   if (available == nullptr)
+   {
+      return VK_ERROR_OUT_OF_HOST_MEMORY;
+   }
+   TRY_LOG_CALL(available->add(properties.data(), count));
+
+   if (!available_device_extensions.try_insert(std::make_pair(phys_dev, available.get())).has_value())
+   {
+      return VK_ERROR_OUT_OF_HOST_MEMORY;
+   }
+
+   *extensions = available.release();
+   return VK_SUCCESS;
+}
+
 VkResult instance_private_data::set_instance_enabled_extensions(const char *const *extension_names,
                                                                 size_t extension_count)
 {
@@ -404,6 +495,7 @@ device_private_data::device_private_data(instance_private_data &inst_data, VkPhy
    , allocator{ alloc }
    , swapchains{ allocator } /* clang-format off */
    , enabled_extensions{ allocator }
+   , queue_families{ allocator }
 #if WSI_IMAGE_COMPRESSION_CONTROL_SWAPCHAIN
    , compression_control_enabled{ false }
 #endif /* WSI_IMAGE_COMPRESSION_CONTROL_SWAPCHAIN */
@@ -541,6 +633,57 @@ bool device_private_data::is_device_extension_enabled(const char *extension_name
    return enabled_extensions.contains(extension_name);
 }
 
+VkResult device_private_data::set_device_queues(const VkDeviceQueueCreateInfo *queue_create_infos,
+                                                uint32_t queue_create_info_count)
+{
+   for (uint32_t i = 0; i < queue_create_info_count; i++)
+   {
+      if (queue_create_infos[i].flags != 0)
+      {
+         continue;
+      }
+      if (!queue_families.try_push_back(
+             std::make_pair(queue_create_infos[i].queueFamilyIndex, queue_create_infos[i].queueCount)))
+      {
+         return VK_ERROR_OUT_OF_HOST_MEMORY;
+      }
+   }
+   return VK_SUCCESS;
+}
+
+bool device_private_data::get_queue_family_index(VkQueue queue, uint32_t &family_index) const
+{
+   for (const auto &family : queue_families)
+   {
+      for (uint32_t i = 0; i < family.second; i++)
+      {
+         VkQueue family_queue = VK_NULL_HANDLE;
+         disp.GetDeviceQueue(device, family.first, i, &family_queue);
+         if (family_queue == queue)
+         {
+            family_index = family.first;
+            return true;
+         }
+      }
+   }
+   return false;
+}
+
+void device_private_data::set_sync_queue(VkQueue queue)
+{
+   sync_queue = queue;
+}
+
+VkQueue device_private_data::get_sync_queue() const
+{
+   return sync_queue;
+}
+
+util::mutex &device_private_data::get_sync_queue_lock()
+{
+   return sync_queue_lock;
+}
+
 void device_private_data::destroy(device_private_data *device_data)
 {
    assert(device_data);
@@ -586,4 +729,14 @@ bool device_private_data::is_swapchain_maintenance1_enabled() const
    return swapchain_maintenance1_enabled;
 }
 
+void device_private_data::set_timeline_semaphore_enabled(bool enable)
+{
+   timeline_semaphore_enabled = enable;
+}
+
+bool device_private_data::is_timeline_semaphore_enabled() const
+{
+   return timeline_semaphore_enabled;
+}
+
 } /* namespace layer */
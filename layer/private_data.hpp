@@ -26,9 +26,10 @@
 
 #include "util/platform_set.hpp"
 #include "util/custom_allocator.hpp"
-#include "util/unordered_set.hpp"
-#include "util/unordered_map.hpp"
+#include "util/flat_map.hpp"
+#include "util/flat_set.hpp"
 #include "util/extension_list.hpp"
+#include "util/instrumented_mutex.hpp"
 
 #include <vulkan/vulkan.h>
 #include <vulkan/vk_layer.h>
@@ -38,14 +39,16 @@
 #include <xcb/xcb.h>
 #include <vulkan/vulkan_xcb.h>
 
+#include <atomic>
 #include <memory>
 #include <unordered_set>
 #include <cassert>
 #include <mutex>
 #include <limits>
 #include <cstring>
+#include <utility>
 
-using scoped_mutex = std::lock_guard<std::mutex>;
+using scoped_mutex = util::lock_guard<util::mutex>;
 
 /** Forward declare stored objects */
 namespace wsi
@@ -56,6 +59,49 @@ class surface;
 namespace layer
 {
 
+/**
+ * @brief Placeholder stored in the entrypoints that have not been resolved yet. Never called.
+ */
+VKAPI_ATTR void VKAPI_CALL unresolved_entrypoint();
+
+/**
+ * @brief Function pointer of an entrypoint.
+ *
+ * The pointer is published atomically, so that an entrypoint can be resolved on first use by any thread.
+ */
+class entrypoint_slot
+{
+public:
+   constexpr entrypoint_slot(PFN_vkVoidFunction fn)
+      : m_fn(fn)
+   {
+   }
+
+   entrypoint_slot(const entrypoint_slot &other)
+      : m_fn(other.load())
+   {
+   }
+
+   entrypoint_slot &operator=(const entrypoint_slot &other)
+   {
+      store(other.load());
+      return *this;
+   }
+
+   PFN_vkVoidFunction load() const
+   {
+      return m_fn.load(std::memory_order_acquire);
+   }
+
+   void store(PFN_vkVoidFunction fn) const
+   {
+      m_fn.store(fn, std::memory_order_release);
+   }
+
+private:
+   mutable std::atomic<PFN_vkVoidFunction> m_fn;
+};
+
 /**
  * @brief Definition of an entrypoint.
  */
@@ -63,7 +109,7 @@ struct entrypoint
 {
    const char *name;
    const char *ext_name;
-   PFN_vkVoidFunction fn;
+   entrypoint_slot fn;
    uint32_t api_version;
    bool user_visible;
    bool required;
@@ -77,7 +123,8 @@ struct entrypoint
 class dispatch_table
 {
 public:
-   using entrypoint_list = util::unordered_map<std::string, entrypoint>;
+   /* The keys point to the names of the static entrypoint definitions. */
+   using entrypoint_list = util::flat_map<const char *, entrypoint, util::cstring_hash, util::cstring_equal>;
 
    /**
     * @brief Construct a new dispatch table object
@@ -96,7 +143,7 @@ public:
     *
     * @tparam FunctionType The signature of the requested function.
     * @param fn_name The name of the function.
-    * @return the requested function pointer, or std::nullopt.
+    * @return the requested function pointer, or std::nullopt if it is not in the table or not available.
     */
    template <typename FunctionType>
    std::optional<FunctionType> get_fn(const char *fn_name) const
@@ -104,7 +151,11 @@ public:
       auto fn = m_entrypoints->find(fn_name);
       if (fn != m_entrypoints->end())
       {
-         return reinterpret_cast<FunctionType>(fn->second.fn);
+         PFN_vkVoidFunction resolved = resolve(fn->second);
+         if (resolved != nullptr)
+         {
+            return reinterpret_cast<FunctionType>(resolved);
+         }
       }
 
       return std::nullopt;
@@ -119,6 +170,55 @@ public:
    void set_user_enabled_extensions(const char *const *extension_names, size_t extension_count);
 
 protected:
+   /**
+    * @brief Resolves an entrypoint with the vkGet*ProcAddr function of the next layer.
+    *
+    * @param handle   The dispatchable object the dispatch table was populated for.
+    * @param get_proc The vkGet*ProcAddr function of the next layer.
+    * @param name     The name of the entrypoint.
+    */
+   using resolver = PFN_vkVoidFunction (*)(void *handle, PFN_vkVoidFunction get_proc, const char *name);
+
+   /**
+    * @brief Set how the entrypoints that are not resolved when the table is populated are resolved.
+    */
+   void set_resolver(resolver resolve_fn, void *handle, PFN_vkVoidFunction get_proc)
+   {
+      m_resolver = resolve_fn;
+      m_handle = handle;
+      m_get_proc = get_proc;
+   }
+
+   /**
+    * @brief Populate the dispatch table entrypoints.
+    *
+    * When WSI_LAZY_ENTRYPOINTS is enabled only the required entrypoints and the ones listed in @p eager_names are
+    * resolved, the other optional entrypoints are resolved on first use. A required entrypoint that is not available
+    * always makes this function fail.
+    *
+    * @param entrypoints     The entrypoints of the dispatch table.
+    * @param num_entrypoints Number of entrypoints.
+    * @param eager_names     The entrypoints that are always resolved immediately.
+    * @param num_eager_names Number of eagerly resolved entrypoints.
+    *
+    * @return VK_SUCCESS if successful, otherwise an error.
+    */
+   VkResult populate_entrypoints(const entrypoint *entrypoints, size_t num_entrypoints, const char *const *eager_names,
+                                 size_t num_eager_names);
+
+   /**
+    * @brief Get the function pointer of an entrypoint, resolving it if needed.
+    */
+   PFN_vkVoidFunction resolve(const entrypoint &entry) const
+   {
+      PFN_vkVoidFunction fn = entry.fn.load();
+      if (fn == unresolved_entrypoint)
+      {
+         fn = resolve_slow(entry);
+      }
+      return fn;
+   }
+
    /**
     * @brief Call function from the dispatch table entrypoints.
     *
@@ -140,7 +240,7 @@ protected:
          return (*fn)(std::forward<Args>(args)...);
       }
 
-      WSI_LOG_WARNING("Call to %s failed, dispatch table does not contain the function.", fn_name);
+      WSI_LOG_SWAPCHAIN_WARNING("Call to %s failed, dispatch table does not contain the function.", fn_name);
 
       return std::nullopt;
    }
@@ -165,7 +265,7 @@ protected:
          return (*fn)(std::forward<Args>(args)...);
       }
 
-      WSI_LOG_WARNING("Call to %s failed, dispatch table does not contain the function.", fn_name);
+      WSI_LOG_SWAPCHAIN_WARNING("Call to %s failed, dispatch table does not contain the function.", fn_name);
    }
 
    /**
@@ -189,13 +289,20 @@ protected:
          return (*fn)(std::forward<Args>(args)...);
       }
 
-      WSI_LOG_WARNING("Call to %s failed, dispatch table does not contain the function.", fn_name);
+      WSI_LOG_SWAPCHAIN_WARNING("Call to %s failed, dispatch table does not contain the function.", fn_name);
 
       return VK_ERROR_EXTENSION_NOT_PRESENT;
    }
 
    /** @brief Vector that holds the entrypoints of the dispatch table */
    util::unique_ptr<entrypoint_list> m_entrypoints;
+
+private:
+   PFN_vkVoidFunction resolve_slow(const entrypoint &entry) const;
+
+   resolver m_resolver{ nullptr };
+   void *m_handle{ nullptr };
+   PFN_vkVoidFunction m_get_proc{ nullptr };
 };
 
 /* Represents the maximum possible Vulkan API version. */
@@ -204,7 +311,8 @@ static constexpr uint32_t API_VERSION_MAX = UINT32_MAX;
 /* List of instance entrypoints in the layer's instance dispatch table.
  * Note that the Vulkan loader implements some of these entrypoints so the fact that these are non-null doesn't
  * guarantee than we can safely call them. We still mark the entrypoints required == true / false. The layer
- * fails if vkGetInstanceProcAddr returns null for entrypoints that are required.
+ * fails if vkGetInstanceProcAddr returns null for entrypoints that are required. Required entrypoints are resolved
+ * when the dispatch table is populated even if lazy resolution is enabled.
  *
  * Format of an entry is: EP(entrypoint_name, extension_name, api_version, required)
  * entrypoint_name: Name of the entrypoint.
@@ -217,6 +325,8 @@ static constexpr uint32_t API_VERSION_MAX = UINT32_MAX;
    EP(GetInstanceProcAddr, "", VK_API_VERSION_1_0, true)                                                             \
    EP(DestroyInstance, "", VK_API_VERSION_1_0, true)                                                                 \
    EP(GetPhysicalDeviceProperties, "", VK_API_VERSION_1_0, true)                                                     \
+   EP(GetPhysicalDeviceMemoryProperties, "", VK_API_VERSION_1_0, true)                                               \
+   EP(GetPhysicalDeviceQueueFamilyProperties, "", VK_API_VERSION_1_0, true)                                          \
    EP(GetPhysicalDeviceImageFormatProperties, "", VK_API_VERSION_1_0, true)                                          \
    EP(EnumerateDeviceExtensionProperties, "", VK_API_VERSION_1_0, true)                                              \
    /* VK_KHR_surface */                                                                                              \
@@ -261,8 +371,17 @@ static constexpr uint32_t API_VERSION_MAX = UINT32_MAX;
    EP(GetPhysicalDeviceExternalFencePropertiesKHR, VK_KHR_EXTERNAL_FENCE_CAPABILITIES_EXTENSION_NAME,                \
       VK_API_VERSION_1_1, false)                                                                                     \
    EP(GetPhysicalDeviceExternalBufferPropertiesKHR, VK_KHR_EXTERNAL_MEMORY_CAPABILITIES_EXTENSION_NAME,              \
+      VK_API_VERSION_1_1, false)                                                                                     \
+   /* VK_KHR_external_semaphore_capabilities or */                                                                   \
+   /* 1.1 (without KHR suffix) */                                                                                    \
+   EP(GetPhysicalDeviceExternalSemaphorePropertiesKHR, VK_KHR_EXTERNAL_SEMAPHORE_CAPABILITIES_EXTENSION_NAME,        \
       VK_API_VERSION_1_1, false)
 
+/* Optional instance entrypoints resolved when the dispatch table is populated even if lazy resolution is enabled. */
+#define INSTANCE_EAGER_ENTRYPOINTS_LIST(EAGER) \
+   EAGER(GetInstanceProcAddr)                  \
+   EAGER(DestroyInstance)
+
 /**
  * @brief Struct representing the instance dispatch table.
  */
@@ -357,6 +476,8 @@ private:
    EP(ResetCommandBuffer, "", VK_API_VERSION_1_0, true)                                                                \
    EP(BeginCommandBuffer, "", VK_API_VERSION_1_0, true)                                                                \
    EP(EndCommandBuffer, "", VK_API_VERSION_1_0, true)                                                                  \
+   EP(CmdPipelineBarrier, "", VK_API_VERSION_1_0, true)                                                                \
+   EP(CmdCopyImageToBuffer, "", VK_API_VERSION_1_0, true)                                                              \
    EP(CreateImage, "", VK_API_VERSION_1_0, true)                                                                       \
    EP(DestroyImage, "", VK_API_VERSION_1_0, true)                                                                      \
    EP(GetImageMemoryRequirements, "", VK_API_VERSION_1_0, true)                                                        \
@@ -364,12 +485,21 @@ private:
    EP(BindImageMemory, "", VK_API_VERSION_1_0, true)                                                                   \
    EP(AllocateMemory, "", VK_API_VERSION_1_0, true)                                                                    \
    EP(FreeMemory, "", VK_API_VERSION_1_0, true)                                                                        \
+   EP(MapMemory, "", VK_API_VERSION_1_0, true)                                                                         \
+   EP(UnmapMemory, "", VK_API_VERSION_1_0, true)                                                                       \
+   EP(InvalidateMappedMemoryRanges, "", VK_API_VERSION_1_0, true)                                                      \
+   EP(CreateBuffer, "", VK_API_VERSION_1_0, true)                                                                      \
+   EP(DestroyBuffer, "", VK_API_VERSION_1_0, true)                                                                     \
+   EP(GetBufferMemoryRequirements, "", VK_API_VERSION_1_0, true)                                                       \
+   EP(BindBufferMemory, "", VK_API_VERSION_1_0, true)                                                                  \
    EP(CreateFence, "", VK_API_VERSION_1_0, true)                                                                       \
    EP(DestroyFence, "", VK_API_VERSION_1_0, true)                                                                      \
    EP(CreateSemaphore, "", VK_API_VERSION_1_0, true)                                                                   \
    EP(DestroySemaphore, "", VK_API_VERSION_1_0, true)                                                                  \
    EP(ResetFences, "", VK_API_VERSION_1_0, true)                                                                       \
    EP(WaitForFences, "", VK_API_VERSION_1_0, true)                                                                     \
+   /* 1.2 */                                                                                                           \
+   EP(WaitSemaphores, "", VK_API_VERSION_1_2, false)                                                                   \
    EP(DestroyDevice, "", VK_API_VERSION_1_0, true)                                                                     \
    /* VK_KHR_swapchain */                                                                                              \
    EP(CreateSwapchainKHR, VK_KHR_SWAPCHAIN_EXTENSION_NAME, API_VERSION_MAX, false)                                     \
@@ -389,6 +519,8 @@ private:
    /* VK_KHR_external_memory_fd */                                                                                     \
    EP(GetMemoryFdKHR, VK_KHR_EXTERNAL_MEMORY_FD_EXTENSION_NAME, API_VERSION_MAX, false)                                \
    EP(GetMemoryFdPropertiesKHR, VK_KHR_EXTERNAL_MEMORY_FD_EXTENSION_NAME, API_VERSION_MAX, false)                      \
+   /* VK_EXT_external_memory_host */                                                                                   \
+   EP(GetMemoryHostPointerPropertiesEXT, VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME, API_VERSION_MAX, false)           \
    /* VK_KHR_bind_memory2 or */                                                                                        \
    /* 1.1 (without KHR suffix) */                                                                                      \
    EP(BindImageMemory2KHR, VK_KHR_BIND_MEMORY_2_EXTENSION_NAME, VK_API_VERSION_1_1, false)                             \
@@ -399,6 +531,8 @@ private:
    /* VK_KHR_external_semaphore_fd */                                                                                  \
    EP(ImportSemaphoreFdKHR, VK_KHR_EXTERNAL_SEMAPHORE_FD_EXTENSION_NAME, API_VERSION_MAX, false)                       \
    EP(GetSemaphoreFdKHR, VK_KHR_EXTERNAL_SEMAPHORE_FD_EXTENSION_NAME, API_VERSION_MAX, false)                          \
+   /* VK_KHR_timeline_semaphore */                                                                                     \
+   EP(WaitSemaphoresKHR, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME, API_VERSION_MAX, false)                             \
    /* VK_KHR_image_drm_format_modifier */                                                                              \
    EP(GetImageDrmFormatModifierPropertiesEXT, VK_EXT_IMAGE_DRM_FORMAT_MODIFIER_EXTENSION_NAME, API_VERSION_MAX, false) \
    /* VK_KHR_sampler_ycbcr_conversion */                                                                               \
@@ -414,6 +548,19 @@ private:
    EP(ReleaseSwapchainImagesEXT, VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME, VK_API_VERSION_1_1, false)             \
    EP(GetMemoryAndroidHardwareBufferANDROID, VK_ANDROID_EXTERNAL_MEMORY_ANDROID_HARDWARE_BUFFER_EXTENSION_NAME, API_VERSION_MAX, false)
 
+/* Device entrypoints resolved when the dispatch table is populated even if lazy resolution is enabled, as they are
+ * used on the acquire and present paths. Required entrypoints are always resolved, whether listed here or not. */
+#define DEVICE_EAGER_ENTRYPOINTS_LIST(EAGER) \
+   EAGER(GetDeviceProcAddr)                  \
+   EAGER(QueueSubmit)                        \
+   EAGER(ResetFences)                        \
+   EAGER(WaitForFences)                      \
+   EAGER(AcquireNextImageKHR)                \
+   EAGER(QueuePresentKHR)                    \
+   EAGER(ImportFenceFdKHR)                   \
+   EAGER(ImportSemaphoreFdKHR)               \
+   EAGER(GetFenceFdKHR)
+
 /**
  * @brief Struct representing the device dispatch table.
  */
@@ -497,6 +644,7 @@ public:
    instance_private_data() = delete;
    instance_private_data(const instance_private_data &) = delete;
    instance_private_data &operator=(const instance_private_data &) = delete;
+   ~instance_private_data();
 
    /**
     * @brief Create and associate a new #instance_private_data to the given #VkInstance.
@@ -606,6 +754,19 @@ public:
 
    bool has_frame_boundary_support(VkPhysicalDevice phys_dev);
 
+   /**
+    * @brief Get the device extensions available on a physical device.
+    *
+    * The extensions are enumerated the first time they are requested for a physical device and cached until the
+    * instance is destroyed, so creating more devices does not enumerate them again.
+    *
+    * @param phys_dev        The physical device to query.
+    * @param[out] extensions Set to the list of available extensions, valid until the instance is destroyed.
+    *
+    * @return VK_SUCCESS if successful, otherwise an error.
+    */
+   VkResult get_available_device_extensions(VkPhysicalDevice phys_dev, const util::extension_list **extensions);
+
    /**
     * @brief Get the instance allocator
     *
@@ -677,17 +838,33 @@ private:
     * Uses plain pointers to store surface data as the lifetime of the object is explicitly controlled by the Vulkan
     * application. The application may also use different but compatible host allocators on creation and destruction.
     */
-   util::unordered_map<VkSurfaceKHR, wsi::surface *> surfaces;
+   struct surface_entry
+   {
+      wsi::surface *surface{ nullptr };
+      /* Size of the type the surface was created as. */
+      size_t object_size{ 0 };
+   };
+   util::flat_map<VkSurfaceKHR, surface_entry> surfaces;
 
    /**
     * @brief Lock for thread safe access to @ref surfaces
     */
-   std::mutex surfaces_lock;
+   util::mutex surfaces_lock{ "surfaces_lock" };
 
    /**
     * @brief List with the names of the enabled instance extensions.
     */
    util::extension_list enabled_extensions;
+
+   /**
+    * @brief Cache of the device extensions available on each physical device.
+    */
+   util::flat_map<VkPhysicalDevice, util::extension_list *> available_device_extensions;
+
+   /**
+    * @brief Lock for thread safe access to @ref available_device_extensions
+    */
+   util::mutex available_device_extensions_lock{ "available_device_extensions_lock" };
 };
 
 /**
@@ -792,6 +969,50 @@ public:
     */
    bool is_device_extension_enabled(const char *extension_name) const;
 
+   /**
+    * @brief Store the queues created with the device.
+    *
+    * @param queue_create_infos      The queue create infos passed to vkCreateDevice.
+    * @param queue_create_info_count Number of queue create infos.
+    *
+    * @return VK_SUCCESS if successful, otherwise an error.
+    */
+   VkResult set_device_queues(const VkDeviceQueueCreateInfo *queue_create_infos, uint32_t queue_create_info_count);
+
+   /**
+    * @brief Find the queue family of a queue created with the device.
+    *
+    * Only queues that can be retrieved with vkGetDeviceQueue, i.e. created without flags, are found.
+    *
+    * @param queue             The queue.
+    * @param[out] family_index The queue family index of @p queue.
+    *
+    * @return true if the queue was found, false otherwise.
+    */
+   bool get_queue_family_index(VkQueue queue, uint32_t &family_index) const;
+
+   /**
+    * @brief Set the queue reserved by the layer at device creation for its own synchronization submissions.
+    *
+    * @param queue The reserved queue, already initialized with the loader's dispatch data.
+    */
+   void set_sync_queue(VkQueue queue);
+
+   /**
+    * @brief Get the queue reserved by the layer for its own synchronization submissions.
+    *
+    * The queue is not visible to the application, so submissions to it do not wait for application work. Callers
+    * must hold the lock returned by @ref get_sync_queue_lock while submitting to it.
+    *
+    * @return The queue, or VK_NULL_HANDLE if no queue could be reserved.
+    */
+   VkQueue get_sync_queue() const;
+
+   /**
+    * @brief Get the lock serializing the submissions to the queue returned by @ref get_sync_queue.
+    */
+   util::mutex &get_sync_queue_lock();
+
    const device_dispatch_table disp;
    instance_private_data &instance_data;
    const PFN_vkSetDeviceLoaderData SetDeviceLoaderData;
@@ -849,6 +1070,20 @@ public:
     */
    bool is_swapchain_maintenance1_enabled() const;
 
+   /**
+    * @brief Set whether the timeline semaphore feature is enabled for this device.
+    *
+    * @param enable Value to set timeline_semaphore_enabled member variable.
+    */
+   void set_timeline_semaphore_enabled(bool enable);
+
+   /**
+    * @brief Check whether the timeline semaphore feature is enabled for this device.
+    *
+    * @return true if enabled, false otherwise.
+    */
+   bool is_timeline_semaphore_enabled() const;
+
 private:
    /* Allow util::allocator to access the private constructor */
    friend util::allocator;
@@ -876,14 +1111,29 @@ private:
    static void destroy(device_private_data *device_data);
 
    const util::allocator allocator;
-   util::unordered_set<VkSwapchainKHR> swapchains;
-   mutable std::mutex swapchains_lock;
+   util::flat_set<VkSwapchainKHR> swapchains;
+   mutable util::mutex swapchains_lock{ "swapchains_lock" };
 
    /**
     * @brief List with the names of the enabled device extensions.
     */
    util::extension_list enabled_extensions;
 
+   /**
+    * @brief Queue family index and number of queues of the queues created without flags.
+    */
+   util::vector<std::pair<uint32_t, uint32_t>> queue_families;
+
+   /**
+    * @brief Queue reserved by the layer for its own synchronization submissions, VK_NULL_HANDLE if none.
+    */
+   VkQueue sync_queue{ VK_NULL_HANDLE };
+
+   /**
+    * @brief Lock serializing the submissions to sync_queue, as it may be shared by several swapchains.
+    */
+   util::mutex sync_queue_lock{ "sync_queue_lock" };
+
 #if WSI_IMAGE_COMPRESSION_CONTROL_SWAPCHAIN
    /**
     * @brief Stores whether the device supports controlling the swapchain image compression.
@@ -907,6 +1157,11 @@ private:
     * @brief Stores whether the device has enabled support for the swapchain maintenance1 features.
     */
    bool swapchain_maintenance1_enabled;
+
+   /**
+    * @brief Stores whether the device has enabled the timeline semaphore feature.
+    */
+   bool timeline_semaphore_enabled{ false };
 };
 
 } /* namespace layer */
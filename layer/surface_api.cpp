@@ -170,6 +170,7 @@ wsi_layer_vkDestroySurfaceKHR(VkInstance instance, VkSurfaceKHR surface,
 
    instance_data.disp.DestroySurfaceKHR(instance, surface, pAllocator);
 
-   instance_data.remove_surface(
-      surface, util::allocator{ instance_data.get_allocator(), VK_SYSTEM_ALLOCATION_SCOPE_OBJECT, pAllocator });
+   instance_data.remove_surface(surface, util::allocator{ instance_data.get_allocator(),
+                                                         VK_SYSTEM_ALLOCATION_SCOPE_OBJECT, pAllocator,
+                                                         util::memory_subsystem::surface });
 }
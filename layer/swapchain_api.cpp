@@ -32,11 +32,13 @@
 #include <cstdlib>
 #include <new>
 
+#include <wsi/extension_chains.hpp>
 #include <wsi/wsi_factory.hpp>
 
 #include "private_data.hpp"
 #include "swapchain_api.hpp"
 #include <util/helpers.hpp>
+#include <util/trace.hpp>
 #include "wsi/synchronization.hpp"
 
 VWL_VKAPI_CALL(VkResult)
@@ -110,6 +112,7 @@ VWL_VKAPI_CALL(VkResult)
 wsi_layer_vkAcquireNextImageKHR(VkDevice device, VkSwapchainKHR swapc, uint64_t timeout, VkSemaphore semaphore,
                                 VkFence fence, uint32_t *pImageIndex) VWL_API_POST
 {
+   WSI_TRACE_SCOPE("vkAcquireNextImageKHR");
    layer::device_private_data &device_data = layer::device_private_data::get(device);
 
    if (!device_data.layer_owns_swapchain(swapc))
@@ -124,6 +127,7 @@ wsi_layer_vkAcquireNextImageKHR(VkDevice device, VkSwapchainKHR swapc, uint64_t
 }
 
 static VkResult submit_wait_request(VkQueue queue, const VkPresentInfoKHR &present_info,
+                                    const VkFrameBoundaryEXT *app_frame_boundary,
                                     layer::device_private_data &device_data, bool &frame_boundary_event_handled)
 {
    util::vector<VkSemaphore> swapchain_semaphores{ util::allocator(device_data.get_allocator(),
@@ -144,7 +148,7 @@ static VkResult submit_wait_request(VkQueue queue, const VkPresentInfoKHR &prese
                                                static_cast<uint32_t>(swapchain_semaphores.size()) };
 
    void *submission_pnext = nullptr;
-   auto frame_boundary = wsi::create_frame_boundary(present_info);
+   auto frame_boundary = wsi::create_frame_boundary(app_frame_boundary);
    if (frame_boundary.has_value())
    {
       submission_pnext = &frame_boundary.value();
@@ -163,6 +167,7 @@ wsi_layer_vkQueuePresentKHR(VkQueue queue, const VkPresentInfoKHR *pPresentInfo)
    assert(queue != VK_NULL_HANDLE);
    assert(pPresentInfo != nullptr);
 
+   WSI_TRACE_SCOPE("vkQueuePresentKHR");
    layer::device_private_data &device_data = layer::device_private_data::get(queue);
 
    if (!device_data.layer_owns_all_swapchains(pPresentInfo->pSwapchains, pPresentInfo->swapchainCount))
@@ -170,26 +175,27 @@ wsi_layer_vkQueuePresentKHR(VkQueue queue, const VkPresentInfoKHR *pPresentInfo)
       return device_data.disp.QueuePresentKHR(queue, pPresentInfo);
    }
 
+   /* Walk the pNext chain once for all the structures the layer handles. */
+   const auto extensions = wsi::decode_present_info_extensions(*pPresentInfo);
+
    /* Avoid allocating on the heap when there is only one swapchain. */
    const VkPresentInfoKHR *present_info = pPresentInfo;
    bool use_image_present_semaphore = false;
    bool frame_boundary_event_handled = true;
    if (pPresentInfo->swapchainCount > 1)
    {
-      TRY_LOG_CALL(submit_wait_request(queue, *pPresentInfo, device_data, frame_boundary_event_handled));
+      TRY_LOG_CALL(submit_wait_request(queue, *pPresentInfo, extensions.frame_boundary, device_data,
+                                       frame_boundary_event_handled));
       use_image_present_semaphore = true;
    }
 
    VkResult ret = VK_SUCCESS;
 
-   auto *present_ids = util::find_extension<VkPresentIdKHR>(VK_STRUCTURE_TYPE_PRESENT_ID_KHR, pPresentInfo->pNext);
-   const auto present_fence_info = util::find_extension<VkSwapchainPresentFenceInfoEXT>(
-      VK_STRUCTURE_TYPE_SWAPCHAIN_PRESENT_FENCE_INFO_EXT, present_info->pNext);
-   const auto swapchain_present_mode_info = util::find_extension<VkSwapchainPresentModeInfoEXT>(
-      VK_STRUCTURE_TYPE_SWAPCHAIN_PRESENT_MODE_INFO_EXT, present_info->pNext);
+   const auto *present_ids = extensions.present_id;
+   const auto *present_fence_info = extensions.present_fence_info;
+   const auto *swapchain_present_mode_info = extensions.present_mode_info;
 #if VULKAN_WSI_LAYER_EXPERIMENTAL
-   const auto present_timings_info =
-      util::find_extension<VkPresentTimingsInfoEXT>(VK_STRUCTURE_TYPE_PRESENT_TIMINGS_INFO_EXT, present_info->pNext);
+   const auto *present_timings_info = extensions.present_timings_info;
    if (present_timings_info)
    {
       assert(present_timings_info->swapchainCount == pPresentInfo->swapchainCount);
@@ -220,6 +226,7 @@ wsi_layer_vkQueuePresentKHR(VkQueue queue, const VkPresentInfoKHR *pPresentInfo)
 
       present_params.use_image_present_semaphore = use_image_present_semaphore;
       present_params.handle_present_frame_boundary_event = frame_boundary_event_handled;
+      present_params.frame_boundary = extensions.frame_boundary;
 
 #if VULKAN_WSI_LAYER_EXPERIMENTAL
       if (present_timings_info)
@@ -333,6 +340,7 @@ wsi_layer_vkAcquireNextImage2KHR(VkDevice device, const VkAcquireNextImageInfoKH
    assert(pAcquireInfo->semaphore != VK_NULL_HANDLE || pAcquireInfo->fence != VK_NULL_HANDLE);
    assert(pImageIndex != nullptr);
 
+   WSI_TRACE_SCOPE("vkAcquireNextImage2KHR");
    auto &device_data = layer::device_private_data::get(device);
 
    if (!device_data.layer_owns_swapchain(pAcquireInfo->swapchain))
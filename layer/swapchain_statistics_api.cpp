@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file swapchain_statistics_api.cpp
+ *
+ * @brief Contains the Vulkan entrypoints for the layer private swapchain statistics extension.
+ */
+#include <cassert>
+#include "wsi_layer_statistics.hpp"
+#include "wsi/swapchain_base.hpp"
+#include "util/helpers.hpp"
+#include "util/memory_accounting.hpp"
+
+namespace
+{
+
+VkMemoryCounterWSI to_memory_counter(const util::memory_counter &counter)
+{
+   return { counter.current.load(std::memory_order_relaxed), counter.peak.load(std::memory_order_relaxed) };
+}
+
+void get_memory_statistics(VkLayerMemoryStatisticsWSI &statistics)
+{
+   namespace accounting = util::memory_accounting;
+
+   statistics.hostTotal = to_memory_counter(accounting::get_host_total());
+   for (size_t scope = 0; scope < accounting::NUM_SCOPES; scope++)
+   {
+      statistics.hostScopes[scope] =
+         to_memory_counter(accounting::get_host_scope(static_cast<VkSystemAllocationScope>(scope)));
+   }
+   statistics.hostGeneral = to_memory_counter(accounting::get_host_subsystem(util::memory_subsystem::general));
+   statistics.hostInstance = to_memory_counter(accounting::get_host_subsystem(util::memory_subsystem::instance));
+   statistics.hostDevice = to_memory_counter(accounting::get_host_subsystem(util::memory_subsystem::device));
+   statistics.hostSurface = to_memory_counter(accounting::get_host_subsystem(util::memory_subsystem::surface));
+   statistics.hostSwapchain = to_memory_counter(accounting::get_host_subsystem(util::memory_subsystem::swapchain));
+   statistics.deviceMemory = to_memory_counter(accounting::get_device_memory(util::device_memory_kind::device_memory));
+   statistics.dmaBuf = to_memory_counter(accounting::get_device_memory(util::device_memory_kind::dma_buf));
+   statistics.hardwareBuffer =
+      to_memory_counter(accounting::get_device_memory(util::device_memory_kind::hardware_buffer));
+}
+
+} /* namespace */
+
+/**
+ * @brief Implements vkGetSwapchainStatisticsWSI Vulkan entrypoint.
+ */
+VWL_VKAPI_CALL(VkResult)
+wsi_layer_vkGetSwapchainStatisticsWSI(VkDevice device, VkSwapchainKHR swapchain,
+                                      VkSwapchainStatisticsWSI *pStatistics) VWL_API_POST
+{
+   assert(swapchain != VK_NULL_HANDLE);
+   assert(pStatistics != nullptr);
+   assert(pStatistics->sType == VK_STRUCTURE_TYPE_SWAPCHAIN_STATISTICS_WSI);
+
+   auto &device_data = layer::device_private_data::get(device);
+   if (!device_data.layer_owns_swapchain(swapchain))
+   {
+      return VK_ERROR_FEATURE_NOT_PRESENT;
+   }
+
+   auto *sc = reinterpret_cast<wsi::swapchain_base *>(swapchain);
+   sc->get_statistics(*pStatistics);
+
+   auto *latency_statistics = util::find_extension<VkSwapchainLatencyStatisticsWSI>(
+      VK_STRUCTURE_TYPE_SWAPCHAIN_LATENCY_STATISTICS_WSI, pStatistics->pNext);
+   if (latency_statistics != nullptr)
+   {
+      sc->get_latency_statistics(*latency_statistics);
+   }
+
+   auto *memory_statistics = util::find_extension<VkLayerMemoryStatisticsWSI>(
+      VK_STRUCTURE_TYPE_LAYER_MEMORY_STATISTICS_WSI, pStatistics->pNext);
+   if (memory_statistics != nullptr)
+   {
+      get_memory_statistics(*memory_statistics);
+   }
+   return VK_SUCCESS;
+}
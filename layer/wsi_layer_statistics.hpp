@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file wsi_layer_statistics.hpp
+ *
+ * @brief Contains the Vulkan definitions for the layer private swapchain statistics extension.
+ *
+ * VK_WSI_swapchain_statistics is implemented by this layer only and is not registered with Khronos.
+ * Applications and tools enable it as a device extension and then sample the statistics of their
+ * swapchains with vkGetSwapchainStatisticsWSI, retrieved with vkGetDeviceProcAddr.
+ */
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include "util/macros.hpp"
+
+#define VK_WSI_swapchain_statistics 1
+#define VK_WSI_SWAPCHAIN_STATISTICS_SPEC_VERSION 1
+#define VK_WSI_SWAPCHAIN_STATISTICS_EXTENSION_NAME "VK_WSI_swapchain_statistics"
+
+/* Value outside of the ranges reserved for the registered extensions. */
+#define VK_STRUCTURE_TYPE_SWAPCHAIN_STATISTICS_WSI ((VkStructureType)1999999000)
+#define VK_STRUCTURE_TYPE_SWAPCHAIN_LATENCY_STATISTICS_WSI ((VkStructureType)1999999001)
+#define VK_STRUCTURE_TYPE_LAYER_MEMORY_STATISTICS_WSI ((VkStructureType)1999999002)
+
+#define VK_SWAPCHAIN_STATISTICS_HISTOGRAM_BUCKET_COUNT_WSI 32U
+
+/**
+ * @brief Distribution of a quantity sampled by the layer.
+ *
+ * Bucket 0 counts the samples equal to 0 and bucket i, for i > 0, counts the samples in [2^(i-1), 2^i).
+ * The last bucket also counts all the larger samples.
+ */
+typedef struct VkSwapchainHistogramWSI
+{
+   uint64_t sampleCount;
+   uint64_t sum;
+   uint64_t max;
+   uint64_t buckets[VK_SWAPCHAIN_STATISTICS_HISTOGRAM_BUCKET_COUNT_WSI];
+} VkSwapchainHistogramWSI;
+
+/**
+ * @brief Statistics of a swapchain since its creation. All the times are in microseconds.
+ */
+typedef struct VkSwapchainStatisticsWSI
+{
+   VkStructureType sType;
+   void *pNext;
+   uint64_t acquireCount;
+   uint64_t presentCount;
+   uint64_t droppedFrameCount;
+   uint64_t errorTransitionCount;
+   VkResult lastErrorState;
+   uint32_t currentQueueDepth;
+   VkDeviceSize allocatedBytes;
+   /* Time spent by vkAcquireNextImageKHR waiting for a free image. */
+   VkSwapchainHistogramWSI acquireWait;
+   /* Time from vkQueuePresentKHR to the image being handed over to the presentation engine. */
+   VkSwapchainHistogramWSI presentToLatch;
+   /* Time spent waiting for the rendering of the presented images to complete. */
+   VkSwapchainHistogramWSI imageWaitPresent;
+   /* Time spent in the backend present call. */
+   VkSwapchainHistogramWSI backendPresent;
+   /* Number of present requests waiting for the presentation engine, sampled at every present. */
+   VkSwapchainHistogramWSI queueDepth;
+} VkSwapchainStatisticsWSI;
+
+/**
+ * @brief Latency of the stages of the present requests, in microseconds.
+ *
+ * Can be chained to VkSwapchainStatisticsWSI. The histograms are only filled when the layer runs with
+ * VULKAN_WSI_LATENCY_MEASUREMENT=1, in which case measurementEnabled is VK_TRUE.
+ */
+typedef struct VkSwapchainLatencyStatisticsWSI
+{
+   VkStructureType sType;
+   void *pNext;
+   VkBool32 measurementEnabled;
+   /* From vkQueuePresentKHR to the completion of the rendering of the image. */
+   VkSwapchainHistogramWSI render;
+   /* From the completion of the rendering to the submission of the image to the presentation engine. */
+   VkSwapchainHistogramWSI submit;
+   /* From the submission to the presentation engine to the image being presented. */
+   VkSwapchainHistogramWSI display;
+   /* From vkQueuePresentKHR to the image being presented. */
+   VkSwapchainHistogramWSI endToEnd;
+} VkSwapchainLatencyStatisticsWSI;
+
+/**
+ * @brief Amount of memory currently allocated, in bytes, and its high-water mark.
+ */
+typedef struct VkMemoryCounterWSI
+{
+   VkDeviceSize current;
+   VkDeviceSize peak;
+} VkMemoryCounterWSI;
+
+/**
+ * @brief Memory allocated by the layer across all its instances and devices.
+ *
+ * Can be chained to VkSwapchainStatisticsWSI. The host memory only covers the allocations the layer makes through
+ * its own allocators, the device memory only covers the memory backing the swapchain images.
+ */
+typedef struct VkLayerMemoryStatisticsWSI
+{
+   VkStructureType sType;
+   void *pNext;
+   VkMemoryCounterWSI hostTotal;
+   /* Host memory by allocation scope, indexed by VkSystemAllocationScope. */
+   VkMemoryCounterWSI hostScopes[VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1];
+   /* Host memory by the objects it is allocated for. */
+   VkMemoryCounterWSI hostGeneral;
+   VkMemoryCounterWSI hostInstance;
+   VkMemoryCounterWSI hostDevice;
+   VkMemoryCounterWSI hostSurface;
+   VkMemoryCounterWSI hostSwapchain;
+   /* Swapchain image memory allocated with vkAllocateMemory. */
+   VkMemoryCounterWSI deviceMemory;
+   /* Swapchain image memory imported from dma-bufs. */
+   VkMemoryCounterWSI dmaBuf;
+   /* Swapchain image memory exported as Android hardware buffers. */
+   VkMemoryCounterWSI hardwareBuffer;
+} VkLayerMemoryStatisticsWSI;
+
+typedef VkResult(VKAPI_PTR *PFN_vkGetSwapchainStatisticsWSI)(VkDevice device, VkSwapchainKHR swapchain,
+                                                             VkSwapchainStatisticsWSI *pStatistics);
+
+VWL_VKAPI_CALL(VkResult)
+wsi_layer_vkGetSwapchainStatisticsWSI(VkDevice device, VkSwapchainKHR swapchain,
+                                      VkSwapchainStatisticsWSI *pStatistics) VWL_API_POST;
@@ -0,0 +1,876 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file present_replay.cpp
+ *
+ * @brief Replays a present path capture through the headless backend of the layer.
+ *
+ * The capture is recorded by the layer with VULKAN_WSI_CAPTURE_FILE. The application side of every captured
+ * swapchain, i.e. the time spent between acquiring and presenting an image and between presenting and acquiring
+ * the next image, is replayed against a headless swapchain created through the layer, so the real swapchain
+ * scheduling and the headless simulated display handle the presents. The replay is itself captured, to
+ * VULKAN_WSI_CAPTURE_FILE set to the output file, and the acquire wait and the present to display latency of both
+ * captures are compared. The present mode, the number of images and the refresh rate can be overridden to evaluate
+ * scheduling changes without a display.
+ *
+ * The rendering of the captured frames is not replayed: the replayed images are ready as soon as they are presented.
+ *
+ * Usage: present_replay [--present-mode fifo|fifo_relaxed|mailbox] [--images N] [--refresh-hz F] [--pace-hz F]
+ *                       [--output FILE] FILE
+ */
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "util/clock.hpp"
+#include "wsi/present_capture.hpp"
+
+namespace
+{
+
+using wsi::capture::capture_header;
+using wsi::capture::capture_record;
+using wsi::capture::event;
+
+constexpr uint32_t NO_OVERRIDE = UINT32_MAX;
+
+struct options
+{
+   uint32_t present_mode{ NO_OVERRIDE };
+   uint32_t image_count{ NO_OVERRIDE };
+   double refresh_hz{ 0.0 };
+   double pace_hz{ 0.0 };
+   const char *output{ nullptr };
+   const char *file{ nullptr };
+};
+
+/**
+ * @brief A frame of the application, as captured.
+ */
+struct frame
+{
+   uint16_t image_index;
+   uint64_t present_id;
+   uint64_t acquire_call_ns;
+   uint64_t acquire_wait_ns;
+   uint64_t present_ns;
+   uint64_t submit_ns;
+   uint64_t latch_ns;
+   uint64_t complete_ns;
+};
+
+struct swapchain_capture
+{
+   uint64_t id;
+   uint32_t image_count;
+   uint32_t present_mode;
+   std::vector<frame> frames;
+};
+
+/**
+ * @brief Summary of a set of durations.
+ */
+struct summary
+{
+   explicit summary(std::vector<uint64_t> samples)
+      : count(samples.size())
+   {
+      if (samples.empty())
+      {
+         return;
+      }
+      std::sort(samples.begin(), samples.end());
+      uint64_t sum = 0;
+      for (uint64_t sample : samples)
+      {
+         sum += sample;
+      }
+      mean = sum / samples.size();
+      p50 = samples[samples.size() / 2];
+      p99 = samples[std::min(samples.size() - 1, samples.size() * 99 / 100)];
+      max = samples.back();
+   }
+
+   void print(const char *name) const
+   {
+      std::printf("    %-18s count=%zu mean=%" PRIu64 " p50=%" PRIu64 " p99=%" PRIu64 " max=%" PRIu64 " us\n", name,
+                  count, mean / util::NSEC_PER_USEC, p50 / util::NSEC_PER_USEC, p99 / util::NSEC_PER_USEC,
+                  max / util::NSEC_PER_USEC);
+   }
+
+   size_t count;
+   uint64_t mean{ 0 };
+   uint64_t p50{ 0 };
+   uint64_t p99{ 0 };
+   uint64_t max{ 0 };
+};
+
+const char *present_mode_name(uint32_t present_mode)
+{
+   switch (present_mode)
+   {
+   case VK_PRESENT_MODE_IMMEDIATE_KHR:
+      return "immediate";
+   case VK_PRESENT_MODE_MAILBOX_KHR:
+      return "mailbox";
+   case VK_PRESENT_MODE_FIFO_KHR:
+      return "fifo";
+   case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+      return "fifo_relaxed";
+   default:
+      return "shared";
+   }
+}
+
+bool parse_options(int argc, char **argv, options &opts)
+{
+   for (int i = 1; i < argc; i++)
+   {
+      const bool has_value = i + 1 < argc;
+      if (std::strcmp(argv[i], "--present-mode") == 0 && has_value)
+      {
+         const char *mode = argv[++i];
+         if (std::strcmp(mode, "fifo") == 0)
+         {
+            opts.present_mode = VK_PRESENT_MODE_FIFO_KHR;
+         }
+         else if (std::strcmp(mode, "fifo_relaxed") == 0)
+         {
+            opts.present_mode = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+         }
+         else if (std::strcmp(mode, "mailbox") == 0)
+         {
+            opts.present_mode = VK_PRESENT_MODE_MAILBOX_KHR;
+         }
+         else
+         {
+            return false;
+         }
+      }
+      else if (std::strcmp(argv[i], "--images") == 0 && has_value)
+      {
+         opts.image_count = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+      }
+      else if (std::strcmp(argv[i], "--refresh-hz") == 0 && has_value)
+      {
+         opts.refresh_hz = std::strtod(argv[++i], nullptr);
+      }
+      else if (std::strcmp(argv[i], "--pace-hz") == 0 && has_value)
+      {
+         opts.pace_hz = std::strtod(argv[++i], nullptr);
+      }
+      else if (std::strcmp(argv[i], "--output") == 0 && has_value)
+      {
+         opts.output = argv[++i];
+      }
+      else if (argv[i][0] != '-' && opts.file == nullptr)
+      {
+         opts.file = argv[i];
+      }
+      else
+      {
+         return false;
+      }
+   }
+   return opts.file != nullptr;
+}
+
+bool read_capture(const char *path, std::vector<capture_record> &records)
+{
+   std::FILE *in = std::fopen(path, "rb");
+   if (in == nullptr)
+   {
+      std::fprintf(stderr, "Failed to open %s.\n", path);
+      return false;
+   }
+
+   capture_header header = {};
+   if (std::fread(&header, sizeof(header), 1, in) != 1 || header.magic != wsi::capture::CAPTURE_MAGIC ||
+       header.version != wsi::capture::CAPTURE_VERSION || header.record_size != sizeof(capture_record))
+   {
+      std::fprintf(stderr, "%s is not a supported present capture.\n", path);
+      std::fclose(in);
+      return false;
+   }
+
+   capture_record record = {};
+   while (std::fread(&record, sizeof(record), 1, in) == 1)
+   {
+      records.push_back(record);
+   }
+   std::fclose(in);
+
+   /* The records of different threads are written in about, not exactly, the order of their timestamps. */
+   std::stable_sort(records.begin(), records.end(), [](const capture_record &a, const capture_record &b) {
+      return a.timestamp_ns < b.timestamp_ns;
+   });
+   return true;
+}
+
+/**
+ * @brief Split the records in the frames of each swapchain.
+ */
+std::vector<swapchain_capture> build_swapchains(const std::vector<capture_record> &records)
+{
+   std::vector<swapchain_capture> swapchains;
+   /* Index in swapchains of the live swapchains. */
+   std::map<uint64_t, size_t> live;
+   /* Last acquire of each image of the live swapchains. */
+   std::map<std::pair<uint64_t, uint16_t>, capture_record> acquires;
+
+   for (const auto &record : records)
+   {
+      if (record.type == event::swapchain_create)
+      {
+         live[record.swapchain] = swapchains.size();
+         swapchains.push_back({ record.swapchain, record.image_index, record.value, {} });
+         continue;
+      }
+
+      auto it = live.find(record.swapchain);
+      if (it == live.end())
+      {
+         continue;
+      }
+      swapchain_capture &sc = swapchains[it->second];
+
+      switch (record.type)
+      {
+      case event::swapchain_destroy:
+         live.erase(it);
+         break;
+      case event::acquire:
+         acquires[{ record.swapchain, record.image_index }] = record;
+         break;
+      case event::present:
+      {
+         frame f = {};
+         f.image_index = record.image_index;
+         f.present_id = record.present_id;
+         f.present_ns = record.timestamp_ns;
+         f.acquire_call_ns = record.timestamp_ns;
+         auto acquire = acquires.find({ record.swapchain, record.image_index });
+         if (acquire != acquires.end())
+         {
+            f.acquire_wait_ns = acquire->second.value * util::NSEC_PER_USEC;
+            f.acquire_call_ns =
+               acquire->second.timestamp_ns - std::min(acquire->second.timestamp_ns, f.acquire_wait_ns);
+            acquires.erase(acquire);
+         }
+         sc.frames.push_back(f);
+         break;
+      }
+      case event::present_submit:
+      case event::present_latch:
+         /* The backend handles the presents of an image in order, so the oldest unhandled one is the match. */
+         for (auto &f : sc.frames)
+         {
+            uint64_t &stage_ns = record.type == event::present_submit ? f.submit_ns : f.latch_ns;
+            if (f.image_index == record.image_index && stage_ns == 0)
+            {
+               stage_ns = record.timestamp_ns;
+               break;
+            }
+         }
+         break;
+      case event::present_complete:
+         for (auto f = sc.frames.rbegin(); record.present_id != 0 && f != sc.frames.rend(); ++f)
+         {
+            if (f->present_id == record.present_id)
+            {
+               f->complete_ns = record.timestamp_ns;
+               break;
+            }
+         }
+         break;
+      default:
+         break;
+      }
+   }
+   return swapchains;
+}
+
+/**
+ * @brief Estimate the refresh period from the intervals between the captured completions.
+ *
+ * @return The median interval, or 0 if the swapchain does not use FIFO or has too few completions.
+ */
+uint64_t estimate_period_ns(const swapchain_capture &sc)
+{
+   std::vector<uint64_t> intervals;
+   uint64_t previous_ns = 0;
+   for (const auto &f : sc.frames)
+   {
+      uint64_t displayed_ns = f.complete_ns != 0 ? f.complete_ns : f.latch_ns;
+      if (displayed_ns != 0 && previous_ns != 0 && displayed_ns > previous_ns)
+      {
+         intervals.push_back(displayed_ns - previous_ns);
+      }
+      previous_ns = displayed_ns != 0 ? displayed_ns : previous_ns;
+   }
+
+   if (intervals.size() < 2 || sc.present_mode != VK_PRESENT_MODE_FIFO_KHR)
+   {
+      return 0;
+   }
+   std::nth_element(intervals.begin(), intervals.begin() + intervals.size() / 2, intervals.end());
+   return intervals[intervals.size() / 2];
+}
+
+void print_summaries(const swapchain_capture &sc)
+{
+   std::vector<uint64_t> acquire_wait;
+   std::vector<uint64_t> latency;
+   for (const auto &f : sc.frames)
+   {
+      acquire_wait.push_back(f.acquire_wait_ns);
+      uint64_t displayed_ns = f.complete_ns != 0 ? f.complete_ns : f.latch_ns;
+      if (displayed_ns >= f.present_ns)
+      {
+         latency.push_back(displayed_ns - f.present_ns);
+      }
+   }
+   summary(acquire_wait).print("acquire_wait");
+   summary(latency).print("present_to_display");
+}
+
+void sleep_until_ns(uint64_t time_ns)
+{
+   struct timespec ts = {};
+   ts.tv_sec = static_cast<time_t>(time_ns / util::NSEC_PER_SEC);
+   ts.tv_nsec = static_cast<long>(time_ns % util::NSEC_PER_SEC);
+   while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) != 0)
+   {
+   }
+}
+
+bool check(VkResult result, const char *call)
+{
+   if (result != VK_SUCCESS)
+   {
+      std::fprintf(stderr, "%s failed with %d.\n", call, static_cast<int>(result));
+      return false;
+   }
+   return true;
+}
+
+/**
+ * @brief A Vulkan device presenting to a headless surface through the layer.
+ */
+class replay_device
+{
+public:
+   replay_device() = default;
+   replay_device(const replay_device &) = delete;
+   replay_device &operator=(const replay_device &) = delete;
+
+   ~replay_device()
+   {
+      if (m_device != VK_NULL_HANDLE)
+      {
+         vkDeviceWaitIdle(m_device);
+         vkDestroyCommandPool(m_device, m_command_pool, nullptr);
+         vkDestroyDevice(m_device, nullptr);
+      }
+      if (m_surface != VK_NULL_HANDLE)
+      {
+         vkDestroySurfaceKHR(m_instance, m_surface, nullptr);
+      }
+      if (m_instance != VK_NULL_HANDLE)
+      {
+         vkDestroyInstance(m_instance, nullptr);
+      }
+   }
+
+   bool init();
+
+   /**
+    * @brief Replay the frames of a captured swapchain.
+    *
+    * @return false if the replay could not run to completion.
+    */
+   bool replay(const swapchain_capture &sc, uint32_t present_mode, uint32_t image_count, uint64_t pace_ns);
+
+private:
+   bool has_device_extension(const char *name) const;
+
+   VkInstance m_instance{ VK_NULL_HANDLE };
+   VkSurfaceKHR m_surface{ VK_NULL_HANDLE };
+   VkPhysicalDevice m_physical_device{ VK_NULL_HANDLE };
+   VkDevice m_device{ VK_NULL_HANDLE };
+   VkQueue m_queue{ VK_NULL_HANDLE };
+   uint32_t m_queue_family{ 0 };
+   VkCommandPool m_command_pool{ VK_NULL_HANDLE };
+   bool m_present_id{ false };
+   PFN_vkCreateHeadlessSurfaceEXT m_create_headless_surface{ nullptr };
+};
+
+bool replay_device::init()
+{
+   const char *instance_extensions[] = { VK_KHR_SURFACE_EXTENSION_NAME, VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME };
+   VkApplicationInfo app_info = {};
+   app_info.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+   app_info.pApplicationName = "present_replay";
+   app_info.apiVersion = VK_API_VERSION_1_1;
+
+   VkInstanceCreateInfo instance_info = {};
+   instance_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+   instance_info.pApplicationInfo = &app_info;
+   instance_info.enabledExtensionCount = 2;
+   instance_info.ppEnabledExtensionNames = instance_extensions;
+   if (!check(vkCreateInstance(&instance_info, nullptr, &m_instance), "vkCreateInstance"))
+   {
+      return false;
+   }
+
+   m_create_headless_surface = reinterpret_cast<PFN_vkCreateHeadlessSurfaceEXT>(
+      vkGetInstanceProcAddr(m_instance, "vkCreateHeadlessSurfaceEXT"));
+   if (m_create_headless_surface == nullptr)
+   {
+      std::fprintf(stderr, "VK_EXT_headless_surface is not available, is the layer installed?\n");
+      return false;
+   }
+
+   VkHeadlessSurfaceCreateInfoEXT surface_info = {};
+   surface_info.sType = VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT;
+   if (!check(m_create_headless_surface(m_instance, &surface_info, nullptr, &m_surface), "vkCreateHeadlessSurfaceEXT"))
+   {
+      return false;
+   }
+
+   uint32_t count = 0;
+   vkEnumeratePhysicalDevices(m_instance, &count, nullptr);
+   if (count == 0)
+   {
+      std::fprintf(stderr, "No Vulkan device found.\n");
+      return false;
+   }
+   count = 1;
+   vkEnumeratePhysicalDevices(m_instance, &count, &m_physical_device);
+
+   uint32_t family_count = 0;
+   vkGetPhysicalDeviceQueueFamilyProperties(m_physical_device, &family_count, nullptr);
+   for (m_queue_family = 0; m_queue_family < family_count; m_queue_family++)
+   {
+      VkBool32 supported = VK_FALSE;
+      vkGetPhysicalDeviceSurfaceSupportKHR(m_physical_device, m_queue_family, m_surface, &supported);
+      if (supported)
+      {
+         break;
+      }
+   }
+   if (m_queue_family == family_count)
+   {
+      std::fprintf(stderr, "No queue family can present to the headless surface.\n");
+      return false;
+   }
+
+   std::vector<const char *> device_extensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+   VkPhysicalDevicePresentIdFeaturesKHR present_id_features = {};
+   present_id_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+   if (has_device_extension(VK_KHR_PRESENT_ID_EXTENSION_NAME))
+   {
+      VkPhysicalDeviceFeatures2 features = {};
+      features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+      features.pNext = &present_id_features;
+      vkGetPhysicalDeviceFeatures2(m_physical_device, &features);
+      m_present_id = present_id_features.presentId == VK_TRUE;
+   }
+   if (m_present_id)
+   {
+      device_extensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+   }
+
+   const float priority = 1.0f;
+   VkDeviceQueueCreateInfo queue_info = {};
+   queue_info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+   queue_info.queueFamilyIndex = m_queue_family;
+   queue_info.queueCount = 1;
+   queue_info.pQueuePriorities = &priority;
+
+   VkDeviceCreateInfo device_info = {};
+   device_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+   device_info.pNext = m_present_id ? &present_id_features : nullptr;
+   device_info.queueCreateInfoCount = 1;
+   device_info.pQueueCreateInfos = &queue_info;
+   device_info.enabledExtensionCount = static_cast<uint32_t>(device_extensions.size());
+   device_info.ppEnabledExtensionNames = device_extensions.data();
+   if (!check(vkCreateDevice(m_physical_device, &device_info, nullptr, &m_device), "vkCreateDevice"))
+   {
+      return false;
+   }
+   vkGetDeviceQueue(m_device, m_queue_family, 0, &m_queue);
+
+   VkCommandPoolCreateInfo pool_info = {};
+   pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+   pool_info.queueFamilyIndex = m_queue_family;
+   return check(vkCreateCommandPool(m_device, &pool_info, nullptr, &m_command_pool), "vkCreateCommandPool");
+}
+
+bool replay_device::has_device_extension(const char *name) const
+{
+   uint32_t count = 0;
+   vkEnumerateDeviceExtensionProperties(m_physical_device, nullptr, &count, nullptr);
+   std::vector<VkExtensionProperties> extensions(count);
+   vkEnumerateDeviceExtensionProperties(m_physical_device, nullptr, &count, extensions.data());
+   return std::any_of(extensions.begin(), extensions.end(),
+                      [name](const VkExtensionProperties &ext) { return std::strcmp(ext.extensionName, name) == 0; });
+}
+
+/**
+ * @brief Vulkan objects of a replayed swapchain, destroyed when the replay of the swapchain ends.
+ */
+struct swapchain_objects
+{
+   swapchain_objects(VkDevice dev, VkCommandPool pool)
+      : device(dev)
+      , command_pool(pool)
+   {
+   }
+
+   ~swapchain_objects()
+   {
+      vkDeviceWaitIdle(device);
+      if (!command_buffers.empty())
+      {
+         vkFreeCommandBuffers(device, command_pool, static_cast<uint32_t>(command_buffers.size()),
+                              command_buffers.data());
+      }
+      for (VkFence fence : fences)
+      {
+         vkDestroyFence(device, fence, nullptr);
+      }
+      for (VkSemaphore semaphore : acquire_semaphores)
+      {
+         vkDestroySemaphore(device, semaphore, nullptr);
+      }
+      for (VkSemaphore semaphore : render_semaphores)
+      {
+         vkDestroySemaphore(device, semaphore, nullptr);
+      }
+      vkDestroySwapchainKHR(device, swapchain, nullptr);
+   }
+
+   VkDevice device;
+   VkCommandPool command_pool;
+   VkSwapchainKHR swapchain{ VK_NULL_HANDLE };
+   std::vector<VkCommandBuffer> command_buffers;
+   std::vector<VkSemaphore> render_semaphores;
+   /* One acquire semaphore and fence per frame in flight, indexed by the frame number. */
+   std::vector<VkSemaphore> acquire_semaphores;
+   std::vector<VkFence> fences;
+};
+
+bool replay_device::replay(const swapchain_capture &sc, uint32_t present_mode, uint32_t image_count, uint64_t pace_ns)
+{
+   uint32_t mode_count = 0;
+   vkGetPhysicalDeviceSurfacePresentModesKHR(m_physical_device, m_surface, &mode_count, nullptr);
+   std::vector<VkPresentModeKHR> modes(mode_count);
+   vkGetPhysicalDeviceSurfacePresentModesKHR(m_physical_device, m_surface, &mode_count, modes.data());
+   if (std::find(modes.begin(), modes.end(), static_cast<VkPresentModeKHR>(present_mode)) == modes.end())
+   {
+      std::printf("  %s is not supported by the headless surface, set VULKAN_WSI_HEADLESS_REFRESH_HZ or "
+                  "--refresh-hz for mailbox\n",
+                  present_mode_name(present_mode));
+      return false;
+   }
+
+   VkSurfaceCapabilitiesKHR caps = {};
+   vkGetPhysicalDeviceSurfaceCapabilitiesKHR(m_physical_device, m_surface, &caps);
+   image_count = std::max(image_count, caps.minImageCount);
+   if (caps.maxImageCount != 0)
+   {
+      image_count = std::min(image_count, caps.maxImageCount);
+   }
+
+   uint32_t format_count = 1;
+   VkSurfaceFormatKHR format = {};
+   vkGetPhysicalDeviceSurfaceFormatsKHR(m_physical_device, m_surface, &format_count, &format);
+
+   swapchain_objects objects(m_device, m_command_pool);
+   VkSwapchainCreateInfoKHR swapchain_info = {};
+   swapchain_info.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+   swapchain_info.surface = m_surface;
+   swapchain_info.minImageCount = image_count;
+   swapchain_info.imageFormat = format.format;
+   swapchain_info.imageColorSpace = format.colorSpace;
+   swapchain_info.imageExtent = { 64, 64 };
+   swapchain_info.imageArrayLayers = 1;
+   swapchain_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+   swapchain_info.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+   swapchain_info.preTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
+   swapchain_info.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+   swapchain_info.presentMode = static_cast<VkPresentModeKHR>(present_mode);
+   swapchain_info.clipped = VK_TRUE;
+   if (!check(vkCreateSwapchainKHR(m_device, &swapchain_info, nullptr, &objects.swapchain), "vkCreateSwapchainKHR"))
+   {
+      return false;
+   }
+
+   uint32_t swapchain_image_count = 0;
+   vkGetSwapchainImagesKHR(m_device, objects.swapchain, &swapchain_image_count, nullptr);
+   std::vector<VkImage> images(swapchain_image_count);
+   vkGetSwapchainImagesKHR(m_device, objects.swapchain, &swapchain_image_count, images.data());
+
+   /* Each image only needs a transition to the layout it is presented in. */
+   objects.command_buffers.resize(swapchain_image_count);
+   VkCommandBufferAllocateInfo command_buffer_info = {};
+   command_buffer_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+   command_buffer_info.commandPool = m_command_pool;
+   command_buffer_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+   command_buffer_info.commandBufferCount = swapchain_image_count;
+   if (!check(vkAllocateCommandBuffers(m_device, &command_buffer_info, objects.command_buffers.data()),
+              "vkAllocateCommandBuffers"))
+   {
+      objects.command_buffers.clear();
+      return false;
+   }
+
+   VkSemaphoreCreateInfo semaphore_info = {};
+   semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+   VkFenceCreateInfo fence_info = {};
+   fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+   fence_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+   for (uint32_t i = 0; i < swapchain_image_count; i++)
+   {
+      VkCommandBufferBeginInfo begin_info = {};
+      begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+      begin_info.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+      vkBeginCommandBuffer(objects.command_buffers[i], &begin_info);
+      VkImageMemoryBarrier barrier = {};
+      barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+      barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+      barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+      barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barrier.image = images[i];
+      barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+      vkCmdPipelineBarrier(objects.command_buffers[i], VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                           VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+      if (!check(vkEndCommandBuffer(objects.command_buffers[i]), "vkEndCommandBuffer"))
+      {
+         return false;
+      }
+
+      objects.render_semaphores.push_back(VK_NULL_HANDLE);
+      if (!check(vkCreateSemaphore(m_device, &semaphore_info, nullptr, &objects.render_semaphores.back()),
+                 "vkCreateSemaphore"))
+      {
+         return false;
+      }
+   }
+   for (uint32_t i = 0; i <= swapchain_image_count; i++)
+   {
+      objects.acquire_semaphores.push_back(VK_NULL_HANDLE);
+      objects.fences.push_back(VK_NULL_HANDLE);
+      if (!check(vkCreateSemaphore(m_device, &semaphore_info, nullptr, &objects.acquire_semaphores.back()),
+                 "vkCreateSemaphore") ||
+          !check(vkCreateFence(m_device, &fence_info, nullptr, &objects.fences.back()), "vkCreateFence"))
+      {
+         return false;
+      }
+   }
+
+   std::printf("  replaying as %s with %u images%s\n", present_mode_name(present_mode), swapchain_image_count,
+               pace_ns != 0 ? ", paced" : "");
+
+   uint64_t next_acquire_ns = util::get_monotonic_time_ns();
+   uint64_t last_acquire_ns = 0;
+   for (size_t i = 0; i < sc.frames.size(); i++)
+   {
+      const frame &f = sc.frames[i];
+      const size_t slot = i % objects.fences.size();
+      if (!check(vkWaitForFences(m_device, 1, &objects.fences[slot], VK_TRUE, UINT64_MAX), "vkWaitForFences"))
+      {
+         return false;
+      }
+      vkResetFences(m_device, 1, &objects.fences[slot]);
+
+      if (pace_ns != 0 && last_acquire_ns != 0)
+      {
+         next_acquire_ns = std::max(next_acquire_ns, last_acquire_ns + pace_ns);
+      }
+      sleep_until_ns(next_acquire_ns);
+      last_acquire_ns = util::get_monotonic_time_ns();
+
+      uint32_t image_index = 0;
+      VkResult result = vkAcquireNextImageKHR(m_device, objects.swapchain, UINT64_MAX,
+                                              objects.acquire_semaphores[slot], VK_NULL_HANDLE, &image_index);
+      if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+      {
+         std::printf("  replay stopped at frame %zu: vkAcquireNextImageKHR failed with %d\n", i,
+                     static_cast<int>(result));
+         return false;
+      }
+
+      /* Application work between acquiring and presenting the image. */
+      sleep_until_ns(util::get_monotonic_time_ns() + f.present_ns -
+                     std::min(f.present_ns, f.acquire_call_ns + f.acquire_wait_ns));
+
+      const VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+      VkSubmitInfo submit_info = {};
+      submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+      submit_info.waitSemaphoreCount = 1;
+      submit_info.pWaitSemaphores = &objects.acquire_semaphores[slot];
+      submit_info.pWaitDstStageMask = &wait_stage;
+      submit_info.commandBufferCount = 1;
+      submit_info.pCommandBuffers = &objects.command_buffers[image_index];
+      submit_info.signalSemaphoreCount = 1;
+      submit_info.pSignalSemaphores = &objects.render_semaphores[image_index];
+      if (!check(vkQueueSubmit(m_queue, 1, &submit_info, objects.fences[slot]), "vkQueueSubmit"))
+      {
+         return false;
+      }
+
+      const uint64_t present_id = i + 1;
+      VkPresentIdKHR present_id_info = {};
+      present_id_info.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+      present_id_info.swapchainCount = 1;
+      present_id_info.pPresentIds = &present_id;
+
+      VkPresentInfoKHR present_info = {};
+      present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+      present_info.pNext = m_present_id ? &present_id_info : nullptr;
+      present_info.waitSemaphoreCount = 1;
+      present_info.pWaitSemaphores = &objects.render_semaphores[image_index];
+      present_info.swapchainCount = 1;
+      present_info.pSwapchains = &objects.swapchain;
+      present_info.pImageIndices = &image_index;
+      result = vkQueuePresentKHR(m_queue, &present_info);
+      if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+      {
+         std::printf("  replay stopped at frame %zu: vkQueuePresentKHR failed with %d\n", i,
+                     static_cast<int>(result));
+         return false;
+      }
+
+      /* Application work between presenting and acquiring the next image. */
+      next_acquire_ns = util::get_monotonic_time_ns();
+      if (i + 1 < sc.frames.size())
+      {
+         const frame &next = sc.frames[i + 1];
+         next_acquire_ns += next.acquire_call_ns - std::min(next.acquire_call_ns, f.present_ns);
+      }
+   }
+   return true;
+}
+
+} /* namespace */
+
+int main(int argc, char **argv)
+{
+   options opts;
+   if (!parse_options(argc, argv, opts))
+   {
+      std::fprintf(stderr,
+                   "Usage: %s [--present-mode fifo|fifo_relaxed|mailbox] [--images N] [--refresh-hz F] "
+                   "[--pace-hz F] [--output FILE] FILE\n",
+                   argv[0]);
+      return EXIT_FAILURE;
+   }
+
+   std::vector<capture_record> records;
+   if (!read_capture(opts.file, records))
+   {
+      return EXIT_FAILURE;
+   }
+   const std::vector<swapchain_capture> captured = build_swapchains(records);
+
+   /* The layer reads its configuration when it is loaded, i.e. on vkCreateInstance. */
+   const std::string output = opts.output != nullptr ? opts.output : std::string(opts.file) + ".replay";
+   setenv("VULKAN_WSI_CAPTURE_FILE", output.c_str(), 1);
+
+   uint64_t period_ns = opts.refresh_hz > 0.0 ? static_cast<uint64_t>(util::NSEC_PER_SEC / opts.refresh_hz) : 0;
+   for (size_t i = 0; i < captured.size() && period_ns == 0 && std::getenv("VULKAN_WSI_HEADLESS_REFRESH_HZ") == nullptr;
+        i++)
+   {
+      period_ns = estimate_period_ns(captured[i]);
+   }
+   if (period_ns != 0)
+   {
+      const std::string refresh_hz = std::to_string((util::NSEC_PER_SEC + period_ns / 2) / period_ns);
+      setenv("VULKAN_WSI_HEADLESS_REFRESH_HZ", refresh_hz.c_str(), 1);
+   }
+   if (const char *refresh_hz = std::getenv("VULKAN_WSI_HEADLESS_REFRESH_HZ"))
+   {
+      std::printf("simulated display refreshing at %s Hz\n", refresh_hz);
+   }
+
+   const uint64_t pace_ns = opts.pace_hz > 0.0 ? static_cast<uint64_t>(util::NSEC_PER_SEC / opts.pace_hz) : 0;
+   std::vector<bool> replayed(captured.size(), false);
+   {
+      replay_device device;
+      if (!device.init())
+      {
+         return EXIT_FAILURE;
+      }
+
+      for (size_t i = 0; i < captured.size(); i++)
+      {
+         const swapchain_capture &sc = captured[i];
+         std::printf("swapchain 0x%" PRIx64 ": %zu frames, captured %s with %u images\n", sc.id, sc.frames.size(),
+                     present_mode_name(sc.present_mode), sc.image_count);
+         if (sc.frames.empty())
+         {
+            continue;
+         }
+         replayed[i] = device.replay(sc, opts.present_mode != NO_OVERRIDE ? opts.present_mode : sc.present_mode,
+                                     opts.image_count != NO_OVERRIDE ? opts.image_count : sc.image_count, pace_ns);
+      }
+   }
+
+   /* The capture of the replay is written when the device is destroyed. */
+   std::vector<capture_record> replay_records;
+   if (!read_capture(output.c_str(), replay_records))
+   {
+      return EXIT_FAILURE;
+   }
+   const std::vector<swapchain_capture> replays = build_swapchains(replay_records);
+
+   size_t replay_index = 0;
+   for (size_t i = 0; i < captured.size(); i++)
+   {
+      if (captured[i].frames.empty())
+      {
+         continue;
+      }
+      std::printf("swapchain 0x%" PRIx64 ":\n  captured:\n", captured[i].id);
+      print_summaries(captured[i]);
+      if (replay_index < replays.size())
+      {
+         std::printf("  replayed%s:\n", replayed[i] ? "" : " (incomplete)");
+         print_summaries(replays[replay_index++]);
+      }
+   }
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file ring_buffer_bench.cpp
+ *
+ * @brief Measures the throughput of the lock-free ring buffers against util::ring_buffer protected by a mutex.
+ *
+ * Every configuration hands a fixed number of items from the producer threads to one consumer thread through a
+ * buffer with the capacity of the swapchain present queue, so that the producers are often blocked by a full
+ * buffer as in the layer. The consumer checks that the items of each producer arrive in order.
+ *
+ * Usage: ring_buffer_bench [--items N] [--producers N]
+ */
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "util/concurrent_ring_buffer.hpp"
+#include "util/ring_buffer.hpp"
+
+namespace
+{
+
+constexpr std::size_t BUFFER_CAPACITY = 8;
+
+struct item
+{
+   uint32_t producer;
+   uint64_t sequence;
+};
+
+/**
+ * @brief util::ring_buffer with a mutex held for every operation, as used by the layer before the lock-free buffers.
+ */
+class locked_ring_buffer
+{
+public:
+   bool push_back(const item &value)
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return m_buffer.push_back(value);
+   }
+
+   std::optional<item> pop_front()
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return m_buffer.pop_front();
+   }
+
+private:
+   std::mutex m_mutex;
+   util::ring_buffer<item, BUFFER_CAPACITY> m_buffer;
+};
+
+/**
+ * @brief Run the producers and the consumer and return the number of items per second, or 0 on error.
+ */
+template <typename Buffer>
+double run(Buffer &buffer, uint32_t num_producers, uint64_t items_per_producer)
+{
+   std::vector<std::thread> producers;
+   auto start = std::chrono::steady_clock::now();
+   for (uint32_t p = 0; p < num_producers; p++)
+   {
+      producers.emplace_back([&buffer, p, items_per_producer]() {
+         for (uint64_t i = 0; i < items_per_producer; i++)
+         {
+            while (!buffer.push_back(item{ p, i }))
+            {
+               std::this_thread::yield();
+            }
+         }
+      });
+   }
+
+   std::vector<uint64_t> expected(num_producers, 0);
+   bool in_order = true;
+   for (uint64_t received = 0; received < items_per_producer * num_producers;)
+   {
+      auto value = buffer.pop_front();
+      if (!value.has_value())
+      {
+         std::this_thread::yield();
+         continue;
+      }
+      in_order = in_order && value->sequence == expected[value->producer];
+      expected[value->producer]++;
+      received++;
+   }
+
+   for (auto &producer : producers)
+   {
+      producer.join();
+   }
+   std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+   if (!in_order)
+   {
+      std::fprintf(stderr, "Items were received out of order\n");
+      return 0;
+   }
+   return static_cast<double>(items_per_producer * num_producers) / elapsed.count();
+}
+
+void print_result(const char *name, uint32_t num_producers, double items_per_second)
+{
+   std::printf("%-28s %2" PRIu32 " producer(s) %12.0f items/s\n", name, num_producers, items_per_second);
+}
+
+} /* namespace */
+
+int main(int argc, char **argv)
+{
+   uint64_t num_items = 10000000;
+   uint32_t num_producers = 4;
+   for (int i = 1; i < argc; i++)
+   {
+      if (strcmp(argv[i], "--items") == 0 && i + 1 < argc)
+      {
+         num_items = strtoull(argv[++i], nullptr, 10);
+      }
+      else if (strcmp(argv[i], "--producers") == 0 && i + 1 < argc)
+      {
+         num_producers = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+      }
+      else
+      {
+         std::fprintf(stderr, "Usage: %s [--items N] [--producers N]\n", argv[0]);
+         return EXIT_FAILURE;
+      }
+   }
+   if (num_producers == 0)
+   {
+      num_producers = 1;
+   }
+
+   double result;
+   {
+      locked_ring_buffer buffer;
+      result = run(buffer, 1, num_items);
+      print_result("ring_buffer + mutex", 1, result);
+   }
+   {
+      util::spsc_ring_buffer<item, BUFFER_CAPACITY> buffer;
+      result = run(buffer, 1, num_items);
+      print_result("spsc_ring_buffer", 1, result);
+   }
+   {
+      locked_ring_buffer buffer;
+      result = run(buffer, num_producers, num_items / num_producers);
+      print_result("ring_buffer + mutex", num_producers, result);
+   }
+   {
+      util::mpsc_ring_buffer<item, BUFFER_CAPACITY> buffer;
+      result = run(buffer, num_producers, num_items / num_producers);
+      print_result("mpsc_ring_buffer", num_producers, result);
+   }
+   return result > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
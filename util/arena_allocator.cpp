@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "arena_allocator.hpp"
+#include "macros.hpp"
+
+#include <cstdint>
+
+namespace util
+{
+
+VWL_VKAPI_CALL(void *)
+arena_allocation(void *pUserData, size_t size, size_t alignment, VkSystemAllocationScope) VWL_API_POST
+{
+   return static_cast<arena *>(pUserData)->allocate(size, alignment);
+}
+
+VWL_VKAPI_CALL(void *)
+arena_reallocation(void *pUserData, void *pOriginal, size_t size, size_t alignment,
+                   VkSystemAllocationScope) VWL_API_POST
+{
+   auto *a = static_cast<arena *>(pUserData);
+   if (pOriginal == nullptr)
+   {
+      return a->allocate(size, alignment);
+   }
+   /* The arena does not record the size of its allocations, so they cannot be grown. */
+   return nullptr;
+}
+
+VWL_VKAPI_CALL(void) arena_free(void *pUserData, void *pMemory) VWL_API_POST
+{
+   static_cast<arena *>(pUserData)->free(pMemory);
+}
+
+arena::arena(const allocator &parent)
+   : m_parent(parent)
+{
+   m_callbacks.pUserData = this;
+   m_callbacks.pfnAllocation = arena_allocation;
+   m_callbacks.pfnReallocation = arena_reallocation;
+   m_callbacks.pfnFree = arena_free;
+}
+
+arena::~arena()
+{
+   while (m_spilled_allocations != nullptr)
+   {
+      spilled_allocation *next = m_spilled_allocations->next;
+      m_parent.record_free(sizeof(spilled_allocation) + m_spilled_allocations->size);
+      m_parent.m_callbacks.pfnFree(m_parent.m_callbacks.pUserData, m_spilled_allocations);
+      m_spilled_allocations = next;
+   }
+   while (m_blocks != nullptr)
+   {
+      block *next = m_blocks->next;
+      m_parent.record_free(sizeof(block) + m_blocks->size);
+      m_parent.m_callbacks.pfnFree(m_parent.m_callbacks.pUserData, m_blocks);
+      m_blocks = next;
+   }
+}
+
+arena::block *arena::add_block(size_t size)
+{
+   if (size > SIZE_MAX - sizeof(block))
+   {
+      return nullptr;
+   }
+   auto &cb = m_parent.m_callbacks;
+   void *memory = cb.pfnAllocation(cb.pUserData, sizeof(block) + size, alignof(std::max_align_t), m_parent.m_scope);
+   if (memory == nullptr)
+   {
+      return nullptr;
+   }
+   m_parent.record_allocation(sizeof(block) + size);
+   auto *b = static_cast<block *>(memory);
+   b->next = m_blocks;
+   b->size = size;
+   b->used = 0;
+   m_blocks = b;
+   return b;
+}
+
+void *arena::allocate_spilled(size_t size)
+{
+   auto &cb = m_parent.m_callbacks;
+   void *memory =
+      cb.pfnAllocation(cb.pUserData, sizeof(spilled_allocation) + size, alignof(std::max_align_t), m_parent.m_scope);
+   if (memory == nullptr)
+   {
+      return nullptr;
+   }
+   m_parent.record_allocation(sizeof(spilled_allocation) + size);
+   auto *header = static_cast<spilled_allocation *>(memory);
+   header->prev = nullptr;
+   header->next = m_spilled_allocations;
+   header->size = size;
+   if (m_spilled_allocations != nullptr)
+   {
+      m_spilled_allocations->prev = header;
+   }
+   m_spilled_allocations = header;
+   return header + 1;
+}
+
+bool arena::free_spilled(void *ptr)
+{
+   for (spilled_allocation *header = m_spilled_allocations; header != nullptr; header = header->next)
+   {
+      if (header + 1 != ptr)
+      {
+         continue;
+      }
+
+      if (header->prev != nullptr)
+      {
+         header->prev->next = header->next;
+      }
+      else
+      {
+         m_spilled_allocations = header->next;
+      }
+      if (header->next != nullptr)
+      {
+         header->next->prev = header->prev;
+      }
+      m_parent.record_free(sizeof(spilled_allocation) + header->size);
+      m_parent.m_callbacks.pfnFree(m_parent.m_callbacks.pUserData, header);
+      return true;
+   }
+   return false;
+}
+
+bool arena::reserve(size_t size)
+{
+   std::lock_guard<std::mutex> lock(m_lock);
+   if (m_blocks != nullptr && m_blocks->size - m_blocks->used >= size)
+   {
+      return true;
+   }
+   return add_block(size) != nullptr;
+}
+
+allocator arena::get_allocator(VkSystemAllocationScope scope) const
+{
+   /* The arena records its blocks, the objects carved from them are not recorded again. */
+   allocator arena_allocator{ scope, &m_callbacks, m_parent.m_subsystem };
+   arena_allocator.m_accounted = false;
+   return arena_allocator;
+}
+
+bool arena::owns(const void *ptr) const
+{
+   std::lock_guard<std::mutex> lock(m_lock);
+   return owns_locked(ptr);
+}
+
+bool arena::owns_locked(const void *ptr) const
+{
+   auto address = reinterpret_cast<uintptr_t>(ptr);
+   for (block *b = m_blocks; b != nullptr; b = b->next)
+   {
+      auto start = reinterpret_cast<uintptr_t>(get_data(b));
+      if (address >= start && address < start + b->size)
+      {
+         return true;
+      }
+   }
+   return false;
+}
+
+void *arena::allocate(size_t size, size_t alignment)
+{
+   if (alignment > alignof(std::max_align_t) || size > SIZE_MAX / 2)
+   {
+      /* The blocks only guarantee the fundamental alignment. */
+      return nullptr;
+   }
+
+   std::lock_guard<std::mutex> lock(m_lock);
+   block *b = m_blocks;
+   size_t offset = 0;
+   if (b != nullptr)
+   {
+      offset = (b->used + alignment - 1) & ~(alignment - 1);
+   }
+   if (b == nullptr && size <= DEFAULT_BLOCK_SIZE)
+   {
+      /* Nothing was reserved, start with a default block. */
+      b = add_block(DEFAULT_BLOCK_SIZE);
+      if (b == nullptr)
+      {
+         return nullptr;
+      }
+   }
+   if (b == nullptr || offset > b->size || b->size - offset < size)
+   {
+      return allocate_spilled(size);
+   }
+   b->used = offset + size;
+   return get_data(b) + offset;
+}
+
+void arena::free(void *ptr)
+{
+   if (ptr == nullptr)
+   {
+      return;
+   }
+
+   std::lock_guard<std::mutex> lock(m_lock);
+   if (!owns_locked(ptr) && !free_spilled(ptr))
+   {
+      m_parent.m_callbacks.pfnFree(m_parent.m_callbacks.pUserData, ptr);
+   }
+}
+
+} /* namespace util */
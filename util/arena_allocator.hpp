@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file arena_allocator.hpp
+ *
+ * @brief Contains the definition of an arena for the allocations sharing the lifetime of an object.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+
+#include <vulkan/vulkan.h>
+
+#include "custom_allocator.hpp"
+#include "helpers.hpp"
+
+namespace util
+{
+
+/**
+ * @brief Arena carving the small allocations made during the lifetime of an object from large blocks.
+ *
+ * The blocks are allocated with a parent allocator and only returned to it when the arena is
+ * destroyed. Freeing memory carved from a block does nothing, so the arena suits metadata that is
+ * allocated when the owning object is initialized and lives until it is destroyed, and its size
+ * should be reserved up front. Requests that do not fit in the current block spill to the parent
+ * and are returned to it when freed, so the arena never grows past the reserved blocks and never
+ * fails an allocation its parent could satisfy.
+ *
+ * The allocators returned by get_allocator() route their allocations through the arena. They must
+ * only be used for layer containers and objects: their callbacks must never be passed to Vulkan
+ * commands, since the arena may be destroyed before the Vulkan objects. Memory of the arena must
+ * never be freed through another allocator, while memory that the arena did not allocate is freed
+ * through the parent. Reallocating memory of the arena is not supported and fails.
+ *
+ * The memory accounting sees the blocks and the spilled allocations of the arena, accounted with the
+ * scope and subsystem of the parent, rather than the objects carved from the blocks.
+ */
+class arena : private noncopyable
+{
+public:
+   /**
+    * @brief Construct an empty arena. No memory is allocated until the first allocation or reserve().
+    *
+    * @param parent The allocator the blocks are allocated with.
+    */
+   explicit arena(const allocator &parent);
+
+   ~arena();
+
+   /**
+    * @brief Make sure that @p size bytes can be carved from the arena without spilling to the parent.
+    *
+    * @param size The number of bytes.
+    * @return true if successful, false if out of memory.
+    */
+   bool reserve(size_t size);
+
+   /**
+    * @brief Get an allocator allocating from the arena.
+    *
+    * @param scope The scope reported to the memory accounting.
+    */
+   allocator get_allocator(VkSystemAllocationScope scope) const;
+
+   /**
+    * @brief Check whether a pointer was carved from one of the blocks of the arena.
+    */
+   bool owns(const void *ptr) const;
+
+   /**
+    * @brief Allocate memory from the arena.
+    *
+    * @param size      The number of bytes.
+    * @param alignment The alignment of the memory, a power of two.
+    * @return The memory or nullptr if out of memory.
+    */
+   void *allocate(size_t size, size_t alignment);
+
+   /**
+    * @brief Free memory. Memory carved from the blocks is only released when the arena is destroyed.
+    */
+   void free(void *ptr);
+
+private:
+   struct alignas(std::max_align_t) block
+   {
+      block *next;
+      size_t size;
+      size_t used;
+   };
+
+   /* Header of the requests spilled to the parent, linked so that free() can recognize them. */
+   struct alignas(std::max_align_t) spilled_allocation
+   {
+      spilled_allocation *prev;
+      spilled_allocation *next;
+      size_t size;
+   };
+
+   static constexpr size_t DEFAULT_BLOCK_SIZE = 4096;
+
+   static char *get_data(block *b)
+   {
+      return reinterpret_cast<char *>(b + 1);
+   }
+
+   block *add_block(size_t size);
+   void *allocate_spilled(size_t size);
+   bool free_spilled(void *ptr);
+   bool owns_locked(const void *ptr) const;
+
+   const allocator m_parent;
+   mutable std::mutex m_lock;
+   block *m_blocks{ nullptr };
+   spilled_allocation *m_spilled_allocations{ nullptr };
+   VkAllocationCallbacks m_callbacks{};
+};
+
+} /* namespace util */
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file clock.hpp
+ *
+ * @brief Contains helpers for reading the monotonic clock used for layer timestamps.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+
+namespace util
+{
+
+/**
+ * @brief Number of nanoseconds in one microsecond.
+ */
+static constexpr uint64_t NSEC_PER_USEC = 1000;
+
+/**
+ * @brief Number of nanoseconds in one second.
+ */
+static constexpr uint64_t NSEC_PER_SEC = 1000000000;
+
+/**
+ * @brief Read the CLOCK_MONOTONIC clock.
+ *
+ * All timestamps recorded by the layer use this clock, so they can be compared with
+ * the timestamps reported by presentation engines (X11 UST, DRM page flip events and
+ * wp_presentation all use CLOCK_MONOTONIC on Linux).
+ *
+ * @return The current time in nanoseconds.
+ */
+inline uint64_t get_monotonic_time_ns()
+{
+   struct timespec ts = {};
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return static_cast<uint64_t>(ts.tv_sec) * NSEC_PER_SEC + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+} /* namespace util */
@@ -0,0 +1,321 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file concurrent_ring_buffer.hpp
+ *
+ * @brief Contains the definition of bounded lock-free ring buffers.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace util
+{
+
+/**
+ * @brief Size of the cache lines the indices of the ring buffers are separated by.
+ */
+constexpr std::size_t RING_BUFFER_CACHE_LINE_SIZE = 64;
+
+/**
+ * @brief Round up @p n to a power of two.
+ */
+constexpr std::size_t ring_buffer_capacity(std::size_t n)
+{
+   std::size_t capacity = 1;
+   while (capacity < n)
+   {
+      capacity *= 2;
+   }
+   return capacity;
+}
+
+/**
+ * @brief Number of items between the head and the tail indices of a ring buffer.
+ *
+ * The head is loaded before the tail: the tail only moves forward, so it is at least the head that
+ * was loaded before it. The other side may still move on between the two loads, so the result is
+ * clamped to the capacity.
+ */
+inline std::size_t ring_buffer_size(const std::atomic<std::size_t> &head, const std::atomic<std::size_t> &tail,
+                                    std::size_t capacity)
+{
+   std::size_t head_index = head.load(std::memory_order_acquire);
+   std::size_t tail_index = tail.load(std::memory_order_acquire);
+   std::size_t size = tail_index - head_index;
+   return size > capacity ? capacity : size;
+}
+
+/**
+ * @brief Bounded single producer, single consumer ring buffer.
+ *
+ * One thread may call push_back() while another thread calls pop_front(), without locks. The
+ * head and the tail indices are on separate cache lines and each side keeps a cached copy of
+ * the index of the other side, so that the shared cache lines are only read when the buffer
+ * looks full or empty. The indices increase monotonically and are masked when accessing the
+ * slots.
+ *
+ * @tparam T The type of the items.
+ * @tparam N The minimum capacity of the buffer, rounded up to a power of two.
+ */
+template <typename T, std::size_t N>
+class spsc_ring_buffer
+{
+public:
+   spsc_ring_buffer() = default;
+   spsc_ring_buffer(const spsc_ring_buffer &) = delete;
+   spsc_ring_buffer &operator=(const spsc_ring_buffer &) = delete;
+
+   ~spsc_ring_buffer()
+   {
+      while (pop_front().has_value())
+      {
+      }
+   }
+
+   /**
+    * @brief Return maximum capacity of the ring buffer.
+    */
+   static constexpr std::size_t capacity()
+   {
+      return CAPACITY;
+   }
+
+   /**
+    * @brief Return the number of items in the ring buffer.
+    *
+    * The value is exact when called by the producer or the consumer while the other side is idle.
+    * Otherwise, and always when called from any other thread, it is only an approximation within
+    * [0, capacity()].
+    */
+   std::size_t size() const
+   {
+      return ring_buffer_size(m_head, m_tail, CAPACITY);
+   }
+
+   /**
+    * @brief Places item into next slot of the ring buffer. Must only be called by the producer.
+    * @return Boolean to indicate success or failure.
+    */
+   template <typename U>
+   bool push_back(U &&item)
+   {
+      std::size_t tail = m_tail.load(std::memory_order_relaxed);
+      if (tail - m_cached_head == CAPACITY)
+      {
+         m_cached_head = m_head.load(std::memory_order_acquire);
+         if (tail - m_cached_head == CAPACITY)
+         {
+            return false;
+         }
+      }
+
+      new (&m_slots[tail & MASK]) T(std::forward<U>(item));
+      m_tail.store(tail + 1, std::memory_order_release);
+      return true;
+   }
+
+   /**
+    * @brief Pop the front of the ring buffer. Must only be called by the consumer.
+    *
+    * @return Item wrapped in an optional, std::nullopt if the buffer is empty.
+    */
+   std::optional<T> pop_front()
+   {
+      std::size_t head = m_head.load(std::memory_order_relaxed);
+      if (head == m_cached_tail)
+      {
+         m_cached_tail = m_tail.load(std::memory_order_acquire);
+         if (head == m_cached_tail)
+         {
+            return std::nullopt;
+         }
+      }
+
+      T *slot = std::launder(reinterpret_cast<T *>(&m_slots[head & MASK]));
+      std::optional<T> value{ std::move(*slot) };
+      slot->~T();
+      m_head.store(head + 1, std::memory_order_release);
+      return value;
+   }
+
+private:
+   static constexpr std::size_t CAPACITY = ring_buffer_capacity(N);
+   static constexpr std::size_t MASK = CAPACITY - 1;
+
+   /* Index of the next item to pop, written by the consumer. */
+   alignas(RING_BUFFER_CACHE_LINE_SIZE) std::atomic<std::size_t> m_head{ 0 };
+   /* Copy of m_tail owned by the consumer. */
+   std::size_t m_cached_tail{ 0 };
+
+   /* Index of the next slot to push to, written by the producer. */
+   alignas(RING_BUFFER_CACHE_LINE_SIZE) std::atomic<std::size_t> m_tail{ 0 };
+   /* Copy of m_head owned by the producer. */
+   std::size_t m_cached_head{ 0 };
+
+   alignas(RING_BUFFER_CACHE_LINE_SIZE) std::aligned_storage_t<sizeof(T), alignof(T)> m_slots[CAPACITY];
+};
+
+/**
+ * @brief Bounded multiple producer, single consumer ring buffer.
+ *
+ * Any number of threads may call push_back() concurrently while one thread calls pop_front().
+ * Every slot has a sequence number telling whether it is ready to be written or read in the
+ * current lap of the buffer, so producers only contend on the tail index and the consumer never
+ * waits for a producer that has not finished writing a slot, it reports the buffer as empty
+ * instead.
+ *
+ * @tparam T The type of the items.
+ * @tparam N The minimum capacity of the buffer, rounded up to a power of two.
+ */
+template <typename T, std::size_t N>
+class mpsc_ring_buffer
+{
+public:
+   mpsc_ring_buffer()
+   {
+      for (std::size_t i = 0; i < CAPACITY; i++)
+      {
+         m_cells[i].sequence.store(i, std::memory_order_relaxed);
+      }
+   }
+
+   mpsc_ring_buffer(const mpsc_ring_buffer &) = delete;
+   mpsc_ring_buffer &operator=(const mpsc_ring_buffer &) = delete;
+
+   ~mpsc_ring_buffer()
+   {
+      while (pop_front().has_value())
+      {
+      }
+   }
+
+   /**
+    * @brief Return maximum capacity of the ring buffer.
+    */
+   static constexpr std::size_t capacity()
+   {
+      return CAPACITY;
+   }
+
+   /**
+    * @brief Return the number of items pushed to the ring buffer and not popped yet.
+    *
+    * Includes the items that producers are still writing. Only an approximation within
+    * [0, capacity()] if other threads are using the buffer, e.g. when called from a thread that is
+    * neither a producer nor the consumer.
+    */
+   std::size_t size() const
+   {
+      return ring_buffer_size(m_head, m_tail, CAPACITY);
+   }
+
+   /**
+    * @brief Places item into next slot of the ring buffer. May be called by any thread.
+    * @return Boolean to indicate success or failure.
+    */
+   template <typename U>
+   bool push_back(U &&item)
+   {
+      std::size_t tail = m_tail.load(std::memory_order_relaxed);
+      cell *c;
+      while (true)
+      {
+         c = &m_cells[tail & MASK];
+         std::size_t sequence = c->sequence.load(std::memory_order_acquire);
+         auto diff = static_cast<std::ptrdiff_t>(sequence - tail);
+         if (diff == 0)
+         {
+            if (m_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed))
+            {
+               break;
+            }
+         }
+         else if (diff < 0)
+         {
+            /* The slot still holds the item pushed one lap ago. */
+            return false;
+         }
+         else
+         {
+            tail = m_tail.load(std::memory_order_relaxed);
+         }
+      }
+
+      new (&c->storage) T(std::forward<U>(item));
+      c->sequence.store(tail + 1, std::memory_order_release);
+      return true;
+   }
+
+   /**
+    * @brief Pop the front of the ring buffer. Must only be called by the consumer.
+    *
+    * @return Item wrapped in an optional, std::nullopt if the buffer is empty or the front item is
+    *         still being written.
+    */
+   std::optional<T> pop_front()
+   {
+      std::size_t head = m_head.load(std::memory_order_relaxed);
+      cell &c = m_cells[head & MASK];
+      if (c.sequence.load(std::memory_order_acquire) != head + 1)
+      {
+         return std::nullopt;
+      }
+
+      T *item = std::launder(reinterpret_cast<T *>(&c.storage));
+      std::optional<T> value{ std::move(*item) };
+      item->~T();
+      c.sequence.store(head + CAPACITY, std::memory_order_release);
+      m_head.store(head + 1, std::memory_order_release);
+      return value;
+   }
+
+private:
+   static constexpr std::size_t CAPACITY = ring_buffer_capacity(N);
+   static constexpr std::size_t MASK = CAPACITY - 1;
+
+   struct cell
+   {
+      std::atomic<std::size_t> sequence;
+      std::aligned_storage_t<sizeof(T), alignof(T)> storage;
+   };
+
+   /* Index of the next item to pop, written by the consumer. */
+   alignas(RING_BUFFER_CACHE_LINE_SIZE) std::atomic<std::size_t> m_head{ 0 };
+
+   /* Index of the next slot to push to, claimed by the producers. */
+   alignas(RING_BUFFER_CACHE_LINE_SIZE) std::atomic<std::size_t> m_tail{ 0 };
+
+   alignas(RING_BUFFER_CACHE_LINE_SIZE) cell m_cells[CAPACITY];
+};
+
+} /* namespace util */
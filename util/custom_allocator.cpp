@@ -26,11 +26,21 @@
 #include "macros.hpp"
 #include <vulkan/vulkan.h>
 
+#include <cstddef>
+#include <cstdlib>
+
 namespace util
 {
 
-VWL_VKAPI_CALL(void *) default_allocation(void *, size_t size, size_t, VkSystemAllocationScope) VWL_API_POST
+VWL_VKAPI_CALL(void *)
+default_allocation(void *, size_t size, size_t alignment, VkSystemAllocationScope) VWL_API_POST
 {
+   /* malloc only guarantees the alignment of fundamental types, which is not enough for
+    * cache line aligned objects. */
+   if (alignment > alignof(std::max_align_t))
+   {
+      return aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+   }
    return malloc(size);
 }
 
@@ -52,14 +62,27 @@ const allocator &allocator::get_generic()
 }
 
 allocator::allocator(const allocator &other, VkSystemAllocationScope new_scope, const VkAllocationCallbacks *callbacks)
-   : allocator{ new_scope, callbacks == nullptr ? other.get_original_callbacks() : callbacks }
+   : allocator{ other, new_scope, callbacks, other.m_subsystem }
 {
 }
 
+allocator::allocator(const allocator &other, VkSystemAllocationScope new_scope, const VkAllocationCallbacks *callbacks,
+                     memory_subsystem subsystem)
+   : allocator{ new_scope, callbacks == nullptr ? other.get_original_callbacks() : callbacks, subsystem }
+{
+   /* Keep the allocations of an arena unaccounted when its callbacks are reused. */
+   if (callbacks == nullptr)
+   {
+      m_accounted = other.m_accounted;
+   }
+}
+
 /* If callbacks is already populated by vulkan then use those specified as default. */
-allocator::allocator(VkSystemAllocationScope scope, const VkAllocationCallbacks *callbacks)
+allocator::allocator(VkSystemAllocationScope scope, const VkAllocationCallbacks *callbacks,
+                     memory_subsystem subsystem)
 {
    m_scope = scope;
+   m_subsystem = subsystem;
    if (callbacks != nullptr)
    {
       m_callbacks = *callbacks;
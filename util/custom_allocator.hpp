@@ -28,10 +28,12 @@
 #include <string>
 #include <cassert>
 #include <memory>
+#include <type_traits>
 
 #include <vulkan/vulkan.h>
 
 #include "helpers.hpp"
+#include "memory_accounting.hpp"
 
 #pragma once
 
@@ -69,8 +71,10 @@ public:
     * @param scope The scope to use for this allocator.
     * @param callbacks Pointer to allocation callbacks. If this is @c nullptr, then default
     *   allocation callbacks are used. These can be accessed through #m_callbacks.
+    * @param subsystem The subsystem the allocations are accounted to.
     */
-   allocator(VkSystemAllocationScope scope, const VkAllocationCallbacks *callbacks);
+   allocator(VkSystemAllocationScope scope, const VkAllocationCallbacks *callbacks,
+             memory_subsystem subsystem = memory_subsystem::general);
 
    /**
     * @brief Construct a new allocator that uses @p callbacks or @p allocator callbacks if the
@@ -84,6 +88,12 @@ public:
    allocator(const allocator &other, VkSystemAllocationScope new_scope,
              const VkAllocationCallbacks *callbacks = nullptr);
 
+   /**
+    * @brief Same as above, but accounts the allocations to @p subsystem rather than to the subsystem of @p other.
+    */
+   allocator(const allocator &other, VkSystemAllocationScope new_scope, const VkAllocationCallbacks *callbacks,
+             memory_subsystem subsystem);
+
    /**
     * @brief Get a pointer to the allocation callbacks provided while constructing this object.
     * @return a copy of the #VkAllocationCallback argument provided in the allocator constructor
@@ -108,11 +118,49 @@ public:
    template <typename T>
    void destroy(size_t num_objects, T *obj) const noexcept;
 
+   /**
+    * @brief Helper method to destroy and deallocate an object created with allocator::create(), possibly as a type
+    *        derived from T.
+    * @param object      The object to destroy. T must have a virtual destructor if the object was created as a derived
+    *                    type.
+    * @param object_size The size of the type the object was created as.
+    */
+   template <typename T>
+   void destroy_sized(T *object, size_t object_size) const noexcept;
+
    template <typename T, typename... Args>
    util::unique_ptr<T> make_unique(Args &&...args) const noexcept;
 
+   /**
+    * @brief Record an allocation of @p size bytes made with the callbacks in the memory accounting.
+    */
+   void record_allocation(size_t size) const
+   {
+      if (m_accounted)
+      {
+         memory_accounting::record_host_allocation(m_scope, m_subsystem, size);
+      }
+   }
+
+   /**
+    * @brief Record that an allocation of @p size bytes made with the callbacks was freed.
+    */
+   void record_free(size_t size) const
+   {
+      if (m_accounted)
+      {
+         memory_accounting::record_host_free(m_scope, m_subsystem, size);
+      }
+   }
+
    VkAllocationCallbacks m_callbacks{};
    VkSystemAllocationScope m_scope;
+   memory_subsystem m_subsystem;
+   /**
+    * @brief Whether the allocations are recorded in the memory accounting. False for the allocators of an arena,
+    *        which records its blocks instead.
+    */
+   bool m_accounted{ true };
 };
 
 /**
@@ -153,6 +201,7 @@ public:
       void *ret = cb.pfnAllocation(cb.pUserData, size, alignof(T), m_alloc.m_scope);
       if (ret == nullptr)
          throw std::bad_alloc();
+      m_alloc.record_allocation(size);
       return reinterpret_cast<pointer>(ret);
    }
 
@@ -171,9 +220,10 @@ public:
       return reinterpret_cast<pointer>(ret);
    }
 
-   void deallocate(void *ptr, size_t) const noexcept
+   void deallocate(void *ptr, size_t n) const noexcept
    {
       m_alloc.m_callbacks.pfnFree(m_alloc.m_callbacks.pUserData, ptr);
+      m_alloc.record_free(n * sizeof(T));
    }
 
 private:
@@ -254,9 +304,25 @@ void allocator::destroy(size_t num_objects, T *objects) const noexcept
    allocator.deallocate(objects, num_objects);
 }
 
+template <typename T>
+void allocator::destroy_sized(T *object, size_t object_size) const noexcept
+{
+   if (object == nullptr)
+   {
+      return;
+   }
+
+   object->~T();
+   m_callbacks.pfnFree(m_callbacks.pUserData, object);
+   record_free(object_size);
+}
+
 /**
  * @brief Class deleter is used to free the resource managed by the util::unique_ptr. Uses the passed in allocator's
- *        destroy method.
+ *        destroy_sized method.
+ *
+ * The deleter keeps the size of the type the object was created as, so that it is still known after the
+ * util::unique_ptr is converted to a pointer to a base class.
  */
 template <typename T>
 class deleter : public allocator
@@ -272,10 +338,28 @@ public:
    {
    }
 
+   template <typename U, std::enable_if_t<std::is_convertible<U *, T *>::value, bool> = true>
+   deleter(const deleter<U> &other)
+      : allocator(other)
+      , m_object_size(other.get_object_size())
+   {
+   }
+
    void operator()(T *object)
    {
-      destroy<T>(1, object);
+      destroy_sized<T>(object, m_object_size);
+   }
+
+   /**
+    * @brief Get the size of the type the managed object was created as.
+    */
+   size_t get_object_size() const
+   {
+      return m_object_size;
    }
+
+private:
+   size_t m_object_size{ sizeof(T) };
 };
 
 /**
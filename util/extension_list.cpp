@@ -35,14 +35,39 @@ namespace util
 extension_list::extension_list(const util::allocator &allocator)
    : m_alloc{ allocator }
    , m_ext_props(allocator)
+   , m_hashes(allocator)
 {
 }
 
+uint64_t extension_list::hash_name(const char *extension_name)
+{
+   /* 64-bit FNV-1a. */
+   uint64_t hash = 0xcbf29ce484222325;
+   for (const char *c = extension_name; *c != '\0'; c++)
+   {
+      hash = (hash ^ static_cast<unsigned char>(*c)) * 0x100000001b3;
+   }
+   return hash;
+}
+
+size_t extension_list::find(const char *extension_name, uint64_t hash) const
+{
+   for (size_t i = 0; i < m_hashes.size(); i++)
+   {
+      if (m_hashes[i] == hash && strcmp(m_ext_props[i].extensionName, extension_name) == 0)
+      {
+         return i;
+      }
+   }
+   return SIZE_MAX;
+}
+
 VkResult extension_list::add(const char *const *extensions, size_t count)
 {
    auto initial_size = m_ext_props.size();
-   if (!m_ext_props.try_resize(initial_size + count))
+   if (!m_ext_props.try_resize(initial_size + count) || !m_hashes.try_resize(initial_size + count))
    {
+      m_ext_props.try_resize(initial_size);
       return VK_ERROR_OUT_OF_HOST_MEMORY;
    }
 
@@ -65,6 +90,7 @@ VkResult extension_list::add(const char *const *extensions, size_t count)
       {
          abort();
       }
+      m_hashes[initial_size + i] = hash_name(dst.extensionName);
    }
    return VK_SUCCESS;
 }
@@ -72,12 +98,23 @@ VkResult extension_list::add(const char *const *extensions, size_t count)
 VkResult extension_list::add(const char *const *extensions, size_t count, const char *const *extensions_subset,
                              size_t subset_count)
 {
+   util::vector<uint64_t> subset_hashes(m_alloc);
+   if (!subset_hashes.try_resize(subset_count))
+   {
+      return VK_ERROR_OUT_OF_HOST_MEMORY;
+   }
+   for (size_t subset_index = 0; subset_index < subset_count; ++subset_index)
+   {
+      subset_hashes[subset_index] = hash_name(extensions_subset[subset_index]);
+   }
+
    util::vector<const char *> extensions_to_add(m_alloc);
    for (size_t ext_index = 0; ext_index < count; ++ext_index)
    {
+      const uint64_t hash = hash_name(extensions[ext_index]);
       for (size_t subset_index = 0; subset_index < subset_count; ++subset_index)
       {
-         if (!strcmp(extensions[ext_index], extensions_subset[subset_index]))
+         if (subset_hashes[subset_index] == hash && !strcmp(extensions[ext_index], extensions_subset[subset_index]))
          {
             if (!extensions_to_add.try_push_back(extensions[ext_index]))
             {
@@ -98,12 +135,18 @@ VkResult extension_list::add(const char *const *extensions, size_t count, const
 
 VkResult extension_list::add(VkExtensionProperties ext_prop)
 {
-   if (!contains(ext_prop.extensionName))
+   const uint64_t hash = hash_name(ext_prop.extensionName);
+   if (find(ext_prop.extensionName, hash) == SIZE_MAX)
    {
       if (!m_ext_props.try_push_back(ext_prop))
       {
          return VK_ERROR_OUT_OF_HOST_MEMORY;
       }
+      if (!m_hashes.try_push_back(hash))
+      {
+         m_ext_props.pop_back();
+         return VK_ERROR_OUT_OF_HOST_MEMORY;
+      }
    }
    return VK_SUCCESS;
 }
@@ -111,26 +154,33 @@ VkResult extension_list::add(VkExtensionProperties ext_prop)
 VkResult extension_list::add(const VkExtensionProperties *props, size_t count)
 {
    auto initial_size = m_ext_props.size();
-   if (!m_ext_props.try_resize(initial_size + count))
+   if (!m_ext_props.try_resize(initial_size + count) || !m_hashes.try_resize(initial_size + count))
    {
+      m_ext_props.try_resize(initial_size);
       return VK_ERROR_OUT_OF_HOST_MEMORY;
    }
    for (size_t i = 0; i < count; i++)
    {
       m_ext_props[initial_size + i] = props[i];
+      m_hashes[initial_size + i] = hash_name(props[i].extensionName);
    }
    return VK_SUCCESS;
 }
 
 VkResult extension_list::add(const extension_list &ext_list)
 {
-   util::vector<const char *> ext_vect{ m_alloc };
-   VkResult result = ext_list.get_extension_strings(ext_vect);
-   if (result != VK_SUCCESS)
+   const size_t initial_size = m_ext_props.size();
+   const size_t count = ext_list.m_ext_props.size();
+   if (!m_ext_props.try_resize(initial_size + count) || !m_hashes.try_resize(initial_size + count))
    {
-      return result;
+      m_ext_props.try_resize(initial_size);
+      return VK_ERROR_OUT_OF_HOST_MEMORY;
    }
-   return add(ext_vect.data(), ext_vect.size());
+
+   /* The names are already validated and hashed. */
+   std::copy(ext_list.m_ext_props.begin(), ext_list.m_ext_props.end(), m_ext_props.begin() + initial_size);
+   std::copy(ext_list.m_hashes.begin(), ext_list.m_hashes.end(), m_hashes.begin() + initial_size);
+   return VK_SUCCESS;
 }
 
 VkResult extension_list::get_extension_strings(util::vector<const char *> &out) const
@@ -151,9 +201,9 @@ VkResult extension_list::get_extension_strings(util::vector<const char *> &out)
 
 bool extension_list::contains(const extension_list &req) const
 {
-   for (const auto &req_ext : req.m_ext_props)
+   for (size_t i = 0; i < req.m_ext_props.size(); i++)
    {
-      if (!contains(req_ext.extensionName))
+      if (find(req.m_ext_props[i].extensionName, req.m_hashes[i]) == SIZE_MAX)
       {
          return false;
       }
@@ -163,20 +213,16 @@ bool extension_list::contains(const extension_list &req) const
 
 bool extension_list::contains(const char *extension_name) const
 {
-   for (const auto &p : m_ext_props)
-   {
-      if (strcmp(p.extensionName, extension_name) == 0)
-      {
-         return true;
-      }
-   }
-   return false;
+   return find(extension_name, hash_name(extension_name)) != SIZE_MAX;
 }
 
 void extension_list::remove(const char *ext)
 {
-   m_ext_props.erase(std::remove_if(m_ext_props.begin(), m_ext_props.end(), [&ext](VkExtensionProperties ext_prop) {
-      return (strcmp(ext_prop.extensionName, ext) == 0);
-   }));
+   const uint64_t hash = hash_name(ext);
+   for (size_t i = find(ext, hash); i != SIZE_MAX; i = find(ext, hash))
+   {
+      m_ext_props.erase(m_ext_props.begin() + i);
+      m_hashes.erase(m_hashes.begin() + i);
+   }
 }
 } // namespace util
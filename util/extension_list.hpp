@@ -37,6 +37,8 @@ namespace util
 /**
  * @brief A helper class for storing a vector of extension names
  *
+ * A hash of each name is stored alongside it, so that lookups only compare the names whose hashes match.
+ *
  * @note This class does not store the extension versions.
  */
 class extension_list : private noncopyable
@@ -104,12 +106,29 @@ public:
     */
    VkResult add(const char *const *extensions, size_t count, const char *const *extensions_subset, size_t subset_count);
 
+   /**
+    * @brief Compute the hash of an extension name.
+    */
+   static uint64_t hash_name(const char *extension_name);
+
 private:
+   /**
+    * @brief Find an extension given its name and the hash of its name.
+    *
+    * @return The index of the extension or SIZE_MAX if the list does not contain the extension.
+    */
+   size_t find(const char *extension_name, uint64_t hash) const;
+
    util::allocator m_alloc;
 
    /**
     * @note We are using VkExtensionProperties to store the extension name only
     */
    util::vector<VkExtensionProperties> m_ext_props;
+
+   /**
+    * @brief Hashes of the names in #m_ext_props, at the same indices.
+    */
+   util::vector<uint64_t> m_hashes;
 };
 } // namespace util
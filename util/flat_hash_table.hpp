@@ -0,0 +1,589 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file flat_hash_table.hpp
+ *
+ * @brief Contains the open addressing hash table used by util::flat_map and util::flat_set.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "custom_allocator.hpp"
+#include "helpers.hpp"
+#include "memory_accounting.hpp"
+
+namespace util
+{
+
+/**
+ * @brief Default hash of the flat hash tables.
+ *
+ * Vulkan handles are pointers or 64-bit integers whose low bits are often zero because of
+ * alignment. The value is multiplied by a large odd constant and folded, so that both the
+ * low and the high bits of the hash depend on all the bits of the handle.
+ */
+template <typename Key>
+struct flat_hash
+{
+   size_t operator()(const Key &key) const
+   {
+      uint64_t value;
+      if constexpr (std::is_pointer_v<Key>)
+      {
+         value = reinterpret_cast<uintptr_t>(key);
+      }
+      else if constexpr (std::is_integral_v<Key> || std::is_enum_v<Key>)
+      {
+         value = static_cast<uint64_t>(key);
+      }
+      else
+      {
+         value = std::hash<Key>{}(key);
+      }
+      uint64_t hash = value * 0x9e3779b97f4a7c15;
+      return static_cast<size_t>(hash ^ (hash >> 32));
+   }
+};
+
+/**
+ * @brief Hash of NUL terminated strings for the flat hash tables.
+ */
+struct cstring_hash
+{
+   size_t operator()(const char *key) const
+   {
+      /* 64-bit FNV-1a. */
+      uint64_t hash = 0xcbf29ce484222325;
+      for (const char *c = key; *c != '\0'; c++)
+      {
+         hash = (hash ^ static_cast<unsigned char>(*c)) * 0x100000001b3;
+      }
+      return static_cast<size_t>(hash ^ (hash >> 32));
+   }
+};
+
+/**
+ * @brief Comparator of NUL terminated strings for the flat hash tables.
+ */
+struct cstring_equal
+{
+   bool operator()(const char *lhs, const char *rhs) const
+   {
+      return strcmp(lhs, rhs) == 0;
+   }
+};
+
+/**
+ * @brief Open addressing hash table with SWAR group probing.
+ *
+ * The table keeps one control byte per slot: the 7 low bits of the hash of the element in the
+ * slot, or a marker for empty and erased slots. The control bytes are probed 8 at a time with
+ * 64-bit integer operations, so a lookup usually reads one word of control bytes and compares a
+ * single key. The control bytes and the elements are stored in one allocation made with the
+ * Vulkan allocation callbacks. Allocation failures are reported by the return values and never
+ * by exceptions.
+ *
+ * Unlike std::unordered_map, inserting an element may move the other elements, which invalidates
+ * the iterators and the references to them. Erasing an element only invalidates the iterators and
+ * references to that element.
+ *
+ * @tparam Slot       The type of the elements.
+ * @tparam Key        The type of the keys.
+ * @tparam KeyOf      Type with a static get() member function returning the key of an element.
+ * @tparam Hash       The hash of the keys.
+ * @tparam Comparator The equality comparison of the keys.
+ */
+template <typename Slot, typename Key, typename KeyOf, typename Hash, typename Comparator>
+class flat_hash_table : private noncopyable
+{
+public:
+   using key_type = Key;
+   using value_type = Slot;
+   using size_type = size_t;
+
+   /**
+    * @brief Forward iterator over the elements of the table.
+    */
+   template <bool is_const>
+   class iterator_base
+   {
+   public:
+      using table_type = std::conditional_t<is_const, const flat_hash_table, flat_hash_table>;
+      using reference = std::conditional_t<is_const, const Slot &, Slot &>;
+      using pointer = std::conditional_t<is_const, const Slot *, Slot *>;
+
+      iterator_base(table_type *table, size_t index)
+         : m_table(table)
+         , m_index(index)
+      {
+      }
+
+      /* Allow converting iterators to const_iterators. */
+      template <bool other_const, typename = std::enable_if_t<is_const && !other_const>>
+      iterator_base(const iterator_base<other_const> &other)
+         : m_table(other.m_table)
+         , m_index(other.m_index)
+      {
+      }
+
+      reference operator*() const
+      {
+         return m_table->m_slots[m_index];
+      }
+
+      pointer operator->() const
+      {
+         return &m_table->m_slots[m_index];
+      }
+
+      iterator_base &operator++()
+      {
+         m_index = m_table->next_full(m_index + 1);
+         return *this;
+      }
+
+      bool operator==(const iterator_base &other) const
+      {
+         return m_index == other.m_index;
+      }
+
+      bool operator!=(const iterator_base &other) const
+      {
+         return m_index != other.m_index;
+      }
+
+   private:
+      friend class flat_hash_table;
+      template <bool>
+      friend class iterator_base;
+
+      table_type *m_table;
+      size_t m_index;
+   };
+
+   using iterator = iterator_base<false>;
+   using const_iterator = iterator_base<true>;
+
+   /**
+    * @brief Construct an empty table. No memory is allocated until the first insertion.
+    *
+    * @param allocator The allocator that will be used.
+    */
+   explicit flat_hash_table(const util::allocator &allocator)
+      : m_allocator(allocator)
+   {
+   }
+
+   ~flat_hash_table()
+   {
+      clear();
+      deallocate(m_ctrl, m_capacity);
+   }
+
+   iterator begin()
+   {
+      return iterator(this, next_full(0));
+   }
+
+   iterator end()
+   {
+      return iterator(this, m_capacity);
+   }
+
+   const_iterator begin() const
+   {
+      return const_iterator(this, next_full(0));
+   }
+
+   const_iterator end() const
+   {
+      return const_iterator(this, m_capacity);
+   }
+
+   size_type size() const
+   {
+      return m_size;
+   }
+
+   bool empty() const
+   {
+      return m_size == 0;
+   }
+
+   /**
+    * @brief Find the element with a key.
+    *
+    * @param key The key to look for.
+    * @return An iterator to the element or end() if there is no element with @p key.
+    */
+   iterator find(const Key &key)
+   {
+      return iterator(this, find_index(key));
+   }
+
+   const_iterator find(const Key &key) const
+   {
+      return const_iterator(this, find_index(key));
+   }
+
+   /**
+    * @brief Insert an element if there is no element with the same key.
+    *
+    * @param value The element to insert.
+    * @return If successful, an iterator to the element with the key of @p value and whether @p value
+    *         was inserted. std::nullopt if out of memory.
+    */
+   std::optional<std::pair<iterator, bool>> try_insert(const Slot &value)
+   {
+      const Key &key = KeyOf::get(value);
+      size_t index = find_index(key);
+      if (index != m_capacity)
+      {
+         return std::make_pair(iterator(this, index), false);
+      }
+
+      if (!reserve_one())
+      {
+         return std::nullopt;
+      }
+
+      size_t hash = Hash{}(key);
+      index = find_free_slot(hash);
+      if (m_ctrl[index] == CTRL_DELETED)
+      {
+         m_deleted--;
+      }
+      new (&m_slots[index]) Slot(value);
+      m_ctrl[index] = get_h2(hash);
+      m_size++;
+      return std::make_pair(iterator(this, index), true);
+   }
+
+   /**
+    * @brief Make room for @p count elements without further allocations.
+    *
+    * @param count The number of elements.
+    * @return true if successful, false if out of memory.
+    */
+   bool try_reserve(size_type count)
+   {
+      size_t capacity = GROUP_SIZE;
+      while (get_max_load(capacity) < count)
+      {
+         capacity *= 2;
+      }
+      return capacity <= m_capacity || rehash(capacity);
+   }
+
+   /**
+    * @brief Erase an element.
+    *
+    * @param it Iterator to the element, must not be end().
+    * @return Iterator to the element following the erased one.
+    */
+   iterator erase(const_iterator it)
+   {
+      size_t index = it.m_index;
+      assert(index < m_capacity && is_full(m_ctrl[index]));
+
+      m_slots[index].~Slot();
+      m_size--;
+
+      /*
+       * An erased slot can only be marked as empty if its group already has an empty slot. Otherwise
+       * the lookups of the elements that were placed after this group would stop early.
+       */
+      if (match_empty(load_group(index / GROUP_SIZE)) != 0)
+      {
+         m_ctrl[index] = CTRL_EMPTY;
+      }
+      else
+      {
+         m_ctrl[index] = CTRL_DELETED;
+         m_deleted++;
+      }
+      return iterator(this, next_full(index + 1));
+   }
+
+   /**
+    * @brief Erase the element with a key, if any.
+    *
+    * @param key The key of the element.
+    * @return The number of elements erased.
+    */
+   size_type erase(const Key &key)
+   {
+      size_t index = find_index(key);
+      if (index == m_capacity)
+      {
+         return 0;
+      }
+      erase(const_iterator(this, index));
+      return 1;
+   }
+
+   /**
+    * @brief Erase all the elements. The memory of the table is kept.
+    */
+   void clear()
+   {
+      for (size_t i = 0; i < m_capacity; i++)
+      {
+         if (is_full(m_ctrl[i]))
+         {
+            m_slots[i].~Slot();
+         }
+      }
+      if (m_ctrl != nullptr)
+      {
+         memset(m_ctrl, CTRL_EMPTY, m_capacity);
+      }
+      m_size = 0;
+      m_deleted = 0;
+   }
+
+private:
+   static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "The group probing assumes little endian words");
+
+   static constexpr size_t GROUP_SIZE = 8;
+   static constexpr uint8_t CTRL_EMPTY = 0x80;
+   static constexpr uint8_t CTRL_DELETED = 0xfe;
+   static constexpr uint64_t LSBS = 0x0101010101010101;
+   static constexpr uint64_t MSBS = 0x8080808080808080;
+
+   static bool is_full(uint8_t ctrl)
+   {
+      return (ctrl & 0x80) == 0;
+   }
+
+   static uint8_t get_h2(size_t hash)
+   {
+      return static_cast<uint8_t>(hash & 0x7f);
+   }
+
+   static size_t get_h1(size_t hash)
+   {
+      return hash >> 7;
+   }
+
+   /* At most 7/8 of the slots hold elements or erased markers, so every probe finds an empty slot. */
+   static size_t get_max_load(size_t capacity)
+   {
+      return capacity - capacity / 8;
+   }
+
+   /* Mask with the top bit set in the bytes of the group equal to h2. May have false positives. */
+   static uint64_t match_byte(uint64_t group, uint8_t h2)
+   {
+      uint64_t x = group ^ (LSBS * h2);
+      return (x - LSBS) & ~x & MSBS;
+   }
+
+   /* Mask with the top bit set in the empty bytes of the group. */
+   static uint64_t match_empty(uint64_t group)
+   {
+      return group & (~group << 6) & MSBS;
+   }
+
+   /* Mask with the top bit set in the empty or erased bytes of the group. */
+   static uint64_t match_free(uint64_t group)
+   {
+      return group & MSBS;
+   }
+
+   static size_t lowest_byte(uint64_t mask)
+   {
+      return static_cast<size_t>(__builtin_ctzll(mask)) / 8;
+   }
+
+   uint64_t load_group(size_t group_index) const
+   {
+      uint64_t group;
+      memcpy(&group, m_ctrl + group_index * GROUP_SIZE, sizeof(group));
+      return group;
+   }
+
+   size_t next_full(size_t index) const
+   {
+      while (index < m_capacity && !is_full(m_ctrl[index]))
+      {
+         index++;
+      }
+      return index;
+   }
+
+   /* Index of the element with the key or m_capacity. */
+   size_t find_index(const Key &key) const
+   {
+      if (m_size == 0)
+      {
+         return m_capacity;
+      }
+
+      size_t hash = Hash{}(key);
+      uint8_t h2 = get_h2(hash);
+      size_t group_mask = m_capacity / GROUP_SIZE - 1;
+      size_t group_index = get_h1(hash) & group_mask;
+      /* Triangular probing visits every group as the number of groups is a power of two. */
+      for (size_t step = 1;; step++)
+      {
+         uint64_t group = load_group(group_index);
+         for (uint64_t match = match_byte(group, h2); match != 0; match &= match - 1)
+         {
+            size_t index = group_index * GROUP_SIZE + lowest_byte(match);
+            if (Comparator{}(KeyOf::get(m_slots[index]), key))
+            {
+               return index;
+            }
+         }
+         if (match_empty(group) != 0)
+         {
+            return m_capacity;
+         }
+         group_index = (group_index + step) & group_mask;
+      }
+   }
+
+   /* Index of the first empty or erased slot in the probe sequence of the hash. */
+   size_t find_free_slot(size_t hash) const
+   {
+      size_t group_mask = m_capacity / GROUP_SIZE - 1;
+      size_t group_index = get_h1(hash) & group_mask;
+      for (size_t step = 1;; step++)
+      {
+         uint64_t match = match_free(load_group(group_index));
+         if (match != 0)
+         {
+            return group_index * GROUP_SIZE + lowest_byte(match);
+         }
+         group_index = (group_index + step) & group_mask;
+      }
+   }
+
+   /* Make sure that one more element can be inserted. */
+   bool reserve_one()
+   {
+      if (m_capacity == 0)
+      {
+         return rehash(GROUP_SIZE);
+      }
+      if (m_size + m_deleted + 1 <= get_max_load(m_capacity))
+      {
+         return true;
+      }
+      /* Reclaim the erased slots if they take a large part of the table, grow it otherwise. */
+      return rehash(m_size + 1 <= get_max_load(m_capacity) / 2 ? m_capacity : m_capacity * 2);
+   }
+
+   static size_t get_slots_offset(size_t capacity)
+   {
+      return (capacity + alignof(Slot) - 1) / alignof(Slot) * alignof(Slot);
+   }
+
+   static size_t get_storage_size(size_t capacity)
+   {
+      return get_slots_offset(capacity) + capacity * sizeof(Slot);
+   }
+
+   uint8_t *allocate(size_t capacity)
+   {
+      if (capacity > (SIZE_MAX - GROUP_SIZE) / (sizeof(Slot) + 1))
+      {
+         return nullptr;
+      }
+      size_t size = get_storage_size(capacity);
+      size_t alignment = alignof(Slot) > alignof(uint64_t) ? alignof(Slot) : alignof(uint64_t);
+      auto &cb = m_allocator.m_callbacks;
+      void *storage = cb.pfnAllocation(cb.pUserData, size, alignment, m_allocator.m_scope);
+      if (storage != nullptr)
+      {
+         m_allocator.record_allocation(size);
+      }
+      return static_cast<uint8_t *>(storage);
+   }
+
+   void deallocate(uint8_t *storage, size_t capacity)
+   {
+      if (storage != nullptr)
+      {
+         m_allocator.m_callbacks.pfnFree(m_allocator.m_callbacks.pUserData, storage);
+         m_allocator.record_free(get_storage_size(capacity));
+      }
+   }
+
+   /* Move all the elements to a new allocation with @p capacity slots. */
+   bool rehash(size_t capacity)
+   {
+      uint8_t *storage = allocate(capacity);
+      if (storage == nullptr)
+      {
+         return false;
+      }
+
+      uint8_t *old_ctrl = m_ctrl;
+      Slot *old_slots = m_slots;
+      size_t old_capacity = m_capacity;
+
+      m_ctrl = storage;
+      m_slots = reinterpret_cast<Slot *>(storage + get_slots_offset(capacity));
+      m_capacity = capacity;
+      m_deleted = 0;
+      memset(m_ctrl, CTRL_EMPTY, capacity);
+
+      for (size_t i = 0; i < old_capacity; i++)
+      {
+         if (is_full(old_ctrl[i]))
+         {
+            size_t hash = Hash{}(KeyOf::get(old_slots[i]));
+            size_t index = find_free_slot(hash);
+            new (&m_slots[index]) Slot(std::move(old_slots[i]));
+            m_ctrl[index] = get_h2(hash);
+            old_slots[i].~Slot();
+         }
+      }
+
+      deallocate(old_ctrl, old_capacity);
+      return true;
+   }
+
+   util::allocator m_allocator;
+   uint8_t *m_ctrl{ nullptr };
+   Slot *m_slots{ nullptr };
+   size_t m_capacity{ 0 };
+   size_t m_size{ 0 };
+   size_t m_deleted{ 0 };
+};
+
+} /* namespace util */
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file flat_map.hpp
+ *
+ * @brief Contains the definition of an open addressing hash map.
+ */
+
+#pragma once
+
+#include <utility>
+
+#include "flat_hash_table.hpp"
+
+namespace util
+{
+
+/**
+ * @brief Hash map storing its elements in a flat array, see util::flat_hash_table.
+ *
+ * Meant for the small maps on the per-call paths of the layer, such as the maps from
+ * dispatchable handles to the layer data. Like util::unordered_map, the operations that
+ * allocate report out of memory errors through their return values.
+ */
+template <typename Key, typename Value, typename Hash = flat_hash<Key>, typename Comparator = std::equal_to<Key>>
+class flat_map : public flat_hash_table<std::pair<const Key, Value>, Key, flat_map<Key, Value, Hash, Comparator>,
+                                        Hash, Comparator>
+{
+   using base =
+      flat_hash_table<std::pair<const Key, Value>, Key, flat_map<Key, Value, Hash, Comparator>, Hash, Comparator>;
+
+public:
+   using mapped_type = Value;
+
+   /**
+    * @brief Construct a new flat map object with a custom allocator.
+    *
+    * @param allocator The allocator that will be used.
+    */
+   explicit flat_map(const util::allocator &allocator)
+      : base(allocator)
+   {
+   }
+
+   /**
+    * @brief Get the value of an element that must be in the map.
+    *
+    * @param key The key of the element.
+    */
+   Value &at(const Key &key)
+   {
+      auto it = base::find(key);
+      assert(it != base::end());
+      return it->second;
+   }
+
+   const Value &at(const Key &key) const
+   {
+      auto it = base::find(key);
+      assert(it != base::end());
+      return it->second;
+   }
+
+   /**
+    * @brief Get the key of an element, used by util::flat_hash_table.
+    */
+   static const Key &get(const std::pair<const Key, Value> &element)
+   {
+      return element.first;
+   }
+};
+
+} /* namespace util */
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file flat_set.hpp
+ *
+ * @brief Contains the definition of an open addressing hash set.
+ */
+
+#pragma once
+
+#include "flat_hash_table.hpp"
+
+namespace util
+{
+
+/**
+ * @brief Hash set storing its elements in a flat array, see util::flat_hash_table.
+ *
+ * Like util::unordered_set, the operations that allocate report out of memory errors through
+ * their return values.
+ */
+template <typename Key, typename Hash = flat_hash<Key>, typename Comparator = std::equal_to<Key>>
+class flat_set : public flat_hash_table<Key, Key, flat_set<Key, Hash, Comparator>, Hash, Comparator>
+{
+   using base = flat_hash_table<Key, Key, flat_set<Key, Hash, Comparator>, Hash, Comparator>;
+
+public:
+   /**
+    * @brief Construct a new flat set object with a custom allocator.
+    *
+    * @param allocator The allocator that will be used.
+    */
+   explicit flat_set(const util::allocator &allocator)
+      : base(allocator)
+   {
+   }
+
+   /**
+    * @brief Get the key of an element, used by util::flat_hash_table.
+    */
+   static const Key &get(const Key &element)
+   {
+      return element;
+   }
+};
+
+} /* namespace util */
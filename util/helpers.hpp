@@ -56,6 +56,9 @@
  *    }
  *    return VK_SUCCESS;
  * }
+ *
+ * TRY_LOG and TRY_LOG_CALL log with WSI_LOG_ERROR, so they must not be used by inline functions and templates
+ * defined in headers, see WSI_LOG_SUBSYSTEM.
  */
 #define TRY_HANDLER(expression, do_log, ...) \
    do                                        \
@@ -99,6 +102,21 @@ T *find_extension(VkStructureType sType, void *pNext)
    return reinterpret_cast<T *>(entry);
 }
 
+/**
+ * @brief Visit every structure of a pNext chain once, in chain order.
+ *
+ * @param pNext The first structure of the chain, may be nullptr.
+ * @param visit Callable taking a const VkBaseInStructure * for each structure.
+ */
+template <typename visitor_fn>
+void for_each_extension(const void *pNext, visitor_fn &&visit)
+{
+   for (auto entry = reinterpret_cast<const VkBaseInStructure *>(pNext); entry != nullptr; entry = entry->pNext)
+   {
+      visit(entry);
+   }
+}
+
 template <typename T>
 inline T shallow_copy_extension(const T *structure_to_copy)
 {
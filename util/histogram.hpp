@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file histogram.hpp
+ *
+ * @brief Contains the definition of a lock-free histogram with power of two buckets.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace util
+{
+
+/**
+ * @brief Histogram with power of two sized buckets that can be updated concurrently.
+ *
+ * Bucket 0 counts samples with the value 0 and bucket i (i > 0) counts the samples in
+ * the range [2^(i-1), 2^i). The last bucket also collects every sample that is too
+ * large for the other buckets. All the updates use relaxed atomics, so recording a
+ * sample never blocks and costs a handful of uncontended atomic additions. Readers may
+ * observe a histogram that is being updated, which is acceptable for statistics.
+ */
+class histogram
+{
+public:
+   /**
+    * @brief Number of buckets in the histogram.
+    */
+   static constexpr size_t NUM_BUCKETS = 32;
+
+   histogram() = default;
+   histogram(const histogram &) = delete;
+   histogram &operator=(const histogram &) = delete;
+
+   /**
+    * @brief Record a sample.
+    *
+    * @param value The value of the sample.
+    */
+   void record(uint64_t value)
+   {
+      m_buckets[get_bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+      m_count.fetch_add(1, std::memory_order_relaxed);
+      m_sum.fetch_add(value, std::memory_order_relaxed);
+
+      uint64_t current_max = m_max.load(std::memory_order_relaxed);
+      while (value > current_max && !m_max.compare_exchange_weak(current_max, value, std::memory_order_relaxed))
+      {
+      }
+   }
+
+   /**
+    * @brief Get the number of samples recorded.
+    */
+   uint64_t get_count() const
+   {
+      return m_count.load(std::memory_order_relaxed);
+   }
+
+   /**
+    * @brief Get the sum of all the samples recorded.
+    */
+   uint64_t get_sum() const
+   {
+      return m_sum.load(std::memory_order_relaxed);
+   }
+
+   /**
+    * @brief Get the largest sample recorded.
+    */
+   uint64_t get_max() const
+   {
+      return m_max.load(std::memory_order_relaxed);
+   }
+
+   /**
+    * @brief Get the mean of the samples recorded or 0 if there are no samples.
+    */
+   uint64_t get_mean() const
+   {
+      uint64_t count = get_count();
+      return count != 0 ? get_sum() / count : 0;
+   }
+
+   /**
+    * @brief Get the number of samples in a bucket.
+    *
+    * @param index Index of the bucket, must be less than NUM_BUCKETS.
+    */
+   uint64_t get_bucket_count(size_t index) const
+   {
+      return m_buckets[index].load(std::memory_order_relaxed);
+   }
+
+   /**
+    * @brief Get the exclusive upper bound of the values counted in a bucket.
+    *
+    * @param index Index of the bucket, must be less than NUM_BUCKETS.
+    */
+   static constexpr uint64_t get_bucket_upper_bound(size_t index)
+   {
+      return uint64_t{ 1 } << index;
+   }
+
+   /**
+    * @brief Estimate a percentile of the recorded samples.
+    *
+    * The estimate is the upper bound of the bucket containing the percentile, capped
+    * by the largest sample recorded.
+    *
+    * @param percentile The percentile to estimate, in the range [0, 100].
+    *
+    * @return The estimated value or 0 if there are no samples.
+    */
+   uint64_t get_percentile(unsigned percentile) const
+   {
+      uint64_t count = get_count();
+      if (count == 0)
+      {
+         return 0;
+      }
+
+      /* Rank of the sample (1 based) that corresponds to the percentile. */
+      uint64_t rank = (count * percentile + 99) / 100;
+      if (rank == 0)
+      {
+         rank = 1;
+      }
+
+      uint64_t seen = 0;
+      for (size_t i = 0; i < NUM_BUCKETS; i++)
+      {
+         seen += get_bucket_count(i);
+         if (seen >= rank)
+         {
+            if (i == NUM_BUCKETS - 1)
+            {
+               break;
+            }
+            uint64_t bound = get_bucket_upper_bound(i) - 1;
+            uint64_t max = get_max();
+            return bound < max ? bound : max;
+         }
+      }
+      return get_max();
+   }
+
+private:
+   static size_t get_bucket_index(uint64_t value)
+   {
+      if (value == 0)
+      {
+         return 0;
+      }
+      size_t index = 64 - static_cast<size_t>(__builtin_clzll(value));
+      return index < NUM_BUCKETS ? index : NUM_BUCKETS - 1;
+   }
+
+   std::array<std::atomic<uint64_t>, NUM_BUCKETS> m_buckets{};
+   std::atomic<uint64_t> m_count{ 0 };
+   std::atomic<uint64_t> m_sum{ 0 };
+   std::atomic<uint64_t> m_max{ 0 };
+};
+
+} /* namespace util */
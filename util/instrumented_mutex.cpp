@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file instrumented_mutex.cpp
+ *
+ * @brief Contains the registry of the lock contention statistics.
+ */
+
+#include "instrumented_mutex.hpp"
+
+#include <array>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+namespace util
+{
+
+#if WSI_LOCK_INSTRUMENTATION
+
+namespace
+{
+
+constexpr size_t MAX_LOCK_NAMES = 32;
+
+std::array<lock_statistics, MAX_LOCK_NAMES> g_lock_statistics;
+
+/**
+ * @brief Protects the registration of new names. This mutex is not instrumented itself.
+ */
+std::mutex g_registry_lock;
+
+} /* namespace */
+
+lock_statistics *get_lock_statistics(const char *name)
+{
+   std::lock_guard<std::mutex> lock(g_registry_lock);
+   for (auto &statistics : g_lock_statistics)
+   {
+      if (statistics.name == nullptr)
+      {
+         statistics.name = name;
+         return &statistics;
+      }
+      if (std::strcmp(statistics.name, name) == 0)
+      {
+         return &statistics;
+      }
+   }
+   return nullptr;
+}
+
+void report_lock_statistics()
+{
+   std::lock_guard<std::mutex> lock(g_registry_lock);
+   std::fprintf(stderr, "WSI lock statistics:\n");
+   for (const auto &statistics : g_lock_statistics)
+   {
+      if (statistics.name == nullptr)
+      {
+         break;
+      }
+
+      uint64_t acquisitions = statistics.acquisitions.load(std::memory_order_relaxed);
+      uint64_t contended = statistics.contended_acquisitions.load(std::memory_order_relaxed);
+      uint64_t total_wait_ns = statistics.total_wait_ns.load(std::memory_order_relaxed);
+      std::fprintf(stderr,
+                   "  %s: acquisitions=%" PRIu64 " contended=%" PRIu64 " total_wait=%" PRIu64 "us mean_wait=%" PRIu64
+                   "us max_wait=%" PRIu64 "us\n",
+                   statistics.name, acquisitions, contended, total_wait_ns / NSEC_PER_USEC,
+                   contended != 0 ? total_wait_ns / contended / NSEC_PER_USEC : 0,
+                   statistics.max_wait_ns.load(std::memory_order_relaxed) / NSEC_PER_USEC);
+   }
+   std::fflush(stderr);
+}
+
+#else
+
+void report_lock_statistics()
+{
+}
+
+#endif
+
+} /* namespace util */
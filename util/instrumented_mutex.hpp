@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file instrumented_mutex.hpp
+ *
+ * @brief Contains the mutex types used for the layer locks that may be contended.
+ *
+ * When the layer is built with ENABLE_LOCK_INSTRUMENTATION the mutexes record how many times they are acquired,
+ * how many of the acquisitions had to wait and for how long. The statistics of all the mutexes with the same name
+ * are aggregated and reported when a device is destroyed. Otherwise the types are the standard mutexes, the name
+ * passed to the constructor is ignored.
+ *
+ * Locks must be taken with util::lock_guard and util::unique_lock, so the code builds in both configurations.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+#include "clock.hpp"
+
+#ifndef WSI_LOCK_INSTRUMENTATION
+#define WSI_LOCK_INSTRUMENTATION 0
+#endif
+
+namespace util
+{
+
+#if WSI_LOCK_INSTRUMENTATION
+
+/**
+ * @brief Contention statistics shared by all the mutexes with the same name.
+ */
+struct lock_statistics
+{
+   const char *name{ nullptr };
+   std::atomic<uint64_t> acquisitions{ 0 };
+   std::atomic<uint64_t> contended_acquisitions{ 0 };
+   std::atomic<uint64_t> total_wait_ns{ 0 };
+   std::atomic<uint64_t> max_wait_ns{ 0 };
+};
+
+/**
+ * @brief Get the statistics of the mutexes with a given name.
+ *
+ * @param name Name of the mutex, must be a string with static storage duration.
+ *
+ * @return Pointer to the statistics or nullptr if too many different names are used.
+ */
+lock_statistics *get_lock_statistics(const char *name);
+
+/**
+ * @brief Mutex that records contention statistics.
+ *
+ * @tparam Mutex The underlying mutex type.
+ */
+template <typename Mutex>
+class instrumented_mutex
+{
+public:
+   using lockable_type = instrumented_mutex;
+
+   explicit instrumented_mutex(const char *name)
+      : m_statistics(get_lock_statistics(name))
+   {
+   }
+
+   instrumented_mutex(const instrumented_mutex &) = delete;
+   instrumented_mutex &operator=(const instrumented_mutex &) = delete;
+
+   void lock()
+   {
+      if (m_mutex.try_lock())
+      {
+         record_acquisition(false, 0);
+         return;
+      }
+
+      uint64_t wait_start = get_monotonic_time_ns();
+      m_mutex.lock();
+      record_acquisition(true, get_monotonic_time_ns() - wait_start);
+   }
+
+   bool try_lock()
+   {
+      bool locked = m_mutex.try_lock();
+      if (locked)
+      {
+         record_acquisition(false, 0);
+      }
+      return locked;
+   }
+
+   void unlock()
+   {
+      m_mutex.unlock();
+   }
+
+private:
+   void record_acquisition(bool contended, uint64_t wait_ns)
+   {
+      if (m_statistics == nullptr)
+      {
+         return;
+      }
+
+      m_statistics->acquisitions.fetch_add(1, std::memory_order_relaxed);
+      if (contended)
+      {
+         m_statistics->contended_acquisitions.fetch_add(1, std::memory_order_relaxed);
+         m_statistics->total_wait_ns.fetch_add(wait_ns, std::memory_order_relaxed);
+
+         uint64_t current_max = m_statistics->max_wait_ns.load(std::memory_order_relaxed);
+         while (wait_ns > current_max &&
+                !m_statistics->max_wait_ns.compare_exchange_weak(current_max, wait_ns, std::memory_order_relaxed))
+         {
+         }
+      }
+   }
+
+   Mutex m_mutex;
+   lock_statistics *m_statistics;
+};
+
+using mutex = instrumented_mutex<std::mutex>;
+using recursive_mutex = instrumented_mutex<std::recursive_mutex>;
+using condition_variable = std::condition_variable_any;
+
+#else
+
+/**
+ * @brief Standard mutex constructed with a name, for compatibility with instrumented builds.
+ *
+ * @tparam Mutex The underlying mutex type.
+ */
+template <typename Mutex>
+class named_mutex : public Mutex
+{
+public:
+   using lockable_type = Mutex;
+
+   constexpr explicit named_mutex(const char *) noexcept
+   {
+   }
+};
+
+using mutex = named_mutex<std::mutex>;
+using recursive_mutex = named_mutex<std::recursive_mutex>;
+using condition_variable = std::condition_variable;
+
+#endif
+
+template <typename Mutex>
+using lock_guard = std::lock_guard<typename Mutex::lockable_type>;
+
+template <typename Mutex>
+using unique_lock = std::unique_lock<typename Mutex::lockable_type>;
+
+/**
+ * @brief Report the statistics of the instrumented mutexes, does nothing in normal builds.
+ */
+void report_lock_statistics();
+
+} /* namespace util */
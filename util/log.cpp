@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2021-2023 Arm Limited.
+ * Copyright (c) 2021-2023, 2026 Arm Limited.
  *
  * SPDX-License-Identifier: MIT
  *
@@ -23,73 +23,494 @@
  */
 
 #include "log.hpp"
-#include <iostream>
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <charconv>
+#include <chrono>
+#include <condition_variable>
 #include <cstdarg>
 #include <cstdio>
 #include <cstdlib>
-#include <string>
 #include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include "clock.hpp"
 
 namespace util
 {
 
+uint32_t get_log_levels()
+{
+   /* Read on first use rather than by a global constructor: messages can be logged from the static initializers
+    * of other translation units (e.g. the present watchdog), which may run before those of this one. */
+   static const uint32_t levels = []() {
+      static constexpr const char *subsystem_env_vars[] = {
+         "VULKAN_WSI_DEBUG_LEVEL_GENERAL", "VULKAN_WSI_DEBUG_LEVEL_SWAPCHAIN", "VULKAN_WSI_DEBUG_LEVEL_SYNC",
+         "VULKAN_WSI_DEBUG_LEVEL_HEADLESS", "VULKAN_WSI_DEBUG_LEVEL_X11",       "VULKAN_WSI_DEBUG_LEVEL_WAYLAND",
+         "VULKAN_WSI_DEBUG_LEVEL_DISPLAY",
+      };
+      static_assert(sizeof(subsystem_env_vars) / sizeof(subsystem_env_vars[0]) ==
+                       static_cast<size_t>(log_subsystem::count),
+                    "Missing environment variable for a log subsystem");
+
+      uint32_t default_level = WSI_DEFAULT_LOG_LEVEL;
+      if (const char *env = std::getenv("VULKAN_WSI_DEBUG_LEVEL"))
+      {
+         std::from_chars(env, env + std::strlen(env), default_level);
+      }
+
+      uint32_t result = 0;
+      for (uint32_t i = 0; i < static_cast<uint32_t>(log_subsystem::count); i++)
+      {
+         uint32_t level = default_level;
+         if (const char *env = std::getenv(subsystem_env_vars[i]))
+         {
+            std::from_chars(env, env + std::strlen(env), level);
+         }
+         result |= std::min(level, LOG_LEVEL_MASK) << (i * LOG_LEVEL_BITS);
+      }
+      return result;
+   }();
+   return levels;
+}
+
 #ifndef NDEBUG
 
+namespace
+{
+
 /**
- * @brief check if a log level is enabled, and print it
+ * @brief A formatted log message waiting to be written.
  */
-static bool check_and_print_log_level(int level)
+struct log_record
 {
-   struct log_state
+   static constexpr size_t MAX_LENGTH = 512;
+
+   size_t length{ 0 };
+   char text[MAX_LENGTH];
+};
+
+class logger;
+logger &get_logger();
+
+/**
+ * @brief Buffer of the messages logged by a thread.
+ *
+ * A single-producer single-consumer ring buffer: the owning thread is the only producer and the flush thread, or
+ * the thread unregistering the buffer, the only consumer. The buffers of all the threads are linked in a list
+ * protected by the logger's buffers lock.
+ */
+struct thread_log_buffer
+{
+   static constexpr size_t RING_SIZE = 64;
+
+   thread_log_buffer();
+   ~thread_log_buffer();
+
+   thread_log_buffer(const thread_log_buffer &) = delete;
+   thread_log_buffer &operator=(const thread_log_buffer &) = delete;
+
+   bool try_push(const char *text, size_t length)
    {
-      int level = WSI_DEFAULT_LOG_LEVEL;
-      log_state()
+      size_t head = m_head.load(std::memory_order_relaxed);
+      if (head - m_tail.load(std::memory_order_acquire) == RING_SIZE)
+      {
+         return false;
+      }
+
+      log_record &record = m_ring[head % RING_SIZE];
+      std::memcpy(record.text, text, length);
+      record.length = length;
+      m_head.store(head + 1, std::memory_order_release);
+      return true;
+   }
+
+   /**
+    * @brief Write the pending messages. Only called with the logger's buffers lock held.
+    *
+    * @return true if any message was written.
+    */
+   bool drain(std::FILE *out)
+   {
+      size_t tail = m_tail.load(std::memory_order_relaxed);
+      size_t head = m_head.load(std::memory_order_acquire);
+      if (tail == head)
+      {
+         return false;
+      }
+
+      for (; tail != head; tail++)
       {
-         if (const char *env = std::getenv("VULKAN_WSI_DEBUG_LEVEL"))
+         const log_record &record = m_ring[tail % RING_SIZE];
+         std::fwrite(record.text, 1, record.length, out);
+      }
+      m_tail.store(tail, std::memory_order_release);
+      return true;
+   }
+
+   std::array<log_record, RING_SIZE> m_ring;
+   alignas(64) std::atomic<size_t> m_head{ 0 };
+   alignas(64) std::atomic<size_t> m_tail{ 0 };
+
+   thread_log_buffer *m_prev{ nullptr };
+   thread_log_buffer *m_next{ nullptr };
+};
+
+/**
+ * @brief Asynchronous logger.
+ *
+ * Messages are formatted by the calling thread and copied into a bounded buffer owned by that thread, so logging
+ * threads never contend with each other. A background thread drains the buffers of all the threads and writes the
+ * messages to stderr or to a file. Formatting can not be deferred to the background thread, as the arguments
+ * (e.g. strings) are not guaranteed to outlive the call.
+ *
+ * The logger is configured with the following environment variables:
+ * - VULKAN_WSI_DEBUG_LEVEL: highest level of the messages that are logged, see also get_log_levels.
+ * - VULKAN_WSI_LOG_FILE: file the messages are appended to instead of stderr.
+ * - VULKAN_WSI_LOG_SYNC: when set to 1 the messages are written synchronously.
+ * - VULKAN_WSI_LOG_RATE_LIMIT: number of messages per second logged from the same call site. Rate limiting is
+ *   disabled when the variable is not set or set to 0.
+ */
+class logger
+{
+public:
+   logger()
+   {
+      if (const char *env = std::getenv("VULKAN_WSI_LOG_RATE_LIMIT"))
+      {
+         std::from_chars(env, env + std::strlen(env), m_rate_limit);
+      }
+
+      if (const char *env = std::getenv("VULKAN_WSI_LOG_SYNC"))
+      {
+         m_synchronous.store(std::strcmp(env, "1") == 0, std::memory_order_relaxed);
+      }
+
+      m_out = stderr;
+      if (const char *env = std::getenv("VULKAN_WSI_LOG_FILE"))
+      {
+         std::FILE *file = std::fopen(env, "a");
+         if (file != nullptr)
          {
-            std::from_chars(env, env + std::strlen(env), level);
+            m_out = file;
          }
       }
-   };
-   static log_state state;
+   }
 
-   bool result = level <= state.level;
-   if (result)
+   ~logger()
    {
-      switch (level)
       {
-      case 0:
-         /* Reserved for no logging */
-         break;
-      case 1:
-         std::fprintf(stderr, "ERROR");
-         break;
-      case 2:
-         std::fprintf(stderr, "WARNING");
-         break;
-      case 3:
-         std::fprintf(stderr, "INFO");
-         break;
-      default:
-         std::fprintf(stderr, "LEVEL_%d", level);
-         break;
+         std::lock_guard<std::mutex> lock(m_thread_lock);
+         m_thread_run = false;
       }
+      m_thread_cond.notify_all();
+      if (m_thread.joinable())
+      {
+         m_thread.join();
+      }
+
+      /* Messages logged by other static destructors are written directly. */
+      m_synchronous.store(true, std::memory_order_relaxed);
+
+      /* Write anything logged after the thread exited, including the pending summaries. */
+      drain(UINT64_MAX);
+      if (m_out != stderr)
+      {
+         std::lock_guard<std::mutex> lock(m_buffers_lock);
+         std::fclose(m_out);
+         m_out = stderr;
+      }
+   }
+
+   logger(const logger &) = delete;
+   logger &operator=(const logger &) = delete;
+
+   /**
+    * @brief Check whether a message from a call site should be logged, updating the rate limit state.
+    */
+   bool check_rate_limit(log_site &site);
+
+   void log(log_site &site, int level, const char *format, va_list args);
+
+   void add_buffer(thread_log_buffer &buffer);
+   void remove_buffer(thread_log_buffer &buffer);
+
+private:
+   void write(const char *text, size_t length);
+   void write_suppressed(log_site &site);
+   void drain(uint64_t now_ms);
+   void flush_thread();
+   void start_thread();
+
+   uint32_t m_rate_limit{ 0 };
+   std::atomic<bool> m_synchronous{ false };
+   std::FILE *m_out{ nullptr };
+
+   std::atomic<uint64_t> m_dropped{ 0 };
+
+   /* Call sites that suppressed messages, so their summaries are written even if they do not log again. */
+   std::atomic<log_site *> m_suppressing_sites{ nullptr };
+
+   /* Protects the list of thread buffers and serializes the writes to m_out. */
+   std::mutex m_buffers_lock;
+   thread_log_buffer *m_buffers{ nullptr };
+
+   std::once_flag m_thread_started;
+   std::mutex m_thread_lock;
+   std::condition_variable m_thread_cond;
+   bool m_thread_run{ true };
+   std::thread m_thread;
+};
+
+thread_log_buffer::thread_log_buffer()
+{
+   get_logger().add_buffer(*this);
+}
+
+thread_log_buffer::~thread_log_buffer()
+{
+   get_logger().remove_buffer(*this);
+}
+
+void logger::add_buffer(thread_log_buffer &buffer)
+{
+   std::lock_guard<std::mutex> lock(m_buffers_lock);
+   buffer.m_prev = nullptr;
+   buffer.m_next = m_buffers;
+   if (m_buffers != nullptr)
+   {
+      m_buffers->m_prev = &buffer;
    }
-   return result;
+   m_buffers = &buffer;
 }
 
-void wsi_log_message(int level, const char *file, int line, const char *format, ...)
+void logger::remove_buffer(thread_log_buffer &buffer)
 {
-   if (check_and_print_log_level(level))
+   std::lock_guard<std::mutex> lock(m_buffers_lock);
+
+   /* The thread is exiting, write what it logged before the buffer goes away. */
+   if (buffer.drain(m_out))
    {
-      std::fprintf(stderr, "(%s:%d): ", file, line);
-      std::va_list args;
-      va_start(args, format);
-      std::vfprintf(stderr, format, args);
-      va_end(args);
-      std::putc('\n', stderr);
+      std::fflush(m_out);
    }
+
+   if (buffer.m_prev != nullptr)
+   {
+      buffer.m_prev->m_next = buffer.m_next;
+   }
+   else
+   {
+      m_buffers = buffer.m_next;
+   }
+   if (buffer.m_next != nullptr)
+   {
+      buffer.m_next->m_prev = buffer.m_prev;
+   }
+}
+
+bool logger::check_rate_limit(log_site &site)
+{
+   if (m_rate_limit == 0)
+   {
+      return true;
+   }
+
+   uint64_t now_ms = get_monotonic_time_ns() / (NSEC_PER_SEC / 1000);
+   uint64_t window_start = site.window_start_ms.load(std::memory_order_relaxed);
+   if (now_ms - window_start >= 1000 &&
+       site.window_start_ms.compare_exchange_strong(window_start, now_ms, std::memory_order_relaxed))
+   {
+      site.count.store(0, std::memory_order_relaxed);
+      write_suppressed(site);
+   }
+
+   if (site.count.fetch_add(1, std::memory_order_relaxed) < m_rate_limit)
+   {
+      return true;
+   }
+
+   if (site.suppressed.fetch_add(1, std::memory_order_relaxed) == 0 &&
+       !site.listed.exchange(true, std::memory_order_relaxed))
+   {
+      /* Sites have static storage duration and are never removed from the list. */
+      log_site *head = m_suppressing_sites.load(std::memory_order_relaxed);
+      do
+      {
+         site.next = head;
+      } while (!m_suppressing_sites.compare_exchange_weak(head, &site, std::memory_order_release,
+                                                          std::memory_order_relaxed));
+   }
+   return false;
+}
+
+void logger::write_suppressed(log_site &site)
+{
+   uint32_t suppressed = site.suppressed.exchange(0, std::memory_order_relaxed);
+   if (suppressed == 0)
+   {
+      return;
+   }
+
+   char text[128];
+   int length =
+      std::snprintf(text, sizeof(text), "(%s:%d): %u similar messages were suppressed\n", site.file, site.line,
+                    suppressed);
+   if (length > 0)
+   {
+      write(text, std::min(static_cast<size_t>(length), sizeof(text) - 1));
+   }
+}
+
+void logger::log(log_site &site, int level, const char *format, va_list args)
+{
+   thread_local char buffer[log_record::MAX_LENGTH];
+
+   int prefix_length = 0;
+   switch (level)
+   {
+   case 1:
+      prefix_length = std::snprintf(buffer, sizeof(buffer), "ERROR(%s:%d): ", site.file, site.line);
+      break;
+   case 2:
+      prefix_length = std::snprintf(buffer, sizeof(buffer), "WARNING(%s:%d): ", site.file, site.line);
+      break;
+   case 3:
+      prefix_length = std::snprintf(buffer, sizeof(buffer), "INFO(%s:%d): ", site.file, site.line);
+      break;
+   default:
+      prefix_length = std::snprintf(buffer, sizeof(buffer), "LEVEL_%d(%s:%d): ", level, site.file, site.line);
+      break;
+   }
+   if (prefix_length < 0)
+   {
+      return;
+   }
+
+   size_t length = std::min(static_cast<size_t>(prefix_length), sizeof(buffer) - 1);
+   int message_length = std::vsnprintf(buffer + length, sizeof(buffer) - length, format, args);
+   if (message_length > 0)
+   {
+      length = std::min(length + static_cast<size_t>(message_length), sizeof(buffer) - 2);
+   }
+   buffer[length++] = '\n';
+
+   write(buffer, length);
+}
+
+void logger::write(const char *text, size_t length)
+{
+   if (!m_synchronous.load(std::memory_order_relaxed))
+   {
+      std::call_once(m_thread_started, [this]() { start_thread(); });
+   }
+
+   if (m_synchronous.load(std::memory_order_relaxed))
+   {
+      std::lock_guard<std::mutex> lock(m_buffers_lock);
+      std::fwrite(text, 1, length, m_out);
+      std::fflush(m_out);
+      return;
+   }
+
+   /* Allocated on the first message of the thread, so threads that do not log do not pay for a buffer. */
+   thread_local std::unique_ptr<thread_log_buffer> thread_buffer;
+   if (thread_buffer == nullptr)
+   {
+      thread_buffer.reset(new (std::nothrow) thread_log_buffer());
+   }
+   if (thread_buffer == nullptr || !thread_buffer->try_push(text, length))
+   {
+      m_dropped.fetch_add(1, std::memory_order_relaxed);
+   }
+}
+
+void logger::drain(uint64_t now_ms)
+{
+   /* Write the summaries of the call sites whose rate limiting window has ended without them logging again. */
+   for (log_site *site = m_suppressing_sites.load(std::memory_order_acquire); site != nullptr; site = site->next)
+   {
+      uint64_t window_start = site->window_start_ms.load(std::memory_order_relaxed);
+      if (site->suppressed.load(std::memory_order_relaxed) != 0 && now_ms - window_start >= 1000 &&
+          site->window_start_ms.compare_exchange_strong(window_start, now_ms, std::memory_order_relaxed))
+      {
+         site->count.store(0, std::memory_order_relaxed);
+         write_suppressed(*site);
+      }
+   }
+
+   std::lock_guard<std::mutex> lock(m_buffers_lock);
+   bool written = false;
+   for (thread_log_buffer *buffer = m_buffers; buffer != nullptr; buffer = buffer->m_next)
+   {
+      written = buffer->drain(m_out) || written;
+   }
+
+   uint64_t dropped = m_dropped.exchange(0, std::memory_order_relaxed);
+   if (dropped != 0)
+   {
+      std::fprintf(m_out, "WARNING: %llu log messages were dropped\n", static_cast<unsigned long long>(dropped));
+      written = true;
+   }
+
+   if (written)
+   {
+      std::fflush(m_out);
+   }
+}
+
+void logger::flush_thread()
+{
+   constexpr auto FLUSH_INTERVAL = std::chrono::milliseconds(10);
+
+   std::unique_lock<std::mutex> lock(m_thread_lock);
+   while (m_thread_run)
+   {
+      lock.unlock();
+      drain(get_monotonic_time_ns() / (NSEC_PER_SEC / 1000));
+      lock.lock();
+      m_thread_cond.wait_for(lock, FLUSH_INTERVAL);
+   }
+}
+
+void logger::start_thread()
+{
+   try
+   {
+      m_thread = std::thread(&logger::flush_thread, this);
+   }
+   catch (const std::system_error &)
+   {
+      m_synchronous.store(true, std::memory_order_relaxed);
+   }
+}
+
+logger &get_logger()
+{
+   static logger instance;
+   return instance;
+}
+
+} /* namespace */
+
+void wsi_log_message(log_site &site, int level, const char *format, ...)
+{
+   /* Level 0 is reserved for no logging. */
+   logger &log = get_logger();
+   if (level <= 0 || !log.check_rate_limit(site))
+   {
+      return;
+   }
+
+   std::va_list args;
+   va_start(args, format);
+   log.log(site, level, format, args);
+   va_end(args);
 }
 
 #endif
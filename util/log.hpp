@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2021-2023 Arm Limited.
+ * Copyright (c) 2021-2023, 2026 Arm Limited.
  *
  * SPDX-License-Identifier: MIT
  *
@@ -23,10 +23,100 @@
  */
 
 #pragma once
+
+#include <atomic>
+#include <cstdint>
+
 namespace util
 {
 #define WSI_DEFAULT_LOG_LEVEL 1
 
+/**
+ * @brief Highest level of the log messages compiled into the layer.
+ *
+ * Log sites with a higher level compile to nothing, including the evaluation of their arguments. It is set
+ * with the WSI_MAX_LOG_LEVEL CMake option.
+ */
+#ifndef WSI_MAX_COMPILED_LOG_LEVEL
+#define WSI_MAX_COMPILED_LOG_LEVEL 3
+#endif
+
+/**
+ * @brief Subsystems with an independent runtime log level.
+ *
+ * The level of every subsystem defaults to VULKAN_WSI_DEBUG_LEVEL and can be overridden with
+ * VULKAN_WSI_DEBUG_LEVEL_<SUBSYSTEM>, e.g. VULKAN_WSI_DEBUG_LEVEL_X11=3.
+ */
+enum class log_subsystem : uint32_t
+{
+   general,
+   swapchain,
+   sync,
+   headless,
+   x11,
+   wayland,
+   display,
+   count,
+};
+
+/**
+ * @brief Number of bits used to store the level of a subsystem in the runtime log levels.
+ */
+static constexpr uint32_t LOG_LEVEL_BITS = 4;
+static constexpr uint32_t LOG_LEVEL_MASK = (1u << LOG_LEVEL_BITS) - 1;
+static_assert(static_cast<uint32_t>(log_subsystem::count) * LOG_LEVEL_BITS <= 32,
+              "The levels of all the subsystems must fit in 32 bits");
+
+/**
+ * @brief Get the runtime log levels of all the subsystems, LOG_LEVEL_BITS bits per subsystem.
+ *
+ * The levels are read from the environment the first time this is called.
+ */
+uint32_t get_log_levels();
+
+/**
+ * @brief Check if messages of a certain level are enabled for a subsystem.
+ *
+ * @param subsystem The subsystem logging the message.
+ * @param level     The log level of the message.
+ */
+inline bool is_log_level_enabled(log_subsystem subsystem, int level)
+{
+   uint32_t levels = get_log_levels();
+   int subsystem_level =
+      static_cast<int>((levels >> (static_cast<uint32_t>(subsystem) * LOG_LEVEL_BITS)) & LOG_LEVEL_MASK);
+   return level <= subsystem_level;
+}
+
+/**
+ * @brief State of a log call site.
+ *
+ * Every WSI_LOG call site has its own instance with static storage duration, used to rate limit the messages of
+ * the call site independently of the others.
+ */
+struct log_site
+{
+   constexpr log_site(const char *site_file, int site_line)
+      : file{ site_file }
+      , line{ site_line }
+   {
+   }
+
+   log_site(const log_site &) = delete;
+   log_site &operator=(const log_site &) = delete;
+
+   /* The source file name (``__FILE__``) and line number (``__LINE__``) of the call site. */
+   const char *file;
+   int line;
+
+   /* Rate limiting state, see log.cpp. */
+   std::atomic<uint64_t> window_start_ms{ 0 };
+   std::atomic<uint32_t> count{ 0 };
+   std::atomic<uint32_t> suppressed{ 0 };
+   std::atomic<bool> listed{ false };
+   log_site *next{ nullptr };
+};
+
 /**
  * @brief Log a message to a certain log level
  *
@@ -37,17 +127,24 @@ namespace util
  * is set to 2, messages with log level 1 and 2 are printed. Please note that
  * the newline character '\n' is automatically appended.
  *
+ * Messages are formatted by the calling thread and written asynchronously by a
+ * background thread, so logging does not block on the output. Repeated messages
+ * from the same call site can be rate limited. See log.cpp for the environment
+ * variables that configure the output.
+ *
+ * The level is not checked by this function, the WSI_LOG macros check it before
+ * evaluating the arguments.
+ *
+ * @param[in] site      The state of the call site logging the message.
  * @param[in] level     The log level of this message, you can set an arbitary
  *                      integer however please refer to the included macros for
  *                      the sensible defaults.
- * @param[in] file      The source file name (``__FILE__``)
- * @param[in] line      The source file line number (``__LINE__``)
  * @param[in] format    A C-style formatting string.
  */
 
-void wsi_log_message(int level, const char *file, int line, const char *format, ...)
+void wsi_log_message(log_site &site, int level, const char *format, ...)
 #ifdef __GNUC__
-   __attribute__((format(printf, 4, 5)))
+   __attribute__((format(printf, 3, 4)))
 #endif
    ;
 
@@ -57,15 +154,48 @@ static constexpr bool wsi_log_enable = false;
 static constexpr bool wsi_log_enable = true;
 #endif
 
-#define WSI_LOG(level, ...)                                               \
-   do                                                                     \
-   {                                                                      \
-      if (::util::wsi_log_enable)                                         \
-         ::util::wsi_log_message(level, __FILE__, __LINE__, __VA_ARGS__); \
+/**
+ * @brief Subsystem of the log messages of a translation unit.
+ *
+ * Defined by the build system for the translation units that belong to a subsystem.
+ *
+ * @note Inline functions and templates defined in headers are compiled in translation units of different
+ *       subsystems, so they must not use WSI_LOG or the macros built on it: their definitions would differ
+ *       between translation units. They log with the macros naming a fixed subsystem instead, such as
+ *       WSI_LOG_SWAPCHAIN_WARNING for the swapchain and present paths or WSI_LOG_GENERAL_WARNING otherwise.
+ */
+#ifndef WSI_LOG_SUBSYSTEM
+#define WSI_LOG_SUBSYSTEM general
+#endif
+
+#define WSI_LOG_SUBSYSTEM_MESSAGE(subsystem, level, ...)                             \
+   do                                                                                \
+   {                                                                                 \
+      if constexpr (::util::wsi_log_enable && (level) <= WSI_MAX_COMPILED_LOG_LEVEL) \
+      {                                                                              \
+         if (::util::is_log_level_enabled(::util::log_subsystem::subsystem, level))  \
+         {                                                                           \
+            static ::util::log_site wsi_log_site{ __FILE__, __LINE__ };              \
+            ::util::wsi_log_message(wsi_log_site, level, __VA_ARGS__);               \
+         }                                                                           \
+      }                                                                              \
    } while (0)
 
+/* Extra level of indirection so that WSI_LOG_SUBSYSTEM is expanded before it is used. */
+#define WSI_LOG_SUBSYSTEM_MESSAGE_EXPAND(subsystem, level, ...) WSI_LOG_SUBSYSTEM_MESSAGE(subsystem, level, __VA_ARGS__)
+
+#define WSI_LOG(level, ...) WSI_LOG_SUBSYSTEM_MESSAGE_EXPAND(WSI_LOG_SUBSYSTEM, level, __VA_ARGS__)
+
 #define WSI_LOG_ERROR(...) WSI_LOG(1, __VA_ARGS__)
 #define WSI_LOG_WARNING(...) WSI_LOG(2, __VA_ARGS__)
 #define WSI_LOG_INFO(...) WSI_LOG(3, __VA_ARGS__)
 
+#define WSI_LOG_GENERAL_ERROR(...) WSI_LOG_SUBSYSTEM_MESSAGE(general, 1, __VA_ARGS__)
+#define WSI_LOG_GENERAL_WARNING(...) WSI_LOG_SUBSYSTEM_MESSAGE(general, 2, __VA_ARGS__)
+#define WSI_LOG_GENERAL_INFO(...) WSI_LOG_SUBSYSTEM_MESSAGE(general, 3, __VA_ARGS__)
+
+#define WSI_LOG_SWAPCHAIN_ERROR(...) WSI_LOG_SUBSYSTEM_MESSAGE(swapchain, 1, __VA_ARGS__)
+#define WSI_LOG_SWAPCHAIN_WARNING(...) WSI_LOG_SUBSYSTEM_MESSAGE(swapchain, 2, __VA_ARGS__)
+#define WSI_LOG_SWAPCHAIN_INFO(...) WSI_LOG_SUBSYSTEM_MESSAGE(swapchain, 3, __VA_ARGS__)
+
 } /* namespace util */
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file memory_accounting.cpp
+ *
+ * @brief Contains the implementation of the accounting of the memory allocated by the layer.
+ */
+
+#include "memory_accounting.hpp"
+#include "log.hpp"
+
+#include <array>
+#include <cassert>
+#include <cinttypes>
+
+namespace util
+{
+namespace memory_accounting
+{
+
+namespace
+{
+
+memory_counter g_host_total;
+std::array<memory_counter, NUM_SCOPES> g_host_scopes;
+std::array<memory_counter, static_cast<size_t>(memory_subsystem::count)> g_host_subsystems;
+std::array<memory_counter, static_cast<size_t>(device_memory_kind::count)> g_device_memory;
+
+const char *const SCOPE_NAMES[NUM_SCOPES] = { "command", "object", "cache", "device", "instance" };
+const char *const SUBSYSTEM_NAMES[] = { "general", "instance", "device", "surface", "swapchain" };
+const char *const DEVICE_MEMORY_NAMES[] = { "device_memory", "dma_buf", "hardware_buffer" };
+
+static_assert(sizeof(SUBSYSTEM_NAMES) / sizeof(SUBSYSTEM_NAMES[0]) == static_cast<size_t>(memory_subsystem::count),
+              "Missing subsystem name");
+static_assert(sizeof(DEVICE_MEMORY_NAMES) / sizeof(DEVICE_MEMORY_NAMES[0]) ==
+                 static_cast<size_t>(device_memory_kind::count),
+              "Missing device memory kind name");
+
+void print_counter(std::FILE *out, const char *name, const memory_counter &counter)
+{
+   std::fprintf(out, " %s=%" PRIu64 "/%" PRIu64, name, counter.current.load(std::memory_order_relaxed),
+                counter.peak.load(std::memory_order_relaxed));
+}
+
+} /* namespace */
+
+void record_host_allocation(VkSystemAllocationScope scope, memory_subsystem subsystem, size_t size)
+{
+   assert(static_cast<size_t>(scope) < NUM_SCOPES);
+   g_host_total.add(size);
+   g_host_scopes[scope].add(size);
+   g_host_subsystems[static_cast<size_t>(subsystem)].add(size);
+}
+
+void record_host_free(VkSystemAllocationScope scope, memory_subsystem subsystem, size_t size)
+{
+   assert(static_cast<size_t>(scope) < NUM_SCOPES);
+   g_host_total.subtract(size);
+   g_host_scopes[scope].subtract(size);
+   g_host_subsystems[static_cast<size_t>(subsystem)].subtract(size);
+}
+
+void record_device_allocation(device_memory_kind kind, uint64_t size)
+{
+   g_device_memory[static_cast<size_t>(kind)].add(size);
+}
+
+void record_device_free(device_memory_kind kind, uint64_t size)
+{
+   g_device_memory[static_cast<size_t>(kind)].subtract(size);
+}
+
+const memory_counter &get_host_total()
+{
+   return g_host_total;
+}
+
+const memory_counter &get_host_scope(VkSystemAllocationScope scope)
+{
+   assert(static_cast<size_t>(scope) < NUM_SCOPES);
+   return g_host_scopes[scope];
+}
+
+const memory_counter &get_host_subsystem(memory_subsystem subsystem)
+{
+   return g_host_subsystems[static_cast<size_t>(subsystem)];
+}
+
+const memory_counter &get_device_memory(device_memory_kind kind)
+{
+   return g_device_memory[static_cast<size_t>(kind)];
+}
+
+void report(std::FILE *out)
+{
+   std::fprintf(out, "  layer host memory (current/peak bytes):");
+   print_counter(out, "total", g_host_total);
+   std::fprintf(out, "\n   ");
+   for (size_t i = 0; i < NUM_SCOPES; i++)
+   {
+      print_counter(out, SCOPE_NAMES[i], g_host_scopes[i]);
+   }
+   std::fprintf(out, "\n   ");
+   for (size_t i = 0; i < g_host_subsystems.size(); i++)
+   {
+      print_counter(out, SUBSYSTEM_NAMES[i], g_host_subsystems[i]);
+   }
+   std::fprintf(out, "\n  swapchain image memory (current/peak bytes):");
+   for (size_t i = 0; i < g_device_memory.size(); i++)
+   {
+      print_counter(out, DEVICE_MEMORY_NAMES[i], g_device_memory[i]);
+   }
+   std::fprintf(out, "\n");
+}
+
+void log_summary()
+{
+   auto &device_memory = get_device_memory(device_memory_kind::device_memory);
+   auto &dma_buf = get_device_memory(device_memory_kind::dma_buf);
+   auto &hardware_buffer = get_device_memory(device_memory_kind::hardware_buffer);
+   WSI_LOG_INFO("Layer host memory: %" PRIu64 " bytes (peak %" PRIu64 "). Swapchain image memory: device_memory=%" PRIu64
+                " (peak %" PRIu64 ") dma_buf=%" PRIu64 " (peak %" PRIu64 ") hardware_buffer=%" PRIu64
+                " (peak %" PRIu64 ")",
+                g_host_total.current.load(std::memory_order_relaxed), g_host_total.peak.load(std::memory_order_relaxed),
+                device_memory.current.load(std::memory_order_relaxed),
+                device_memory.peak.load(std::memory_order_relaxed), dma_buf.current.load(std::memory_order_relaxed),
+                dma_buf.peak.load(std::memory_order_relaxed), hardware_buffer.current.load(std::memory_order_relaxed),
+                hardware_buffer.peak.load(std::memory_order_relaxed));
+}
+
+} /* namespace memory_accounting */
+} /* namespace util */
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file memory_accounting.hpp
+ *
+ * @brief Contains the accounting of the host and device memory allocated by the layer.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+
+#include <vulkan/vulkan.h>
+
+namespace util
+{
+
+/**
+ * @brief Parts of the layer host memory allocations are accounted to.
+ *
+ * Allocators inherit the subsystem of the allocator they are derived from.
+ */
+enum class memory_subsystem : uint8_t
+{
+   general,
+   instance,
+   device,
+   surface,
+   swapchain,
+   count,
+};
+
+/**
+ * @brief Kinds of device memory backing the swapchain images.
+ */
+enum class device_memory_kind : uint8_t
+{
+   /* Memory allocated by the layer with vkAllocateMemory. */
+   device_memory,
+   /* dma-buf allocated with wsialloc and imported in Vulkan. */
+   dma_buf,
+   /* Memory exported as an Android hardware buffer. */
+   hardware_buffer,
+   count,
+};
+
+/**
+ * @brief Amount of memory currently allocated and its high-water mark.
+ */
+struct memory_counter
+{
+   void add(uint64_t size)
+   {
+      uint64_t value = current.fetch_add(size, std::memory_order_relaxed) + size;
+      uint64_t current_peak = peak.load(std::memory_order_relaxed);
+      while (value > current_peak &&
+             !peak.compare_exchange_weak(current_peak, value, std::memory_order_relaxed))
+      {
+      }
+   }
+
+   void subtract(uint64_t size)
+   {
+      current.fetch_sub(size, std::memory_order_relaxed);
+   }
+
+   std::atomic<uint64_t> current{ 0 };
+   std::atomic<uint64_t> peak{ 0 };
+};
+
+namespace memory_accounting
+{
+
+/**
+ * @brief Number of VkSystemAllocationScope values.
+ */
+static constexpr size_t NUM_SCOPES = VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1;
+
+/**
+ * @brief Record a host allocation made through util::allocator.
+ *
+ * @param scope     The scope of the allocator.
+ * @param subsystem The subsystem of the allocator.
+ * @param size      Size of the allocation in bytes.
+ */
+void record_host_allocation(VkSystemAllocationScope scope, memory_subsystem subsystem, size_t size);
+
+/**
+ * @brief Record the release of a host allocation recorded with record_host_allocation().
+ *
+ * Must be called with the same parameters as the allocation.
+ */
+void record_host_free(VkSystemAllocationScope scope, memory_subsystem subsystem, size_t size);
+
+/**
+ * @brief Record device memory backing a swapchain image.
+ *
+ * @param kind The kind of memory.
+ * @param size Size of the memory in bytes.
+ */
+void record_device_allocation(device_memory_kind kind, uint64_t size);
+
+/**
+ * @brief Record the release of device memory recorded with record_device_allocation().
+ */
+void record_device_free(device_memory_kind kind, uint64_t size);
+
+/**
+ * @brief Get the counter of all the host memory allocated by the layer.
+ */
+const memory_counter &get_host_total();
+
+/**
+ * @brief Get the counter of the host memory allocated by the layer with a given scope.
+ */
+const memory_counter &get_host_scope(VkSystemAllocationScope scope);
+
+/**
+ * @brief Get the counter of the host memory allocated by a subsystem of the layer.
+ */
+const memory_counter &get_host_subsystem(memory_subsystem subsystem);
+
+/**
+ * @brief Get the counter of the device memory of a given kind backing the swapchain images.
+ */
+const memory_counter &get_device_memory(device_memory_kind kind);
+
+/**
+ * @brief Print the current and peak memory usage of the layer.
+ *
+ * @param out The file to print to.
+ */
+void report(std::FILE *out);
+
+/**
+ * @brief Log the current and peak memory usage of the layer at info level.
+ */
+void log_summary();
+
+} /* namespace memory_accounting */
+
+} /* namespace util */
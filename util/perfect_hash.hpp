@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file perfect_hash.hpp
+ *
+ * @brief Contains the definition of a perfect hash over a set of strings known at compile time.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace util
+{
+
+/**
+ * @brief Perfect hash over a fixed set of strings, built at compile time.
+ *
+ * The constructor searches for a seed for which the seeded FNV-1a hashes of all the
+ * keys fall in different slots of a table with at least four slots per key. A lookup
+ * then costs one hash of the name and a single string comparison. The keys must
+ * outlive the object, which is meant to be a constexpr variable built from a constexpr
+ * array of string literals. Check valid() in a static_assert, as construction does not
+ * fail if no seed is found.
+ *
+ * @tparam N Number of keys.
+ */
+template <size_t N>
+class perfect_hash
+{
+public:
+   /**
+    * @brief Value returned by find() for the names that are not keys.
+    */
+   static constexpr size_t NOT_FOUND = N;
+
+   /**
+    * @brief Build the perfect hash.
+    *
+    * @param keys The keys. They must be unique.
+    */
+   constexpr perfect_hash(const char *const (&keys)[N])
+      : m_keys(keys)
+   {
+      for (uint32_t seed = 1; seed <= MAX_SEED; seed++)
+      {
+         if (try_seed(seed))
+         {
+            m_seed = seed;
+            return;
+         }
+      }
+   }
+
+   /**
+    * @brief Check whether a seed was found for the keys.
+    */
+   constexpr bool valid() const
+   {
+      return m_seed != 0;
+   }
+
+   /**
+    * @brief Find the index of a key.
+    *
+    * @param name The name to look up.
+    *
+    * @return The index of @p name in the keys or NOT_FOUND.
+    */
+   size_t find(const char *name) const
+   {
+      size_t index = m_slots[get_slot(name, m_seed)];
+      if (index == NOT_FOUND || strcmp(m_keys[index], name) != 0)
+      {
+         return NOT_FOUND;
+      }
+      return index;
+   }
+
+private:
+   static constexpr size_t get_table_size()
+   {
+      size_t size = 1;
+      while (size < 4 * N)
+      {
+         size *= 2;
+      }
+      return size;
+   }
+
+   static constexpr size_t TABLE_SIZE = get_table_size();
+   static constexpr uint32_t MAX_SEED = 4096;
+
+   static constexpr size_t get_slot(const char *name, uint32_t seed)
+   {
+      /* 64-bit FNV-1a with the seed mixed into the offset basis. */
+      uint64_t hash = 0xcbf29ce484222325 ^ (static_cast<uint64_t>(seed) * 0x9e3779b97f4a7c15);
+      for (const char *c = name; *c != '\0'; c++)
+      {
+         hash = (hash ^ static_cast<unsigned char>(*c)) * 0x100000001b3;
+      }
+      return static_cast<size_t>(hash ^ (hash >> 32)) & (TABLE_SIZE - 1);
+   }
+
+   constexpr bool try_seed(uint32_t seed)
+   {
+      for (size_t i = 0; i < TABLE_SIZE; i++)
+      {
+         m_slots[i] = NOT_FOUND;
+      }
+      for (size_t i = 0; i < N; i++)
+      {
+         size_t slot = get_slot(m_keys[i], seed);
+         if (m_slots[slot] != NOT_FOUND)
+         {
+            return false;
+         }
+         m_slots[slot] = i;
+      }
+      return true;
+   }
+
+   const char *const *m_keys;
+   uint32_t m_seed{ 0 };
+   std::array<size_t, TABLE_SIZE> m_slots{};
+};
+
+} /* namespace util */
@@ -0,0 +1,289 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file small_vector.hpp
+ *
+ * @brief Contains the definition of a vector with inline storage for a few elements.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "custom_allocator.hpp"
+#include "helpers.hpp"
+
+namespace util
+{
+
+/**
+ * @brief Vector storing up to @p N elements inside the object.
+ *
+ * Has the same non-throwing try_... interface as util::vector. The elements only move to memory
+ * allocated with the custom allocator when the vector grows beyond @p N elements, so small
+ * vectors of metadata live next to the object that owns them and cost no allocation.
+ *
+ * @tparam T The type of the elements.
+ * @tparam N The number of elements stored inline.
+ */
+template <typename T, size_t N>
+class small_vector : private noncopyable
+{
+public:
+   using value_type = T;
+   using size_type = size_t;
+   using iterator = T *;
+   using const_iterator = const T *;
+
+   /**
+    * @brief Construct an empty vector.
+    *
+    * @param allocator The allocator used if the vector grows beyond its inline storage.
+    */
+   explicit small_vector(const util::allocator &allocator)
+      : m_allocator(allocator)
+   {
+   }
+
+   ~small_vector()
+   {
+      clear();
+      release(m_data, m_capacity);
+   }
+
+   T *data()
+   {
+      return m_data;
+   }
+
+   const T *data() const
+   {
+      return m_data;
+   }
+
+   iterator begin()
+   {
+      return m_data;
+   }
+
+   iterator end()
+   {
+      return m_data + m_size;
+   }
+
+   const_iterator begin() const
+   {
+      return m_data;
+   }
+
+   const_iterator end() const
+   {
+      return m_data + m_size;
+   }
+
+   size_type size() const
+   {
+      return m_size;
+   }
+
+   size_type capacity() const
+   {
+      return m_capacity;
+   }
+
+   bool empty() const
+   {
+      return m_size == 0;
+   }
+
+   T &operator[](size_type index)
+   {
+      return m_data[index];
+   }
+
+   const T &operator[](size_type index) const
+   {
+      return m_data[index];
+   }
+
+   T &front()
+   {
+      return m_data[0];
+   }
+
+   T &back()
+   {
+      return m_data[m_size - 1];
+   }
+
+   /**
+    * @brief Construct an element at the end of the vector.
+    * @return @c false iff the operation could not be performed due to an allocation failure.
+    */
+   template <typename... arg_types>
+   bool try_push_back(arg_types &&...args) noexcept
+   {
+      if (m_size == m_capacity && !try_reserve(m_capacity * 2))
+      {
+         return false;
+      }
+      new (&m_data[m_size]) T(std::forward<arg_types>(args)...);
+      m_size++;
+      return true;
+   }
+
+   /**
+    * @brief Push back multiple elements at once.
+    * @return @c false iff the operation could not be performed due to an allocation failure.
+    */
+   bool try_push_back_many(const T *begin, const T *end) noexcept
+   {
+      for (const T *it = begin; it != end; ++it)
+      {
+         if (!try_push_back(*it))
+         {
+            return false;
+         }
+      }
+      return true;
+   }
+
+   /**
+    * @brief Like std::vector::resize, but non throwing.
+    *
+    * @param size The new size of the vector.
+    * @param args Arguments the new elements are constructed with, value initialized if empty.
+    * @return @c false iff the operation could not be performed due to an allocation failure.
+    */
+   template <typename... arg_types>
+   bool try_resize(size_type size, const arg_types &...args) noexcept
+   {
+      if (!try_reserve(size))
+      {
+         return false;
+      }
+      while (m_size > size)
+      {
+         pop_back();
+      }
+      while (m_size < size)
+      {
+         new (&m_data[m_size]) T(args...);
+         m_size++;
+      }
+      return true;
+   }
+
+   /**
+    * @brief Like std::vector::reserve but doesn't throw on out of memory errors.
+    *
+    * @param size The new capacity of the vector.
+    * @return true if successful, false if the host has run out of memory.
+    */
+   bool try_reserve(size_type size) noexcept
+   {
+      if (size <= m_capacity)
+      {
+         return true;
+      }
+
+      T *new_data;
+      try
+      {
+         new_data = custom_allocator<T>(m_allocator).allocate(size);
+      }
+      catch (const std::bad_alloc &)
+      {
+         return false;
+      }
+
+      for (size_type i = 0; i < m_size; i++)
+      {
+         new (&new_data[i]) T(std::move(m_data[i]));
+         m_data[i].~T();
+      }
+      release(m_data, m_capacity);
+      m_data = new_data;
+      m_capacity = size;
+      return true;
+   }
+
+   void pop_back()
+   {
+      m_size--;
+      m_data[m_size].~T();
+   }
+
+   /**
+    * @brief Erase an element, moving the following elements down.
+    *
+    * @return Iterator to the element following the erased one.
+    */
+   iterator erase(const_iterator position)
+   {
+      auto index = static_cast<size_type>(position - m_data);
+      for (size_type i = index; i + 1 < m_size; i++)
+      {
+         m_data[i] = std::move(m_data[i + 1]);
+      }
+      pop_back();
+      return m_data + index;
+   }
+
+   void clear()
+   {
+      while (m_size > 0)
+      {
+         pop_back();
+      }
+   }
+
+private:
+   static_assert(N > 0, "small_vector needs inline storage");
+
+   T *get_inline_data()
+   {
+      return reinterpret_cast<T *>(m_inline);
+   }
+
+   void release(T *data, size_type capacity)
+   {
+      if (data != get_inline_data())
+      {
+         custom_allocator<T>(m_allocator).deallocate(data, capacity);
+      }
+   }
+
+   util::allocator m_allocator;
+   std::aligned_storage_t<sizeof(T), alignof(T)> m_inline[N];
+   T *m_data{ get_inline_data() };
+   size_type m_size{ 0 };
+   size_type m_capacity{ N };
+};
+
+} /* namespace util */
@@ -97,7 +97,11 @@ VkResult timed_semaphore::wait(uint64_t timeout)
    res = pthread_mutex_lock(&m_mutex);
    assert(res == 0); /* only fails with programming error (EINVAL) */
 
-   if (m_count == 0)
+   if (m_count == 0 && m_interrupted)
+   {
+      retval = VK_NOT_READY;
+   }
+   else if (m_count == 0)
    {
       switch (timeout)
       {
@@ -108,6 +112,11 @@ VkResult timed_semaphore::wait(uint64_t timeout)
          res = pthread_cond_wait(&m_cond, &m_mutex);
          assert(res == 0); /* only fails with programming error (EINVAL) */
 
+         if (m_count == 0)
+         {
+            assert(m_interrupted);
+            retval = VK_NOT_READY;
+         }
          break;
       default:
          struct timespec diff = { /* narrowing casts */
@@ -135,6 +144,11 @@ VkResult timed_semaphore::wait(uint64_t timeout)
          {
             retval = VK_TIMEOUT;
          }
+         else if (m_count == 0)
+         {
+            assert(m_interrupted);
+            retval = VK_NOT_READY;
+         }
       }
    }
    if (retval == VK_SUCCESS)
@@ -167,4 +181,23 @@ void timed_semaphore::post()
    assert(res == 0); /* only fails with programming error (EPERM) */
 }
 
+void timed_semaphore::interrupt()
+{
+   int res;
+   (void)res; /* unused when NDEBUG */
+
+   assert(initialized);
+
+   res = pthread_mutex_lock(&m_mutex);
+   assert(res == 0); /* only fails with programming error (EINVAL) */
+
+   m_interrupted = true;
+
+   res = pthread_cond_broadcast(&m_cond);
+   assert(res == 0); /* only fails with programming error (EINVAL) */
+
+   res = pthread_mutex_unlock(&m_mutex);
+   assert(res == 0); /* only fails with programming error (EPERM) */
+}
+
 } /* namespace util */
@@ -66,7 +66,8 @@ class timed_semaphore : private noncopyable
 public:
    ~timed_semaphore();
    timed_semaphore()
-      : initialized(false){};
+      : initialized(false)
+      , m_interrupted(false){};
 
    /**
     * @brief initializes the semaphore
@@ -82,7 +83,7 @@ public:
     *
     * @param timeout time to wait (ns). 0 doesn't block, UINT64_MAX waits indefinately.
     * @retval VK_TIMEOUT timeout was non-zero and reached the timeout
-    * @retval VK_NOT_READY timeout was zero and count is 0
+    * @retval VK_NOT_READY timeout was zero and count is 0, or the semaphore was interrupted and count is 0
     * @retval VK_SUCCESS on success
     */
    VkResult wait(uint64_t timeout);
@@ -92,6 +93,13 @@ public:
     */
    void post();
 
+   /**
+    * @brief unblock all the waiting threads without incrementing the semaphore
+    *
+    * Once interrupted, waits no longer block when count is 0, they return VK_NOT_READY instead.
+    */
+   void interrupt();
+
 private:
    /**
     * @brief true if the semaphore has been initialized
@@ -103,6 +111,10 @@ private:
     * @brief semaphore value
     */
    unsigned m_count;
+   /**
+    * @brief true once interrupt has been called
+    */
+   bool m_interrupted;
 
    pthread_mutex_t m_mutex;
    pthread_cond_t m_cond;
@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file trace.cpp
+ *
+ * @brief Contains the implementation of the tracing subsystem.
+ */
+
+#include "trace.hpp"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "clock.hpp"
+#include "custom_allocator.hpp"
+#include "log.hpp"
+
+namespace util
+{
+namespace trace
+{
+
+std::atomic<bool> g_enabled{ false };
+
+namespace
+{
+
+struct event
+{
+   const char *name;
+   uint64_t timestamp_ns;
+   uint64_t id;
+   phase event_phase;
+};
+
+/**
+ * @brief Fixed size block of events written by a single thread.
+ *
+ * Only the owning thread writes to a chunk. The number of valid events is published with a
+ * release store after the event is written, so a concurrent flush reads only complete events.
+ */
+struct chunk
+{
+   static constexpr size_t CAPACITY = 4096;
+
+   std::atomic<size_t> count{ 0 };
+   std::atomic<chunk *> next{ nullptr };
+   event events[CAPACITY];
+};
+
+/**
+ * @brief Event buffer of a thread.
+ *
+ * Buffers are never freed while the layer is loaded, so the events of threads that have
+ * exited are still written to the trace file.
+ */
+struct thread_buffer
+{
+   /**
+    * @brief Upper limit of the number of chunks per thread, once reached new events are dropped.
+    */
+   static constexpr size_t MAX_CHUNKS = 256;
+
+   long tid{ 0 };
+   chunk *first{ nullptr };
+   chunk *current{ nullptr };
+   size_t num_chunks{ 0 };
+   uint64_t dropped_events{ 0 };
+   thread_buffer *next{ nullptr };
+};
+
+/**
+ * @brief Head of the list of all thread buffers, new buffers are pushed at the front.
+ */
+std::atomic<thread_buffer *> g_thread_buffers{ nullptr };
+
+/**
+ * @brief Serializes the writes to the trace file.
+ */
+std::mutex g_flush_lock;
+
+const char *g_trace_file = nullptr;
+
+chunk *allocate_chunk()
+{
+   return allocator::get_generic().create<chunk>(1);
+}
+
+thread_buffer *create_thread_buffer()
+{
+   thread_buffer *buffer = allocator::get_generic().create<thread_buffer>(1);
+   if (buffer == nullptr)
+   {
+      return nullptr;
+   }
+
+   buffer->tid = syscall(SYS_gettid);
+   buffer->first = allocate_chunk();
+   if (buffer->first == nullptr)
+   {
+      allocator::get_generic().destroy(1, buffer);
+      return nullptr;
+   }
+   buffer->current = buffer->first;
+   buffer->num_chunks = 1;
+
+   thread_buffer *head = g_thread_buffers.load(std::memory_order_relaxed);
+   do
+   {
+      buffer->next = head;
+   } while (!g_thread_buffers.compare_exchange_weak(head, buffer, std::memory_order_release,
+                                                    std::memory_order_relaxed));
+   return buffer;
+}
+
+thread_buffer *get_thread_buffer()
+{
+   thread_local thread_buffer *buffer = create_thread_buffer();
+   return buffer;
+}
+
+void write_events(std::FILE *out)
+{
+   const long pid = static_cast<long>(getpid());
+   bool first_event = true;
+
+   std::fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+   for (thread_buffer *buffer = g_thread_buffers.load(std::memory_order_acquire); buffer != nullptr;
+        buffer = buffer->next)
+   {
+      for (chunk *c = buffer->first; c != nullptr; c = c->next.load(std::memory_order_acquire))
+      {
+         size_t count = c->count.load(std::memory_order_acquire);
+         for (size_t i = 0; i < count; i++)
+         {
+            const event &ev = c->events[i];
+            std::fprintf(out, "%s{\"name\":\"%s\",\"cat\":\"wsi\",\"ph\":\"%c\",\"ts\":%" PRIu64 ".%03" PRIu64
+                              ",\"pid\":%ld,\"tid\":%ld",
+                         first_event ? "" : ",\n", ev.name, static_cast<char>(ev.event_phase),
+                         ev.timestamp_ns / NSEC_PER_USEC, ev.timestamp_ns % NSEC_PER_USEC, pid, buffer->tid);
+            switch (ev.event_phase)
+            {
+            case phase::instant:
+               std::fprintf(out, ",\"s\":\"t\"");
+               break;
+            case phase::flow_begin:
+            case phase::flow_step:
+               std::fprintf(out, ",\"id\":\"0x%" PRIx64 "\"", ev.id);
+               break;
+            case phase::flow_end:
+               /* Bind the end of the flow to the enclosing slice. */
+               std::fprintf(out, ",\"id\":\"0x%" PRIx64 "\",\"bp\":\"e\"", ev.id);
+               break;
+            default:
+               break;
+            }
+            std::fprintf(out, "}");
+            first_event = false;
+         }
+      }
+
+      if (buffer->dropped_events != 0)
+      {
+         WSI_LOG_WARNING("Trace buffer of thread %ld overflowed, %" PRIu64 " events were dropped.", buffer->tid,
+                         buffer->dropped_events);
+      }
+   }
+   std::fprintf(out, "\n]}\n");
+}
+
+/**
+ * @brief Reads the configuration when the layer is loaded and writes the trace when it is unloaded.
+ */
+struct tracer
+{
+   tracer()
+   {
+      g_trace_file = std::getenv("VULKAN_WSI_TRACE_FILE");
+      g_enabled.store(g_trace_file != nullptr, std::memory_order_relaxed);
+   }
+
+   ~tracer()
+   {
+      if (!is_enabled())
+      {
+         return;
+      }
+
+      flush();
+      g_enabled.store(false, std::memory_order_relaxed);
+   }
+};
+
+tracer g_tracer;
+
+} /* namespace */
+
+void record(phase event_phase, const char *name, uint64_t id)
+{
+   thread_buffer *buffer = get_thread_buffer();
+   if (buffer == nullptr)
+   {
+      return;
+   }
+
+   chunk *current = buffer->current;
+   size_t index = current->count.load(std::memory_order_relaxed);
+   if (index == chunk::CAPACITY)
+   {
+      chunk *new_chunk = nullptr;
+      if (buffer->num_chunks < thread_buffer::MAX_CHUNKS)
+      {
+         new_chunk = allocate_chunk();
+      }
+      if (new_chunk == nullptr)
+      {
+         buffer->dropped_events++;
+         return;
+      }
+
+      current->next.store(new_chunk, std::memory_order_release);
+      buffer->current = new_chunk;
+      buffer->num_chunks++;
+      current = new_chunk;
+      index = 0;
+   }
+
+   current->events[index] = event{ name, get_monotonic_time_ns(), id, event_phase };
+   current->count.store(index + 1, std::memory_order_release);
+}
+
+void flush()
+{
+   if (!is_enabled())
+   {
+      return;
+   }
+
+   std::lock_guard<std::mutex> lock(g_flush_lock);
+   std::FILE *out = std::fopen(g_trace_file, "w");
+   if (out == nullptr)
+   {
+      WSI_LOG_ERROR("Failed to open trace file %s.", g_trace_file);
+      return;
+   }
+
+   write_events(out);
+   std::fclose(out);
+}
+
+} /* namespace trace */
+} /* namespace util */
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file trace.hpp
+ *
+ * @brief Contains the tracing subsystem used to record the timeline of the present pipeline.
+ *
+ * Tracing is disabled by default. It is enabled by setting the VULKAN_WSI_TRACE_FILE environment
+ * variable to the path of the output file. The events are recorded to per thread buffers that are
+ * written without locks and they are serialized in the Chrome trace event JSON format, which can
+ * be loaded in chrome://tracing or in the Perfetto UI, whenever a device is destroyed and when the
+ * layer is unloaded.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace util
+{
+namespace trace
+{
+
+/**
+ * @brief Type of a trace event, the values match the Chrome trace event phases.
+ */
+enum class phase : char
+{
+   begin = 'B',
+   end = 'E',
+   instant = 'i',
+   flow_begin = 's',
+   flow_step = 't',
+   flow_end = 'f',
+};
+
+/**
+ * @brief Whether tracing is enabled, set once when the layer is loaded.
+ */
+extern std::atomic<bool> g_enabled;
+
+/**
+ * @brief Check if tracing is enabled.
+ */
+inline bool is_enabled()
+{
+   return g_enabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Record an event in the buffer of the calling thread.
+ *
+ * Must only be called if tracing is enabled.
+ *
+ * @param event_phase The phase of the event.
+ * @param name        Name of the event. Must be a string with static storage duration.
+ * @param id          Identifier of the flow the event belongs to, 0 for other events.
+ */
+void record(phase event_phase, const char *name, uint64_t id);
+
+/**
+ * @brief Write all the events recorded so far to the trace file.
+ */
+void flush();
+
+/**
+ * @brief Record a flow event connecting the stages of a present request.
+ *
+ * Flows are keyed by present ID, so presents that do not have a present ID are not connected.
+ *
+ * @param event_phase The phase of the flow event.
+ * @param name        Name of the flow. Must be a string with static storage duration.
+ * @param owner       The swapchain the present request belongs to.
+ * @param present_id  The present ID of the request.
+ */
+inline void flow(phase event_phase, const char *name, const void *owner, uint64_t present_id)
+{
+   if (is_enabled() && present_id != 0)
+   {
+      /* Present IDs are only unique within a swapchain. */
+      uint64_t id = present_id ^ (static_cast<uint64_t>(reinterpret_cast<uintptr_t>(owner)) << 16);
+      record(event_phase, name, id);
+   }
+}
+
+/**
+ * @brief Record an instant event.
+ *
+ * @param name Name of the event. Must be a string with static storage duration.
+ */
+inline void instant(const char *name)
+{
+   if (is_enabled())
+   {
+      record(phase::instant, name, 0);
+   }
+}
+
+/**
+ * @brief Records a begin event when constructed and the matching end event when destroyed.
+ */
+class scope
+{
+public:
+   explicit scope(const char *name)
+      : m_name(is_enabled() ? name : nullptr)
+   {
+      if (m_name != nullptr)
+      {
+         record(phase::begin, m_name, 0);
+      }
+   }
+
+   ~scope()
+   {
+      if (m_name != nullptr)
+      {
+         record(phase::end, m_name, 0);
+      }
+   }
+
+   scope(const scope &) = delete;
+   scope &operator=(const scope &) = delete;
+
+private:
+   const char *m_name;
+};
+
+} /* namespace trace */
+} /* namespace util */
+
+#define WSI_TRACE_CONCAT_IMPL(a, b) a##b
+#define WSI_TRACE_CONCAT(a, b) WSI_TRACE_CONCAT_IMPL(a, b)
+
+/**
+ * @brief Trace the duration of the enclosing scope.
+ */
+#define WSI_TRACE_SCOPE(name) ::util::trace::scope WSI_TRACE_CONCAT(wsi_trace_scope_, __LINE__)(name)
@@ -92,7 +92,8 @@ public:
                              [present_mode](present_mode_compatibility p) { return p.present_mode == present_mode; });
       if (it == m_present_mode_compatibilites.end())
       {
-         WSI_LOG_ERROR("Querying compatible presentation mode support for a presentation mode that is not supported.");
+         WSI_LOG_GENERAL_ERROR(
+            "Querying compatible presentation mode support for a presentation mode that is not supported.");
          return;
       }
       const present_mode_compatibility &surface_supported_compatibility = *it;
@@ -126,7 +127,8 @@ public:
                       [present_mode_a](present_mode_compatibility p) { return p.present_mode == present_mode_a; });
       if (it == m_present_mode_compatibilites.end())
       {
-         WSI_LOG_ERROR("Querying compatible presentation mode support for a presentation mode that is not supported.");
+         WSI_LOG_GENERAL_ERROR(
+            "Querying compatible presentation mode support for a presentation mode that is not supported.");
          return false;
       }
 
@@ -35,9 +35,10 @@ namespace wsi
 namespace display
 {
 
-surface::surface(drm_display_mode *display_mode, VkExtent2D extent)
+surface::surface(drm_display_mode *display_mode, VkExtent2D extent, const util::allocator &allocator)
    : m_display_mode(display_mode)
    , m_extent(extent)
+   , m_surface_properties(nullptr, allocator)
 {
 }
 
@@ -49,7 +50,8 @@ wsi::surface_properties &surface::get_properties()
 util::unique_ptr<swapchain_base> surface::allocate_swapchain(layer::device_private_data &dev_data,
                                                              const VkAllocationCallbacks *allocator)
 {
-   util::allocator alloc{ dev_data.get_allocator(), VK_SYSTEM_ALLOCATION_SCOPE_OBJECT, allocator };
+   util::allocator alloc{ dev_data.get_allocator(), VK_SYSTEM_ALLOCATION_SCOPE_OBJECT, allocator,
+                          util::memory_subsystem::swapchain };
    return util::unique_ptr<swapchain_base>(alloc.make_unique<swapchain>(dev_data, allocator, *this));
 }
 
@@ -45,8 +45,9 @@ public:
     *
     * @param mode The display mode to be used with the surface.
     * @param extent The extent of the surface.
+    * @param allocator The allocator used for the surface properties.
     */
-   surface(drm_display_mode *mode, VkExtent2D extent);
+   surface(drm_display_mode *mode, VkExtent2D extent, const util::allocator &allocator);
 
    wsi::surface_properties &get_properties() override;
    util::unique_ptr<swapchain_base> allocate_swapchain(layer::device_private_data &dev_data,
@@ -44,39 +44,43 @@ void surface_properties::populate_present_mode_compatibilities()
    m_compatible_present_modes = compatible_present_modes<1>(compatible_present_modes_list);
 }
 
-surface_properties::surface_properties(surface *wsi_surface)
+surface_properties::surface_properties(surface *wsi_surface, const util::allocator &allocator)
    : m_specific_surface(wsi_surface)
    , m_supported_modes({ VK_PRESENT_MODE_FIFO_KHR })
+   , m_query_cache(allocator)
 {
    populate_present_mode_compatibilities();
 }
 
 surface_properties::surface_properties()
-   : surface_properties(nullptr)
+   : surface_properties(nullptr, util::allocator::get_generic())
 {
 }
 
 VkResult surface_properties::get_surface_capabilities(VkPhysicalDevice physical_device,
                                                       VkSurfaceCapabilitiesKHR *pSurfaceCapabilities)
 {
-   get_surface_capabilities_common(physical_device, pSurfaceCapabilities);
+   return m_query_cache.get_surface_capabilities(
+      physical_device, pSurfaceCapabilities, [this, physical_device](VkSurfaceCapabilitiesKHR *capabilities) {
+         get_surface_capabilities_common(physical_device, capabilities);
 
-   if (m_specific_surface != nullptr)
-   {
-      pSurfaceCapabilities->currentExtent = m_specific_surface->get_extent();
-      pSurfaceCapabilities->minImageExtent = m_specific_surface->get_extent();
-      pSurfaceCapabilities->maxImageExtent = m_specific_surface->get_extent();
-   }
+         if (m_specific_surface != nullptr)
+         {
+            capabilities->currentExtent = m_specific_surface->get_extent();
+            capabilities->minImageExtent = m_specific_surface->get_extent();
+            capabilities->maxImageExtent = m_specific_surface->get_extent();
+         }
 
-   /* Image count limits */
-   pSurfaceCapabilities->minImageCount = 2;
-   pSurfaceCapabilities->maxImageCount = 3;
+         /* Image count limits */
+         capabilities->minImageCount = 2;
+         capabilities->maxImageCount = 3;
 
-   /* Composite alpha */
-   pSurfaceCapabilities->supportedCompositeAlpha =
-      static_cast<VkCompositeAlphaFlagBitsKHR>(VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR | VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR);
+         /* Composite alpha */
+         capabilities->supportedCompositeAlpha = static_cast<VkCompositeAlphaFlagBitsKHR>(
+            VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR | VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR);
 
-   return VK_SUCCESS;
+         return VK_SUCCESS;
+      });
 }
 
 VkResult surface_properties::get_surface_capabilities(VkPhysicalDevice physical_device,
@@ -102,6 +106,42 @@ VkResult surface_properties::get_surface_capabilities(VkPhysicalDevice physical_
    return VK_SUCCESS;
 }
 
+/**
+ * @brief Append @p vk_format to @p formats if the device supports it as a color attachment.
+ *
+ * @param physical_device The physical device to check format support for.
+ * @param query_format    The format used in the device support query.
+ * @param vk_format       The format exposed to the application.
+ * @param formats         The list of supported formats to append to.
+ *
+ * @return VK_SUCCESS on success, VK_ERROR_OUT_OF_HOST_MEMORY if the format could not be appended.
+ */
+static VkResult add_supported_format(VkPhysicalDevice physical_device, VkFormat query_format, VkFormat vk_format,
+                                     util::vector<surface_format_properties> &formats)
+{
+   surface_format_properties format{ vk_format };
+   VkPhysicalDeviceImageFormatInfo2KHR format_info = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_FORMAT_INFO_2_KHR,
+                                                       nullptr,
+                                                       query_format,
+                                                       VK_IMAGE_TYPE_2D,
+                                                       VK_IMAGE_TILING_OPTIMAL,
+                                                       VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+                                                       0 };
+   if (format.check_device_support(physical_device, format_info) != VK_SUCCESS)
+   {
+      return VK_SUCCESS;
+   }
+
+#if WSI_IMAGE_COMPRESSION_CONTROL_SWAPCHAIN
+   if (layer::instance_private_data::get(physical_device).has_image_compression_support(physical_device))
+   {
+      format.add_device_compression_support(physical_device, format_info);
+   }
+#endif
+
+   return formats.try_push_back(format) ? VK_SUCCESS : VK_ERROR_OUT_OF_HOST_MEMORY;
+}
+
 VkResult surface_properties::get_surface_formats(VkPhysicalDevice physical_device, uint32_t *surfaceFormatCount,
                                                  VkSurfaceFormatKHR *surfaceFormats,
                                                  VkSurfaceFormat2KHR *extended_surface_formats)
@@ -112,72 +152,35 @@ VkResult surface_properties::get_surface_formats(VkPhysicalDevice physical_devic
       return VK_ERROR_SURFACE_LOST_KHR;
    }
 
-   auto display_formats = display->get_supported_formats();
-
-   uint32_t format_count = 0;
+   return m_query_cache.get_surface_formats(
+      physical_device, surfaceFormatCount, surfaceFormats, extended_surface_formats,
+      [&display, physical_device](util::vector<surface_format_properties> &formats) {
+         auto display_formats = display->get_supported_formats();
 
-   assert(display_formats->size() > 0);
-   assert(display_formats->size() <= max_core_1_0_formats);
+         assert(display_formats->size() > 0);
+         assert(display_formats->size() <= max_core_1_0_formats);
 
-   std::array<surface_format_properties, max_core_1_0_formats> formats{};
-
-   for (const auto &drm_format : *display_formats)
-   {
-      auto vk_format = util::drm::drm_to_vk_format(drm_format.fourcc);
-      if (VK_FORMAT_UNDEFINED != vk_format)
-      {
-         formats[format_count] = surface_format_properties{ vk_format };
-         VkPhysicalDeviceImageFormatInfo2KHR format_info = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_FORMAT_INFO_2_KHR,
-                                                             nullptr,
-                                                             vk_format,
-                                                             VK_IMAGE_TYPE_2D,
-                                                             VK_IMAGE_TILING_OPTIMAL,
-                                                             VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
-                                                             0 };
-         VkResult res = formats[format_count].check_device_support(physical_device, format_info);
-         if (VK_SUCCESS == res)
+         for (const auto &drm_format : *display_formats)
          {
-#if WSI_IMAGE_COMPRESSION_CONTROL_SWAPCHAIN
-            if (layer::instance_private_data::get(physical_device).has_image_compression_support(physical_device))
+            auto vk_format = util::drm::drm_to_vk_format(drm_format.fourcc);
+            if (VK_FORMAT_UNDEFINED != vk_format)
             {
-               formats[format_count].add_device_compression_support(physical_device, format_info);
+               TRY(add_supported_format(physical_device, vk_format, vk_format, formats));
             }
-#endif
-            format_count++;
-         }
-      }
 
-      /* Certain 8-bit UNORM formats can be interpreted as both UNORM and sRGB by Vulkan, so expose both formats.
-       * The colorSpace value is how the presentation engine interprets the format.
-       * The linearity of VkFormat and the display format may be different.
-       */
-      auto vk_srgb_format = util::drm::drm_to_vk_srgb_format(drm_format.fourcc);
-      if (VK_FORMAT_UNDEFINED != vk_srgb_format)
-      {
-         formats[format_count] = surface_format_properties{ vk_srgb_format };
-         VkPhysicalDeviceImageFormatInfo2KHR format_info = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_FORMAT_INFO_2_KHR,
-                                                             nullptr,
-                                                             vk_format,
-                                                             VK_IMAGE_TYPE_2D,
-                                                             VK_IMAGE_TILING_OPTIMAL,
-                                                             VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
-                                                             0 };
-         VkResult res = formats[format_count].check_device_support(physical_device, format_info);
-         if (VK_SUCCESS == res)
-         {
-#if WSI_IMAGE_COMPRESSION_CONTROL_SWAPCHAIN
-            if (layer::instance_private_data::get(physical_device).has_image_compression_support(physical_device))
+            /* Certain 8-bit UNORM formats can be interpreted as both UNORM and sRGB by Vulkan, so expose both
+             * formats. The colorSpace value is how the presentation engine interprets the format.
+             * The linearity of VkFormat and the display format may be different.
+             */
+            auto vk_srgb_format = util::drm::drm_to_vk_srgb_format(drm_format.fourcc);
+            if (VK_FORMAT_UNDEFINED != vk_srgb_format)
             {
-               formats[format_count].add_device_compression_support(physical_device, format_info);
+               TRY(add_supported_format(physical_device, vk_format, vk_srgb_format, formats));
             }
-#endif
-            format_count++;
          }
-      }
-   }
 
-   return surface_properties_formats_helper(formats.begin(), formats.begin() + format_count, surfaceFormatCount,
-                                            surfaceFormats, extended_surface_formats);
+         return VK_SUCCESS;
+      });
 }
 
 VkResult surface_properties::get_surface_present_modes(VkPhysicalDevice physical_device, VkSurfaceKHR surface,
@@ -234,7 +237,8 @@ CreateDisplayPlaneSurfaceKHR(VkInstance instance, const VkDisplaySurfaceCreateIn
                              const VkAllocationCallbacks *pAllocator, VkSurfaceKHR *pSurface)
 {
    auto &instance_data = layer::instance_private_data::get(instance);
-   util::allocator allocator{ instance_data.get_allocator(), VK_SYSTEM_ALLOCATION_SCOPE_OBJECT, pAllocator };
+   util::allocator allocator{ instance_data.get_allocator(), VK_SYSTEM_ALLOCATION_SCOPE_OBJECT, pAllocator,
+                              util::memory_subsystem::surface };
 
    drm_display_mode *display_mode = reinterpret_cast<drm_display_mode *>(pCreateInfo->displayMode);
 
@@ -242,7 +246,7 @@ CreateDisplayPlaneSurfaceKHR(VkInstance instance, const VkDisplaySurfaceCreateIn
    if (res == VK_SUCCESS)
    {
 
-      auto wsi_surface = allocator.make_unique<surface>(display_mode, pCreateInfo->imageExtent);
+      auto wsi_surface = allocator.make_unique<surface>(display_mode, pCreateInfo->imageExtent, allocator);
       if (wsi_surface == nullptr)
       {
          return VK_ERROR_OUT_OF_HOST_MEMORY;
@@ -555,6 +559,11 @@ void surface_properties::get_surface_present_scaling_and_gravity(
    scaling_capabilities->supportedPresentGravityY = VK_PRESENT_GRAVITY_MIN_BIT_EXT;
 }
 
+void surface_properties::invalidate_query_cache()
+{
+   m_query_cache.invalidate();
+}
+
 bool surface_properties::is_compatible_present_modes(VkPresentModeKHR present_mode_a, VkPresentModeKHR present_mode_b)
 {
    return m_compatible_present_modes.is_compatible_present_modes(present_mode_a, present_mode_b);
@@ -29,6 +29,7 @@
 #include "wsi/surface_properties.hpp"
 #include "drm_display.hpp"
 #include "wsi/compatible_present_modes.hpp"
+#include "wsi/surface_query_cache.hpp"
 
 namespace wsi
 {
@@ -43,7 +44,7 @@ class surface_properties : public wsi::surface_properties
 public:
    surface_properties();
 
-   surface_properties(surface *wsi_surface);
+   surface_properties(surface *wsi_surface, const util::allocator &allocator);
 
    VkResult get_surface_capabilities(VkPhysicalDevice physical_device,
                                      VkSurfaceCapabilitiesKHR *pSurfaceCapabilities) override;
@@ -74,6 +75,8 @@ public:
 
    bool is_compatible_present_modes(VkPresentModeKHR present_mode_a, VkPresentModeKHR present_mode_b) override;
 
+   void invalidate_query_cache() override;
+
 private:
    surface *const m_specific_surface;
 
@@ -83,6 +86,9 @@ private:
    /* Stores compatible presentation modes */
    compatible_present_modes<1> m_compatible_present_modes;
 
+   /* Cached results of the capability and format queries */
+   surface_query_cache m_query_cache;
+
    void get_surface_present_scaling_and_gravity(VkSurfacePresentScalingCapabilitiesEXT *scaling_capabilities) override;
    void populate_present_mode_compatibilities() override;
 };
@@ -34,6 +34,7 @@
 #include "swapchain.hpp"
 #include "surface.hpp"
 #include "util/macros.hpp"
+#include "util/trace.hpp"
 
 #include <errno.h>
 namespace wsi
@@ -44,7 +45,7 @@ namespace display
 
 swapchain::swapchain(layer::device_private_data &dev_data, const VkAllocationCallbacks *pAllocator,
                      surface &wsi_surface)
-   : wsi::swapchain_base(dev_data, pAllocator)
+   : wsi::typed_swapchain<swapchain, display_image_data>(dev_data, pAllocator)
    , m_wsi_allocator(nullptr)
    , m_display_mode(wsi_surface.get_display_mode())
    , m_image_creation_parameters({}, m_allocator, {}, {})
@@ -65,14 +66,23 @@ swapchain::~swapchain()
    m_wsi_allocator = nullptr;
 }
 
+/**
+ * @brief Result of a page flip, filled by the DRM page flip event handler.
+ */
+struct page_flip_result
+{
+   bool complete{ false };
+   /* Time of the flip in nanoseconds of CLOCK_MONOTONIC. */
+   uint64_t time_ns{ 0 };
+};
+
 static void page_flip_event(int fd, unsigned int sequence, unsigned int tv_sec, unsigned int tv_usec, void *user_data)
 {
    UNUSED(fd);
    UNUSED(sequence);
-   UNUSED(tv_sec);
-   UNUSED(tv_usec);
-   bool *done = (bool *)user_data;
-   *done = true;
+   auto *result = reinterpret_cast<page_flip_result *>(user_data);
+   result->complete = true;
+   result->time_ns = tv_sec * util::NSEC_PER_SEC + tv_usec * util::NSEC_PER_USEC;
 }
 
 VkResult swapchain::init_platform(VkDevice device, const VkSwapchainCreateInfoKHR *swapchain_create_info,
@@ -93,7 +103,7 @@ VkResult swapchain::bind_swapchain_image(VkDevice &device, const VkBindImageMemo
                                          const VkBindImageMemorySwapchainInfoKHR *bind_sc_info)
 {
    const wsi::swapchain_image &swapchain_image = m_swapchain_images[bind_sc_info->imageIndex];
-   auto image_data = reinterpret_cast<display_image_data *>(swapchain_image.data);
+   auto image_data = get_image_data(swapchain_image);
    return image_data->external_mem.bind_swapchain_image_memory(bind_image_mem_info->image);
 }
 
@@ -282,7 +292,7 @@ VkResult swapchain::allocate_wsialloc(VkImageCreateInfo &image_create_info, disp
 }
 
 static VkResult fill_image_create_info(VkImageCreateInfo &image_create_info,
-                                       util::vector<VkSubresourceLayout> &image_plane_layouts,
+                                       wsi::plane_layouts &image_plane_layouts,
                                        VkImageDrmFormatModifierExplicitCreateInfoEXT &drm_mod_info,
                                        VkExternalMemoryImageCreateInfoKHR &external_info,
                                        display_image_data &image_data, uint64_t modifier)
@@ -377,10 +387,10 @@ VkResult swapchain::create_framebuffer(const VkImageCreateInfo &image_create_inf
 
 VkResult swapchain::allocate_and_bind_swapchain_image(VkImageCreateInfo image_create_info, swapchain_image &image)
 {
-   std::unique_lock<std::recursive_mutex> image_status_lock(m_image_status_mutex);
+   util::unique_lock<util::recursive_mutex> image_status_lock(m_image_status_mutex);
    image.status = swapchain_image::FREE;
-   assert(image.data != nullptr);
-   auto image_data = static_cast<display_image_data *>(image.data);
+   assert(has_image_data(image));
+   auto image_data = get_image_data(image);
    TRY_LOG(allocate_image(image_create_info, image_data), "Failed to allocate image");
 
    image_status_lock.unlock();
@@ -404,12 +414,11 @@ VkResult swapchain::allocate_and_bind_swapchain_image(VkImageCreateInfo image_cr
 VkResult swapchain::create_swapchain_image(VkImageCreateInfo image_create_info, swapchain_image &image)
 {
    /* Create image_data */
-   auto image_data = m_allocator.create<display_image_data>(1, m_device, m_allocator);
+   auto image_data = create_image_data(image, m_device, m_allocator);
    if (image_data == nullptr)
    {
       return VK_ERROR_OUT_OF_HOST_MEMORY;
    }
-   image.data = image_data;
 
    if (m_image_create_info.format == VK_FORMAT_UNDEFINED)
    {
@@ -456,8 +465,7 @@ VkResult swapchain::create_swapchain_image(VkImageCreateInfo image_create_info,
 void swapchain::present_image(const pending_present_request &pending_present)
 {
    int drm_res = 0;
-   display_image_data *image_data =
-      reinterpret_cast<display_image_data *>(m_swapchain_images[pending_present.image_index].data);
+   display_image_data *image_data = get_image_data(pending_present.image_index);
    const auto &display = drm_display::get_display();
    if (!display.has_value())
    {
@@ -465,6 +473,7 @@ void swapchain::present_image(const pending_present_request &pending_present)
       return;
    }
 
+   uint64_t present_complete_ns = 0;
    if (m_first_present)
    {
       /* Now we can set the mode of the new swapchain. */
@@ -480,15 +489,16 @@ void swapchain::present_image(const pending_present_request &pending_present)
          set_error_state(VK_ERROR_SURFACE_LOST_KHR);
          return;
       }
+      present_complete_ns = util::get_monotonic_time_ns();
    }
    /* The swapchain has already started presenting. */
    else
    {
 
-      bool page_flip_complete = false;
+      page_flip_result page_flip{};
 
       drm_res = drmModePageFlip(display->get_drm_fd(), display->get_crtc_id(), image_data->fb_id,
-                                DRM_MODE_PAGE_FLIP_EVENT, (void *)&page_flip_complete);
+                                DRM_MODE_PAGE_FLIP_EVENT, (void *)&page_flip);
 
       if (drm_res != 0)
       {
@@ -501,6 +511,7 @@ void swapchain::present_image(const pending_present_request &pending_present)
       FD_ZERO(&fds);
       FD_SET(display->get_drm_fd(), &fds);
 
+      /* Wait for the flip, unless the present watchdog has given up on the swapchain. */
       do
       {
          struct timeval t;
@@ -532,7 +543,10 @@ void swapchain::present_image(const pending_present_request &pending_present)
 
             drmHandleEvent(display->get_drm_fd(), &ev);
          }
-      } while ((drm_res == -1 && (errno == EINTR || errno == EAGAIN)) || drm_res == 0 || !page_flip_complete);
+      } while (((drm_res == -1 && (errno == EINTR || errno == EAGAIN)) || drm_res == 0 || !page_flip.complete) &&
+               !error_has_occured());
+      util::trace::instant("drm_page_flip");
+      present_complete_ns = page_flip.time_ns;
    }
 
    /* Find currently presented image */
@@ -552,6 +566,12 @@ void swapchain::present_image(const pending_present_request &pending_present)
    }
    /* The image is on screen, change the image status to PRESENTED. */
    m_swapchain_images[pending_present.image_index].status = swapchain_image::PRESENTED;
+   util::trace::flow(util::trace::phase::flow_end, "present", this, pending_present.present_id);
+   if (swapchain_statistics::is_latency_measurement_enabled())
+   {
+      m_statistics.record_present_complete(m_swapchain_images[pending_present.image_index].timestamps,
+                                           present_complete_ns);
+   }
    set_present_id(pending_present.present_id);
 
    /* And release the old one. */
@@ -566,19 +586,19 @@ void swapchain::present_image(const pending_present_request &pending_present)
 VkResult swapchain::image_set_present_payload(swapchain_image &image, VkQueue queue,
                                               const queue_submit_semaphores &semaphores, const void *submission_pnext)
 {
-   auto image_data = reinterpret_cast<display_image_data *>(image.data);
+   auto image_data = get_image_data(image);
    return image_data->present_fence.set_payload(queue, semaphores, submission_pnext);
 }
 
 VkResult swapchain::image_wait_present(swapchain_image &image, uint64_t timeout)
 {
-   auto data = reinterpret_cast<display_image_data *>(image.data);
+   auto data = get_image_data(image);
    return data->present_fence.wait_payload(timeout);
 }
 
 void swapchain::destroy_image(swapchain_image &image)
 {
-   std::unique_lock<std::recursive_mutex> image_status_lock(m_image_status_mutex);
+   util::unique_lock<util::recursive_mutex> image_status_lock(m_image_status_mutex);
 
    if (image.status != swapchain_image::INVALID)
    {
@@ -593,9 +613,9 @@ void swapchain::destroy_image(swapchain_image &image)
 
    image_status_lock.unlock();
 
-   if (image.data != nullptr)
+   if (has_image_data(image))
    {
-      auto image_data = reinterpret_cast<display_image_data *>(image.data);
+      auto image_data = get_image_data(image);
       auto &display = drm_display::get_display();
       if (!display.has_value())
       {
@@ -608,8 +628,7 @@ void swapchain::destroy_image(swapchain_image &image)
          assert(result == 0);
       }
 
-      m_allocator.destroy(1, image_data);
-      image.data = nullptr;
+      destroy_image_data(image);
    }
 }
 
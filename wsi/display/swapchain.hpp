@@ -60,7 +60,7 @@ struct display_image_data
 struct image_creation_parameters
 {
    wsialloc_format m_allocated_format;
-   util::vector<VkSubresourceLayout> m_image_layout;
+   wsi::plane_layouts m_image_layout;
    VkExternalMemoryImageCreateInfoKHR m_external_info;
    VkImageDrmFormatModifierExplicitCreateInfoEXT m_drm_mod_info;
 
@@ -78,7 +78,7 @@ struct image_creation_parameters
 /**
  * @brief Display swapchain class.
  */
-class swapchain : public wsi::swapchain_base
+class swapchain final : public wsi::typed_swapchain<swapchain, display_image_data>
 {
 public:
    swapchain(layer::device_private_data &dev_data, const VkAllocationCallbacks *pAllocator, surface &wsi_surface);
@@ -100,13 +100,12 @@ public:
     *
     * @param pending_present Information on the pending present request.
     */
-   void present_image(const pending_present_request &pending_present) override;
+   void present_image(const pending_present_request &pending_present);
 
-   virtual VkResult image_set_present_payload(swapchain_image &image, VkQueue queue,
-                                              const queue_submit_semaphores &semaphores,
-                                              const void *submission_pnext) override;
+   VkResult image_set_present_payload(swapchain_image &image, VkQueue queue, const queue_submit_semaphores &semaphores,
+                                      const void *submission_pnext);
 
-   virtual VkResult image_wait_present(swapchain_image &image, uint64_t timeout) override;
+   VkResult image_wait_present(swapchain_image &image, uint64_t timeout);
 
    void destroy_image(swapchain_image &image) override;
 
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file extension_chains.cpp
+ *
+ * @brief Contains the pNext chain decoders of the present and create paths.
+ */
+
+#include "extension_chains.hpp"
+
+#include "util/helpers.hpp"
+
+namespace wsi
+{
+
+/**
+ * @brief Point @p field at @p entry unless an earlier structure of the same type was already found.
+ */
+template <typename T>
+static void set_first_extension(const T *&field, const VkBaseInStructure *entry)
+{
+   if (field == nullptr)
+   {
+      field = reinterpret_cast<const T *>(entry);
+   }
+}
+
+present_info_extensions decode_present_info_extensions(const VkPresentInfoKHR &present_info)
+{
+   present_info_extensions extensions{};
+   util::for_each_extension(present_info.pNext, [&extensions](const VkBaseInStructure *entry) {
+      switch (entry->sType)
+      {
+      case VK_STRUCTURE_TYPE_PRESENT_ID_KHR:
+         set_first_extension(extensions.present_id, entry);
+         break;
+      case VK_STRUCTURE_TYPE_SWAPCHAIN_PRESENT_FENCE_INFO_EXT:
+         set_first_extension(extensions.present_fence_info, entry);
+         break;
+      case VK_STRUCTURE_TYPE_SWAPCHAIN_PRESENT_MODE_INFO_EXT:
+         set_first_extension(extensions.present_mode_info, entry);
+         break;
+      case VK_STRUCTURE_TYPE_FRAME_BOUNDARY_EXT:
+         set_first_extension(extensions.frame_boundary, entry);
+         break;
+#if VULKAN_WSI_LAYER_EXPERIMENTAL
+      case VK_STRUCTURE_TYPE_PRESENT_TIMINGS_INFO_EXT:
+         set_first_extension(extensions.present_timings_info, entry);
+         break;
+#endif
+      default:
+         break;
+      }
+   });
+   return extensions;
+}
+
+swapchain_create_info_extensions decode_swapchain_create_info_extensions(const VkSwapchainCreateInfoKHR &create_info)
+{
+   swapchain_create_info_extensions extensions{};
+   util::for_each_extension(create_info.pNext, [&extensions](const VkBaseInStructure *entry) {
+      switch (entry->sType)
+      {
+      case VK_STRUCTURE_TYPE_SWAPCHAIN_PRESENT_SCALING_CREATE_INFO_EXT:
+         set_first_extension(extensions.present_scaling, entry);
+         break;
+      case VK_STRUCTURE_TYPE_SWAPCHAIN_PRESENT_MODES_CREATE_INFO_EXT:
+         set_first_extension(extensions.present_modes, entry);
+         break;
+#if WSI_IMAGE_COMPRESSION_CONTROL_SWAPCHAIN
+      case VK_STRUCTURE_TYPE_IMAGE_COMPRESSION_CONTROL_EXT:
+         set_first_extension(extensions.image_compression_control, entry);
+         break;
+#endif
+      default:
+         break;
+      }
+   });
+   return extensions;
+}
+
+} /* namespace wsi */
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file extension_chains.hpp
+ *
+ * @brief Single pass decoding of the pNext chains of the structures passed to the present and create paths.
+ */
+
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#if VULKAN_WSI_LAYER_EXPERIMENTAL
+#include "layer/wsi_layer_experimental.hpp"
+#endif
+
+namespace wsi
+{
+
+/**
+ * @brief Structures understood by the layer in the pNext chain of VkPresentInfoKHR.
+ *
+ * Members are nullptr when the structure is not part of the chain.
+ */
+struct present_info_extensions
+{
+   const VkPresentIdKHR *present_id{ nullptr };
+   const VkSwapchainPresentFenceInfoEXT *present_fence_info{ nullptr };
+   const VkSwapchainPresentModeInfoEXT *present_mode_info{ nullptr };
+   const VkFrameBoundaryEXT *frame_boundary{ nullptr };
+#if VULKAN_WSI_LAYER_EXPERIMENTAL
+   const VkPresentTimingsInfoEXT *present_timings_info{ nullptr };
+#endif
+};
+
+/**
+ * @brief Structures understood by the layer in the pNext chain of VkSwapchainCreateInfoKHR.
+ *
+ * Members are nullptr when the structure is not part of the chain.
+ */
+struct swapchain_create_info_extensions
+{
+   const VkSwapchainPresentScalingCreateInfoEXT *present_scaling{ nullptr };
+   const VkSwapchainPresentModesCreateInfoEXT *present_modes{ nullptr };
+#if WSI_IMAGE_COMPRESSION_CONTROL_SWAPCHAIN
+   const VkImageCompressionControlEXT *image_compression_control{ nullptr };
+#endif
+};
+
+/**
+ * @brief Walk the pNext chain of @p present_info once and collect the structures the layer understands.
+ *
+ * As with util::find_extension, the first instance of a structure in the chain is used.
+ *
+ * @param present_info The present info to decode.
+ *
+ * @return Typed pointers into the chain of @p present_info.
+ */
+present_info_extensions decode_present_info_extensions(const VkPresentInfoKHR &present_info);
+
+/**
+ * @brief Walk the pNext chain of @p create_info once and collect the structures the layer understands.
+ *
+ * As with util::find_extension, the first instance of a structure in the chain is used.
+ *
+ * @param create_info The swapchain create info to decode.
+ *
+ * @return Typed pointers into the chain of @p create_info.
+ */
+swapchain_create_info_extensions decode_swapchain_create_info_extensions(const VkSwapchainCreateInfoKHR &create_info);
+
+} /* namespace wsi */
@@ -31,6 +31,7 @@
 
 #include "util/log.hpp"
 #include "util/helpers.hpp"
+#include "util/memory_accounting.hpp"
 #include "util/drm/drm_utils.hpp"
 
 namespace wsi
@@ -51,6 +52,7 @@ external_memory::~external_memory()
       if (memory != VK_NULL_HANDLE)
       {
          device_data.disp.FreeMemory(m_device, memory, m_allocator.get_original_callbacks());
+         util::memory_accounting::record_device_free(util::device_memory_kind::dma_buf, m_memory_sizes[plane]);
       }
       else if (m_buffer_fds[plane] >= 0)
       {
@@ -110,16 +112,17 @@ VkResult external_memory::import_plane_memories()
          auto it = std::find(std::begin(m_buffer_fds), std::end(m_buffer_fds), m_buffer_fds[plane]);
          if (std::distance(std::begin(m_buffer_fds), it) == plane)
          {
-            TRY_LOG_CALL(import_plane_memory(m_buffer_fds[plane], &m_memories[memory_plane]));
+            TRY_LOG_CALL(
+               import_plane_memory(m_buffer_fds[plane], &m_memories[memory_plane], &m_memory_sizes[memory_plane]));
             memory_plane++;
          }
       }
       return VK_SUCCESS;
    }
-   return import_plane_memory(m_buffer_fds[0], &m_memories[0]);
+   return import_plane_memory(m_buffer_fds[0], &m_memories[0], &m_memory_sizes[0]);
 }
 
-VkResult external_memory::import_plane_memory(int fd, VkDeviceMemory *memory)
+VkResult external_memory::import_plane_memory(int fd, VkDeviceMemory *memory, VkDeviceSize *memory_size)
 {
    uint32_t mem_index = 0;
    TRY_LOG_CALL(get_fd_mem_type_index(fd, &mem_index));
@@ -146,6 +149,9 @@ VkResult external_memory::import_plane_memory(int fd, VkDeviceMemory *memory)
    TRY_LOG(device_data.disp.AllocateMemory(m_device, &alloc_info, m_allocator.get_original_callbacks(), memory),
            "Failed to import device memory");
 
+   *memory_size = alloc_info.allocationSize;
+   util::memory_accounting::record_device_allocation(util::device_memory_kind::dma_buf, *memory_size);
+
    return VK_SUCCESS;
 }
 
@@ -154,13 +160,13 @@ VkResult external_memory::bind_swapchain_image_memory(const VkImage &image)
    auto &device_data = layer::device_private_data::get(m_device);
    if (is_disjoint())
    {
-      util::vector<VkBindImageMemoryInfo> bind_img_mem_infos(m_allocator);
+      util::small_vector<VkBindImageMemoryInfo, MAX_PLANES> bind_img_mem_infos(m_allocator);
       if (!bind_img_mem_infos.try_resize(get_num_memories()))
       {
          return VK_ERROR_OUT_OF_HOST_MEMORY;
       }
 
-      util::vector<VkBindImagePlaneMemoryInfo> bind_plane_mem_infos(m_allocator);
+      util::small_vector<VkBindImagePlaneMemoryInfo, MAX_PLANES> bind_plane_mem_infos(m_allocator);
       if (!bind_plane_mem_infos.try_resize(get_num_memories()))
       {
          return VK_ERROR_OUT_OF_HOST_MEMORY;
@@ -192,7 +198,7 @@ VkResult external_memory::import_memory_and_bind_swapchain_image(const VkImage &
    return VK_SUCCESS;
 }
 
-VkResult external_memory::fill_image_plane_layouts(util::vector<VkSubresourceLayout> &image_plane_layouts)
+VkResult external_memory::fill_image_plane_layouts(plane_layouts &image_plane_layouts)
 {
    if (!image_plane_layouts.try_resize(get_num_planes()))
    {
@@ -209,13 +215,13 @@ VkResult external_memory::fill_image_plane_layouts(util::vector<VkSubresourceLay
 }
 
 void external_memory::fill_drm_mod_info(const void *pNext, VkImageDrmFormatModifierExplicitCreateInfoEXT &drm_mod_info,
-                                        util::vector<VkSubresourceLayout> &plane_layouts, uint64_t modifier)
+                                        plane_layouts &image_layout, uint64_t modifier)
 {
    drm_mod_info.sType = VK_STRUCTURE_TYPE_IMAGE_DRM_FORMAT_MODIFIER_EXPLICIT_CREATE_INFO_EXT;
    drm_mod_info.pNext = pNext;
    drm_mod_info.drmFormatModifier = modifier;
    drm_mod_info.drmFormatModifierPlaneCount = get_num_memories();
-   drm_mod_info.pPlaneLayouts = plane_layouts.data();
+   drm_mod_info.pPlaneLayouts = image_layout.data();
 }
 
 void external_memory::fill_external_info(VkExternalMemoryImageCreateInfoKHR &external_info, void *pNext)
@@ -37,6 +37,7 @@
 #include "wsi/synchronization.hpp"
 #include "layer/private_data.hpp"
 #include "util/custom_allocator.hpp"
+#include "util/small_vector.hpp"
 #include "util/helpers.hpp"
 
 namespace wsi
@@ -44,6 +45,11 @@ namespace wsi
 
 using util::MAX_PLANES;
 
+/**
+ * @brief Per-plane subresource layouts of an image, stored inline for up to MAX_PLANES planes.
+ */
+using plane_layouts = util::small_vector<VkSubresourceLayout, MAX_PLANES>;
+
 class external_memory
 {
 public:
@@ -191,7 +197,7 @@ public:
     *
     * @return VK_ERROR_OUT_OF_HOST_MEMORY when out of memory else VK_SUCCESS on success.
     */
-   VkResult fill_image_plane_layouts(util::vector<VkSubresourceLayout> &image_plane_layouts);
+   VkResult fill_image_plane_layouts(plane_layouts &image_plane_layouts);
 
    /**
     * @brief Fills out a VkImageDrmFormatModifierExplicitCreateInfoEXT struct.
@@ -202,7 +208,7 @@ public:
     * @param modifier      Modifier that the DRM format will use.
     */
    void fill_drm_mod_info(const void *pNext, VkImageDrmFormatModifierExplicitCreateInfoEXT &drm_mod_info,
-                          util::vector<VkSubresourceLayout> &image_layout, uint64_t modifier);
+                          plane_layouts &image_layout, uint64_t modifier);
 
    /**
     * @brief Fills out a VkExternalMemoryImageCreateInfoKHR struct.
@@ -217,13 +223,15 @@ private:
 
    VkResult import_plane_memories(void);
 
-   VkResult import_plane_memory(int fd, VkDeviceMemory *memory);
+   VkResult import_plane_memory(int fd, VkDeviceMemory *memory, VkDeviceSize *memory_size);
 
    std::array<int, MAX_PLANES> m_buffer_fds{ -1, -1, -1, -1 };
    std::array<int, MAX_PLANES> m_strides{ 0, 0, 0, 0 };
    std::array<uint32_t, MAX_PLANES> m_offsets{ 0, 0, 0, 0 };
    std::array<VkDeviceMemory, MAX_PLANES> m_memories = { VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE,
                                                          VK_NULL_HANDLE };
+   /* Size of the imported memories, for memory accounting. */
+   std::array<VkDeviceSize, MAX_PLANES> m_memory_sizes{ 0, 0, 0, 0 };
    uint32_t m_num_planes{ 0 };
    uint32_t m_num_memories{ 0 };
    VkExternalMemoryHandleTypeFlagBits m_handle_type{ VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT };
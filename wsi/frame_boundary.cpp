@@ -38,23 +38,20 @@ frame_boundary_handler::frame_boundary_handler(const layer::device_private_data
 }
 
 std::optional<VkFrameBoundaryEXT> frame_boundary_handler::handle_frame_boundary_event(
-   const VkPresentInfoKHR *present_info, VkImage *current_image_to_be_presented)
+   const VkFrameBoundaryEXT *app_frame_boundary, VkImage *current_image_to_be_presented)
 {
    /* If frame boundary feature is not enabled by the application, the layer will pass its own frame boundary events back to ICD.
     * Otherwise, let the application handle the frame boundary events. */
    return m_handle_frame_boundary_events ? create_frame_boundary(current_image_to_be_presented) :
-                                           wsi::create_frame_boundary(*present_info);
+                                           wsi::create_frame_boundary(app_frame_boundary);
 }
 
-std::optional<VkFrameBoundaryEXT> create_frame_boundary(const VkPresentInfoKHR &present_info)
+std::optional<VkFrameBoundaryEXT> create_frame_boundary(const VkFrameBoundaryEXT *app_frame_boundary)
 {
-   auto *present_frame_boundary =
-      util::find_extension<VkFrameBoundaryEXT>(VK_STRUCTURE_TYPE_PRESENT_ID_KHR, present_info.pNext);
-
    /* Extract the VkFrameBoundaryEXT structure to avoid passing other, unrelated structures to vkQueueSubmit */
-   if (present_frame_boundary != nullptr)
+   if (app_frame_boundary != nullptr)
    {
-      return util::shallow_copy_extension(present_frame_boundary);
+      return util::shallow_copy_extension(app_frame_boundary);
    }
 
    return std::nullopt;
@@ -45,10 +45,10 @@ public:
    /**
     * @brief Handle frame boundary event at present time
     *
-    * @param present_info Information about the swapchain and image to be presented.
+    * @param app_frame_boundary Frame boundary passed by the application with the present request, may be nullptr.
     * @param current_image_to_be_presented Address to the currently to be presented image
     */
-   std::optional<VkFrameBoundaryEXT> handle_frame_boundary_event(const VkPresentInfoKHR *present_info,
+   std::optional<VkFrameBoundaryEXT> handle_frame_boundary_event(const VkFrameBoundaryEXT *app_frame_boundary,
                                                                  VkImage *current_image_to_be_presented);
 
 private:
@@ -81,9 +81,9 @@ private:
 /**
  * @brief Create a frame boundary object
  *
- * @param present_info Present info
- * @return Frame boundary if @p present_info has passed it.
+ * @param app_frame_boundary Frame boundary passed by the application with the present request, may be nullptr.
+ * @return Frame boundary if the application has passed it.
  */
-std::optional<VkFrameBoundaryEXT> create_frame_boundary(const VkPresentInfoKHR &present_info);
+std::optional<VkFrameBoundaryEXT> create_frame_boundary(const VkFrameBoundaryEXT *app_frame_boundary);
 
 }
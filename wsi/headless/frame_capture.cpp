@@ -0,0 +1,996 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file frame_capture.cpp
+ *
+ * @brief Contains the implementation of the capture of the images presented to a headless swapchain.
+ */
+
+#include "frame_capture.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <charconv>
+#include <cinttypes>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <optional>
+#include <system_error>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <layer/private_data.hpp>
+#include <util/helpers.hpp>
+#include <util/log.hpp>
+#include <util/memory_accounting.hpp>
+
+#include "virtual_display.hpp"
+
+namespace wsi
+{
+namespace headless
+{
+
+namespace
+{
+
+enum class capture_format
+{
+   ppm,
+   y4m,
+   ring,
+   shared_export,
+};
+
+/**
+ * @brief Capture configuration, read once from the environment.
+ */
+struct capture_config
+{
+   const char *directory{ nullptr };
+   capture_format format{ capture_format::ppm };
+   uint32_t queue_depth{ 3 };
+   uint32_t ring_frames{ 8 };
+
+   capture_config()
+   {
+      directory = std::getenv("VULKAN_WSI_HEADLESS_CAPTURE_DIR");
+
+      if (const char *env = std::getenv("VULKAN_WSI_HEADLESS_CAPTURE_FORMAT"))
+      {
+         if (std::strcmp(env, "y4m") == 0)
+         {
+            format = capture_format::y4m;
+         }
+         else if (std::strcmp(env, "ring") == 0)
+         {
+            format = capture_format::ring;
+         }
+         else if (std::strcmp(env, "export") == 0)
+         {
+            format = capture_format::shared_export;
+         }
+      }
+
+      if (const char *env = std::getenv("VULKAN_WSI_HEADLESS_CAPTURE_QUEUE"))
+      {
+         std::from_chars(env, env + std::strlen(env), queue_depth);
+         queue_depth = std::clamp(queue_depth, 1u, frame_capture::MAX_SLOTS);
+      }
+
+      if (const char *env = std::getenv("VULKAN_WSI_HEADLESS_CAPTURE_RING_FRAMES"))
+      {
+         std::from_chars(env, env + std::strlen(env), ring_frames);
+         ring_frames = std::max(ring_frames, 1u);
+      }
+   }
+};
+
+const capture_config &get_config()
+{
+   static capture_config config;
+   return config;
+}
+
+/**
+ * @brief Counter naming the captures of the swapchains created by the process.
+ */
+std::atomic<uint32_t> g_capture_count{ 0 };
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "The ring file is shared with other processes");
+static_assert(std::atomic<uint32_t>::is_always_lock_free && sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "The export file is shared with other processes and its counters are used as futexes");
+
+/**
+ * @brief Wake the processes waiting on a futex in a shared mapping.
+ */
+void futex_wake_all(std::atomic<uint32_t> &futex)
+{
+   syscall(SYS_futex, reinterpret_cast<uint32_t *>(&futex), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+} /* namespace */
+
+frame_capture::frame_capture(layer::device_private_data &device_data, const util::allocator &allocator)
+   : m_device_data(device_data)
+   , m_allocator(allocator)
+   , m_capture_id(g_capture_count.fetch_add(1, std::memory_order_relaxed))
+   , m_width(0)
+   , m_height(0)
+   , m_format(VK_FORMAT_UNDEFINED)
+   , m_bgra(false)
+   , m_slot_count(0)
+   , m_non_coherent(false)
+   , m_command_pool(VK_NULL_HANDLE)
+   , m_queue_family_index(0)
+   , m_last_queue(VK_NULL_HANDLE)
+   , m_last_queue_supported(false)
+   , m_lock("headless_capture_lock")
+   , m_run(false)
+   , m_frame_count(0)
+   , m_stream(nullptr)
+   , m_ring(nullptr)
+   , m_ring_size(0)
+   , m_conversion(allocator)
+   , m_export_targets(allocator)
+{
+}
+
+frame_capture::~frame_capture()
+{
+   if (m_thread.joinable())
+   {
+      {
+         util::lock_guard<util::mutex> lock(m_lock);
+         m_run = false;
+      }
+      m_cond.notify_all();
+      m_thread.join();
+   }
+
+   if (m_stream != nullptr)
+   {
+      std::fclose(m_stream);
+   }
+   /* The imported memory must be released before the pixels it imports are unmapped. */
+   destroy_export_targets();
+   if (m_ring != nullptr)
+   {
+      munmap(m_ring, m_ring_size);
+   }
+
+   const auto *callbacks = m_allocator.get_original_callbacks();
+   for (uint32_t i = 0; i < m_slot_count; i++)
+   {
+      auto &slot = m_slots[i];
+      if (slot.command_buffer != VK_NULL_HANDLE)
+      {
+         m_device_data.disp.FreeCommandBuffers(m_device_data.device, m_command_pool, 1, &slot.command_buffer);
+      }
+      m_device_data.disp.DestroyBuffer(m_device_data.device, slot.buffer, callbacks);
+      if (slot.memory != VK_NULL_HANDLE)
+      {
+         m_device_data.disp.FreeMemory(m_device_data.device, slot.memory, callbacks);
+         util::memory_accounting::record_device_free(util::device_memory_kind::device_memory, slot.memory_size);
+      }
+   }
+   m_device_data.disp.DestroyCommandPool(m_device_data.device, m_command_pool, callbacks);
+}
+
+bool frame_capture::is_enabled()
+{
+   return get_config().directory != nullptr;
+}
+
+bool frame_capture::is_export_enabled()
+{
+   return is_enabled() && get_config().format == capture_format::shared_export;
+}
+
+VkResult frame_capture::init(const VkSwapchainCreateInfoKHR &swapchain_create_info)
+{
+   switch (swapchain_create_info.imageFormat)
+   {
+   case VK_FORMAT_R8G8B8A8_UNORM:
+   case VK_FORMAT_R8G8B8A8_SRGB:
+      m_bgra = false;
+      break;
+   case VK_FORMAT_B8G8R8A8_UNORM:
+   case VK_FORMAT_B8G8R8A8_SRGB:
+      m_bgra = true;
+      break;
+   default:
+      return VK_ERROR_FORMAT_NOT_SUPPORTED;
+   }
+   m_format = swapchain_create_info.imageFormat;
+   m_width = swapchain_create_info.imageExtent.width;
+   m_height = swapchain_create_info.imageExtent.height;
+
+   TRY(open_output());
+
+   VkPhysicalDeviceMemoryProperties memory_properties = {};
+   m_device_data.instance_data.disp.GetPhysicalDeviceMemoryProperties(m_device_data.physical_device,
+                                                                      &memory_properties);
+
+   for (; m_slot_count < get_config().queue_depth; m_slot_count++)
+   {
+      /* The frames copied to the export slots directly need no readback buffer. */
+      if (m_export_targets.empty())
+      {
+         TRY_LOG_CALL(create_slot(m_slots[m_slot_count], memory_properties));
+      }
+      if (!m_free_slots.push_back(m_slot_count))
+      {
+         return VK_ERROR_OUT_OF_HOST_MEMORY;
+      }
+   }
+
+   m_run = true;
+   try
+   {
+      m_thread = std::thread(&frame_capture::writer_thread, this);
+   }
+   catch (const std::system_error &)
+   {
+      m_run = false;
+      return VK_ERROR_INITIALIZATION_FAILED;
+   }
+   catch (const std::bad_alloc &)
+   {
+      m_run = false;
+      return VK_ERROR_OUT_OF_HOST_MEMORY;
+   }
+
+   return VK_SUCCESS;
+}
+
+VkResult frame_capture::create_slot(readback_slot &slot, const VkPhysicalDeviceMemoryProperties &memory_properties)
+{
+   const auto *callbacks = m_allocator.get_original_callbacks();
+
+   VkBufferCreateInfo buffer_info = {};
+   buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+   buffer_info.size = static_cast<VkDeviceSize>(m_width) * m_height * 4;
+   buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+   buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+   TRY_LOG_CALL(m_device_data.disp.CreateBuffer(m_device_data.device, &buffer_info, callbacks, &slot.buffer));
+
+   VkMemoryRequirements requirements = {};
+   m_device_data.disp.GetBufferMemoryRequirements(m_device_data.device, slot.buffer, &requirements);
+
+   /* Prefer cached memory, the writer thread reads every byte of the buffers. */
+   uint32_t type_index = UINT32_MAX;
+   for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++)
+   {
+      VkMemoryPropertyFlags flags = memory_properties.memoryTypes[i].propertyFlags;
+      if (!(requirements.memoryTypeBits & (1u << i)) || !(flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+      {
+         continue;
+      }
+      if (type_index == UINT32_MAX || ((flags & VK_MEMORY_PROPERTY_HOST_CACHED_BIT) &&
+                                       !(memory_properties.memoryTypes[type_index].propertyFlags &
+                                         VK_MEMORY_PROPERTY_HOST_CACHED_BIT)))
+      {
+         type_index = i;
+      }
+   }
+   if (type_index == UINT32_MAX)
+   {
+      WSI_LOG_ERROR("No host visible memory type to capture the frames.");
+      return VK_ERROR_INITIALIZATION_FAILED;
+   }
+   if (!(memory_properties.memoryTypes[type_index].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+   {
+      m_non_coherent = true;
+   }
+
+   VkMemoryAllocateInfo allocate_info = {};
+   allocate_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+   allocate_info.allocationSize = requirements.size;
+   allocate_info.memoryTypeIndex = type_index;
+   TRY_LOG_CALL(m_device_data.disp.AllocateMemory(m_device_data.device, &allocate_info, callbacks, &slot.memory));
+   slot.memory_size = requirements.size;
+   util::memory_accounting::record_device_allocation(util::device_memory_kind::device_memory, slot.memory_size);
+
+   TRY_LOG_CALL(m_device_data.disp.BindBufferMemory(m_device_data.device, slot.buffer, slot.memory, 0));
+
+   void *mapped = nullptr;
+   TRY_LOG_CALL(m_device_data.disp.MapMemory(m_device_data.device, slot.memory, 0, VK_WHOLE_SIZE, 0, &mapped));
+   slot.mapped = static_cast<const uint8_t *>(mapped);
+
+   return VK_SUCCESS;
+}
+
+VkResult frame_capture::open_output()
+{
+   const auto &config = get_config();
+   const size_t pixel_count = static_cast<size_t>(m_width) * m_height;
+   char path[PATH_MAX];
+
+   switch (config.format)
+   {
+   case capture_format::ppm:
+      /* One RGB row. */
+      if (!m_conversion.try_resize(static_cast<size_t>(m_width) * 3))
+      {
+         return VK_ERROR_OUT_OF_HOST_MEMORY;
+      }
+      break;
+   case capture_format::y4m:
+   {
+      /* The Y, Cb and Cr planes of a frame. */
+      if (!m_conversion.try_resize(pixel_count * 3))
+      {
+         return VK_ERROR_OUT_OF_HOST_MEMORY;
+      }
+
+      std::snprintf(path, sizeof(path), "%s/swapchain%u.y4m", config.directory, m_capture_id);
+      m_stream = std::fopen(path, "wb");
+      if (m_stream == nullptr)
+      {
+         WSI_LOG_ERROR("Failed to open %s: %s", path, std::strerror(errno));
+         return VK_ERROR_INITIALIZATION_FAILED;
+      }
+
+      uint32_t frame_rate = virtual_display::get_refresh_rate();
+      std::fprintf(m_stream, "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C444\n", m_width, m_height,
+                   frame_rate != 0 ? frame_rate : 60);
+      break;
+   }
+   case capture_format::ring:
+   {
+      uint64_t slot_size = (sizeof(frame_ring_slot) + pixel_count * 4 + 63) & ~uint64_t{ 63 };
+      m_ring_size = sizeof(frame_ring_header) + slot_size * config.ring_frames;
+
+      std::snprintf(path, sizeof(path), "%s/swapchain%u.ring", config.directory, m_capture_id);
+      TRY(map_output(path));
+
+      auto *header = new (m_ring) frame_ring_header();
+      header->magic = FRAME_RING_MAGIC;
+      header->version = FRAME_RING_VERSION;
+      header->width = m_width;
+      header->height = m_height;
+      header->slot_count = config.ring_frames;
+      header->slot_size = slot_size;
+      for (uint32_t i = 0; i < config.ring_frames; i++)
+      {
+         new (static_cast<uint8_t *>(m_ring) + sizeof(frame_ring_header) + i * slot_size) frame_ring_slot();
+      }
+      break;
+   }
+   case capture_format::shared_export:
+   {
+      /* Importing the pixels of the slots needs them to start and end on the import alignment. */
+      const uint64_t import_alignment = get_export_alignment();
+      const uint64_t mask = std::max(import_alignment, uint64_t{ 64 }) - 1;
+      const uint64_t slot_offset = (sizeof(frame_export_header) + mask) & ~mask;
+      const uint64_t pixel_offset = (sizeof(frame_export_slot) + mask) & ~mask;
+      const uint64_t slot_size = (pixel_offset + pixel_count * 4 + mask) & ~mask;
+      m_ring_size = slot_offset + slot_size * config.ring_frames;
+
+      std::snprintf(path, sizeof(path), "%s/swapchain%u.export", config.directory, m_capture_id);
+      TRY(map_output(path));
+
+      auto *header = new (m_ring) frame_export_header();
+      header->magic = FRAME_EXPORT_MAGIC;
+      header->version = FRAME_EXPORT_VERSION;
+      header->width = m_width;
+      header->height = m_height;
+      header->stride = m_width * 4;
+      header->format = m_format;
+      header->slot_count = config.ring_frames;
+      header->pixel_offset = static_cast<uint32_t>(pixel_offset);
+      header->slot_size = slot_size;
+      header->slot_offset = static_cast<uint32_t>(slot_offset);
+      for (uint32_t i = 0; i < config.ring_frames; i++)
+      {
+         new (get_export_slot(i)) frame_export_slot();
+      }
+
+      if (import_alignment != 0 && import_export_slots() != VK_SUCCESS)
+      {
+         destroy_export_targets();
+         WSI_LOG_WARNING("The export file cannot be imported, the frames are copied to it through readback buffers.");
+      }
+      break;
+   }
+   }
+
+   return VK_SUCCESS;
+}
+
+VkResult frame_capture::map_output(const char *path)
+{
+   int fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+   if (fd < 0)
+   {
+      WSI_LOG_ERROR("Failed to open %s: %s", path, std::strerror(errno));
+      return VK_ERROR_INITIALIZATION_FAILED;
+   }
+   if (ftruncate(fd, static_cast<off_t>(m_ring_size)) == 0)
+   {
+      m_ring = mmap(nullptr, m_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   }
+   close(fd);
+   if (m_ring == nullptr || m_ring == MAP_FAILED)
+   {
+      m_ring = nullptr;
+      WSI_LOG_ERROR("Failed to map %s: %s", path, std::strerror(errno));
+      return VK_ERROR_INITIALIZATION_FAILED;
+   }
+   return VK_SUCCESS;
+}
+
+uint32_t frame_capture::get_export_alignment()
+{
+   auto get_properties = m_device_data.instance_data.disp.get_fn<PFN_vkGetPhysicalDeviceProperties2KHR>(
+      "vkGetPhysicalDeviceProperties2KHR");
+   if (!m_device_data.is_device_extension_enabled(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME) ||
+       !get_properties.has_value())
+   {
+      return 0;
+   }
+
+   VkPhysicalDeviceExternalMemoryHostPropertiesEXT host_properties = {};
+   host_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_MEMORY_HOST_PROPERTIES_EXT;
+   VkPhysicalDeviceProperties2KHR properties = {};
+   properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2_KHR;
+   properties.pNext = &host_properties;
+   (*get_properties)(m_device_data.physical_device, &properties);
+
+   /* The slots are mapped at page granularity, a larger alignment cannot be guaranteed. */
+   const auto page_size = static_cast<VkDeviceSize>(sysconf(_SC_PAGESIZE));
+   const VkDeviceSize alignment = host_properties.minImportedHostPointerAlignment;
+   if (alignment == 0 || alignment > page_size)
+   {
+      return 0;
+   }
+   return static_cast<uint32_t>(alignment);
+}
+
+VkResult frame_capture::import_export_slots()
+{
+   const auto *header = static_cast<const frame_export_header *>(m_ring);
+   const auto *callbacks = m_allocator.get_original_callbacks();
+   const VkDeviceSize pixel_size = static_cast<VkDeviceSize>(m_width) * m_height * 4;
+   const VkDeviceSize import_size = header->slot_size - header->pixel_offset;
+
+   VkPhysicalDeviceMemoryProperties memory_properties = {};
+   m_device_data.instance_data.disp.GetPhysicalDeviceMemoryProperties(m_device_data.physical_device,
+                                                                      &memory_properties);
+
+   if (!m_export_targets.try_resize(header->slot_count))
+   {
+      return VK_ERROR_OUT_OF_HOST_MEMORY;
+   }
+   for (uint32_t i = 0; i < header->slot_count; i++)
+   {
+      auto &target = m_export_targets[i];
+      void *pixels = reinterpret_cast<uint8_t *>(get_export_slot(i)) + header->pixel_offset;
+
+      VkMemoryHostPointerPropertiesEXT pointer_properties = {};
+      pointer_properties.sType = VK_STRUCTURE_TYPE_MEMORY_HOST_POINTER_PROPERTIES_EXT;
+      TRY_LOG_CALL(m_device_data.disp.GetMemoryHostPointerPropertiesEXT(
+         m_device_data.device, VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT, pixels, &pointer_properties));
+
+      VkExternalMemoryBufferCreateInfoKHR external_info = {};
+      external_info.sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO_KHR;
+      external_info.handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT;
+
+      VkBufferCreateInfo buffer_info = {};
+      buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+      buffer_info.pNext = &external_info;
+      buffer_info.size = pixel_size;
+      buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+      buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+      TRY_LOG_CALL(m_device_data.disp.CreateBuffer(m_device_data.device, &buffer_info, callbacks, &target.buffer));
+
+      VkMemoryRequirements requirements = {};
+      m_device_data.disp.GetBufferMemoryRequirements(m_device_data.device, target.buffer, &requirements);
+      if (requirements.size > import_size)
+      {
+         return VK_ERROR_INITIALIZATION_FAILED;
+      }
+
+      /* The writer thread publishes the slots without touching the pixels, the copies must be visible as is. */
+      uint32_t type_index = UINT32_MAX;
+      const uint32_t type_bits = requirements.memoryTypeBits & pointer_properties.memoryTypeBits;
+      for (uint32_t j = 0; j < memory_properties.memoryTypeCount && type_index == UINT32_MAX; j++)
+      {
+         if ((type_bits & (1u << j)) &&
+             (memory_properties.memoryTypes[j].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+         {
+            type_index = j;
+         }
+      }
+      if (type_index == UINT32_MAX)
+      {
+         return VK_ERROR_INITIALIZATION_FAILED;
+      }
+
+      VkImportMemoryHostPointerInfoEXT import_info = {};
+      import_info.sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_HOST_POINTER_INFO_EXT;
+      import_info.handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT;
+      import_info.pHostPointer = pixels;
+
+      VkMemoryAllocateInfo allocate_info = {};
+      allocate_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+      allocate_info.pNext = &import_info;
+      allocate_info.allocationSize = import_size;
+      allocate_info.memoryTypeIndex = type_index;
+      TRY_LOG_CALL(
+         m_device_data.disp.AllocateMemory(m_device_data.device, &allocate_info, callbacks, &target.memory));
+      TRY_LOG_CALL(m_device_data.disp.BindBufferMemory(m_device_data.device, target.buffer, target.memory, 0));
+   }
+
+   return VK_SUCCESS;
+}
+
+void frame_capture::destroy_export_targets()
+{
+   const auto *callbacks = m_allocator.get_original_callbacks();
+   for (auto &target : m_export_targets)
+   {
+      m_device_data.disp.DestroyBuffer(m_device_data.device, target.buffer, callbacks);
+      m_device_data.disp.FreeMemory(m_device_data.device, target.memory, callbacks);
+   }
+   m_export_targets.clear();
+}
+
+frame_export_slot *frame_capture::get_export_slot(uint32_t index)
+{
+   auto *header = static_cast<frame_export_header *>(m_ring);
+   return reinterpret_cast<frame_export_slot *>(static_cast<uint8_t *>(m_ring) + header->slot_offset +
+                                                index * header->slot_size);
+}
+
+uint32_t frame_capture::claim_export_slot()
+{
+   const auto *header = static_cast<const frame_export_header *>(m_ring);
+
+   /* Take a free slot or, when the consumers are behind, replace the oldest frame they have not taken. Only the
+    * layer claims READY slots, a failed compare and swap means a consumer took the frame in the meantime and the
+    * slots are scanned again rather than dropping the frame. */
+   while (true)
+   {
+      uint32_t oldest_ready = NO_SLOT;
+      for (uint32_t i = 0; i < header->slot_count; i++)
+      {
+         frame_export_slot *slot = get_export_slot(i);
+         uint32_t state = slot->state.load(std::memory_order_acquire);
+         if (state == FRAME_EXPORT_SLOT_FREE)
+         {
+            /* Consumers never change a FREE slot. */
+            slot->state.store(FRAME_EXPORT_SLOT_WRITING, std::memory_order_relaxed);
+            return i;
+         }
+         if (state == FRAME_EXPORT_SLOT_READY &&
+             (oldest_ready == NO_SLOT || slot->frame < get_export_slot(oldest_ready)->frame))
+         {
+            oldest_ready = i;
+         }
+      }
+      if (oldest_ready == NO_SLOT)
+      {
+         return NO_SLOT;
+      }
+
+      uint32_t expected = FRAME_EXPORT_SLOT_READY;
+      if (get_export_slot(oldest_ready)
+             ->state.compare_exchange_strong(expected, FRAME_EXPORT_SLOT_WRITING, std::memory_order_acquire))
+      {
+         return oldest_ready;
+      }
+   }
+}
+
+void frame_capture::publish_export_slot(uint32_t index, const pending_frame &frame)
+{
+   auto *header = static_cast<frame_export_header *>(m_ring);
+   frame_export_slot *slot = get_export_slot(index);
+   slot->frame = m_frame_count;
+   slot->present_id = frame.present_id;
+   slot->time_ns = frame.time_ns;
+   slot->state.store(FRAME_EXPORT_SLOT_READY, std::memory_order_release);
+
+   header->frames_written.store(m_frame_count + 1, std::memory_order_release);
+   header->frame_futex.fetch_add(1, std::memory_order_release);
+   futex_wake_all(header->frame_futex);
+}
+
+VkResult frame_capture::create_command_buffers(uint32_t queue_family_index)
+{
+   VkCommandPoolCreateInfo pool_info = {};
+   pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+   pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+   pool_info.queueFamilyIndex = queue_family_index;
+   TRY_LOG_CALL(m_device_data.disp.CreateCommandPool(m_device_data.device, &pool_info,
+                                                     m_allocator.get_original_callbacks(), &m_command_pool));
+   m_queue_family_index = queue_family_index;
+
+   for (uint32_t i = 0; i < m_slot_count; i++)
+   {
+      VkCommandBufferAllocateInfo allocate_info = {};
+      allocate_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+      allocate_info.commandPool = m_command_pool;
+      allocate_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+      allocate_info.commandBufferCount = 1;
+      TRY_LOG_CALL(
+         m_device_data.disp.AllocateCommandBuffers(m_device_data.device, &allocate_info, &m_slots[i].command_buffer));
+      /* Command buffers are dispatchable, they need the loader dispatch table of the device. */
+      TRY_LOG_CALL(m_device_data.SetDeviceLoaderData(m_device_data.device, m_slots[i].command_buffer));
+   }
+
+   return VK_SUCCESS;
+}
+
+VkResult frame_capture::record_copy(const readback_slot &slot, VkBuffer buffer, VkImage image)
+{
+   VkCommandBuffer command_buffer = slot.command_buffer;
+   TRY_LOG_CALL(m_device_data.disp.ResetCommandBuffer(command_buffer, 0));
+
+   VkCommandBufferBeginInfo begin_info = {};
+   begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+   begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+   TRY_LOG_CALL(m_device_data.disp.BeginCommandBuffer(command_buffer, &begin_info));
+
+   /* The wait semaphores make the rendering available to the transfer stage. */
+   VkImageMemoryBarrier image_barrier = {};
+   image_barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+   image_barrier.srcAccessMask = 0;
+   image_barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+   image_barrier.oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+   image_barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+   image_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+   image_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+   image_barrier.image = image;
+   image_barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+   m_device_data.disp.CmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1,
+                                         &image_barrier);
+
+   VkBufferImageCopy region = {};
+   region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+   region.imageExtent = { m_width, m_height, 1 };
+   m_device_data.disp.CmdCopyImageToBuffer(command_buffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, buffer, 1,
+                                           &region);
+
+   /* Give the image back in the layout it was presented in and make the copy visible to the host. */
+   image_barrier.srcAccessMask = 0;
+   image_barrier.dstAccessMask = 0;
+   image_barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+   image_barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+   VkBufferMemoryBarrier buffer_barrier = {};
+   buffer_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+   buffer_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+   buffer_barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+   buffer_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+   buffer_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+   buffer_barrier.buffer = buffer;
+   buffer_barrier.size = VK_WHOLE_SIZE;
+   m_device_data.disp.CmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                                         VK_PIPELINE_STAGE_HOST_BIT | VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0,
+                                         nullptr, 1, &buffer_barrier, 1, &image_barrier);
+
+   return m_device_data.disp.EndCommandBuffer(command_buffer);
+}
+
+uint32_t frame_capture::acquire_slot()
+{
+   auto lock = util::unique_lock<util::mutex>(m_lock);
+   while (m_free_slots.size() == 0)
+   {
+      m_cond.wait(lock);
+   }
+   return *m_free_slots.pop_front();
+}
+
+VkResult frame_capture::submit_copy(VkQueue queue, VkImage image, const queue_submit_semaphores &semaphores,
+                                    uint32_t &slot_index)
+{
+   /* The previous present of the image failed before its copy was written. */
+   if (slot_index != NO_SLOT)
+   {
+      release(slot_index);
+      slot_index = NO_SLOT;
+   }
+
+   if (queue != m_last_queue)
+   {
+      uint32_t queue_family_index = 0;
+      bool found = m_device_data.get_queue_family_index(queue, queue_family_index);
+      if (found && m_command_pool == VK_NULL_HANDLE)
+      {
+         TRY_LOG_CALL(create_command_buffers(queue_family_index));
+      }
+
+      m_last_queue = queue;
+      m_last_queue_supported = found && queue_family_index == m_queue_family_index;
+      if (!m_last_queue_supported)
+      {
+         WSI_LOG_WARNING("Frames presented to queue %p are not captured, the capture uses queue family %u.",
+                         reinterpret_cast<void *>(queue), m_queue_family_index);
+      }
+   }
+   if (!m_last_queue_supported)
+   {
+      return VK_SUCCESS;
+   }
+
+   uint32_t index = acquire_slot();
+   VkBuffer buffer = m_slots[index].buffer;
+   if (!m_export_targets.empty())
+   {
+      uint32_t export_index = claim_export_slot();
+      if (export_index == NO_SLOT)
+      {
+         /* All the slots are held by consumers, the frame is not exported rather than stalling the presents. */
+         static_cast<frame_export_header *>(m_ring)->frames_dropped.fetch_add(1, std::memory_order_relaxed);
+         release(index);
+         return VK_SUCCESS;
+      }
+      m_slots[index].export_index = export_index;
+      buffer = m_export_targets[export_index].buffer;
+   }
+
+   VkResult result = record_copy(m_slots[index], buffer, image);
+   if (result == VK_SUCCESS)
+   {
+      util::vector<VkPipelineStageFlags> wait_stages{ util::allocator(m_allocator,
+                                                                      VK_SYSTEM_ALLOCATION_SCOPE_COMMAND) };
+      if (!wait_stages.try_resize(semaphores.wait_semaphores_count, VK_PIPELINE_STAGE_TRANSFER_BIT))
+      {
+         result = VK_ERROR_OUT_OF_HOST_MEMORY;
+      }
+      else
+      {
+         VkSubmitInfo submit_info = {};
+         submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+         submit_info.waitSemaphoreCount = semaphores.wait_semaphores_count;
+         submit_info.pWaitSemaphores = semaphores.wait_semaphores;
+         submit_info.pWaitDstStageMask = wait_stages.data();
+         submit_info.commandBufferCount = 1;
+         submit_info.pCommandBuffers = &m_slots[index].command_buffer;
+         result = m_device_data.disp.QueueSubmit(queue, 1, &submit_info, VK_NULL_HANDLE);
+      }
+   }
+
+   if (result != VK_SUCCESS)
+   {
+      release(index);
+      return result;
+   }
+
+   slot_index = index;
+   return VK_SUCCESS;
+}
+
+void frame_capture::write(uint32_t slot_index, uint64_t present_id, uint64_t time_ns)
+{
+   {
+      util::lock_guard<util::mutex> lock(m_lock);
+      /* There are as many entries as slots, it cannot overflow. */
+      bool pushed = m_pending_frames.push_back(pending_frame{ slot_index, present_id, time_ns });
+      assert(pushed);
+      (void)pushed;
+   }
+   m_cond.notify_all();
+}
+
+void frame_capture::release(uint32_t slot_index)
+{
+   auto &slot = m_slots[slot_index];
+   if (slot.export_index != NO_SLOT)
+   {
+      get_export_slot(slot.export_index)->state.store(FRAME_EXPORT_SLOT_FREE, std::memory_order_release);
+      slot.export_index = NO_SLOT;
+   }
+
+   {
+      util::lock_guard<util::mutex> lock(m_lock);
+      bool pushed = m_free_slots.push_back(slot_index);
+      assert(pushed);
+      (void)pushed;
+   }
+   m_cond.notify_all();
+}
+
+void frame_capture::writer_thread()
+{
+   auto lock = util::unique_lock<util::mutex>(m_lock);
+   while (true)
+   {
+      std::optional<pending_frame> frame = m_pending_frames.pop_front();
+      if (!frame.has_value())
+      {
+         /* Stop once all the frames handed over before the destruction are written. */
+         if (!m_run)
+         {
+            break;
+         }
+         m_cond.wait(lock);
+         continue;
+      }
+
+      lock.unlock();
+      write_frame(*frame);
+      lock.lock();
+
+      m_free_slots.push_back(frame->slot_index);
+      m_cond.notify_all();
+   }
+}
+
+void frame_capture::write_frame(const pending_frame &frame)
+{
+   auto &slot = m_slots[frame.slot_index];
+   if (m_non_coherent)
+   {
+      VkMappedMemoryRange range = {};
+      range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+      range.memory = slot.memory;
+      range.size = VK_WHOLE_SIZE;
+      m_device_data.disp.InvalidateMappedMemoryRanges(m_device_data.device, 1, &range);
+   }
+
+   switch (get_config().format)
+   {
+   case capture_format::ppm:
+      write_ppm(slot.mapped, frame);
+      break;
+   case capture_format::y4m:
+      write_y4m(slot.mapped);
+      break;
+   case capture_format::ring:
+      write_ring(slot.mapped, frame);
+      break;
+   case capture_format::shared_export:
+      write_export(slot, frame);
+      break;
+   }
+   m_frame_count++;
+}
+
+void frame_capture::write_ppm(const uint8_t *pixels, const pending_frame &frame)
+{
+   char path[PATH_MAX];
+   std::snprintf(path, sizeof(path), "%s/swapchain%u_%06" PRIu64 ".ppm", get_config().directory, m_capture_id,
+                 m_frame_count);
+   std::FILE *file = std::fopen(path, "wb");
+   if (file == nullptr)
+   {
+      WSI_LOG_WARNING("Failed to open %s: %s", path, std::strerror(errno));
+      return;
+   }
+
+   std::fprintf(file, "P6\n# present_id=%" PRIu64 " time_ns=%" PRIu64 "\n%u %u\n255\n", frame.present_id,
+                frame.time_ns, m_width, m_height);
+
+   const size_t red = m_bgra ? 2 : 0;
+   const size_t blue = m_bgra ? 0 : 2;
+   uint8_t *row = m_conversion.data();
+   for (uint32_t y = 0; y < m_height; y++)
+   {
+      const uint8_t *src = pixels + static_cast<size_t>(y) * m_width * 4;
+      for (uint32_t x = 0; x < m_width; x++, src += 4)
+      {
+         row[x * 3] = src[red];
+         row[x * 3 + 1] = src[1];
+         row[x * 3 + 2] = src[blue];
+      }
+      std::fwrite(row, 3, m_width, file);
+   }
+   std::fclose(file);
+}
+
+void frame_capture::write_y4m(const uint8_t *pixels)
+{
+   /* BT.601 limited range, the default of YUV4MPEG2 readers. */
+   const size_t pixel_count = static_cast<size_t>(m_width) * m_height;
+   const size_t red = m_bgra ? 2 : 0;
+   const size_t blue = m_bgra ? 0 : 2;
+   uint8_t *y_plane = m_conversion.data();
+   uint8_t *cb_plane = y_plane + pixel_count;
+   uint8_t *cr_plane = cb_plane + pixel_count;
+   for (size_t i = 0; i < pixel_count; i++, pixels += 4)
+   {
+      int r = pixels[red];
+      int g = pixels[1];
+      int b = pixels[blue];
+      y_plane[i] = static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+      cb_plane[i] = static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+      cr_plane[i] = static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+   }
+
+   std::fputs("FRAME\n", m_stream);
+   std::fwrite(m_conversion.data(), 1, pixel_count * 3, m_stream);
+}
+
+void frame_capture::write_ring(const uint8_t *pixels, const pending_frame &frame)
+{
+   auto *header = static_cast<frame_ring_header *>(m_ring);
+   auto *slot = reinterpret_cast<frame_ring_slot *>(static_cast<uint8_t *>(m_ring) + sizeof(frame_ring_header) +
+                                                    (m_frame_count % header->slot_count) * header->slot_size);
+
+   slot->sequence.store(2 * m_frame_count + 1, std::memory_order_relaxed);
+   std::atomic_thread_fence(std::memory_order_release);
+
+   slot->present_id = frame.present_id;
+   slot->time_ns = frame.time_ns;
+   auto *dst = reinterpret_cast<uint8_t *>(slot + 1);
+   const size_t pixel_count = static_cast<size_t>(m_width) * m_height;
+   if (!m_bgra)
+   {
+      std::memcpy(dst, pixels, pixel_count * 4);
+   }
+   else
+   {
+      for (size_t i = 0; i < pixel_count; i++, pixels += 4, dst += 4)
+      {
+         dst[0] = pixels[2];
+         dst[1] = pixels[1];
+         dst[2] = pixels[0];
+         dst[3] = pixels[3];
+      }
+   }
+
+   slot->sequence.store(2 * m_frame_count + 2, std::memory_order_release);
+   header->frames_written.store(m_frame_count + 1, std::memory_order_release);
+}
+
+void frame_capture::write_export(readback_slot &slot, const pending_frame &frame)
+{
+   /* The copy already wrote the pixels to the slot claimed by the present. */
+   if (slot.export_index != NO_SLOT)
+   {
+      publish_export_slot(slot.export_index, frame);
+      slot.export_index = NO_SLOT;
+      return;
+   }
+
+   uint32_t index = claim_export_slot();
+   if (index == NO_SLOT)
+   {
+      /* All the slots are held by consumers, the frame is not exported rather than stalling the presents. */
+      static_cast<frame_export_header *>(m_ring)->frames_dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+   }
+
+   const auto *header = static_cast<const frame_export_header *>(m_ring);
+   std::memcpy(reinterpret_cast<uint8_t *>(get_export_slot(index)) + header->pixel_offset, slot.mapped,
+               static_cast<size_t>(m_width) * m_height * 4);
+   publish_export_slot(index, frame);
+}
+
+} /* namespace headless */
+} /* namespace wsi */
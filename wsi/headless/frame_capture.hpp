@@ -0,0 +1,355 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file frame_capture.hpp
+ *
+ * @brief Contains the capture of the images presented to a headless swapchain.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+#include <vulkan/vulkan.h>
+
+#include <util/custom_allocator.hpp>
+#include <util/instrumented_mutex.hpp>
+#include <util/ring_buffer.hpp>
+#include <wsi/synchronization.hpp>
+
+namespace layer
+{
+class device_private_data;
+} /* namespace layer */
+
+namespace wsi
+{
+namespace headless
+{
+
+/**
+ * @brief Header of the ring file written with VULKAN_WSI_HEADLESS_CAPTURE_FORMAT=ring.
+ *
+ * The header is followed by slot_count slots of slot_size bytes. Each slot starts with a
+ * @ref frame_ring_slot followed by width * height RGBA8 pixels. Frame n is written to slot n % slot_count.
+ */
+struct frame_ring_header
+{
+   /* FRAME_RING_MAGIC. */
+   uint32_t magic;
+   /* FRAME_RING_VERSION. */
+   uint32_t version;
+   uint32_t width;
+   uint32_t height;
+   uint32_t slot_count;
+   uint32_t reserved;
+   uint64_t slot_size;
+   /* Number of frames completely written to the file. */
+   std::atomic<uint64_t> frames_written;
+};
+
+/**
+ * @brief Header of a slot of the ring file.
+ */
+struct frame_ring_slot
+{
+   /* 2 * n + 1 while frame n is being written, 2 * n + 2 once it is complete. A reader copying a frame checks that
+    * the sequence is even and unchanged after the copy. */
+   std::atomic<uint64_t> sequence;
+   /* Present ID of the frame, 0 if the present had none. */
+   uint64_t present_id;
+   /* Time the frame was presented, in nanoseconds of CLOCK_MONOTONIC. */
+   uint64_t time_ns;
+   uint64_t reserved;
+};
+
+static constexpr uint32_t FRAME_RING_MAGIC = 0x52465357; /* "WSFR" */
+static constexpr uint32_t FRAME_RING_VERSION = 1;
+
+/**
+ * @brief Header of the export file written with VULKAN_WSI_HEADLESS_CAPTURE_FORMAT=export.
+ *
+ * The slots start slot_offset bytes into the file and are slot_size bytes apart. Each slot starts with a
+ * @ref frame_export_slot, its pixels start pixel_offset bytes into the slot and are height rows of stride bytes, in
+ * the format of the swapchain. Unlike the ring file, a consumer can use the pixels in place: it takes a READY slot
+ * by moving it to HELD with a compare and swap and gives it back by storing FREE. The layer never writes to a HELD
+ * slot, when all the slots are held the frames are dropped.
+ *
+ * When the device supports VK_EXT_external_memory_host, the pixels of the slots are aligned for import and the
+ * presented images are copied straight to them by the GPU, otherwise they go through a readback buffer.
+ *
+ * To wait for a frame, a consumer reads frame_futex and calls FUTEX_WAIT on it with the value read. The layer
+ * increments it and wakes the waiters after each frame. The export file is meant to be created in a shared memory
+ * file system such as /dev/shm.
+ */
+struct frame_export_header
+{
+   /* FRAME_EXPORT_MAGIC. */
+   uint32_t magic;
+   /* FRAME_EXPORT_VERSION. */
+   uint32_t version;
+   uint32_t width;
+   uint32_t height;
+   /* Size of a row of pixels in bytes. */
+   uint32_t stride;
+   /* VkFormat of the pixels. */
+   uint32_t format;
+   uint32_t slot_count;
+   /* Offset of the pixels from the start of a slot. */
+   uint32_t pixel_offset;
+   uint64_t slot_size;
+   /* Number of frames written to the file. */
+   std::atomic<uint64_t> frames_written;
+   /* Number of frames not exported because all the slots were held. */
+   std::atomic<uint64_t> frames_dropped;
+   /* Incremented after each frame is written. */
+   std::atomic<uint32_t> frame_futex;
+   /* Offset of the first slot from the start of the file. */
+   uint32_t slot_offset;
+};
+
+/**
+ * @brief States of a slot of the export file.
+ */
+enum frame_export_slot_state : uint32_t
+{
+   FRAME_EXPORT_SLOT_FREE = 0,
+   /* The layer is writing to the slot. */
+   FRAME_EXPORT_SLOT_WRITING = 1,
+   /* The slot holds a frame no consumer has taken. */
+   FRAME_EXPORT_SLOT_READY = 2,
+   /* A consumer is using the slot. */
+   FRAME_EXPORT_SLOT_HELD = 3,
+};
+
+/**
+ * @brief Header of a slot of the export file.
+ */
+struct frame_export_slot
+{
+   /* A frame_export_slot_state. */
+   std::atomic<uint32_t> state;
+   uint32_t reserved;
+   /* Index of the frame in the capture. */
+   uint64_t frame;
+   /* Present ID of the frame, 0 if the present had none. */
+   uint64_t present_id;
+   /* Time the frame was presented, in nanoseconds of CLOCK_MONOTONIC. */
+   uint64_t time_ns;
+};
+
+static constexpr uint32_t FRAME_EXPORT_MAGIC = 0x45465357; /* "WSFE" */
+static constexpr uint32_t FRAME_EXPORT_VERSION = 1;
+
+/**
+ * @brief Writes the images presented to a headless swapchain to disk.
+ *
+ * The capture is configured from the environment:
+ *  - VULKAN_WSI_HEADLESS_CAPTURE_DIR: directory the captures are written to, enables the capture.
+ *  - VULKAN_WSI_HEADLESS_CAPTURE_FORMAT: "ppm" for one PPM file per frame, the default, "y4m" for a YUV 4:4:4
+ *    stream, "ring" for a memory-mapped ring file of RGBA8 frames described by @ref frame_ring_header or "export"
+ *    for a file shared with consumer processes described by @ref frame_export_header.
+ *  - VULKAN_WSI_HEADLESS_CAPTURE_QUEUE: number of frames that can wait to be written, between 1 and
+ *    MAX_SLOTS. 3 by default.
+ *  - VULKAN_WSI_HEADLESS_CAPTURE_RING_FRAMES: number of frames in the ring or export file, 8 by default.
+ *
+ * Each present submits a copy of the image to a host visible buffer on the present queue, which the present fence
+ * of the image waits for. Once the image is presented, the buffer is handed over to a writer thread. The present
+ * only blocks when all the buffers are waiting to be written. The export file is the exception when its slots can
+ * be imported as device memory: the copy then writes to an export slot and the writer thread only publishes it.
+ */
+class frame_capture
+{
+public:
+   /**
+    * @brief Slot index of an image presented without a copy.
+    */
+   static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+   /**
+    * @brief Maximum number of readback buffers.
+    */
+   static constexpr uint32_t MAX_SLOTS = 8;
+
+   frame_capture(layer::device_private_data &device_data, const util::allocator &allocator);
+
+   frame_capture(const frame_capture &) = delete;
+   frame_capture &operator=(const frame_capture &) = delete;
+
+   /**
+    * @brief Write the pending frames and release the resources of the capture.
+    *
+    * The copies of all the images must have completed, i.e. the swapchain has waited the present fences.
+    */
+   ~frame_capture();
+
+   /**
+    * @brief Whether the capture is enabled in the environment.
+    */
+   static bool is_enabled();
+
+   /**
+    * @brief Whether the capture writes an export file, which the GPU can copy the frames to directly when the
+    *        device has VK_EXT_external_memory_host enabled.
+    */
+   static bool is_export_enabled();
+
+   /**
+    * @brief Create the readback buffers and the output file and start the writer thread.
+    *
+    * @param swapchain_create_info The create info of the swapchain.
+    *
+    * @return VK_SUCCESS on success, VK_ERROR_FORMAT_NOT_SUPPORTED if the image format cannot be captured,
+    *         VK_ERROR_INITIALIZATION_FAILED if the output cannot be created or another error code on failure.
+    */
+   VkResult init(const VkSwapchainCreateInfoKHR &swapchain_create_info);
+
+   /**
+    * @brief Submit a copy of a presented image to a readback buffer.
+    *
+    * Blocks until a readback buffer is available. The copy waits for the wait semaphores, the caller must signal the
+    * present fence of the image with a later submission to the same queue.
+    *
+    * @param queue            The present queue.
+    * @param image            The presented image, in the VK_IMAGE_LAYOUT_PRESENT_SRC_KHR layout.
+    * @param semaphores       The semaphores the present waits for, only the wait semaphores are used.
+    * @param[in,out] slot_index Readback slot of the image. A slot left by a previous present of the image is released.
+    *                         Set to NO_SLOT when the copy is skipped, the semaphores are then not waited for.
+    *
+    * @return VK_SUCCESS on success or an error code otherwise.
+    */
+   VkResult submit_copy(VkQueue queue, VkImage image, const queue_submit_semaphores &semaphores,
+                        uint32_t &slot_index);
+
+   /**
+    * @brief Hand over a copied image to the writer thread.
+    *
+    * @param slot_index The slot returned by @ref submit_copy, its copy must have completed.
+    * @param present_id The present ID of the frame.
+    * @param time_ns    The time the frame was presented.
+    */
+   void write(uint32_t slot_index, uint64_t present_id, uint64_t time_ns);
+
+   /**
+    * @brief Release a readback slot without writing it, e.g. because the image was not presented.
+    *
+    * @param slot_index The slot returned by @ref submit_copy.
+    */
+   void release(uint32_t slot_index);
+
+private:
+   struct readback_slot
+   {
+      VkBuffer buffer{ VK_NULL_HANDLE };
+      VkDeviceMemory memory{ VK_NULL_HANDLE };
+      VkDeviceSize memory_size{ 0 };
+      const uint8_t *mapped{ nullptr };
+      VkCommandBuffer command_buffer{ VK_NULL_HANDLE };
+      /* Export slot claimed for the frame, NO_SLOT when it is not copied to the export file directly. */
+      uint32_t export_index{ NO_SLOT };
+   };
+
+   /**
+    * @brief Buffer bound to the imported pixels of an export slot.
+    */
+   struct export_target
+   {
+      VkBuffer buffer{ VK_NULL_HANDLE };
+      VkDeviceMemory memory{ VK_NULL_HANDLE };
+   };
+
+   struct pending_frame
+   {
+      uint32_t slot_index;
+      uint64_t present_id;
+      uint64_t time_ns;
+   };
+
+   VkResult create_slot(readback_slot &slot, const VkPhysicalDeviceMemoryProperties &memory_properties);
+   VkResult create_command_buffers(uint32_t queue_family_index);
+   VkResult record_copy(const readback_slot &slot, VkBuffer buffer, VkImage image);
+   VkResult open_output();
+   VkResult map_output(const char *path);
+   uint32_t get_export_alignment();
+   VkResult import_export_slots();
+   void destroy_export_targets();
+   frame_export_slot *get_export_slot(uint32_t index);
+   uint32_t claim_export_slot();
+   void publish_export_slot(uint32_t index, const pending_frame &frame);
+   uint32_t acquire_slot();
+
+   void writer_thread();
+   void write_frame(const pending_frame &frame);
+   void write_ppm(const uint8_t *pixels, const pending_frame &frame);
+   void write_y4m(const uint8_t *pixels);
+   void write_ring(const uint8_t *pixels, const pending_frame &frame);
+   void write_export(readback_slot &slot, const pending_frame &frame);
+
+   layer::device_private_data &m_device_data;
+   const util::allocator m_allocator;
+
+   /* Sequence number of the swapchain, used to name the output files. */
+   uint32_t m_capture_id;
+   uint32_t m_width;
+   uint32_t m_height;
+   VkFormat m_format;
+   /* Whether the image has its red and blue channels swapped compared to RGBA. */
+   bool m_bgra;
+
+   uint32_t m_slot_count;
+   readback_slot m_slots[MAX_SLOTS];
+   bool m_non_coherent;
+
+   VkCommandPool m_command_pool;
+   uint32_t m_queue_family_index;
+   /* Last queue the images were presented to, to avoid looking up its family on every present. */
+   VkQueue m_last_queue;
+   bool m_last_queue_supported;
+
+   /* Protects the queues of slots and m_run. */
+   util::mutex m_lock;
+   util::condition_variable m_cond;
+   util::ring_buffer<uint32_t, MAX_SLOTS> m_free_slots;
+   util::ring_buffer<pending_frame, MAX_SLOTS> m_pending_frames;
+   bool m_run;
+   std::thread m_thread;
+
+   /* Output state, only accessed by the writer thread once it is started, except for the export slots claimed by
+    * the presents when the frames are copied to them directly. */
+   uint64_t m_frame_count;
+   std::FILE *m_stream;
+   void *m_ring;
+   size_t m_ring_size;
+   util::vector<uint8_t> m_conversion;
+
+   /* Buffers of the export slots, empty when the writer thread copies the frames to the export file. */
+   util::vector<export_target> m_export_targets;
+};
+
+} /* namespace headless */
+} /* namespace wsi */
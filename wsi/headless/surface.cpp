@@ -43,7 +43,8 @@ wsi::surface_properties &surface::get_properties()
 util::unique_ptr<swapchain_base> surface::allocate_swapchain(layer::device_private_data &dev_data,
                                                              const VkAllocationCallbacks *allocator)
 {
-   util::allocator alloc{ dev_data.get_allocator(), VK_SYSTEM_ALLOCATION_SCOPE_OBJECT, allocator };
+   util::allocator alloc{ dev_data.get_allocator(), VK_SYSTEM_ALLOCATION_SCOPE_OBJECT, allocator,
+                          util::memory_subsystem::swapchain };
    return util::unique_ptr<swapchain_base>(alloc.make_unique<swapchain>(dev_data, allocator));
 }
 
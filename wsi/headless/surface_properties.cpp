@@ -37,6 +37,7 @@
 
 #include "surface_properties.hpp"
 #include "surface.hpp"
+#include "virtual_display.hpp"
 #include "util/macros.hpp"
 
 namespace wsi
@@ -53,6 +54,7 @@ void surface_properties::populate_present_mode_compatibilities()
          VK_PRESENT_MODE_FIFO_KHR, 2, { VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_RELAXED_KHR } },
       present_mode_compatibility{
          VK_PRESENT_MODE_FIFO_RELAXED_KHR, 2, { VK_PRESENT_MODE_FIFO_RELAXED_KHR, VK_PRESENT_MODE_FIFO_KHR } },
+      present_mode_compatibility{ VK_PRESENT_MODE_MAILBOX_KHR, 1, { VK_PRESENT_MODE_MAILBOX_KHR } },
       present_mode_compatibility{
          VK_PRESENT_MODE_SHARED_DEMAND_REFRESH_KHR, 1, { VK_PRESENT_MODE_SHARED_DEMAND_REFRESH_KHR } },
       present_mode_compatibility{
@@ -65,6 +67,10 @@ void surface_properties::populate_present_mode_compatibilities()
 surface_properties::surface_properties()
    : m_supported_modes({ VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_RELAXED_KHR,
                          VK_PRESENT_MODE_SHARED_DEMAND_REFRESH_KHR, VK_PRESENT_MODE_SHARED_CONTINUOUS_REFRESH_KHR })
+   , m_display_supported_modes({ VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_RELAXED_KHR,
+                                 VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_SHARED_DEMAND_REFRESH_KHR,
+                                 VK_PRESENT_MODE_SHARED_CONTINUOUS_REFRESH_KHR })
+   , m_query_cache(util::allocator::get_generic())
 {
    populate_present_mode_compatibilities();
 }
@@ -78,16 +84,26 @@ surface_properties &surface_properties::get_instance()
 VkResult surface_properties::get_surface_capabilities(VkPhysicalDevice physical_device,
                                                       VkSurfaceCapabilitiesKHR *surface_capabilities)
 {
-   get_surface_capabilities_common(physical_device, surface_capabilities);
-   return VK_SUCCESS;
+   return m_query_cache.get_surface_capabilities(
+      physical_device, surface_capabilities, [physical_device](VkSurfaceCapabilitiesKHR *capabilities) {
+         get_surface_capabilities_common(physical_device, capabilities);
+         return VK_SUCCESS;
+      });
 }
 
 VkResult surface_properties::get_surface_capabilities(VkPhysicalDevice physical_device,
                                                       const VkPhysicalDeviceSurfaceInfo2KHR *surface_info,
                                                       VkSurfaceCapabilities2KHR *surface_capabilities)
 {
-   TRY(check_surface_present_mode_query_is_supported(surface_info, m_supported_modes));
-   get_surface_capabilities_common(physical_device, &surface_capabilities->surfaceCapabilities);
+   if (virtual_display::is_enabled())
+   {
+      TRY(check_surface_present_mode_query_is_supported(surface_info, m_display_supported_modes));
+   }
+   else
+   {
+      TRY(check_surface_present_mode_query_is_supported(surface_info, m_supported_modes));
+   }
+   TRY_LOG_CALL(get_surface_capabilities(physical_device, &surface_capabilities->surfaceCapabilities));
    m_compatible_present_modes.get_surface_present_mode_compatibility_common(surface_info, surface_capabilities);
 
    auto surface_scaling_capabilities = util::find_extension<VkSurfacePresentScalingCapabilitiesEXT>(
@@ -102,13 +118,12 @@ VkResult surface_properties::get_surface_capabilities(VkPhysicalDevice physical_
    return VK_SUCCESS;
 }
 
-static uint32_t fill_supported_formats(VkPhysicalDevice physical_device,
-                                       std::array<surface_format_properties, max_core_1_0_formats> &formats)
+static VkResult fill_supported_formats(VkPhysicalDevice physical_device,
+                                       util::vector<surface_format_properties> &formats)
 {
-   uint32_t format_count = 0;
    for (int id = 0; id < max_core_1_0_formats; id++)
    {
-      formats[format_count] = surface_format_properties{ static_cast<VkFormat>(id) };
+      surface_format_properties format{ static_cast<VkFormat>(id) };
 
       VkPhysicalDeviceImageFormatInfo2KHR format_info = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_FORMAT_INFO_2_KHR,
                                                           nullptr,
@@ -118,21 +133,24 @@ static uint32_t fill_supported_formats(VkPhysicalDevice physical_device,
                                                           VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
                                                           0 };
 
-      VkResult res = formats[format_count].check_device_support(physical_device, format_info);
+      VkResult res = format.check_device_support(physical_device, format_info);
 
       if (res == VK_SUCCESS)
       {
 #if WSI_IMAGE_COMPRESSION_CONTROL_SWAPCHAIN
          if (layer::instance_private_data::get(physical_device).has_image_compression_support(physical_device))
          {
-            formats[format_count].add_device_compression_support(physical_device, format_info);
+            format.add_device_compression_support(physical_device, format_info);
          }
 #endif
-         format_count++;
+         if (!formats.try_push_back(format))
+         {
+            return VK_ERROR_OUT_OF_HOST_MEMORY;
+         }
       }
    }
 
-   return format_count;
+   return VK_SUCCESS;
 }
 
 VkResult surface_properties::get_surface_formats(VkPhysicalDevice physical_device, uint32_t *surface_format_count,
@@ -140,11 +158,11 @@ VkResult surface_properties::get_surface_formats(VkPhysicalDevice physical_devic
                                                  VkSurfaceFormat2KHR *extended_surface_formats)
 {
    /* Construct a list of all formats supported by the driver - for color attachment */
-   std::array<surface_format_properties, max_core_1_0_formats> formats{};
-   auto format_count = fill_supported_formats(physical_device, formats);
-
-   return surface_properties_formats_helper(formats.begin(), formats.begin() + format_count, surface_format_count,
-                                            surface_formats, extended_surface_formats);
+   return m_query_cache.get_surface_formats(
+      physical_device, surface_format_count, surface_formats, extended_surface_formats,
+      [physical_device](util::vector<surface_format_properties> &formats) {
+         return fill_supported_formats(physical_device, formats);
+      });
 }
 
 VkResult surface_properties::get_surface_present_modes(VkPhysicalDevice physical_device, VkSurfaceKHR surface,
@@ -152,6 +170,10 @@ VkResult surface_properties::get_surface_present_modes(VkPhysicalDevice physical
 {
    UNUSED(physical_device);
    UNUSED(surface);
+   if (virtual_display::is_enabled())
+   {
+      return get_surface_present_modes_common(present_mode_count, present_modes, m_display_supported_modes);
+   }
    return get_surface_present_modes_common(present_mode_count, present_modes, m_supported_modes);
 }
 
@@ -160,7 +182,8 @@ CreateHeadlessSurfaceEXT(VkInstance instance, const VkHeadlessSurfaceCreateInfoE
                          const VkAllocationCallbacks *pAllocator, VkSurfaceKHR *pSurface) VWL_API_POST
 {
    auto &instance_data = layer::instance_private_data::get(instance);
-   util::allocator allocator{ instance_data.get_allocator(), VK_SYSTEM_ALLOCATION_SCOPE_OBJECT, pAllocator };
+   util::allocator allocator{ instance_data.get_allocator(), VK_SYSTEM_ALLOCATION_SCOPE_OBJECT, pAllocator,
+                              util::memory_subsystem::surface };
    auto wsi_surface = util::unique_ptr<wsi::surface>(allocator.make_unique<surface>());
    if (wsi_surface == nullptr)
    {
@@ -210,6 +233,11 @@ void surface_properties::get_surface_present_scaling_and_gravity(
    scaling_capabilities->supportedPresentGravityY = 0;
 }
 
+void surface_properties::invalidate_query_cache()
+{
+   m_query_cache.invalidate();
+}
+
 bool surface_properties::is_compatible_present_modes(VkPresentModeKHR present_mode_a, VkPresentModeKHR present_mode_b)
 {
    return m_compatible_present_modes.is_compatible_present_modes(present_mode_a, present_mode_b);
@@ -28,6 +28,7 @@
 #include <vulkan/vulkan.h>
 #include <wsi/surface_properties.hpp>
 #include <wsi/compatible_present_modes.hpp>
+#include <wsi/surface_query_cache.hpp>
 namespace wsi
 {
 namespace headless
@@ -62,6 +63,8 @@ public:
 
    bool is_compatible_present_modes(VkPresentModeKHR present_mode_a, VkPresentModeKHR present_mode_b) override;
 
+   void invalidate_query_cache() override;
+
 #if VULKAN_WSI_LAYER_EXPERIMENTAL
    void get_present_timing_surface_caps(VkPresentTimingSurfaceCapabilitiesEXT *present_timing_surface_caps) override;
 #endif
@@ -70,8 +73,14 @@ private:
    /* List of supported presentation modes */
    std::array<VkPresentModeKHR, 4> m_supported_modes;
 
+   /* List of supported presentation modes when the simulated display is enabled, which is needed for MAILBOX */
+   std::array<VkPresentModeKHR, 5> m_display_supported_modes;
+
    /* Stores compatible presentation modes */
-   compatible_present_modes<4> m_compatible_present_modes;
+   compatible_present_modes<5> m_compatible_present_modes;
+
+   /* Cached results of the capability and format queries */
+   surface_query_cache m_query_cache;
 
    void populate_present_mode_compatibilities() override;
 
@@ -31,7 +31,11 @@
 #include <cassert>
 #include <cstdlib>
 
+#include <util/helpers.hpp>
+#include <util/log.hpp>
+#include <util/memory_accounting.hpp>
 #include <util/timed_semaphore.hpp>
+#include <util/trace.hpp>
 
 #include "swapchain.hpp"
 
@@ -40,15 +44,8 @@ namespace wsi
 namespace headless
 {
 
-struct image_data
-{
-   /* Device memory backing the image. */
-   VkDeviceMemory memory{};
-   fence_sync present_fence;
-};
-
 swapchain::swapchain(layer::device_private_data &dev_data, const VkAllocationCallbacks *pAllocator)
-   : wsi::swapchain_base(dev_data, pAllocator)
+   : wsi::typed_swapchain<swapchain, image_data>(dev_data, pAllocator)
 #if WSI_IMAGE_COMPRESSION_CONTROL_SWAPCHAIN
    , m_image_compression_control{}
 #endif
@@ -73,13 +70,45 @@ VkResult swapchain::init_platform(VkDevice device, const VkSwapchainCreateInfoKH
       use_presentation_thread = true;
    }
 
+   if (timeline_semaphore_sync::is_supported(m_device_data))
+   {
+      m_present_timeline = timeline_semaphore_sync::create(m_device_data);
+      if (!m_present_timeline.has_value())
+      {
+         return VK_ERROR_OUT_OF_HOST_MEMORY;
+      }
+   }
+
+   /* A shared presentable image is not presented in the PRESENT_SRC layout and is not handed over on each present. */
+   if (frame_capture::is_enabled() && swapchain_create_info->presentMode != VK_PRESENT_MODE_SHARED_DEMAND_REFRESH_KHR &&
+       swapchain_create_info->presentMode != VK_PRESENT_MODE_SHARED_CONTINUOUS_REFRESH_KHR)
+   {
+      m_capture = m_allocator.make_unique<frame_capture>(m_device_data, m_allocator);
+      if (m_capture == nullptr)
+      {
+         return VK_ERROR_OUT_OF_HOST_MEMORY;
+      }
+
+      VkResult result = m_capture->init(*swapchain_create_info);
+      if (result == VK_ERROR_OUT_OF_HOST_MEMORY)
+      {
+         return result;
+      }
+      else if (result != VK_SUCCESS)
+      {
+         WSI_LOG_WARNING("The frames of swapchain %p are not captured, error %d.", reinterpret_cast<void *>(this),
+                         result);
+         m_capture.reset();
+      }
+   }
+
    return VK_SUCCESS;
 }
 
 VkResult swapchain::allocate_and_bind_swapchain_image(VkImageCreateInfo image_create, swapchain_image &image)
 {
    VkResult res = VK_SUCCESS;
-   const std::lock_guard<std::recursive_mutex> lock(m_image_status_mutex);
+   const util::lock_guard<util::recursive_mutex> lock(m_image_status_mutex);
 
    VkMemoryRequirements memory_requirements = {};
    m_device_data.disp.GetImageMemoryRequirements(m_device, image.image, &memory_requirements);
@@ -100,16 +129,13 @@ VkResult swapchain::allocate_and_bind_swapchain_image(VkImageCreateInfo image_cr
    mem_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
    mem_info.allocationSize = memory_requirements.size;
    mem_info.memoryTypeIndex = mem_type_idx;
-   image_data *data = nullptr;
-
    /* Create image_data */
-   data = m_allocator.create<image_data>(1);
+   image_data *data = create_image_data(image);
    if (data == nullptr)
    {
       m_device_data.disp.DestroyImage(m_device, image.image, get_allocation_callbacks());
       return VK_ERROR_OUT_OF_HOST_MEMORY;
    }
-   image.data = reinterpret_cast<void *>(data);
    image.status = wsi::swapchain_image::FREE;
 
    res = m_device_data.disp.AllocateMemory(m_device, &mem_info, get_allocation_callbacks(), &data->memory);
@@ -119,6 +145,8 @@ VkResult swapchain::allocate_and_bind_swapchain_image(VkImageCreateInfo image_cr
       destroy_image(image);
       return res;
    }
+   data->memory_size = mem_info.allocationSize;
+   util::memory_accounting::record_device_allocation(util::device_memory_kind::device_memory, data->memory_size);
 
    res = m_device_data.disp.BindImageMemory(m_device, image.image, data->memory, 0);
    assert(VK_SUCCESS == res);
@@ -128,14 +156,17 @@ VkResult swapchain::allocate_and_bind_swapchain_image(VkImageCreateInfo image_cr
       return res;
    }
 
-   /* Initialize presentation fence. */
-   auto present_fence = fence_sync::create(m_device_data);
-   if (!present_fence.has_value())
+   /* Initialize presentation fence, unless the presents are synchronized with the timeline semaphore. */
+   if (!m_present_timeline.has_value())
    {
-      destroy_image(image);
-      return VK_ERROR_OUT_OF_HOST_MEMORY;
+      auto present_fence = fence_sync::create(m_device_data);
+      if (!present_fence.has_value())
+      {
+         destroy_image(image);
+         return VK_ERROR_OUT_OF_HOST_MEMORY;
+      }
+      data->present_fence = std::move(present_fence.value());
    }
-   data->present_fence = std::move(present_fence.value());
 
    return res;
 }
@@ -143,6 +174,10 @@ VkResult swapchain::allocate_and_bind_swapchain_image(VkImageCreateInfo image_cr
 VkResult swapchain::create_swapchain_image(VkImageCreateInfo image_create_info, swapchain_image &image)
 {
    m_image_create_info = image_create_info;
+   if (m_capture != nullptr)
+   {
+      m_image_create_info.usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+   }
 #if WSI_IMAGE_COMPRESSION_CONTROL_SWAPCHAIN
    if (m_device_data.is_swapchain_compression_control_enabled())
    {
@@ -163,13 +198,52 @@ VkResult swapchain::create_swapchain_image(VkImageCreateInfo image_create_info,
 
 void swapchain::present_image(const pending_present_request &pending_present)
 {
+   auto *data = get_image_data(pending_present.image_index);
+
+   /* Without a simulated display the image is presented as soon as it is submitted. */
+   uint64_t latch_ns = util::get_monotonic_time_ns();
+   if (virtual_display::is_enabled() && m_present_mode != VK_PRESENT_MODE_SHARED_DEMAND_REFRESH_KHR &&
+       m_present_mode != VK_PRESENT_MODE_SHARED_CONTINUOUS_REFRESH_KHR)
+   {
+      latch_ns = m_display.schedule(m_present_mode, latch_ns);
+      virtual_display::wait_until(latch_ns);
+
+      if (m_present_mode == VK_PRESENT_MODE_MAILBOX_KHR && m_pending_buffer_pool.size() != 0)
+      {
+         /* A newer image was queued before the vertical blank, it replaces this one. The present ID is still
+          * signalled, the replacing present may not have one. */
+         m_display.drop(latch_ns);
+         m_statistics.record_dropped_frame();
+         if (m_capture != nullptr && data->capture_slot != frame_capture::NO_SLOT)
+         {
+            m_capture->release(data->capture_slot);
+            data->capture_slot = frame_capture::NO_SLOT;
+         }
+         util::trace::flow(util::trace::phase::flow_end, "present", this, pending_present.present_id);
+         set_present_id(pending_present.present_id);
+         unpresent_image(pending_present.image_index);
+         return;
+      }
+      m_display.latch(latch_ns);
+   }
+
+   util::trace::flow(util::trace::phase::flow_end, "present", this, pending_present.present_id);
+   if (swapchain_statistics::is_latency_measurement_enabled())
+   {
+      m_statistics.record_present_complete(m_swapchain_images[pending_present.image_index].timestamps, latch_ns);
+   }
+   if (m_capture != nullptr && data->capture_slot != frame_capture::NO_SLOT)
+   {
+      m_capture->write(data->capture_slot, pending_present.present_id, latch_ns);
+      data->capture_slot = frame_capture::NO_SLOT;
+   }
    set_present_id(pending_present.present_id);
    unpresent_image(pending_present.image_index);
 }
 
 void swapchain::destroy_image(wsi::swapchain_image &image)
 {
-   std::unique_lock<std::recursive_mutex> image_status_lock(m_image_status_mutex);
+   util::unique_lock<util::recursive_mutex> image_status_lock(m_image_status_mutex);
    if (image.status != wsi::swapchain_image::INVALID)
    {
       if (image.image != VK_NULL_HANDLE)
@@ -183,29 +257,58 @@ void swapchain::destroy_image(wsi::swapchain_image &image)
 
    image_status_lock.unlock();
 
-   if (image.data != nullptr)
+   if (has_image_data(image))
    {
-      auto *data = reinterpret_cast<image_data *>(image.data);
+      auto *data = get_image_data(image);
       if (data->memory != VK_NULL_HANDLE)
       {
          m_device_data.disp.FreeMemory(m_device, data->memory, get_allocation_callbacks());
+         util::memory_accounting::record_device_free(util::device_memory_kind::device_memory, data->memory_size);
          data->memory = VK_NULL_HANDLE;
       }
-      m_allocator.destroy(1, data);
-      image.data = nullptr;
+      destroy_image_data(image);
+   }
+}
+
+VkResult swapchain::set_present_sync_payload(image_data &data, VkQueue queue, const queue_submit_semaphores &semaphores,
+                                             const void *submission_pnext)
+{
+   if (m_present_timeline.has_value())
+   {
+      return m_present_timeline->set_payload(queue, semaphores, submission_pnext, data.present_point);
    }
+   return data.present_fence.set_payload(queue, semaphores, submission_pnext);
 }
 
 VkResult swapchain::image_set_present_payload(swapchain_image &image, VkQueue queue,
                                               const queue_submit_semaphores &semaphores, const void *submission_pnext)
 {
-   auto data = reinterpret_cast<image_data *>(image.data);
-   return data->present_fence.set_payload(queue, semaphores, submission_pnext);
+   auto data = get_image_data(image);
+   if (m_capture == nullptr)
+   {
+      return set_present_sync_payload(*data, queue, semaphores, submission_pnext);
+   }
+
+   TRY_LOG_CALL(m_capture->submit_copy(queue, image.image, semaphores, data->capture_slot));
+   if (data->capture_slot == frame_capture::NO_SLOT)
+   {
+      return set_present_sync_payload(*data, queue, semaphores, submission_pnext);
+   }
+
+   /* The copy has waited for the semaphores and the payload is signalled after it in submission order. */
+   queue_submit_semaphores payload_semaphores = semaphores;
+   payload_semaphores.wait_semaphores = nullptr;
+   payload_semaphores.wait_semaphores_count = 0;
+   return set_present_sync_payload(*data, queue, payload_semaphores, submission_pnext);
 }
 
 VkResult swapchain::image_wait_present(swapchain_image &image, uint64_t timeout)
 {
-   auto data = reinterpret_cast<image_data *>(image.data);
+   auto data = get_image_data(image);
+   if (m_present_timeline.has_value())
+   {
+      return m_present_timeline->wait_payload(data->present_point, timeout);
+   }
    return data->present_fence.wait_payload(timeout);
 }
 
@@ -215,7 +318,7 @@ VkResult swapchain::bind_swapchain_image(VkDevice &device, const VkBindImageMemo
    auto &device_data = layer::device_private_data::get(device);
 
    const wsi::swapchain_image &swapchain_image = m_swapchain_images[bind_sc_info->imageIndex];
-   VkDeviceMemory memory = reinterpret_cast<image_data *>(swapchain_image.data)->memory;
+   VkDeviceMemory memory = get_image_data(swapchain_image)->memory;
 
    return device_data.disp.BindImageMemory(device, bind_image_mem_info->image, memory, 0);
 }
@@ -34,18 +34,38 @@
 #include <vulkan/vulkan.h>
 #include <wsi/swapchain_base.hpp>
 
+#include "frame_capture.hpp"
+#include "virtual_display.hpp"
+
 namespace wsi
 {
 namespace headless
 {
 
+/**
+ * @brief Per-image data of the headless swapchain.
+ */
+struct image_data
+{
+   /* Device memory backing the image. */
+   VkDeviceMemory memory{};
+   /* Size of the device memory, for memory accounting. */
+   VkDeviceSize memory_size{};
+   /* Present payload fence, only created when the swapchain cannot synchronize its presents with a timeline. */
+   fence_sync present_fence;
+   /* Point of the swapchain's present timeline signalled by the last present payload, 0 if none. */
+   uint64_t present_point{ 0 };
+   /* Readback slot of the frame capture holding the copy of the last present, frame_capture::NO_SLOT if none. */
+   uint32_t capture_slot{ frame_capture::NO_SLOT };
+};
+
 /**
  * @brief Headless swapchain class.
  *
  * This class is mostly empty, because all the swapchain stuff is handled by the swapchain class,
  * which we inherit. This class only provides a way to create an image and page-flip ops.
  */
-class swapchain : public wsi::swapchain_base
+class swapchain final : public wsi::typed_swapchain<swapchain, image_data>
 {
 public:
    explicit swapchain(layer::device_private_data &dev_data, const VkAllocationCallbacks *pAllocator);
@@ -53,6 +73,8 @@ public:
    ~swapchain();
 
 protected:
+   friend class wsi::typed_swapchain<swapchain, image_data>;
+
    /**
     * @brief Platform specific init
     */
@@ -86,9 +108,12 @@ protected:
     *
     * It sends the next image for presentation to the presentation engine.
     *
+    * When the simulated display is enabled the image is latched on its vertical blanks according to the present
+    * mode, see @ref virtual_display.
+    *
     * @param pending_present Information on the pending present request.
     */
-   void present_image(const pending_present_request &pending_present) override;
+   void present_image(const pending_present_request &pending_present);
 
    /**
     * @brief Method to release a swapchain image
@@ -108,9 +133,9 @@ protected:
     * @return VK_SUCCESS on success or an error code otherwise.
     */
    VkResult image_set_present_payload(swapchain_image &image, VkQueue queue, const queue_submit_semaphores &semaphores,
-                                      const void *submission_pnext) override;
+                                      const void *submission_pnext);
 
-   VkResult image_wait_present(swapchain_image &image, uint64_t timeout) override;
+   VkResult image_wait_present(swapchain_image &image, uint64_t timeout);
 
    /**
     * @brief Bind image to a swapchain
@@ -126,6 +151,28 @@ protected:
                                  const VkBindImageMemorySwapchainInfoKHR *bind_sc_info) override;
 
 private:
+   /**
+    * @brief Simulated display pacing the presents, only used by the page flip thread.
+    */
+   virtual_display m_display;
+
+   /**
+    * @brief Capture of the presented images, nullptr when disabled.
+    */
+   util::unique_ptr<frame_capture> m_capture;
+
+   /**
+    * @brief Timeline semaphore signalled by the present payloads of all the images, empty when per-image fences are
+    *        used instead.
+    */
+   std::optional<timeline_semaphore_sync> m_present_timeline;
+
+   /**
+    * @brief Set the present payload of an image using the timeline semaphore if available, or its fence otherwise.
+    */
+   VkResult set_present_sync_payload(image_data &data, VkQueue queue, const queue_submit_semaphores &semaphores,
+                                     const void *submission_pnext);
+
 #if WSI_IMAGE_COMPRESSION_CONTROL_SWAPCHAIN
    VkImageCompressionControlEXT m_image_compression_control;
 #endif
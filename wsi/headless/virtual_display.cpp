@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file virtual_display.cpp
+ *
+ * @brief Contains the implementation of the simulated vertical blanking clock of the headless backend.
+ */
+
+#include "virtual_display.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include <util/clock.hpp>
+
+namespace wsi
+{
+namespace headless
+{
+
+namespace
+{
+
+/**
+ * @brief Display configuration, read once from the environment.
+ */
+struct display_config
+{
+   /* Refresh rate, the highest one of a variable refresh rate display. 0 when the display is disabled. */
+   uint32_t refresh_hz{ 0 };
+   /* Refresh period of a fixed rate display, shortest refresh period of a variable refresh rate display. */
+   uint64_t period_ns{ 0 };
+   /* Longest refresh period of a variable refresh rate display, 0 for a fixed rate display. */
+   uint64_t max_period_ns{ 0 };
+   /* Maximum deviation of a fixed rate vertical blank from its nominal time. */
+   uint64_t jitter_ns{ 0 };
+
+   display_config()
+   {
+      refresh_hz = static_cast<uint32_t>(read_env("VULKAN_WSI_HEADLESS_REFRESH_HZ"));
+      if (refresh_hz == 0)
+      {
+         return;
+      }
+      period_ns = util::NSEC_PER_SEC / refresh_hz;
+
+      uint64_t vrr_min_hz = read_env("VULKAN_WSI_HEADLESS_VRR_MIN_HZ");
+      if (vrr_min_hz != 0 && vrr_min_hz < refresh_hz)
+      {
+         max_period_ns = util::NSEC_PER_SEC / vrr_min_hz;
+      }
+
+      /* Keep the vertical blanks in order: each one deviates by less than half a period. */
+      jitter_ns = std::min(read_env("VULKAN_WSI_HEADLESS_JITTER_US") * util::NSEC_PER_USEC, (period_ns - 1) / 2);
+   }
+
+   static uint64_t read_env(const char *name)
+   {
+      uint64_t value = 0;
+      if (const char *env = std::getenv(name))
+      {
+         std::from_chars(env, env + std::strlen(env), value);
+      }
+      return value;
+   }
+};
+
+const display_config &get_config()
+{
+   static display_config config;
+   return config;
+}
+
+/**
+ * @brief Deviation of a fixed rate vertical blank from its nominal time.
+ *
+ * @param index  Index of the vertical blank.
+ * @param config The display configuration.
+ *
+ * @return Signed deviation in nanoseconds, within [-jitter_ns, jitter_ns].
+ */
+int64_t vblank_jitter(uint64_t index, const display_config &config)
+{
+   if (config.jitter_ns == 0)
+   {
+      return 0;
+   }
+
+   /* splitmix64 finalizer, spreads consecutive indices over the whole range. */
+   uint64_t hash = index + 0x9e3779b97f4a7c15ull;
+   hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+   hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+   hash ^= hash >> 31;
+
+   return static_cast<int64_t>(hash % (2 * config.jitter_ns + 1)) - static_cast<int64_t>(config.jitter_ns);
+}
+
+} /* namespace */
+
+virtual_display::virtual_display()
+   : m_epoch_ns(util::get_monotonic_time_ns() + get_config().period_ns)
+   , m_last_latch_ns(0)
+   , m_open_vblank_ns(0)
+{
+}
+
+bool virtual_display::is_enabled()
+{
+   return get_config().period_ns != 0;
+}
+
+uint32_t virtual_display::get_refresh_rate()
+{
+   return get_config().refresh_hz;
+}
+
+uint64_t virtual_display::next_vblank(uint64_t time_ns) const
+{
+   const auto &config = get_config();
+
+   if (config.max_period_ns != 0)
+   {
+      /* A variable refresh rate display starts scanning out as soon as an image is ready and the previous scanout
+       * has finished. When no image arrives within the longest period, the display refreshes on its own and the
+       * next image has to wait for that scanout to finish. */
+      if (m_last_latch_ns == 0)
+      {
+         return time_ns;
+      }
+      if (time_ns <= m_last_latch_ns + config.period_ns)
+      {
+         return m_last_latch_ns + config.period_ns;
+      }
+      if (time_ns <= m_last_latch_ns + config.max_period_ns)
+      {
+         return time_ns;
+      }
+      uint64_t self_refreshes = (time_ns - m_last_latch_ns) / config.max_period_ns;
+      return std::max(time_ns, m_last_latch_ns + self_refreshes * config.max_period_ns + config.period_ns);
+   }
+
+   /* The jitter is below half a period, so the vertical blanks are in order and the first one after time_ns is one
+    * of the next three nominal ones. */
+   uint64_t index = time_ns < m_epoch_ns ? 0 : (time_ns - m_epoch_ns) / config.period_ns;
+   for (;; index++)
+   {
+      uint64_t vblank_ns = m_epoch_ns + index * config.period_ns + vblank_jitter(index, config);
+      if (vblank_ns > time_ns)
+      {
+         return vblank_ns;
+      }
+   }
+}
+
+uint64_t virtual_display::schedule(VkPresentModeKHR present_mode, uint64_t now_ns)
+{
+   if (m_open_vblank_ns != 0)
+   {
+      uint64_t vblank_ns = m_open_vblank_ns;
+      m_open_vblank_ns = 0;
+      return std::max(now_ns, vblank_ns);
+   }
+
+   if (present_mode == VK_PRESENT_MODE_FIFO_RELAXED_KHR && m_last_latch_ns != 0 &&
+       next_vblank(m_last_latch_ns) < now_ns)
+   {
+      /* The image missed its vertical blank, flip immediately. */
+      return now_ns;
+   }
+
+   return next_vblank(std::max(now_ns, m_last_latch_ns));
+}
+
+void virtual_display::latch(uint64_t latch_ns)
+{
+   m_last_latch_ns = latch_ns;
+}
+
+void virtual_display::drop(uint64_t latch_ns)
+{
+   m_open_vblank_ns = latch_ns;
+}
+
+void virtual_display::wait_until(uint64_t time_ns)
+{
+   struct timespec ts = {};
+   ts.tv_sec = static_cast<time_t>(time_ns / util::NSEC_PER_SEC);
+   ts.tv_nsec = static_cast<long>(time_ns % util::NSEC_PER_SEC);
+   while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR)
+   {
+   }
+}
+
+} /* namespace headless */
+} /* namespace wsi */
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file virtual_display.hpp
+ *
+ * @brief Contains the simulated vertical blanking clock of the headless backend.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include <vulkan/vulkan.h>
+
+namespace wsi
+{
+namespace headless
+{
+
+/**
+ * @brief Simulated display paced by a vertical blanking clock.
+ *
+ * The display is configured from the environment:
+ *  - VULKAN_WSI_HEADLESS_REFRESH_HZ: refresh rate of the display. When unset or 0 the display is disabled and the
+ *    images are presented as soon as they are submitted.
+ *  - VULKAN_WSI_HEADLESS_VRR_MIN_HZ: lowest refresh rate of a variable refresh rate display. The refresh rate then
+ *    varies between this rate and VULKAN_WSI_HEADLESS_REFRESH_HZ.
+ *  - VULKAN_WSI_HEADLESS_JITTER_US: maximum deviation of each vertical blank of a fixed rate display from its
+ *    nominal time. The deviation is a deterministic function of the vertical blank index, so runs are reproducible.
+ *
+ * The display is owned by the page flip thread of a swapchain and is not thread safe.
+ */
+class virtual_display
+{
+public:
+   /**
+    * @brief Create a display whose first vertical blank is one refresh period from now.
+    */
+   virtual_display();
+
+   /**
+    * @brief Whether the headless presents are paced by a simulated display.
+    */
+   static bool is_enabled();
+
+   /**
+    * @brief Get the refresh rate of the display in Hz, the highest one of a variable refresh rate display.
+    *
+    * @return The refresh rate or 0 if the display is disabled.
+    */
+   static uint32_t get_refresh_rate();
+
+   /**
+    * @brief Compute the time the next present is latched by the display.
+    *
+    * In FIFO and MAILBOX modes at most one image is latched per vertical blank. In FIFO relaxed mode an image that
+    * missed the vertical blank following the previous latch is latched immediately, as a tearing flip would be.
+    * The time is not recorded until @ref latch or @ref drop is called.
+    *
+    * @param present_mode The present mode of the swapchain.
+    * @param now_ns       The current time in nanoseconds of CLOCK_MONOTONIC.
+    *
+    * @return The latch time in nanoseconds of CLOCK_MONOTONIC.
+    */
+   uint64_t schedule(VkPresentModeKHR present_mode, uint64_t now_ns);
+
+   /**
+    * @brief Record that an image was latched.
+    *
+    * @param latch_ns The time returned by @ref schedule.
+    */
+   void latch(uint64_t latch_ns);
+
+   /**
+    * @brief Record that the image scheduled for a vertical blank was replaced by a newer one before it was latched.
+    *
+    * The next @ref schedule call latches the newer image on the same vertical blank.
+    *
+    * @param latch_ns The time returned by @ref schedule.
+    */
+   void drop(uint64_t latch_ns);
+
+   /**
+    * @brief Block the calling thread until the given time.
+    *
+    * @param time_ns Absolute time in nanoseconds of CLOCK_MONOTONIC.
+    */
+   static void wait_until(uint64_t time_ns);
+
+private:
+   /**
+    * @brief Get the first vertical blank strictly after the given time.
+    */
+   uint64_t next_vblank(uint64_t time_ns) const;
+
+   /**
+    * @brief Time of the first vertical blank, all fixed rate vertical blanks are relative to it.
+    */
+   uint64_t m_epoch_ns;
+
+   /**
+    * @brief Time the last image was latched, 0 before the first present.
+    */
+   uint64_t m_last_latch_ns;
+
+   /**
+    * @brief Vertical blank whose image was dropped and that is still waiting for the replacing image, 0 if none.
+    */
+   uint64_t m_open_vblank_ns;
+};
+
+} /* namespace headless */
+} /* namespace wsi */
@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file present_capture.cpp
+ *
+ * @brief Contains the implementation of the capture of the present path events.
+ */
+
+#include "present_capture.hpp"
+
+#include <chrono>
+#include <cinttypes>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <system_error>
+#include <thread>
+
+#include "util/clock.hpp"
+#include "util/concurrent_ring_buffer.hpp"
+#include "util/log.hpp"
+
+namespace wsi
+{
+namespace capture
+{
+
+std::atomic<bool> g_enabled{ false };
+
+namespace
+{
+
+/**
+ * @brief Opens the capture file when the layer is loaded and closes it when it is unloaded.
+ *
+ * The threads recording events only push the records to a ring buffer, a background thread writes them to the file.
+ */
+struct capture_file
+{
+   static constexpr size_t RING_SIZE = 4096;
+   using record_ring = util::mpsc_ring_buffer<capture_record, RING_SIZE>;
+
+   capture_file()
+   {
+      const char *path = std::getenv("VULKAN_WSI_CAPTURE_FILE");
+      if (path == nullptr)
+      {
+         return;
+      }
+
+      records.reset(new (std::nothrow) record_ring());
+      if (records == nullptr)
+      {
+         WSI_LOG_ERROR("Failed to allocate the capture buffer.");
+         return;
+      }
+
+      file = std::fopen(path, "wb");
+      if (file == nullptr)
+      {
+         WSI_LOG_ERROR("Failed to open capture file %s.", path);
+         return;
+      }
+
+      const capture_header header = { CAPTURE_MAGIC, CAPTURE_VERSION, sizeof(capture_record), 0 };
+      if (std::fwrite(&header, sizeof(header), 1, file) != 1)
+      {
+         WSI_LOG_ERROR("Failed to write capture file %s.", path);
+         std::fclose(file);
+         file = nullptr;
+         return;
+      }
+      g_enabled.store(true, std::memory_order_relaxed);
+   }
+
+   ~capture_file()
+   {
+      if (file == nullptr)
+      {
+         return;
+      }
+
+      g_enabled.store(false, std::memory_order_relaxed);
+      {
+         std::lock_guard<std::mutex> guard(thread_lock);
+         thread_run = false;
+      }
+      thread_cond.notify_all();
+      if (thread.joinable())
+      {
+         thread.join();
+      }
+
+      std::lock_guard<std::mutex> guard(drain_lock);
+      drain();
+      std::fclose(file);
+      file = nullptr;
+   }
+
+   void push(const capture_record &record)
+   {
+      if (!synchronous.load(std::memory_order_relaxed))
+      {
+         std::call_once(thread_started, [this]() { start_thread(); });
+      }
+
+      if (synchronous.load(std::memory_order_relaxed))
+      {
+         std::lock_guard<std::mutex> guard(drain_lock);
+         std::fwrite(&record, sizeof(record), 1, file);
+      }
+      else if (!records->push_back(record))
+      {
+         dropped.fetch_add(1, std::memory_order_relaxed);
+      }
+   }
+
+   /**
+    * @brief Write the records pushed so far to the file. Must be called with drain_lock held.
+    *
+    * @return The number of records dropped since the previous call because the ring buffer was full.
+    */
+   uint64_t drain()
+   {
+      while (auto record = records->pop_front())
+      {
+         std::fwrite(&*record, sizeof(*record), 1, file);
+      }
+      return dropped.exchange(0, std::memory_order_relaxed);
+   }
+
+   void writer_thread()
+   {
+      constexpr auto WRITE_INTERVAL = std::chrono::milliseconds(10);
+
+      std::unique_lock<std::mutex> lock(thread_lock);
+      while (thread_run)
+      {
+         lock.unlock();
+         uint64_t dropped_records = 0;
+         {
+            std::lock_guard<std::mutex> guard(drain_lock);
+            dropped_records = drain();
+         }
+         if (dropped_records != 0)
+         {
+            WSI_LOG_WARNING("Capture buffer overflowed, %" PRIu64 " records were dropped.", dropped_records);
+         }
+         lock.lock();
+         thread_cond.wait_for(lock, WRITE_INTERVAL);
+      }
+   }
+
+   void start_thread()
+   {
+      try
+      {
+         thread = std::thread(&capture_file::writer_thread, this);
+      }
+      catch (const std::system_error &)
+      {
+         /* Write the records from the recording threads instead. */
+         std::lock_guard<std::mutex> guard(drain_lock);
+         drain();
+         synchronous.store(true, std::memory_order_relaxed);
+      }
+   }
+
+   std::unique_ptr<record_ring> records;
+   std::atomic<uint64_t> dropped{ 0 };
+   std::atomic<bool> synchronous{ false };
+
+   /* Serializes the consumers of the ring buffer and the writes to the file. */
+   std::mutex drain_lock;
+   std::FILE *file{ nullptr };
+
+   std::once_flag thread_started;
+   std::thread thread;
+   std::mutex thread_lock;
+   std::condition_variable thread_cond;
+   bool thread_run{ true };
+};
+
+capture_file g_capture;
+
+} /* namespace */
+
+void write(event type, const void *swapchain, uint16_t image_index, uint64_t present_id, uint32_t value)
+{
+   capture_record record = {};
+   record.timestamp_ns = util::get_monotonic_time_ns();
+   record.swapchain = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(swapchain));
+   record.present_id = present_id;
+   record.value = value;
+   record.image_index = image_index;
+   record.type = type;
+
+   g_capture.push(record);
+}
+
+void flush()
+{
+   if (!is_enabled())
+   {
+      return;
+   }
+
+   uint64_t dropped_records = 0;
+   {
+      std::lock_guard<std::mutex> guard(g_capture.drain_lock);
+      dropped_records = g_capture.drain();
+      std::fflush(g_capture.file);
+   }
+   if (dropped_records != 0)
+   {
+      WSI_LOG_WARNING("Capture buffer overflowed, %" PRIu64 " records were dropped.", dropped_records);
+   }
+}
+
+} /* namespace capture */
+} /* namespace wsi */
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file present_capture.hpp
+ *
+ * @brief Contains the capture of the present path events for offline replay.
+ *
+ * Capture is disabled by default. It is enabled by setting the VULKAN_WSI_CAPTURE_FILE environment variable
+ * to the path of the output file. The file starts with a capture_header followed by fixed size
+ * capture_record entries. The records are written by a background thread, in about the order of their
+ * timestamps: readers sort them by timestamp. The format only depends on fixed width integer types.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace wsi
+{
+namespace capture
+{
+
+constexpr uint32_t CAPTURE_MAGIC = 0x50435357; /* "WSCP" */
+constexpr uint32_t CAPTURE_VERSION = 1;
+
+/**
+ * @brief Image index of the records that do not refer to an image.
+ */
+constexpr uint16_t NO_IMAGE = UINT16_MAX;
+
+enum class event : uint8_t
+{
+   /* image_index is the number of images, value is the present mode. */
+   swapchain_create,
+   swapchain_destroy,
+   /* value is the time spent waiting for a free image, in microseconds. */
+   acquire,
+   /* vkQueuePresentKHR was called, value is the present mode. */
+   present,
+   /* The present request was handed over to the backend. */
+   present_submit,
+   /* The backend returned from presenting the image. */
+   present_latch,
+   /* The presentation engine reported the present request as completed. Only present_id is valid. */
+   present_complete,
+   /* The image was released by the presentation engine. */
+   image_release,
+   /* The presentation queue became empty. */
+   idle,
+   count,
+};
+
+struct capture_header
+{
+   uint32_t magic;
+   uint32_t version;
+   uint32_t record_size;
+   uint32_t reserved;
+};
+
+struct capture_record
+{
+   /* CLOCK_MONOTONIC timestamp. */
+   uint64_t timestamp_ns;
+   /* Opaque identifier of the swapchain, only unique between its create and destroy records. */
+   uint64_t swapchain;
+   uint64_t present_id;
+   uint32_t value;
+   uint16_t image_index;
+   event type;
+   uint8_t reserved;
+};
+
+static_assert(sizeof(capture_header) == 16, "Unexpected capture header layout");
+static_assert(sizeof(capture_record) == 32, "Unexpected capture record layout");
+
+/**
+ * @brief Whether capture is enabled, set once when the layer is loaded.
+ */
+extern std::atomic<bool> g_enabled;
+
+/**
+ * @brief Check if capture is enabled.
+ */
+inline bool is_enabled()
+{
+   return g_enabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Queue a record to be appended to the capture file.
+ *
+ * Must only be called if capture is enabled. Does not block on the file, a background thread writes the records.
+ */
+void write(event type, const void *swapchain, uint16_t image_index, uint64_t present_id, uint32_t value);
+
+/**
+ * @brief Write the queued records to the capture file from the calling thread.
+ */
+void flush();
+
+/**
+ * @brief Record a present path event if capture is enabled.
+ *
+ * @param type        The type of the event.
+ * @param swapchain   The swapchain the event belongs to.
+ * @param image_index The index of the image the event refers to, or NO_IMAGE.
+ * @param present_id  The present ID of the request the event refers to, 0 if there is none.
+ * @param value       Value depending on the type of the event.
+ */
+inline void record(event type, const void *swapchain, uint32_t image_index = NO_IMAGE, uint64_t present_id = 0,
+                   uint32_t value = 0)
+{
+   if (is_enabled())
+   {
+      write(type, swapchain, static_cast<uint16_t>(image_index), present_id, value);
+   }
+}
+
+} /* namespace capture */
+} /* namespace wsi */
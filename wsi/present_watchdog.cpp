@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file present_watchdog.cpp
+ *
+ * @brief Contains the implementation of the watchdog detecting swapchains whose presentation has stalled.
+ */
+
+#include "present_watchdog.hpp"
+#include "swapchain_base.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <system_error>
+#include <thread>
+
+namespace wsi
+{
+
+namespace
+{
+
+/**
+ * @brief State of the watchdog thread and list of the monitored swapchains.
+ */
+class watchdog
+{
+public:
+   watchdog()
+   {
+      if (const char *env = std::getenv("VULKAN_WSI_WATCHDOG_TIMEOUT_MS"))
+      {
+         uint64_t timeout_ms = 0;
+         std::from_chars(env, env + std::strlen(env), timeout_ms);
+         m_deadline_ns = timeout_ms * (util::NSEC_PER_SEC / 1000);
+      }
+
+      if (const char *env = std::getenv("VULKAN_WSI_WATCHDOG_ACTION"))
+      {
+         if (std::strcmp(env, "surface_lost") == 0)
+         {
+            m_action = VK_ERROR_SURFACE_LOST_KHR;
+         }
+         else if (std::strcmp(env, "out_of_date") == 0)
+         {
+            m_action = VK_ERROR_OUT_OF_DATE_KHR;
+         }
+      }
+   }
+
+   ~watchdog()
+   {
+      {
+         std::lock_guard<std::mutex> lock(m_lock);
+         m_run = false;
+      }
+      m_cond.notify_all();
+      if (m_thread.joinable())
+      {
+         m_thread.join();
+      }
+   }
+
+   bool is_enabled() const
+   {
+      return m_deadline_ns != 0;
+   }
+
+   uint64_t get_poll_period_ns() const
+   {
+      /* Check a few times per deadline, so a stall is detected at most a quarter of the deadline late. */
+      constexpr uint64_t MIN_PERIOD_NS = 10 * (util::NSEC_PER_SEC / 1000);
+      return std::max(m_deadline_ns / 4, MIN_PERIOD_NS);
+   }
+
+   void add(present_progress &progress, swapchain_base *owner)
+   {
+      std::lock_guard<std::mutex> lock(m_lock);
+      if (!m_thread.joinable())
+      {
+         try
+         {
+            m_thread = std::thread(&watchdog::thread_main, this);
+         }
+         catch (const std::system_error &)
+         {
+            return;
+         }
+         catch (const std::bad_alloc &)
+         {
+            return;
+         }
+      }
+
+      progress.owner = owner;
+      progress.prev = nullptr;
+      progress.next = m_head;
+      if (m_head != nullptr)
+      {
+         m_head->prev = &progress;
+      }
+      m_head = &progress;
+   }
+
+   void remove(present_progress &progress)
+   {
+      std::lock_guard<std::mutex> lock(m_lock);
+      if (progress.owner == nullptr)
+      {
+         return;
+      }
+
+      if (progress.prev != nullptr)
+      {
+         progress.prev->next = progress.next;
+      }
+      else
+      {
+         m_head = progress.next;
+      }
+      if (progress.next != nullptr)
+      {
+         progress.next->prev = progress.prev;
+      }
+      progress.owner = nullptr;
+      progress.prev = nullptr;
+      progress.next = nullptr;
+   }
+
+private:
+   void thread_main()
+   {
+      const auto period = std::chrono::nanoseconds(get_poll_period_ns());
+
+      std::unique_lock<std::mutex> lock(m_lock);
+      while (m_run)
+      {
+         m_cond.wait_for(lock, period);
+
+         uint64_t now = util::get_monotonic_time_ns();
+         for (present_progress *progress = m_head; progress != nullptr; progress = progress->next)
+         {
+            uint64_t completed = progress->completed.load(std::memory_order_relaxed);
+            if (progress->queued.load(std::memory_order_relaxed) <= completed ||
+                progress->reported_completed == completed)
+            {
+               continue;
+            }
+
+            uint64_t last_progress = progress->last_progress_ns.load(std::memory_order_relaxed);
+            if (now > last_progress && now - last_progress >= m_deadline_ns)
+            {
+               progress->reported_completed = completed;
+               progress->owner->handle_presentation_stall(now - last_progress, m_action);
+            }
+         }
+      }
+   }
+
+   uint64_t m_deadline_ns{ 0 };
+   VkResult m_action{ VK_SUCCESS };
+
+   std::mutex m_lock;
+   std::condition_variable m_cond;
+   std::thread m_thread;
+   bool m_run{ true };
+   present_progress *m_head{ nullptr };
+};
+
+watchdog &get_watchdog()
+{
+   static watchdog instance;
+   return instance;
+}
+
+} /* namespace */
+
+bool present_watchdog::is_enabled()
+{
+   return get_watchdog().is_enabled();
+}
+
+uint64_t present_watchdog::get_poll_period_ns()
+{
+   auto &instance = get_watchdog();
+   if (instance.is_enabled())
+   {
+      return instance.get_poll_period_ns();
+   }
+   /* Nothing moves a swapchain to an error state asynchronously, the period only bounds the wait. */
+   constexpr uint64_t DISABLED_PERIOD_NS = 250 * (util::NSEC_PER_SEC / 1000);
+   return DISABLED_PERIOD_NS;
+}
+
+void present_watchdog::add(present_progress &progress, swapchain_base *owner)
+{
+   auto &instance = get_watchdog();
+   if (instance.is_enabled())
+   {
+      instance.add(progress, owner);
+   }
+}
+
+void present_watchdog::remove(present_progress &progress)
+{
+   auto &instance = get_watchdog();
+   if (instance.is_enabled())
+   {
+      instance.remove(progress);
+   }
+}
+
+} /* namespace wsi */
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file present_watchdog.hpp
+ *
+ * @brief Contains the watchdog detecting swapchains whose presentation has stalled.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include <vulkan/vulkan.h>
+
+#include "util/clock.hpp"
+
+namespace wsi
+{
+
+class swapchain_base;
+
+/**
+ * @brief Progress of the present requests of a swapchain, monitored by the present watchdog.
+ */
+struct present_progress
+{
+   /**
+    * @brief Record a present request handed over to the presentation engine.
+    */
+   void record_queued()
+   {
+      /* Restart the deadline when the presentation engine was idle. */
+      if (queued.fetch_add(1, std::memory_order_relaxed) == completed.load(std::memory_order_relaxed))
+      {
+         last_progress_ns.store(util::get_monotonic_time_ns(), std::memory_order_relaxed);
+      }
+   }
+
+   /**
+    * @brief Record a present request completed by the backend, successfully or not.
+    */
+   void record_completed()
+   {
+      last_progress_ns.store(util::get_monotonic_time_ns(), std::memory_order_relaxed);
+      completed.fetch_add(1, std::memory_order_relaxed);
+   }
+
+   std::atomic<uint64_t> queued{ 0 };
+   std::atomic<uint64_t> completed{ 0 };
+   std::atomic<uint64_t> last_progress_ns{ 0 };
+
+   /* The fields below are protected by the watchdog lock. */
+
+   /* Number of completed presents when a stall was last reported, so each stall is reported once. */
+   uint64_t reported_completed{ UINT64_MAX };
+   swapchain_base *owner{ nullptr };
+   present_progress *prev{ nullptr };
+   present_progress *next{ nullptr };
+};
+
+/**
+ * @brief Watchdog detecting swapchains that did not complete a present within a deadline.
+ *
+ * The watchdog is configured with environment variables:
+ * - VULKAN_WSI_WATCHDOG_TIMEOUT_MS: deadline in milliseconds for a present request to complete. The watchdog is
+ *   disabled when the variable is not set or set to 0.
+ * - VULKAN_WSI_WATCHDOG_ACTION: what to do when a swapchain stalls besides dumping its state to stderr:
+ *   "none" (default), "surface_lost" or "out_of_date" to move the swapchain to the corresponding error state.
+ *
+ * A single thread, started with the first monitored swapchain, checks all the swapchains periodically.
+ */
+class present_watchdog
+{
+public:
+   /**
+    * @brief Check if the watchdog is enabled.
+    */
+   static bool is_enabled();
+
+   /**
+    * @brief Get the period at which the watchdog checks the swapchains.
+    *
+    * Threads blocking on the presentation use it to bound their waits, so they notice that the watchdog moved the
+    * swapchain to an error state.
+    *
+    * @return The period in nanoseconds, or a default period if the watchdog is disabled.
+    */
+   static uint64_t get_poll_period_ns();
+
+   /**
+    * @brief Start monitoring a swapchain. Does nothing if the watchdog is disabled.
+    *
+    * @param progress The progress of the swapchain.
+    * @param owner    The swapchain, which must stay valid until remove() is called.
+    */
+   static void add(present_progress &progress, swapchain_base *owner);
+
+   /**
+    * @brief Stop monitoring a swapchain. Does nothing if the swapchain is not monitored.
+    *
+    * @param progress The progress of the swapchain.
+    */
+   static void remove(present_progress &progress);
+};
+
+} /* namespace wsi */
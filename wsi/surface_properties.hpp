@@ -114,6 +114,14 @@ public:
 
    virtual bool is_compatible_present_modes(VkPresentModeKHR present_mode_a, VkPresentModeKHR present_mode_b) = 0;
 
+   /**
+    * @brief Drop any cached query results, as the presentation engine state they were derived from has changed.
+    */
+   virtual void invalidate_query_cache()
+   {
+      /* Nothing cached by default */
+   }
+
 #if VULKAN_WSI_LAYER_EXPERIMENTAL
    /**
     * @brief Get the present timing surface capabilities for the specific VkSurface type.
@@ -259,7 +267,8 @@ VkResult check_surface_present_mode_query_is_supported(const VkPhysicalDeviceSur
       VkPresentModeKHR present_mode = surface_present_mode->presentMode;
       if (std::find(modes.begin(), modes.end(), present_mode) == modes.end())
       {
-         WSI_LOG_ERROR("Querying surface capability support for a present mode that is not supported by the surface");
+         WSI_LOG_GENERAL_ERROR(
+            "Querying surface capability support for a present mode that is not supported by the surface");
          return VK_ERROR_OUT_OF_HOST_MEMORY;
       }
    }
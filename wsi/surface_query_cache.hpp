@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file surface_query_cache.hpp
+ *
+ * @brief Contains a cache for the results of the surface capability and format queries.
+ */
+
+#pragma once
+
+#include <mutex>
+
+#include <vulkan/vulkan.h>
+
+#include "util/custom_allocator.hpp"
+#include "util/helpers.hpp"
+#include "surface_properties.hpp"
+
+namespace wsi
+{
+
+/**
+ * @brief Cache of the surface capability and format query results.
+ *
+ * Applications commonly query the surface every frame or on every resize poll, while the results only change when
+ * the presentation engine state changes. The cache computes the results once through a backend supplied callback
+ * and serves the following queries by copying them out.
+ *
+ * Only the results for the most recently queried physical device are kept. Backends must call @ref invalidate
+ * whenever an event may change the results, e.g. a window configure event, a change in the formats advertised by
+ * the compositor or a display hotplug. The caches of the enabled platforms are also invalidated when an instance is
+ * destroyed, as its physical device handles may be reused by another instance.
+ */
+class surface_query_cache
+{
+public:
+   /**
+    * @brief Construct an empty cache.
+    *
+    * @param allocator The allocator used for the cached format list.
+    */
+   explicit surface_query_cache(const util::allocator &allocator)
+      : m_formats(allocator)
+   {
+   }
+
+   /**
+    * @brief Drop all cached results so that the next query recomputes them.
+    */
+   void invalidate()
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_formats_device = VK_NULL_HANDLE;
+      m_capabilities_device = VK_NULL_HANDLE;
+   }
+
+   /**
+    * @brief Implementation of vkGetPhysicalDeviceSurfaceFormatsKHR on top of the cache.
+    *
+    * @param physical_device          The physical device being queried.
+    * @param surface_formats_count    Pointer for setting the length of the supported formats.
+    * @param surface_formats          The supported formats by the surface.
+    * @param extended_surface_formats Extended surface formats, used by vkGetPhysicalDeviceSurfaceFormats2KHR.
+    * @param fill_formats             Callable with signature VkResult(util::vector<surface_format_properties> &),
+    *                                 which appends the supported formats to an empty vector on a cache miss.
+    *
+    * @return VK_SUCCESS or VK_INCOMPLETE on success, the error returned by @p fill_formats otherwise.
+    */
+   template <typename fill_fn>
+   VkResult get_surface_formats(VkPhysicalDevice physical_device, uint32_t *surface_formats_count,
+                                VkSurfaceFormatKHR *surface_formats, VkSurfaceFormat2KHR *extended_surface_formats,
+                                fill_fn &&fill_formats)
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_formats_device != physical_device)
+      {
+         m_formats_device = VK_NULL_HANDLE;
+         m_formats.clear();
+         VkResult result = fill_formats(m_formats);
+         if (result != VK_SUCCESS)
+         {
+            WSI_LOG_GENERAL_ERROR("Failed to query the surface formats.");
+            return result;
+         }
+         m_formats_device = physical_device;
+      }
+
+      return surface_properties_formats_helper(m_formats.begin(), m_formats.end(), surface_formats_count,
+                                               surface_formats, extended_surface_formats);
+   }
+
+   /**
+    * @brief Implementation of vkGetPhysicalDeviceSurfaceCapabilitiesKHR on top of the cache.
+    *
+    * @param physical_device      The physical device being queried.
+    * @param surface_capabilities The capabilities to fill.
+    * @param fill_capabilities    Callable with signature VkResult(VkSurfaceCapabilitiesKHR *), which computes the
+    *                             capabilities on a cache miss.
+    *
+    * @return VK_SUCCESS on success, the error returned by @p fill_capabilities otherwise.
+    */
+   template <typename fill_fn>
+   VkResult get_surface_capabilities(VkPhysicalDevice physical_device, VkSurfaceCapabilitiesKHR *surface_capabilities,
+                                     fill_fn &&fill_capabilities)
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_capabilities_device != physical_device)
+      {
+         m_capabilities_device = VK_NULL_HANDLE;
+         VkResult result = fill_capabilities(&m_capabilities);
+         if (result != VK_SUCCESS)
+         {
+            WSI_LOG_GENERAL_ERROR("Failed to query the surface capabilities.");
+            return result;
+         }
+         m_capabilities_device = physical_device;
+      }
+
+      *surface_capabilities = m_capabilities;
+      return VK_SUCCESS;
+   }
+
+private:
+   std::mutex m_mutex;
+
+   /** Physical device the cached formats belong to, VK_NULL_HANDLE if they are not valid. */
+   VkPhysicalDevice m_formats_device{ VK_NULL_HANDLE };
+   util::vector<surface_format_properties> m_formats;
+
+   /** Physical device the cached capabilities belong to, VK_NULL_HANDLE if they are not valid. */
+   VkPhysicalDevice m_capabilities_device{ VK_NULL_HANDLE };
+   VkSurfaceCapabilitiesKHR m_capabilities{};
+};
+
+} /* namespace wsi */
@@ -31,9 +31,11 @@
  * that is not specific to how images are created or presented.
  */
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cerrno>
+#include <cinttypes>
 #include <cstdio>
 #include <cstdlib>
 #include <system_error>
@@ -41,85 +43,96 @@
 #include <unistd.h>
 #include <vulkan/vulkan.h>
 
+#include "util/clock.hpp"
 #include "util/log.hpp"
 #include "util/helpers.hpp"
+#include "util/trace.hpp"
 
+#include "extension_chains.hpp"
+#include "present_capture.hpp"
 #include "swapchain_base.hpp"
 #include "wsi_factory.hpp"
 namespace wsi
 {
 
-void swapchain_base::page_flip_thread()
+bool swapchain_base::dequeue_present_request(pending_present_request &submit_info)
 {
-   auto &sc_images = m_swapchain_images;
-   VkResult vk_res = VK_SUCCESS;
-   uint64_t timeout = UINT64_MAX;
    constexpr uint64_t SEMAPHORE_TIMEOUT = 250000000; /* 250 ms. */
+   VkResult vk_res = VK_SUCCESS;
 
-   /* No mutex is needed for the accesses to m_page_flip_thread_run variable as after the variable is
-    * initialized it is only ever changed to false. The while loop will make the thread read the
-    * value repeatedly, and the combination of semaphores and thread joins will force any changes to
-    * the variable to be visible to this thread.
-    */
-   while (m_page_flip_thread_run)
+   if (m_present_mode == VK_PRESENT_MODE_SHARED_CONTINUOUS_REFRESH_KHR)
    {
-      pending_present_request submit_info{};
-      if (m_present_mode == VK_PRESENT_MODE_SHARED_CONTINUOUS_REFRESH_KHR)
+      /* In continuous mode the application will only make one presentation request,
+       * therefore the page flip semaphore will only be signalled once. */
+      if (m_first_present && (vk_res = m_page_flip_semaphore.wait(SEMAPHORE_TIMEOUT)) == VK_TIMEOUT)
       {
-         /* In continuous mode the application will only make one presentation request,
-          * therefore the page flip semaphore will only be signalled once. */
-         if (!m_first_present)
-         {
-            vk_res = VK_SUCCESS;
-         }
-         else if ((vk_res = m_page_flip_semaphore.wait(SEMAPHORE_TIMEOUT)) == VK_TIMEOUT)
-         {
-            /* Image is not ready yet. */
-            continue;
-         }
-         assert(vk_res == VK_SUCCESS);
-
-         /* For continuous mode there will be only one image in the swapchain.
-          * This image will always be used, and there is no pending state in this case. */
-         submit_info.image_index = 0;
+         /* Image is not ready yet. */
+         return false;
       }
-      else
-      {
-         /* Waiting for the page_flip_semaphore which will be signalled once there is an
-          * image to display.*/
-         if ((vk_res = m_page_flip_semaphore.wait(SEMAPHORE_TIMEOUT)) == VK_TIMEOUT)
-         {
-            /* Image is not ready yet. */
-            continue;
-         }
+      assert(vk_res == VK_SUCCESS);
 
-         /* We want to present the oldest queued for present image from our present queue,
-          * which we can find at the sc->pending_buffer_pool.head index. */
-         std::unique_lock<std::recursive_mutex> image_status_lock(m_image_status_mutex);
+      /* For continuous mode there will be only one image in the swapchain.
+       * This image will always be used, and there is no pending state in this case. */
+      submit_info.image_index = 0;
+      return true;
+   }
 
-         auto pending_submission = m_pending_buffer_pool.pop_front();
-         assert(pending_submission.has_value());
-         submit_info = *pending_submission;
-      }
+   /* Waiting for the page_flip_semaphore which will be signalled once there is an
+    * image to display.*/
+   if ((vk_res = m_page_flip_semaphore.wait(SEMAPHORE_TIMEOUT)) == VK_TIMEOUT)
+   {
+      /* Image is not ready yet. */
+      return false;
+   }
+   util::trace::instant("page_flip_thread_wakeup");
+
+   /* We want to present the oldest queued for present image from our present queue,
+    * which we can find at the front of m_pending_buffer_pool. */
+   auto pending_submission = m_pending_buffer_pool.pop_front();
+   assert(pending_submission.has_value());
+   submit_info = *pending_submission;
+   if (m_pending_buffer_pool.size() == 0)
+   {
+      capture::record(capture::event::idle, this);
+   }
+   return true;
+}
 
-      /* We may need to wait for the payload of the present sync of the oldest pending image to be finished. */
-      while ((vk_res = image_wait_present(sc_images[submit_info.image_index], timeout)) == VK_TIMEOUT)
-      {
-         WSI_LOG_WARNING("Timeout waiting for image's present fences, retrying..");
-      }
-      if (vk_res != VK_SUCCESS)
-      {
-         set_error_state(vk_res);
-         m_free_image_semaphore.post();
-         continue;
-      }
+uint64_t swapchain_base::begin_render_wait(const pending_present_request &submit_info)
+{
+   util::trace::flow(util::trace::phase::flow_step, "present", this, submit_info.present_id);
+   return util::get_monotonic_time_ns();
+}
 
-      call_present(submit_info);
-   }
+void swapchain_base::end_render_wait(const pending_present_request &submit_info, uint64_t wait_start)
+{
+   uint64_t wait_end = util::get_monotonic_time_ns();
+   m_statistics.record_image_wait_present(wait_end - wait_start);
+   m_swapchain_images[submit_info.image_index].timestamps.render_done_ns = wait_end;
 }
 
-void swapchain_base::call_present(const pending_present_request &pending_present)
+void swapchain_base::drop_present_request(VkResult result)
 {
+   set_error_state(result);
+   m_statistics.record_dropped_frame();
+   m_progress.record_completed();
+   m_free_image_semaphore.post();
+}
+
+uint64_t swapchain_base::begin_present(const pending_present_request &pending_present)
+{
+   util::trace::flow(util::trace::phase::flow_step, "present", this, pending_present.present_id);
+   uint64_t present_start = util::get_monotonic_time_ns();
+   capture::record(capture::event::present_submit, this, pending_present.image_index, pending_present.present_id);
+
+   /* Without the page flip thread the rendering is waited for by the backend, if at all. */
+   auto &timestamps = m_swapchain_images[pending_present.image_index].timestamps;
+   if (timestamps.render_done_ns < timestamps.queue_present_ns)
+   {
+      timestamps.render_done_ns = present_start;
+   }
+   timestamps.backend_submit_ns = present_start;
+
    /* First present of the swapchain. If it has an ancestor, wait until all the
     * pending buffers from the ancestor have been presented. */
    if (m_first_present)
@@ -131,15 +144,28 @@ void swapchain_base::call_present(const pending_present_request &pending_present
       }
 
       sem_post(&m_start_present_semaphore);
+   }
 
-      present_image(pending_present);
+   return present_start;
+}
 
-      m_first_present = false;
+void swapchain_base::end_present(const pending_present_request &pending_present, uint64_t present_start)
+{
+   m_first_present = false;
+
+   uint64_t present_end = util::get_monotonic_time_ns();
+   auto &timestamps = m_swapchain_images[pending_present.image_index].timestamps;
+   capture::record(capture::event::present_latch, this, pending_present.image_index, pending_present.present_id);
+   m_statistics.record_backend_present(present_end - present_start);
+   /* In continuous refresh mode the same request is presented repeatedly, only measure the first present. */
+   if (timestamps.queue_present_ns != 0)
+   {
+      m_statistics.record_present_to_latch(present_end - timestamps.queue_present_ns);
+      m_progress.record_completed();
    }
-   /* The swapchain has already started presenting. */
-   else
+   if (m_present_mode == VK_PRESENT_MODE_SHARED_CONTINUOUS_REFRESH_KHR)
    {
-      present_image(pending_present);
+      timestamps.queue_present_ns = 0;
    }
 }
 
@@ -179,7 +205,8 @@ VkResult swapchain_base::init_page_flip_thread()
 
 void swapchain_base::unpresent_image(uint32_t presented_index)
 {
-   std::unique_lock<std::recursive_mutex> image_status_lock(m_image_status_mutex);
+   capture::record(capture::event::image_release, this, presented_index);
+   util::unique_lock<util::recursive_mutex> image_status_lock(m_image_status_mutex);
 
    if (m_present_mode == VK_PRESENT_MODE_SHARED_DEMAND_REFRESH_KHR ||
        m_present_mode == VK_PRESENT_MODE_SHARED_CONTINUOUS_REFRESH_KHR)
@@ -207,11 +234,14 @@ swapchain_base::swapchain_base(layer::device_private_data &dev_data, const VkAll
    , m_thread_sem_defined(false)
    , m_first_present(true)
    , m_pending_buffer_pool()
-   , m_allocator(dev_data.get_allocator(), VK_SYSTEM_ALLOCATION_SCOPE_OBJECT, callbacks)
-   , m_swapchain_images(m_allocator)
+   , m_allocator(dev_data.get_allocator(), VK_SYSTEM_ALLOCATION_SCOPE_OBJECT, callbacks,
+                 util::memory_subsystem::swapchain)
+   , m_arena(m_allocator)
+   , m_arena_allocator(m_arena.get_allocator(VK_SYSTEM_ALLOCATION_SCOPE_OBJECT))
+   , m_swapchain_images(m_arena_allocator)
    , m_surface(VK_NULL_HANDLE)
    , m_present_mode(VK_PRESENT_MODE_IMMEDIATE_KHR)
-   , m_present_modes(m_allocator)
+   , m_present_modes(m_arena_allocator)
    , m_descendant(VK_NULL_HANDLE)
    , m_ancestor(VK_NULL_HANDLE)
    , m_device(VK_NULL_HANDLE)
@@ -220,7 +250,7 @@ swapchain_base::swapchain_base(layer::device_private_data &dev_data, const VkAll
    , m_image_compression_control_params({ VK_IMAGE_COMPRESSION_DEFAULT_EXT, 0 })
 #endif
    , m_image_create_info()
-   , m_image_acquire_lock()
+   , m_image_acquire_lock("image_acquire_lock")
    , m_error_state(VK_NOT_READY)
    , m_started_presenting(false)
    , m_frame_boundary_handler(m_device_data)
@@ -230,12 +260,10 @@ swapchain_base::swapchain_base(layer::device_private_data &dev_data, const VkAll
 {
 }
 
-static VkResult handle_scaling_create_info(VkDevice device, const VkSwapchainCreateInfoKHR *swapchain_create_info,
+static VkResult handle_scaling_create_info(VkDevice device,
+                                           const VkSwapchainPresentScalingCreateInfoEXT *present_scaling_create_info,
                                            const VkSurfaceKHR &surface)
 {
-
-   auto present_scaling_create_info = util::find_extension<VkSwapchainPresentScalingCreateInfoEXT>(
-      VK_STRUCTURE_TYPE_SWAPCHAIN_PRESENT_SCALING_CREATE_INFO_EXT, swapchain_create_info);
    if (present_scaling_create_info != nullptr)
    {
       auto &device_data = layer::device_private_data::get(device);
@@ -259,10 +287,8 @@ static VkResult handle_scaling_create_info(VkDevice device, const VkSwapchainCre
 }
 
 VkResult swapchain_base::handle_swapchain_present_modes_create_info(
-   VkDevice device, const VkSwapchainCreateInfoKHR *swapchain_create_info)
+   VkDevice device, const VkSwapchainPresentModesCreateInfoEXT *swapchain_present_modes_create_info)
 {
-   const auto *swapchain_present_modes_create_info = util::find_extension<VkSwapchainPresentModesCreateInfoEXT>(
-      VK_STRUCTURE_TYPE_SWAPCHAIN_PRESENT_MODES_CREATE_INFO_EXT, swapchain_create_info->pNext);
    if (swapchain_present_modes_create_info != nullptr)
    {
       if (!m_present_modes.try_resize(swapchain_present_modes_create_info->presentModeCount))
@@ -291,13 +317,23 @@ VkResult swapchain_base::init(VkDevice device, const VkSwapchainCreateInfoKHR *s
    m_device = device;
    m_surface = swapchain_create_info->surface;
 
+   /* Acquire one block for the metadata of the images. The images and the present modes are stored inline in the
+    * swapchain unless there are more of them than expected, in which case the arena spills to m_allocator. */
+   constexpr size_t arena_slack = 512;
+   size_t per_image_size = get_image_metadata_size() + alignof(std::max_align_t);
+   if (!m_arena.reserve(swapchain_create_info->minImageCount * per_image_size + arena_slack))
+   {
+      return VK_ERROR_OUT_OF_HOST_MEMORY;
+   }
+
    m_present_mode = swapchain_create_info->presentMode;
 
-   TRY(handle_swapchain_present_modes_create_info(device, swapchain_create_info));
+   const auto extensions = decode_swapchain_create_info_extensions(*swapchain_create_info);
+
+   TRY(handle_swapchain_present_modes_create_info(device, extensions.present_modes));
 
 #if WSI_IMAGE_COMPRESSION_CONTROL_SWAPCHAIN
-   const auto *image_compression_control = util::find_extension<VkImageCompressionControlEXT>(
-      VK_STRUCTURE_TYPE_IMAGE_COMPRESSION_CONTROL_EXT, swapchain_create_info->pNext);
+   const auto *image_compression_control = extensions.image_compression_control;
    if (m_device_data.is_swapchain_compression_control_enabled() && image_compression_control != nullptr)
    {
       m_image_compression_control_params.compression_control_plane_count =
@@ -316,7 +352,7 @@ VkResult swapchain_base::init(VkDevice device, const VkSwapchainCreateInfoKHR *s
       return VK_ERROR_OUT_OF_HOST_MEMORY;
    }
 
-   TRY_LOG_CALL(handle_scaling_create_info(device, swapchain_create_info, m_surface));
+   TRY_LOG_CALL(handle_scaling_create_info(device, extensions.present_scaling, m_surface));
 
    /* We have allocated images, we can call the platform init function if something needs to be done. */
    bool use_presentation_thread = true;
@@ -365,6 +401,7 @@ VkResult swapchain_base::init(VkDevice device, const VkSwapchainCreateInfoKHR *s
       else
       {
          TRY_LOG_CALL(allocate_and_bind_swapchain_image(image_create_info, img));
+         record_image_memory(img);
       }
 
       VkSemaphoreCreateInfo semaphore_info = {};
@@ -405,6 +442,11 @@ VkResult swapchain_base::init(VkDevice device, const VkSwapchainCreateInfoKHR *s
 
    set_error_state(VK_SUCCESS);
 
+   present_watchdog::add(m_progress, this);
+   m_statistics.start_periodic_reports(this);
+   capture::record(capture::event::swapchain_create, this, static_cast<uint32_t>(m_swapchain_images.size()), 0,
+                   m_present_mode);
+
    return VK_SUCCESS;
 }
 
@@ -429,7 +471,14 @@ void swapchain_base::teardown()
       wait_for_pending_buffers();
    }
 
-   if (m_queue != VK_NULL_HANDLE)
+   if (is_presentation_stalled())
+   {
+      /* The queue may never go idle, do not block the application on it. The page flip thread still exits as its
+       * waits are bounded and it drops the pending presents once the swapchain is in an error state. */
+      WSI_LOG_WARNING("Swapchain %p stalled, destroying it without waiting for the queue to be idle.",
+                      static_cast<void *>(this));
+   }
+   else if (m_queue != VK_NULL_HANDLE)
    {
       /* Make sure the vkFences are done signaling. */
       m_device_data.disp.QueueWaitIdle(m_queue);
@@ -451,6 +500,10 @@ void swapchain_base::teardown()
       }
    }
 
+   /* No more presents can complete, stop monitoring the swapchain before its images are released. */
+   present_watchdog::remove(m_progress);
+   m_statistics.stop_periodic_reports();
+
    int res = sem_destroy(&m_start_present_semaphore);
    if (res != 0)
    {
@@ -477,20 +530,32 @@ void swapchain_base::teardown()
       m_device_data.disp.DestroySemaphore(m_device, img.present_semaphore, get_allocation_callbacks());
       m_device_data.disp.DestroySemaphore(m_device, img.present_fence_wait, get_allocation_callbacks());
    }
+
+   m_statistics.report(this, "destroyed");
+   capture::record(capture::event::swapchain_destroy, this);
 }
 
 VkResult swapchain_base::acquire_next_image(uint64_t timeout, VkSemaphore semaphore, VkFence fence,
                                             uint32_t *image_index)
 {
-   std::unique_lock<std::mutex> acquire_lock(m_image_acquire_lock);
+   WSI_TRACE_SCOPE("acquire_next_image");
+   util::unique_lock<util::mutex> acquire_lock(m_image_acquire_lock);
 
-   TRY(wait_for_free_buffer(timeout));
+   uint64_t wait_start = util::get_monotonic_time_ns();
+   VkResult wait_result = wait_for_free_buffer(timeout);
+   m_statistics.record_acquire(util::get_monotonic_time_ns() - wait_start);
    if (error_has_occured())
    {
+      if (wait_result == VK_SUCCESS)
+      {
+         /* No image is acquired, give the free image back. */
+         m_free_image_semaphore.post();
+      }
       return get_error_state();
    }
+   TRY(wait_result);
 
-   std::unique_lock<std::recursive_mutex> image_status_lock(m_image_status_mutex);
+   util::unique_lock<util::recursive_mutex> image_status_lock(m_image_status_mutex);
 
    size_t i;
    for (i = 0; i < m_swapchain_images.size(); ++i)
@@ -503,6 +568,7 @@ VkResult swapchain_base::acquire_next_image(uint64_t timeout, VkSemaphore semaph
             WSI_LOG_ERROR("Failed to allocate swapchain image.");
             return res != VK_ERROR_INITIALIZATION_FAILED ? res : VK_ERROR_OUT_OF_HOST_MEMORY;
          }
+         record_image_memory(m_swapchain_images[i]);
       }
 
       if (m_swapchain_images[i].status == swapchain_image::FREE)
@@ -514,6 +580,12 @@ VkResult swapchain_base::acquire_next_image(uint64_t timeout, VkSemaphore semaph
    }
 
    assert(i < m_swapchain_images.size());
+   if (capture::is_enabled())
+   {
+      uint64_t wait_us = (util::get_monotonic_time_ns() - wait_start) / util::NSEC_PER_USEC;
+      capture::record(capture::event::acquire, this, *image_index, 0,
+                      static_cast<uint32_t>(std::min<uint64_t>(wait_us, UINT32_MAX)));
+   }
 
    image_status_lock.unlock();
 
@@ -574,13 +646,25 @@ VkResult swapchain_base::acquire_next_image(uint64_t timeout, VkSemaphore semaph
       }
    }
 
-   /* Fallback for when importing fence/semaphore sync FDs is unsupported by the ICD. */
+   if (fence == VK_NULL_HANDLE && semaphore == VK_NULL_HANDLE)
+   {
+      return VK_SUCCESS;
+   }
+
+   /* Fallback for when importing fence/semaphore sync FDs is unsupported by the ICD. The image is already free, so
+    * prefer the layer's own queue where the submission does not wait for the application's work on m_queue. */
    queue_submit_semaphores semaphores = {
       nullptr,
       0,
       (semaphore != VK_NULL_HANDLE) ? &semaphore : nullptr,
       (semaphore != VK_NULL_HANDLE) ? 1u : 0,
    };
+   VkQueue sync_queue = m_device_data.get_sync_queue();
+   if (sync_queue != VK_NULL_HANDLE)
+   {
+      const util::lock_guard<util::mutex> lock(m_device_data.get_sync_queue_lock());
+      return sync_queue_submit(m_device_data, sync_queue, fence, semaphores);
+   }
    TRY(sync_queue_submit(m_device_data, m_queue, fence, semaphores));
 
    return VK_SUCCESS;
@@ -636,9 +720,98 @@ VkResult swapchain_base::get_swapchain_status()
    return get_error_state();
 }
 
+void swapchain_base::get_statistics(VkSwapchainStatisticsWSI &statistics)
+{
+   m_statistics.get_statistics(statistics);
+
+   const util::lock_guard<util::recursive_mutex> lock(m_image_status_mutex);
+   statistics.currentQueueDepth = static_cast<uint32_t>(m_pending_buffer_pool.size());
+}
+
+static const char *image_status_name(enum swapchain_image::status status)
+{
+   switch (status)
+   {
+   case swapchain_image::INVALID:
+      return "INVALID";
+   case swapchain_image::ACQUIRED:
+      return "ACQUIRED";
+   case swapchain_image::PENDING:
+      return "PENDING";
+   case swapchain_image::PRESENTED:
+      return "PRESENTED";
+   case swapchain_image::FREE:
+      return "FREE";
+   case swapchain_image::UNALLOCATED:
+      return "UNALLOCATED";
+   }
+   return "UNKNOWN";
+}
+
+void swapchain_base::handle_presentation_stall(uint64_t stall_time_ns, VkResult action)
+{
+   util::trace::instant("presentation_stall");
+
+   constexpr uint64_t NSEC_PER_MSEC = util::NSEC_PER_SEC / 1000;
+   const uint64_t now = util::get_monotonic_time_ns();
+   auto age_ms = [now](uint64_t timestamp) -> int64_t {
+      return timestamp != 0 ? static_cast<int64_t>((now - timestamp) / NSEC_PER_MSEC) : -1;
+   };
+
+   WSI_LOG_ERROR("Watchdog: swapchain %p has not completed a present for %" PRIu64 " ms "
+                 "(present mode %d, presents queued %" PRIu64 ", completed %" PRIu64 ", error state %d, "
+                 "page flip thread %s)",
+                 static_cast<void *>(this), stall_time_ns / NSEC_PER_MSEC, static_cast<int>(m_present_mode),
+                 m_progress.queued.load(std::memory_order_relaxed),
+                 m_progress.completed.load(std::memory_order_relaxed), static_cast<int>(get_error_state()),
+                 m_page_flip_thread_run ? "running" : "not running");
+
+   /* The thread that stalled may hold the lock, never block on it here. */
+   util::unique_lock<util::recursive_mutex> image_status_lock(m_image_status_mutex, std::try_to_lock);
+   if (image_status_lock.owns_lock())
+   {
+      WSI_LOG_ERROR("Watchdog: swapchain %p has %zu pending presents", static_cast<void *>(this),
+                    m_pending_buffer_pool.size());
+   }
+   else
+   {
+      WSI_LOG_ERROR("Watchdog: swapchain %p image status lock is held, image states may be inconsistent",
+                    static_cast<void *>(this));
+   }
+
+   /* The ages are in ms, -1 if the stage was not reached for the last present of the image. */
+   for (size_t i = 0; i < m_swapchain_images.size(); i++)
+   {
+      const auto &image = m_swapchain_images[i];
+      WSI_LOG_ERROR("Watchdog: swapchain %p image %zu: %s, last present request %" PRId64
+                    " ms ago, render done %" PRId64 " ms ago, backend submit %" PRId64 " ms ago",
+                    static_cast<void *>(this), i, image_status_name(image.status),
+                    age_ms(image.timestamps.queue_present_ns), age_ms(image.timestamps.render_done_ns),
+                    age_ms(image.timestamps.backend_submit_ns));
+   }
+
+   if (action != VK_SUCCESS)
+   {
+      m_presentation_stalled.store(true, std::memory_order_release);
+      set_error_state(action);
+      /* Wake up a thread waiting in vkAcquireNextImageKHR, so it can return the error. Interrupt rather than post
+       * the semaphore, its count must keep matching the number of free images. */
+      m_free_image_semaphore.interrupt();
+   }
+}
+
+void swapchain_base::record_image_memory(const swapchain_image &image)
+{
+   VkMemoryRequirements memory_requirements = {};
+   m_device_data.disp.GetImageMemoryRequirements(m_device, image.image, &memory_requirements);
+   m_statistics.record_image_memory(memory_requirements.size);
+}
+
 VkResult swapchain_base::notify_presentation_engine(const pending_present_request &pending_present)
 {
-   const std::lock_guard<std::recursive_mutex> lock(m_image_status_mutex);
+   WSI_TRACE_SCOPE("notify_presentation_engine");
+   util::trace::flow(util::trace::phase::flow_step, "present", this, pending_present.present_id);
+   const util::lock_guard<util::recursive_mutex> lock(m_image_status_mutex);
 
    /* If the descendant has started presenting, we should release the image
     * however we do not want to block inside the main thread so we mark it
@@ -647,6 +820,7 @@ VkResult swapchain_base::notify_presentation_engine(const pending_present_reques
    if (descendant_started_presenting)
    {
       m_swapchain_images[pending_present.image_index].status = swapchain_image::FREE;
+      m_statistics.record_dropped_frame();
       m_free_image_semaphore.post();
       return VK_ERROR_OUT_OF_DATE_KHR;
    }
@@ -656,22 +830,28 @@ VkResult swapchain_base::notify_presentation_engine(const pending_present_reques
 
    if (m_page_flip_thread_run)
    {
+      m_progress.record_queued();
       bool buffer_pool_res = m_pending_buffer_pool.push_back(pending_present);
       (void)buffer_pool_res;
       assert(buffer_pool_res);
+      m_statistics.record_present(m_pending_buffer_pool.size());
       m_page_flip_semaphore.post();
    }
    else
    {
+      m_statistics.record_present(0);
+      m_progress.record_queued();
       call_present(pending_present);
    }
 
    return VK_SUCCESS;
 }
 
-VkResult swapchain_base::queue_present(VkQueue queue, const VkPresentInfoKHR *present_info,
-                                       const swapchain_presentation_parameters &submit_info)
+VkResult swapchain_base::begin_queue_present(const swapchain_presentation_parameters &submit_info)
 {
+   util::trace::flow(util::trace::phase::flow_begin, "present", this, submit_info.pending_present.present_id);
+   m_swapchain_images[submit_info.pending_present.image_index].timestamps = { util::get_monotonic_time_ns(), 0, 0 };
+
 #if VULKAN_WSI_LAYER_EXPERIMENTAL
    if (submit_info.present_timing_info)
    {
@@ -693,7 +873,15 @@ VkResult swapchain_base::queue_present(VkQueue queue, const VkPresentInfoKHR *pr
    {
       TRY(handle_switching_presentation_mode(submit_info.present_mode));
    }
+   capture::record(capture::event::present, this, submit_info.pending_present.image_index,
+                   submit_info.pending_present.present_id, m_present_mode);
+
+   return VK_SUCCESS;
+}
 
+swapchain_base::present_payload swapchain_base::get_present_payload(
+   const VkPresentInfoKHR *present_info, const swapchain_presentation_parameters &submit_info)
+{
    const VkSemaphore *wait_semaphores = &m_swapchain_images[submit_info.pending_present.image_index].present_semaphore;
    uint32_t sem_count = 1;
    if (!submit_info.use_image_present_semaphore)
@@ -702,28 +890,15 @@ VkResult swapchain_base::queue_present(VkQueue queue, const VkPresentInfoKHR *pr
       sem_count = present_info->waitSemaphoreCount;
    }
 
-   if (!m_page_flip_thread_run)
-   {
-      /* If the page flip thread is not running, we need to wait for any present payload here, before setting a new present payload. */
-      constexpr uint64_t WAIT_PRESENT_TIMEOUT = 1000000000; /* 1 second */
-      TRY_LOG_CALL(
-         image_wait_present(m_swapchain_images[submit_info.pending_present.image_index], WAIT_PRESENT_TIMEOUT));
-   }
-
-   void *submission_pnext = nullptr;
-   std::optional<VkFrameBoundaryEXT> frame_boundary;
+   present_payload payload{};
    /* Do not handle the event if it was handled before reaching this point */
    if (submit_info.handle_present_frame_boundary_event)
    {
-      frame_boundary = m_frame_boundary_handler.handle_frame_boundary_event(
-         present_info, &m_swapchain_images[submit_info.pending_present.image_index].image);
-      if (frame_boundary.has_value())
-      {
-         submission_pnext = &frame_boundary.value();
-      }
+      payload.frame_boundary = m_frame_boundary_handler.handle_frame_boundary_event(
+         submit_info.frame_boundary, &m_swapchain_images[submit_info.pending_present.image_index].image);
    }
 
-   queue_submit_semaphores semaphores = {
+   payload.semaphores = {
       wait_semaphores,
       sem_count,
       (submit_info.present_fence != VK_NULL_HANDLE) ?
@@ -731,9 +906,11 @@ VkResult swapchain_base::queue_present(VkQueue queue, const VkPresentInfoKHR *pr
          nullptr,
       (submit_info.present_fence != VK_NULL_HANDLE) ? 1u : 0,
    };
-   TRY_LOG_CALL(image_set_present_payload(m_swapchain_images[submit_info.pending_present.image_index], queue,
-                                          semaphores, submission_pnext));
+   return payload;
+}
 
+VkResult swapchain_base::end_queue_present(VkQueue queue, const swapchain_presentation_parameters &submit_info)
+{
    if (submit_info.present_fence != VK_NULL_HANDLE)
    {
       const queue_submit_semaphores wait_semaphores = {
@@ -766,10 +943,10 @@ void swapchain_base::deprecate(VkSwapchainKHR descendant)
 
 void swapchain_base::wait_for_pending_buffers()
 {
-   std::unique_lock<std::mutex> acquire_lock(m_image_acquire_lock);
+   util::unique_lock<util::mutex> acquire_lock(m_image_acquire_lock);
    int wait;
    int acquired_images = 0;
-   std::unique_lock<std::recursive_mutex> image_status_lock(m_image_status_mutex);
+   util::unique_lock<util::recursive_mutex> image_status_lock(m_image_status_mutex);
 
    for (auto &img : m_swapchain_images)
    {
@@ -808,13 +985,13 @@ VkResult swapchain_base::wait_for_free_buffer(uint64_t timeout)
    VkResult retval;
    /* first see if a buffer is already marked as free */
    retval = m_free_image_semaphore.wait(0);
-   if (retval == VK_NOT_READY)
+   if (retval == VK_NOT_READY && !error_has_occured())
    {
       /* if not, we still have work to do even if timeout==0 -
        * the swapchain implementation may be able to get a buffer without
        * waiting */
 
-      retval = get_free_buffer(&timeout);
+      retval = call_get_free_buffer(&timeout);
       if (retval == VK_SUCCESS)
       {
          /* the sub-implementation has done it's thing, so re-check the
@@ -856,6 +1033,7 @@ VkResult swapchain_base::handle_switching_presentation_mode(VkPresentModeKHR swa
 
 void swapchain_base::set_present_id(uint64_t value)
 {
+   capture::record(capture::event::present_complete, this, capture::NO_IMAGE, value);
    if (value != 0)
    {
       assert(value > m_present_id);
@@ -35,15 +35,26 @@
 #include <vulkan/vulkan.h>
 #include <thread>
 #include <array>
+#include <atomic>
+#include <cassert>
+#include <new>
+#include <optional>
 
 #include <layer/private_data.hpp>
 #include <util/timed_semaphore.hpp>
+#include <util/arena_allocator.hpp>
 #include <util/custom_allocator.hpp>
-#include <util/ring_buffer.hpp>
+#include <util/small_vector.hpp>
+#include <util/concurrent_ring_buffer.hpp>
 #include "surface_properties.hpp"
+#include "wsi/compatible_present_modes.hpp"
 #include "wsi/synchronization.hpp"
 #include "wsi/frame_boundary.hpp"
+#include "wsi/swapchain_statistics.hpp"
+#include "wsi/present_watchdog.hpp"
 #include "util/helpers.hpp"
+#include "util/log.hpp"
+#include "util/trace.hpp"
 
 namespace wsi
 {
@@ -62,13 +73,13 @@ struct swapchain_image
       UNALLOCATED,
    };
 
-   /* Implementation specific data */
-   void *data{ nullptr };
-
    VkImage image{ VK_NULL_HANDLE };
    status status{ swapchain_image::INVALID };
    VkSemaphore present_semaphore{ VK_NULL_HANDLE };
    VkSemaphore present_fence_wait{ VK_NULL_HANDLE };
+
+   /* Timestamps of the last present request for the image. */
+   present_timestamps timestamps{};
 };
 
 struct pending_present_request
@@ -111,6 +122,9 @@ struct swapchain_presentation_parameters
     */
    VkBool32 handle_present_frame_boundary_event{ true };
 
+   /* Frame boundary passed by the application with VkFrameBoundaryEXT, or nullptr. */
+   const VkFrameBoundaryEXT *frame_boundary{ nullptr };
+
 #if VULKAN_WSI_LAYER_EXPERIMENTAL
    /**
     * Pointer to the present timing info.
@@ -184,6 +198,22 @@ public:
     */
    VkResult acquire_next_image(uint64_t timeout, VkSemaphore semaphore, VkFence fence, uint32_t *image_index);
 
+   /**
+    * @brief Get the size of the swapchain object, which depends on the backend it was created for.
+    */
+   size_t get_object_size() const
+   {
+      return m_object_size;
+   }
+
+   /**
+    * @brief Record the size of the swapchain object, used to account its memory when it is destroyed.
+    */
+   void set_object_size(size_t object_size)
+   {
+      m_object_size = object_size;
+   }
+
    /**
     * @brief Gets the number of swapchain images or a number of at most
     * m_num_swapchain_images images.
@@ -211,9 +241,11 @@ public:
     * @return If queue submission fails returns error of vkQueueSubmit, if the
     * swapchain has a descendant who started presenting returns VK_ERROR_OUT_OF_DATE_KHR,
     * otherwise returns VK_SUCCESS.
+    *
+    * @note Implemented by @ref typed_swapchain, which calls the backend hooks statically.
     */
-   VkResult queue_present(VkQueue queue, const VkPresentInfoKHR *present_info,
-                          const swapchain_presentation_parameters &presentation_parameters);
+   virtual VkResult queue_present(VkQueue queue, const VkPresentInfoKHR *present_info,
+                                  const swapchain_presentation_parameters &presentation_parameters) = 0;
 
    /**
     * @brief Get the allocator
@@ -277,6 +309,44 @@ public:
     */
    VkResult get_swapchain_status();
 
+   /**
+    * @brief Get the statistics collected for the swapchain.
+    *
+    * @param[out] statistics The structure to fill.
+    */
+   void get_statistics(VkSwapchainStatisticsWSI &statistics);
+
+   /**
+    * @brief Get the latency distributions collected for the swapchain.
+    *
+    * @param[out] statistics The structure to fill.
+    */
+   void get_latency_statistics(VkSwapchainLatencyStatisticsWSI &statistics) const
+   {
+      m_statistics.get_latency_statistics(statistics);
+   }
+
+   /**
+    * @brief Called by the present watchdog when the swapchain has not completed a present within the deadline.
+    *
+    * Dumps the state of the swapchain to stderr and, if requested, moves the swapchain to an error state so that the
+    * application stops waiting for it.
+    *
+    * @param stall_time_ns Time since the last progress of the presentation, in nanoseconds.
+    * @param action        Error state to set, or VK_SUCCESS to only dump the state.
+    */
+   void handle_presentation_stall(uint64_t stall_time_ns, VkResult action);
+
+   /**
+    * @brief Returns true if the present watchdog moved the swapchain to an error state.
+    *
+    * The presentation engine may then never release the pending images, so teardown does not wait for it.
+    */
+   bool is_presentation_stalled() const
+   {
+      return m_presentation_stalled.load(std::memory_order_acquire);
+   }
+
    /**
     * @brief Release all images not belonging to the device
     * by making them available to be acquired again
@@ -338,7 +408,7 @@ protected:
     * these functions to be called both with and without the mutex already locked in the
     * same thread.
     */
-   std::recursive_mutex m_image_status_mutex;
+   util::recursive_mutex m_image_status_mutex{ "image_status_mutex" };
 
    /**
     * @brief Defines if the pthread_t and sem_t members of the class are defined.
@@ -355,22 +425,35 @@ protected:
 
    /**
     * @brief In order to present the images in a FIFO order we implement
-    * a ring buffer to hold the images queued for presentation. Since the
-    * two pointers (head and tail) are used by different
-    * threads and we do not allow the application to acquire more images
-    * than we have we eliminate race conditions.
+    * a ring buffer to hold the images queued for presentation. The presents
+    * of a swapchain are externally synchronized, so the queueing thread is
+    * the only producer and the page flip thread is the only consumer. We do
+    * not allow the application to acquire more images than we have, so the
+    * buffer never overflows.
     */
-   util::ring_buffer<pending_present_request, wsi::surface_properties::MAX_SWAPCHAIN_IMAGE_COUNT> m_pending_buffer_pool;
+   util::spsc_ring_buffer<pending_present_request, wsi::surface_properties::MAX_SWAPCHAIN_IMAGE_COUNT>
+      m_pending_buffer_pool;
 
    /**
     * @brief User provided memory allocation callbacks.
     */
    const util::allocator m_allocator;
 
+   /**
+    * @brief Arena for the metadata allocated when the swapchain and its images are created and freed when the
+    * swapchain is destroyed. Declared before its users so that it is destroyed after them.
+    */
+   util::arena m_arena;
+
+   /**
+    * @brief Allocator carving from @ref m_arena. Must not be passed to Vulkan commands.
+    */
+   const util::allocator m_arena_allocator;
+
    /**
     * @brief Vector of images in the swapchain.
     */
-   util::vector<swapchain_image> m_swapchain_images;
+   util::small_vector<swapchain_image, wsi::surface_properties::MAX_SWAPCHAIN_IMAGE_COUNT> m_swapchain_images;
 
    /**
     * @brief Handle to the surface object this swapchain will present images to.
@@ -385,7 +468,7 @@ protected:
    /**
     * @brief Possible presentation modes this swapchain is allowed to present with VkSwapchainPresentModesCreateInfoEXT
     */
-   util::vector<VkPresentModeKHR> m_present_modes;
+   util::small_vector<VkPresentModeKHR, MAX_PRESENT_MODES> m_present_modes;
 
    /**
     * @brief Descendant of this swapchain.
@@ -426,6 +509,16 @@ protected:
     */
    VkImageCreateInfo m_image_create_info;
 
+   /**
+    * @brief Frame statistics collected for this swapchain.
+    */
+   swapchain_statistics m_statistics;
+
+   /**
+    * @brief Progress of the present requests, monitored by the present watchdog.
+    */
+   present_progress m_progress;
+
    /**
     * @brief Return the VkAllocationCallbacks passed in this object constructor.
     */
@@ -496,6 +589,13 @@ protected:
     */
    virtual VkResult allocate_and_bind_swapchain_image(VkImageCreateInfo image_create_info, swapchain_image &image) = 0;
 
+   /**
+    * @brief Account the memory bound to a swapchain image in the swapchain statistics.
+    *
+    * @param image The image, with its memory bound.
+    */
+   void record_image_memory(const swapchain_image &image);
+
    /**
     * @brief Creates a new swapchain image.
     *
@@ -508,15 +608,6 @@ protected:
     */
    virtual VkResult create_swapchain_image(VkImageCreateInfo image_create_info, swapchain_image &image) = 0;
 
-   /**
-    * @brief Method to present and image
-    *
-    * It sends the next image for presentation to the presentation engine.
-    *
-    * @param pending_present Information on the pending present request.
-    */
-   virtual void present_image(const pending_present_request &pending_present) = 0;
-
    /**
     * @brief Transition a presented image to free.
     *
@@ -536,62 +627,118 @@ protected:
    virtual void destroy_image(swapchain_image &image){};
 
    /**
-    * @brief Hook for any actions to free up a buffer for acquire
+    * @brief Get the number of bytes the backend allocates from @ref m_arena_allocator for each image.
     *
-    * If specific actions are required by the windowing system to query whether a buffer
-    * is still used by it, this function should be implemented by the WSI backend's
-    * swapchain implementation.
-    *
-    * @param[in,out] timeout time to wait, in nanoseconds. 0 doesn't block,
-    *                        UINT64_MAX waits indefinately. The timeout should
-    *                        be updated if a sleep is required - this can
-    *                        be set to 0 if the semaphore is now not expected
-    *                        block.
+    * Used to size the arena when the swapchain is initialized, so that the image metadata is contiguous.
     */
-   virtual VkResult get_free_buffer(uint64_t *timeout)
+   virtual size_t get_image_metadata_size() const
    {
-      return VK_SUCCESS;
+      return 0;
    }
 
    /**
-    * @brief Sets the present payload for a swapchain image.
+    * @brief Record a present request before the backend sets its present payload.
+    *
+    * Also switches the presentation mode if the request asks for it.
+    *
+    * @param submit_info Presentation parameters of the request.
+    *
+    * @return VK_SUCCESS on success or an error code otherwise.
+    */
+   VkResult begin_queue_present(const swapchain_presentation_parameters &submit_info);
+
+   /**
+    * @brief Semaphores and submission chain of the present payload of a request.
+    */
+   struct present_payload
+   {
+      queue_submit_semaphores semaphores;
+      std::optional<VkFrameBoundaryEXT> frame_boundary;
+
+      const void *submission_pnext() const
+      {
+         return frame_boundary.has_value() ? &frame_boundary.value() : nullptr;
+      }
+   };
+
+   /**
+    * @brief Get the present payload of a request.
+    *
+    * @param present_info Information about the swapchain and image to be presented.
+    * @param submit_info  Presentation parameters of the request.
+    */
+   present_payload get_present_payload(const VkPresentInfoKHR *present_info,
+                                       const swapchain_presentation_parameters &submit_info);
+
+   /**
+    * @brief Signal the present fence of a request, if any, and hand the request to the presentation engine.
     *
-    * @param[in] image            The swapchain image for which to set a present payload.
-    * @param     queue            A Vulkan queue that can be used for any Vulkan commands needed.
-    * @param[in] semaphores       The wait and signal semaphores and their number of elements.
-    * @param[in] submission_pnext Chain of pointers to attach to the payload submission.
+    * @param queue       The queue the request was submitted to.
+    * @param submit_info Presentation parameters of the request.
     *
     * @return VK_SUCCESS on success or an error code otherwise.
     */
-   virtual VkResult image_set_present_payload(swapchain_image &image, VkQueue queue,
-                                              const queue_submit_semaphores &semaphores,
-                                              const void *submission_pnext = nullptr) = 0;
+   VkResult end_queue_present(VkQueue queue, const swapchain_presentation_parameters &submit_info);
 
    /**
-    * @brief Waits for the present payload of an image if necessary.
+    * @brief Wait for the next request the page flip thread should present.
     *
-    * If the page flip thread needs to wait for the image present synchronization payload the WSI implemention can block
-    * and wait in this call. Otherwise the function should return successfully without blocking.
+    * @param[out] submit_info The request to present.
     *
-    * @param[in] image   The swapchain image for which the function may need to wait until the presentat payload has
-    *                    finished.
-    * @param     timeout Timeout for any wait in nanoseconds.
+    * @return true if there is a request to present, false if the wait timed out.
+    */
+   bool dequeue_present_request(pending_present_request &submit_info);
+
+   /**
+    * @brief Start waiting for the rendering of a request in the page flip thread.
     *
-    * @return VK_SUCCESS if waiting was successful or unnecessary. An error code otherwise.
+    * @return The time the wait started.
     */
-   virtual VkResult image_wait_present(swapchain_image &image, uint64_t timeout) = 0;
+   uint64_t begin_render_wait(const pending_present_request &submit_info);
+
+   /**
+    * @brief Account a finished wait for the rendering of a request.
+    *
+    * @param submit_info The request waited for.
+    * @param wait_start  The time returned by @ref begin_render_wait.
+    */
+   void end_render_wait(const pending_present_request &submit_info, uint64_t wait_start);
+
+   /**
+    * @brief Drop a request whose rendering could not be waited for and give its image back.
+    *
+    * @param result The error to report to the application.
+    */
+   void drop_present_request(VkResult result);
+
+   /**
+    * @brief Prepare the presentation of a request by the backend.
+    *
+    * Before the first present of a swapchain with an ancestor, waits for the ancestor to finish presenting.
+    *
+    * @return The time the presentation started.
+    */
+   uint64_t begin_present(const pending_present_request &pending_present);
+
+   /**
+    * @brief Account the presentation of a request by the backend.
+    *
+    * @param pending_present The request presented.
+    * @param present_start   The time returned by @ref begin_present.
+    */
+   void end_present(const pending_present_request &pending_present, uint64_t present_start);
 
    /**
     * @brief Returns true if an error has occurred.
     */
    bool error_has_occured() const
    {
-      return m_error_state != VK_SUCCESS;
+      return get_error_state() != VK_SUCCESS;
    }
 
    VkResult get_error_state() const
    {
-      return m_error_state;
+      return m_error_state.load(std::memory_order_acquire);
    }
 
    /*
@@ -604,7 +751,11 @@ protected:
     */
    void set_error_state(VkResult state)
    {
-      m_error_state = state;
+      VkResult previous_state = m_error_state.exchange(state, std::memory_order_acq_rel);
+      if (state != VK_SUCCESS && state != previous_state)
+      {
+         m_statistics.record_error_transition(state);
+      }
    }
 
    /**
@@ -615,21 +766,42 @@ protected:
    void set_present_id(uint64_t value);
 
 private:
-   std::mutex m_image_acquire_lock;
+   util::mutex m_image_acquire_lock;
    /**
     * @brief In case we encounter threading or drm errors we need a way to
     * notify the user of the failure. While no error has occurred its value
     * is VK_SUCCESS. When an error occurs, its value is set to the
     * appropriate error code and it is returned to the user through the next
     * acquire_next_image call.
+    *
+    * Atomic as it is set by the page flip thread and the present watchdog while the application threads read it.
     */
-   VkResult m_error_state;
+   std::atomic<VkResult> m_error_state;
+
+   /**
+    * @brief Set by the present watchdog when it moves the swapchain to an error state, see is_presentation_stalled.
+    */
+   std::atomic<bool> m_presentation_stalled{ false };
+
+   /**
+    * @brief Size of the swapchain object, see set_object_size.
+    */
+   size_t m_object_size{ sizeof(swapchain_base) };
 
    /**
     * @brief Wait for a buffer to become free.
     */
    VkResult wait_for_free_buffer(uint64_t timeout);
 
+   /**
+    * @brief Call the swapchain implementation specific get_free_buffer function.
+    *
+    * Only called when no image is known to be free. Implemented by @ref typed_swapchain.
+    *
+    * @param[in,out] timeout Time to wait in nanoseconds, updated by the backend if it had to wait.
+    */
+   virtual VkResult call_get_free_buffer(uint64_t *timeout) = 0;
+
    /**
     * @brief A semaphore to be signalled once a free image becomes available.
     *
@@ -663,18 +835,20 @@ private:
     * logic splits into the above 3 cases and if an image has been
     * presented then the old one is marked as FREE and the free_image
     * semaphore of the swapchain will be posted.
+    *
+    * Implemented by @ref typed_swapchain, so that the backend is called statically on every frame.
     **/
-   void page_flip_thread();
+   virtual void page_flip_thread() = 0;
 
    /**
     * @brief Call the swapchain implementation specific present_image function.
     *
     * In addition to calling the present_image function it also handles the
-    * communication with the ancestor before the first presentation.
+    * communication with the ancestor before the first presentation. Implemented by @ref typed_swapchain.
     *
     * @param pending_present_request Submission information for the present request.
     */
-   void call_present(const pending_present_request &pending_present);
+   virtual void call_present(const pending_present_request &pending_present) = 0;
 
    /**
     * @brief Return true if the descendant has started presenting.
@@ -725,13 +899,13 @@ private:
     * If VkSwapchainPresentModesCreateInfoEXT is supplied as part of the pNext chain of VkSwapchainCreateInfoKHR
     * then this function handles setting up the presentation modes for the swapchain.
     *
-    * @param device                  VkDevice object.
-    * @param swapchain_create_info   Pointer to the swapchain create info struct.
+    * @param device                              VkDevice object.
+    * @param swapchain_present_modes_create_info  The present modes create info found in the pNext chain, or nullptr.
     *
     * @return VK_SUCCESS on success or an error code otherwise.
     */
-   VkResult handle_swapchain_present_modes_create_info(VkDevice device,
-                                                       const VkSwapchainCreateInfoKHR *swapchain_create_info);
+   VkResult handle_swapchain_present_modes_create_info(
+      VkDevice device, const VkSwapchainPresentModesCreateInfoEXT *swapchain_present_modes_create_info);
 
    /**
     * @brief Current present ID for this swapchain.
@@ -759,4 +933,255 @@ private:
 #endif
 };
 
+/**
+ * @brief Base of the backend swapchains, which pass their own type as @p swapchain_type.
+ *
+ * Implements the present and acquire paths of @ref swapchain_base on top of the backend hooks, which are called
+ * statically rather than through virtual functions. The backend must declare this class as a friend and provide:
+ *
+ * - void present_image(const pending_present_request &pending_present)
+ *   Sends the next image for presentation to the presentation engine.
+ * - VkResult image_set_present_payload(swapchain_image &image, VkQueue queue,
+ *                                      const queue_submit_semaphores &semaphores, const void *submission_pnext)
+ *   Sets the present payload for a swapchain image.
+ * - VkResult image_wait_present(swapchain_image &image, uint64_t timeout)
+ *   Waits for the present payload of an image if necessary. Returns VK_SUCCESS if waiting was successful or
+ *   unnecessary and VK_TIMEOUT if @p timeout expired.
+ *
+ * and may provide VkResult get_free_buffer(uint64_t *timeout), see @ref get_free_buffer.
+ *
+ * The per-image data of type @p image_data_type is stored in an array in the swapchain arena, indexed like the
+ * swapchain images, and constructed by @ref create_image_data.
+ */
+template <typename swapchain_type, typename image_data_type>
+class typed_swapchain : public swapchain_base
+{
+public:
+   using swapchain_base::swapchain_base;
+
+   VkResult queue_present(VkQueue queue, const VkPresentInfoKHR *present_info,
+                          const swapchain_presentation_parameters &submit_info) final
+   {
+      WSI_TRACE_SCOPE("queue_present");
+      TRY(begin_queue_present(submit_info));
+
+      swapchain_image &image = m_swapchain_images[submit_info.pending_present.image_index];
+      if (!m_page_flip_thread_run)
+      {
+         /* If the page flip thread is not running, we need to wait for any present payload here, before setting a
+          * new present payload. */
+         constexpr uint64_t WAIT_PRESENT_TIMEOUT = 1000000000; /* 1 second */
+         VkResult result = backend().image_wait_present(image, WAIT_PRESENT_TIMEOUT);
+         if (result != VK_SUCCESS)
+         {
+            WSI_LOG_SWAPCHAIN_ERROR("Failed to wait for the present payload of image %u.",
+                                    submit_info.pending_present.image_index);
+            return result;
+         }
+      }
+
+      present_payload payload = get_present_payload(present_info, submit_info);
+      VkResult result =
+         backend().image_set_present_payload(image, queue, payload.semaphores, payload.submission_pnext());
+      if (result != VK_SUCCESS)
+      {
+         WSI_LOG_SWAPCHAIN_ERROR("Failed to set the present payload of image %u.",
+                                 submit_info.pending_present.image_index);
+         return result;
+      }
+
+      return end_queue_present(queue, submit_info);
+   }
+
+protected:
+   /**
+    * @brief Default hook for any actions to free up a buffer for acquire.
+    *
+    * If specific actions are required by the windowing system to query whether a buffer is still used by it, the
+    * backend should provide its own get_free_buffer.
+    *
+    * @param[in,out] timeout time to wait, in nanoseconds. 0 doesn't block,
+    *                        UINT64_MAX waits indefinately. The timeout should
+    *                        be updated if a sleep is required - this can
+    *                        be set to 0 if the semaphore is now not expected
+    *                        block.
+    */
+   VkResult get_free_buffer(uint64_t *timeout)
+   {
+      return VK_SUCCESS;
+   }
+
+   /**
+    * @brief Check whether the backend data of @p image has been created.
+    */
+   bool has_image_data(const swapchain_image &image) const
+   {
+      return m_image_data != nullptr && m_image_data[get_image_index(image)].constructed;
+   }
+
+   /**
+    * @brief Get the backend data of @p image.
+    */
+   image_data_type *get_image_data(const swapchain_image &image)
+   {
+      return get_image_data(get_image_index(image));
+   }
+
+   /**
+    * @brief Get the backend data of the image at @p image_index.
+    */
+   image_data_type *get_image_data(uint32_t image_index)
+   {
+      assert(m_image_data != nullptr && m_image_data[image_index].constructed);
+      return reinterpret_cast<image_data_type *>(m_image_data[image_index].storage);
+   }
+
+   /**
+    * @brief Construct the backend data of @p image.
+    *
+    * @return The new image data, or nullptr if the allocation failed.
+    */
+   template <typename... arg_types>
+   image_data_type *create_image_data(swapchain_image &image, arg_types &&...args)
+   {
+      if (m_image_data == nullptr)
+      {
+         /* The number of images is fixed once the swapchain is initialized. */
+         m_image_data_count = m_swapchain_images.size();
+         m_image_data = m_arena_allocator.create<image_data_slot>(m_image_data_count);
+         if (m_image_data == nullptr)
+         {
+            return nullptr;
+         }
+      }
+
+      image_data_slot &slot = m_image_data[get_image_index(image)];
+      assert(!slot.constructed);
+      try
+      {
+         new (slot.storage) image_data_type(std::forward<arg_types>(args)...);
+      }
+      catch (...)
+      {
+         return nullptr;
+      }
+      slot.constructed = true;
+      return reinterpret_cast<image_data_type *>(slot.storage);
+   }
+
+   /**
+    * @brief Destroy the backend data of @p image created by @ref create_image_data.
+    */
+   void destroy_image_data(swapchain_image &image)
+   {
+      image_data_slot &slot = m_image_data[get_image_index(image)];
+      assert(slot.constructed);
+      reinterpret_cast<image_data_type *>(slot.storage)->~image_data_type();
+      slot.constructed = false;
+   }
+
+   size_t get_image_metadata_size() const override
+   {
+      return sizeof(image_data_slot);
+   }
+
+   ~typed_swapchain()
+   {
+      /* The backend destroys the image data of its images in its own destructor. */
+      if (m_image_data != nullptr)
+      {
+         m_arena_allocator.destroy(m_image_data_count, m_image_data);
+      }
+   }
+
+private:
+   /**
+    * @brief Storage for the backend data of one image.
+    */
+   struct image_data_slot
+   {
+      alignas(image_data_type) unsigned char storage[sizeof(image_data_type)];
+      bool constructed;
+   };
+
+   /**
+    * @brief Backend data of the images, indexed like @ref m_swapchain_images, nullptr until first created.
+    */
+   image_data_slot *m_image_data{ nullptr };
+   size_t m_image_data_count{ 0 };
+
+   swapchain_type &backend()
+   {
+      return static_cast<swapchain_type &>(*this);
+   }
+
+   uint32_t get_image_index(const swapchain_image &image) const
+   {
+      assert(&image >= m_swapchain_images.data() && &image < m_swapchain_images.data() + m_swapchain_images.size());
+      return static_cast<uint32_t>(&image - m_swapchain_images.data());
+   }
+
+   void page_flip_thread() final
+   {
+      /* No mutex is needed for the accesses to m_page_flip_thread_run variable as after the variable is
+       * initialized it is only ever changed to false. The while loop will make the thread read the
+       * value repeatedly, and the combination of semaphores and thread joins will force any changes to
+       * the variable to be visible to this thread.
+       */
+      while (m_page_flip_thread_run)
+      {
+         pending_present_request submit_info{};
+         if (!dequeue_present_request(submit_info))
+         {
+            continue;
+         }
+
+         /* We may need to wait for the payload of the present sync of the oldest pending image to be finished. */
+         VkResult vk_res;
+         {
+            WSI_TRACE_SCOPE("image_wait_present");
+            uint64_t wait_start = begin_render_wait(submit_info);
+            swapchain_image &image = m_swapchain_images[submit_info.image_index];
+            /* Bound the wait so that the loop notices when the present watchdog gives up on the swapchain. */
+            const uint64_t wait_timeout = present_watchdog::get_poll_period_ns();
+            bool warned = false;
+            while ((vk_res = backend().image_wait_present(image, wait_timeout)) == VK_TIMEOUT)
+            {
+               if (error_has_occured())
+               {
+                  vk_res = get_error_state();
+                  break;
+               }
+               if (!warned)
+               {
+                  WSI_LOG_SWAPCHAIN_WARNING("Timeout waiting for image's present fences, retrying..");
+                  warned = true;
+               }
+            }
+            end_render_wait(submit_info, wait_start);
+         }
+         if (vk_res != VK_SUCCESS)
+         {
+            drop_present_request(vk_res);
+            continue;
+         }
+
+         typed_swapchain::call_present(submit_info);
+      }
+   }
+
+   void call_present(const pending_present_request &pending_present) final
+   {
+      WSI_TRACE_SCOPE("present_image");
+      uint64_t present_start = begin_present(pending_present);
+      backend().present_image(pending_present);
+      end_present(pending_present, present_start);
+   }
+
+   VkResult call_get_free_buffer(uint64_t *timeout) final
+   {
+      return backend().get_free_buffer(timeout);
+   }
+};
+
 } /* namespace wsi */
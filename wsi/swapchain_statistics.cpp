@@ -0,0 +1,377 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file swapchain_statistics.cpp
+ *
+ * @brief Contains the implementation of the per swapchain frame statistics collector.
+ */
+
+#include "swapchain_statistics.hpp"
+
+#include <charconv>
+#include <chrono>
+#include <cinttypes>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <system_error>
+#include <thread>
+
+#include "util/memory_accounting.hpp"
+
+namespace wsi
+{
+
+namespace
+{
+
+/**
+ * @brief Reporting configuration, read once from the environment.
+ */
+struct statistics_config
+{
+   bool enabled{ false };
+   const char *file{ nullptr };
+   uint64_t interval_ns{ 0 };
+   bool latency{ false };
+
+   statistics_config()
+   {
+      if (const char *env = std::getenv("VULKAN_WSI_STATS_FILE"))
+      {
+         enabled = true;
+         file = env;
+      }
+
+      if (const char *env = std::getenv("VULKAN_WSI_STATS_INTERVAL_MS"))
+      {
+         uint64_t interval_ms = 0;
+         std::from_chars(env, env + std::strlen(env), interval_ms);
+         enabled = true;
+         interval_ns = interval_ms * (util::NSEC_PER_SEC / 1000);
+      }
+
+      if (const char *env = std::getenv("VULKAN_WSI_LATENCY_MEASUREMENT"))
+      {
+         latency = std::strcmp(env, "0") != 0;
+         enabled = enabled || latency;
+      }
+   }
+};
+
+const statistics_config &get_config()
+{
+   static statistics_config config;
+   return config;
+}
+
+/**
+ * @brief Serializes the reports of all the swapchains so they do not interleave.
+ */
+std::mutex g_report_lock;
+
+void print_histogram(std::FILE *out, const char *name, const char *unit, const util::histogram &hist)
+{
+   std::fprintf(out,
+                "  %s: samples=%" PRIu64 " mean=%" PRIu64 "%s p50=%" PRIu64 "%s p90=%" PRIu64 "%s p99=%" PRIu64
+                "%s max=%" PRIu64 "%s\n",
+                name, hist.get_count(), hist.get_mean(), unit, hist.get_percentile(50), unit,
+                hist.get_percentile(90), unit, hist.get_percentile(99), unit, hist.get_max(), unit);
+
+   if (hist.get_count() == 0)
+   {
+      return;
+   }
+
+   std::fprintf(out, "   ");
+   for (size_t i = 0; i < util::histogram::NUM_BUCKETS; i++)
+   {
+      uint64_t count = hist.get_bucket_count(i);
+      if (count != 0)
+      {
+         std::fprintf(out, " [<%" PRIu64 "%s]=%" PRIu64, util::histogram::get_bucket_upper_bound(i), unit, count);
+      }
+   }
+   std::fprintf(out, "\n");
+}
+
+void get_histogram(VkSwapchainHistogramWSI &out, const util::histogram &hist)
+{
+   static_assert(VK_SWAPCHAIN_STATISTICS_HISTOGRAM_BUCKET_COUNT_WSI == util::histogram::NUM_BUCKETS,
+                 "The histogram layout does not match the API");
+
+   out.sampleCount = hist.get_count();
+   out.sum = hist.get_sum();
+   out.max = hist.get_max();
+   for (size_t i = 0; i < util::histogram::NUM_BUCKETS; i++)
+   {
+      out.buckets[i] = hist.get_bucket_count(i);
+   }
+}
+
+} /* namespace */
+
+/**
+ * @brief Thread generating the periodic reports of all the swapchains.
+ */
+class statistics_reporter
+{
+public:
+   ~statistics_reporter()
+   {
+      {
+         std::lock_guard<std::mutex> lock(m_lock);
+         m_run = false;
+      }
+      m_cond.notify_all();
+      if (m_thread.joinable())
+      {
+         m_thread.join();
+      }
+   }
+
+   void add(swapchain_statistics &statistics, const void *swapchain)
+   {
+      std::lock_guard<std::mutex> lock(m_lock);
+      if (statistics.m_report_swapchain != nullptr)
+      {
+         return;
+      }
+      if (!m_thread.joinable())
+      {
+         try
+         {
+            m_thread = std::thread(&statistics_reporter::thread_main, this);
+         }
+         catch (const std::system_error &)
+         {
+            return;
+         }
+         catch (const std::bad_alloc &)
+         {
+            return;
+         }
+      }
+
+      statistics.m_report_swapchain = swapchain;
+      statistics.m_report_prev = nullptr;
+      statistics.m_report_next = m_head;
+      if (m_head != nullptr)
+      {
+         m_head->m_report_prev = &statistics;
+      }
+      m_head = &statistics;
+   }
+
+   void remove(swapchain_statistics &statistics)
+   {
+      std::lock_guard<std::mutex> lock(m_lock);
+      if (statistics.m_report_swapchain == nullptr)
+      {
+         return;
+      }
+
+      if (statistics.m_report_prev != nullptr)
+      {
+         statistics.m_report_prev->m_report_next = statistics.m_report_next;
+      }
+      else
+      {
+         m_head = statistics.m_report_next;
+      }
+      if (statistics.m_report_next != nullptr)
+      {
+         statistics.m_report_next->m_report_prev = statistics.m_report_prev;
+      }
+      statistics.m_report_swapchain = nullptr;
+      statistics.m_report_prev = nullptr;
+      statistics.m_report_next = nullptr;
+   }
+
+private:
+   void thread_main()
+   {
+      const auto period = std::chrono::nanoseconds(get_config().interval_ns);
+
+      std::unique_lock<std::mutex> lock(m_lock);
+      while (m_run)
+      {
+         m_cond.wait_for(lock, period);
+         if (!m_run)
+         {
+            break;
+         }
+
+         /* The lock is held while reporting so that a swapchain cannot be destroyed in the meantime. */
+         for (swapchain_statistics *statistics = m_head; statistics != nullptr; statistics = statistics->m_report_next)
+         {
+            statistics->report(statistics->m_report_swapchain, "periodic");
+         }
+      }
+   }
+
+   std::mutex m_lock;
+   std::condition_variable m_cond;
+   std::thread m_thread;
+   bool m_run{ true };
+   swapchain_statistics *m_head{ nullptr };
+};
+
+namespace
+{
+
+statistics_reporter &get_reporter()
+{
+   static statistics_reporter instance;
+   return instance;
+}
+
+} /* namespace */
+
+swapchain_statistics::swapchain_statistics()
+   : m_creation_time_ns(util::get_monotonic_time_ns())
+{
+}
+
+bool swapchain_statistics::is_latency_measurement_enabled()
+{
+   return get_config().latency;
+}
+
+void swapchain_statistics::record_present_complete(const present_timestamps &timestamps, uint64_t complete_ns)
+{
+   /* Discard the requests whose stages were not all observed, e.g. the ones queued before the first present. */
+   if (timestamps.queue_present_ns == 0 || timestamps.render_done_ns < timestamps.queue_present_ns ||
+       timestamps.backend_submit_ns < timestamps.render_done_ns || complete_ns < timestamps.backend_submit_ns)
+   {
+      return;
+   }
+
+   m_latency.render_us.record((timestamps.render_done_ns - timestamps.queue_present_ns) / util::NSEC_PER_USEC);
+   m_latency.submit_us.record((timestamps.backend_submit_ns - timestamps.render_done_ns) / util::NSEC_PER_USEC);
+   m_latency.display_us.record((complete_ns - timestamps.backend_submit_ns) / util::NSEC_PER_USEC);
+   m_latency.end_to_end_us.record((complete_ns - timestamps.queue_present_ns) / util::NSEC_PER_USEC);
+}
+
+void swapchain_statistics::start_periodic_reports(const void *swapchain)
+{
+   const auto &config = get_config();
+   if (config.enabled && config.interval_ns != 0)
+   {
+      get_reporter().add(*this, swapchain);
+   }
+}
+
+void swapchain_statistics::stop_periodic_reports()
+{
+   const auto &config = get_config();
+   if (config.enabled && config.interval_ns != 0)
+   {
+      get_reporter().remove(*this);
+   }
+}
+
+void swapchain_statistics::report(const void *swapchain, const char *reason)
+{
+   const auto &config = get_config();
+   if (!config.enabled)
+   {
+      return;
+   }
+
+   std::lock_guard<std::mutex> lock(g_report_lock);
+
+   std::FILE *out = stderr;
+   if (config.file != nullptr && std::strcmp(config.file, "stderr") != 0)
+   {
+      out = std::fopen(config.file, "a");
+      if (out == nullptr)
+      {
+         return;
+      }
+   }
+
+   uint64_t uptime_ms = (util::get_monotonic_time_ns() - m_creation_time_ns) / (util::NSEC_PER_SEC / 1000);
+   std::fprintf(out, "WSI swapchain statistics %p (%s, uptime %" PRIu64 " ms):\n", swapchain, reason, uptime_ms);
+   std::fprintf(out, "  acquires=%" PRIu64 " presents=%" PRIu64 " dropped_frames=%" PRIu64
+                     " error_transitions=%" PRIu64 " last_error_state=%d\n",
+                m_app.acquire_count.load(std::memory_order_relaxed),
+                m_app.present_count.load(std::memory_order_relaxed),
+                m_events.dropped_frames.load(std::memory_order_relaxed),
+                m_events.error_transitions.load(std::memory_order_relaxed),
+                static_cast<int>(m_events.last_error_state.load(std::memory_order_relaxed)));
+   print_histogram(out, "acquire_wait", "us", m_app.acquire_wait_us);
+   print_histogram(out, "queue_depth", "", m_app.queue_depth);
+   print_histogram(out, "image_wait_present", "us", m_presenter.image_wait_present_us);
+   print_histogram(out, "present_image", "us", m_presenter.backend_present_us);
+   print_histogram(out, "present_to_latch", "us", m_presenter.present_to_latch_us);
+   if (config.latency)
+   {
+      print_histogram(out, "latency_render", "us", m_latency.render_us);
+      print_histogram(out, "latency_submit", "us", m_latency.submit_us);
+      print_histogram(out, "latency_display", "us", m_latency.display_us);
+      print_histogram(out, "latency_end_to_end", "us", m_latency.end_to_end_us);
+   }
+   std::fprintf(out, "  image_memory=%" PRIu64 " bytes\n", m_events.image_memory_bytes.load(std::memory_order_relaxed));
+   util::memory_accounting::report(out);
+
+   if (out != stderr)
+   {
+      std::fclose(out);
+   }
+   else
+   {
+      std::fflush(out);
+   }
+}
+
+void swapchain_statistics::get_statistics(VkSwapchainStatisticsWSI &statistics) const
+{
+   statistics.acquireCount = m_app.acquire_count.load(std::memory_order_relaxed);
+   statistics.presentCount = m_app.present_count.load(std::memory_order_relaxed);
+   statistics.droppedFrameCount = m_events.dropped_frames.load(std::memory_order_relaxed);
+   statistics.errorTransitionCount = m_events.error_transitions.load(std::memory_order_relaxed);
+   statistics.lastErrorState = m_events.last_error_state.load(std::memory_order_relaxed);
+   statistics.allocatedBytes = m_events.image_memory_bytes.load(std::memory_order_relaxed);
+   get_histogram(statistics.acquireWait, m_app.acquire_wait_us);
+   get_histogram(statistics.presentToLatch, m_presenter.present_to_latch_us);
+   get_histogram(statistics.imageWaitPresent, m_presenter.image_wait_present_us);
+   get_histogram(statistics.backendPresent, m_presenter.backend_present_us);
+   get_histogram(statistics.queueDepth, m_app.queue_depth);
+}
+
+void swapchain_statistics::get_latency_statistics(VkSwapchainLatencyStatisticsWSI &statistics) const
+{
+   statistics.measurementEnabled = is_latency_measurement_enabled() ? VK_TRUE : VK_FALSE;
+   get_histogram(statistics.render, m_latency.render_us);
+   get_histogram(statistics.submit, m_latency.submit_us);
+   get_histogram(statistics.display, m_latency.display_us);
+   get_histogram(statistics.endToEnd, m_latency.end_to_end_us);
+}
+
+} /* namespace wsi */
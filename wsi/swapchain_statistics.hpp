@@ -0,0 +1,294 @@
+/*
+ * Copyright (c) 2026 Arm Limited.
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file swapchain_statistics.hpp
+ *
+ * @brief Contains the definition of the per swapchain frame statistics collector.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include <vulkan/vulkan.h>
+
+#include "util/clock.hpp"
+#include "util/histogram.hpp"
+#include "layer/wsi_layer_statistics.hpp"
+
+namespace wsi
+{
+
+/**
+ * @brief Size of a cache line, used to keep counters written by different threads apart.
+ */
+static constexpr size_t CACHE_LINE_SIZE = 64;
+
+/**
+ * @brief CLOCK_MONOTONIC timestamps of the stages of a present request, in nanoseconds.
+ *
+ * A timestamp of 0 means the stage has not been reached yet.
+ */
+struct present_timestamps
+{
+   /* Entry of vkQueuePresentKHR. */
+   uint64_t queue_present_ns{ 0 };
+   /* Rendering of the image completed, observed after image_wait_present. */
+   uint64_t render_done_ns{ 0 };
+   /* Submission of the image to the backend. */
+   uint64_t backend_submit_ns{ 0 };
+};
+
+/**
+ * @brief Low overhead frame statistics collected for a swapchain.
+ *
+ * The counters are updated with relaxed atomics from the application threads and the
+ * page flip thread. Counters written by different threads live in separate cache lines
+ * so that recording a sample does not cause false sharing.
+ *
+ * The statistics are always collected. Reporting is controlled with environment variables:
+ * - VULKAN_WSI_STATS_FILE: path of the file the statistics are appended to, or "stderr".
+ * - VULKAN_WSI_STATS_INTERVAL_MS: interval in milliseconds between two periodic reports.
+ *
+ * - VULKAN_WSI_LATENCY_MEASUREMENT: set to 1 to measure the latency of each stage of the present
+ *   requests, up to the completion reported by the presentation engine.
+ *
+ * Reporting is enabled if any of the variables is set. When enabled, the statistics are always
+ * reported when the swapchain is destroyed and, if an interval is set, periodically by a reporting
+ * thread shared by all the swapchains, so the file I/O stays out of the application's present path.
+ */
+class swapchain_statistics
+{
+public:
+   swapchain_statistics();
+
+   swapchain_statistics(const swapchain_statistics &) = delete;
+   swapchain_statistics &operator=(const swapchain_statistics &) = delete;
+
+   /**
+    * @brief Record an acquire request.
+    *
+    * @param wait_time_ns Time spent waiting for a free image in nanoseconds.
+    */
+   void record_acquire(uint64_t wait_time_ns)
+   {
+      m_app.acquire_count.fetch_add(1, std::memory_order_relaxed);
+      m_app.acquire_wait_us.record(wait_time_ns / util::NSEC_PER_USEC);
+   }
+
+   /**
+    * @brief Record a present request.
+    *
+    * @param queue_depth Number of present requests pending in the presentation queue
+    *                    once the new request has been enqueued.
+    */
+   void record_present(uint64_t queue_depth)
+   {
+      m_app.present_count.fetch_add(1, std::memory_order_relaxed);
+      m_app.queue_depth.record(queue_depth);
+   }
+
+   /**
+    * @brief Record the time spent waiting for the present payload of an image.
+    *
+    * @param wait_time_ns Time spent in image_wait_present in nanoseconds.
+    */
+   void record_image_wait_present(uint64_t wait_time_ns)
+   {
+      m_presenter.image_wait_present_us.record(wait_time_ns / util::NSEC_PER_USEC);
+   }
+
+   /**
+    * @brief Record the time spent in the backend present_image call.
+    *
+    * @param present_time_ns Time spent in present_image in nanoseconds.
+    */
+   void record_backend_present(uint64_t present_time_ns)
+   {
+      m_presenter.backend_present_us.record(present_time_ns / util::NSEC_PER_USEC);
+   }
+
+   /**
+    * @brief Record the time between a present request and the hand-over of its image to the presentation engine.
+    *
+    * @param latch_time_ns Time elapsed since the present request in nanoseconds.
+    */
+   void record_present_to_latch(uint64_t latch_time_ns)
+   {
+      m_presenter.present_to_latch_us.record(latch_time_ns / util::NSEC_PER_USEC);
+   }
+
+   /**
+    * @brief Check if the latency measurement mode is enabled.
+    */
+   static bool is_latency_measurement_enabled();
+
+   /**
+    * @brief Record the completion of a present request by the presentation engine.
+    *
+    * Only call when the latency measurement mode is enabled.
+    *
+    * @param timestamps  Timestamps of the stages of the present request.
+    * @param complete_ns Time the presentation engine reported the image as presented, in nanoseconds
+    *                    of CLOCK_MONOTONIC.
+    */
+   void record_present_complete(const present_timestamps &timestamps, uint64_t complete_ns);
+
+   /**
+    * @brief Record the device memory bound to a swapchain image.
+    *
+    * @param size Size of the memory in bytes.
+    */
+   void record_image_memory(uint64_t size)
+   {
+      m_events.image_memory_bytes.fetch_add(size, std::memory_order_relaxed);
+   }
+
+   /**
+    * @brief Record a frame that was queued for presentation but never shown.
+    */
+   void record_dropped_frame()
+   {
+      m_events.dropped_frames.fetch_add(1, std::memory_order_relaxed);
+   }
+
+   /**
+    * @brief Record a change of the swapchain error state.
+    *
+    * @param state The new error state.
+    */
+   void record_error_transition(VkResult state)
+   {
+      m_events.error_transitions.fetch_add(1, std::memory_order_relaxed);
+      m_events.last_error_state.store(state, std::memory_order_relaxed);
+   }
+
+   /**
+    * @brief Start reporting the statistics periodically. Does nothing if no reporting interval is set.
+    *
+    * @param swapchain Handle of the swapchain, used to identify the reports.
+    */
+   void start_periodic_reports(const void *swapchain);
+
+   /**
+    * @brief Stop reporting the statistics periodically. Does nothing if the reports were not started.
+    *
+    * Once this returns, the reporting thread no longer accesses the statistics.
+    */
+   void stop_periodic_reports();
+
+   /**
+    * @brief Report the statistics if reporting is enabled.
+    *
+    * @param swapchain Handle of the swapchain, used to identify the report.
+    * @param reason    Short string describing why the report is generated.
+    */
+   void report(const void *swapchain, const char *reason);
+
+   /**
+    * @brief Get a snapshot of the statistics.
+    *
+    * The counters are sampled independently, so a snapshot taken while the swapchain is in use
+    * may be slightly inconsistent. The queue depth is not filled as it is owned by the swapchain.
+    *
+    * @param[out] statistics The structure to fill.
+    */
+   void get_statistics(VkSwapchainStatisticsWSI &statistics) const;
+
+   /**
+    * @brief Get a snapshot of the latency distributions of the present requests.
+    *
+    * @param[out] statistics The structure to fill.
+    */
+   void get_latency_statistics(VkSwapchainLatencyStatisticsWSI &statistics) const;
+
+private:
+   /**
+    * @brief Counters updated by the application threads.
+    */
+   struct alignas(CACHE_LINE_SIZE) app_counters
+   {
+      std::atomic<uint64_t> acquire_count{ 0 };
+      std::atomic<uint64_t> present_count{ 0 };
+      util::histogram acquire_wait_us;
+      util::histogram queue_depth;
+   };
+
+   /**
+    * @brief Counters updated by the thread presenting the images.
+    */
+   struct alignas(CACHE_LINE_SIZE) presenter_counters
+   {
+      util::histogram image_wait_present_us;
+      util::histogram backend_present_us;
+      util::histogram present_to_latch_us;
+   };
+
+   /**
+    * @brief Counters for rare events that may be updated from any thread.
+    */
+   struct alignas(CACHE_LINE_SIZE) event_counters
+   {
+      std::atomic<uint64_t> dropped_frames{ 0 };
+      std::atomic<uint64_t> error_transitions{ 0 };
+      std::atomic<VkResult> last_error_state{ VK_SUCCESS };
+      std::atomic<uint64_t> image_memory_bytes{ 0 };
+   };
+
+   /**
+    * @brief Latency distributions, updated by the thread receiving the completion events.
+    */
+   struct alignas(CACHE_LINE_SIZE) latency_counters
+   {
+      util::histogram render_us;
+      util::histogram submit_us;
+      util::histogram display_us;
+      util::histogram end_to_end_us;
+   };
+
+   app_counters m_app;
+   presenter_counters m_presenter;
+   latency_counters m_latency;
+   event_counters m_events;
+
+   /**
+    * @brief Time of creation of the statistics in nanoseconds.
+    */
+   uint64_t m_creation_time_ns;
+
+   /* The fields below are protected by the lock of the reporting thread. */
+
+   /**
+    * @brief Swapchain the periodic reports are generated for, nullptr when they are not started.
+    */
+   const void *m_report_swapchain{ nullptr };
+   swapchain_statistics *m_report_prev{ nullptr };
+   swapchain_statistics *m_report_next{ nullptr };
+
+   friend class statistics_reporter;
+};
+
+} /* namespace wsi */
@@ -169,6 +169,194 @@ std::optional<util::fd_owner> sync_fd_fence_sync::export_sync_fd()
    return std::nullopt;
 }
 
+timeline_semaphore_sync::timeline_semaphore_sync(layer::device_private_data &device, VkSemaphore vk_semaphore,
+                                                 PFN_vkWaitSemaphores wait_semaphores)
+   : semaphore{ vk_semaphore }
+   , wait_semaphores_fn{ wait_semaphores }
+   , dev{ &device }
+{
+}
+
+/**
+ * @brief Get the vkWaitSemaphores entrypoint of a device, either from core Vulkan 1.2 or VK_KHR_timeline_semaphore.
+ */
+static std::optional<PFN_vkWaitSemaphores> get_wait_semaphores_fn(const layer::device_private_data &device)
+{
+   auto wait_semaphores = device.disp.get_fn<PFN_vkWaitSemaphores>("vkWaitSemaphores");
+   if (!wait_semaphores.has_value() || *wait_semaphores == nullptr)
+   {
+      wait_semaphores = device.disp.get_fn<PFN_vkWaitSemaphoresKHR>("vkWaitSemaphoresKHR");
+   }
+   if (!wait_semaphores.has_value() || *wait_semaphores == nullptr)
+   {
+      return std::nullopt;
+   }
+   return wait_semaphores;
+}
+
+bool timeline_semaphore_sync::is_supported(const layer::device_private_data &device)
+{
+   return device.is_timeline_semaphore_enabled() && get_wait_semaphores_fn(device).has_value();
+}
+
+std::optional<timeline_semaphore_sync> timeline_semaphore_sync::create(layer::device_private_data &device)
+{
+   auto wait_semaphores = get_wait_semaphores_fn(device);
+   if (!device.is_timeline_semaphore_enabled() || !wait_semaphores.has_value())
+   {
+      return std::nullopt;
+   }
+
+   VkSemaphoreTypeCreateInfo type_info = {};
+   type_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+   type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+   type_info.initialValue = 0;
+   VkSemaphoreCreateInfo semaphore_info = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, &type_info, 0 };
+   VkSemaphore semaphore = VK_NULL_HANDLE;
+   VkResult res = device.disp.CreateSemaphore(device.device, &semaphore_info,
+                                              device.get_allocator().get_original_callbacks(), &semaphore);
+   if (res != VK_SUCCESS)
+   {
+      return std::nullopt;
+   }
+   return timeline_semaphore_sync{ device, semaphore, *wait_semaphores };
+}
+
+timeline_semaphore_sync::timeline_semaphore_sync(timeline_semaphore_sync &&rhs)
+{
+   *this = std::move(rhs);
+}
+
+timeline_semaphore_sync &timeline_semaphore_sync::operator=(timeline_semaphore_sync &&rhs)
+{
+   std::swap(semaphore, rhs.semaphore);
+   std::swap(last_queue, rhs.last_queue);
+   std::swap(last_point, rhs.last_point);
+   std::swap(completed_point, rhs.completed_point);
+   std::swap(wait_semaphores_fn, rhs.wait_semaphores_fn);
+   std::swap(dev, rhs.dev);
+   return *this;
+}
+
+timeline_semaphore_sync::~timeline_semaphore_sync()
+{
+   if (semaphore != VK_NULL_HANDLE)
+   {
+      wait_payload(last_point, UINT64_MAX);
+      dev->disp.DestroySemaphore(dev->device, semaphore, dev->get_allocator().get_original_callbacks());
+   }
+}
+
+VkResult timeline_semaphore_sync::wait_payload(uint64_t point, uint64_t timeout)
+{
+   if (point <= completed_point)
+   {
+      return VK_SUCCESS;
+   }
+
+   VkSemaphoreWaitInfo wait_info = {};
+   wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+   wait_info.semaphoreCount = 1;
+   wait_info.pSemaphores = &semaphore;
+   wait_info.pValues = &point;
+   VkResult res = wait_semaphores_fn(dev->device, &wait_info, timeout);
+   if (res == VK_SUCCESS)
+   {
+      completed_point = point;
+   }
+   return res;
+}
+
+VkResult timeline_semaphore_sync::set_payload(VkQueue queue, const queue_submit_semaphores &semaphores,
+                                              const void *submission_pnext, uint64_t &point)
+{
+   const uint64_t next_point = last_point + 1;
+
+   /* The timeline semaphore is signalled after the caller's signal semaphores, whose values are ignored as they are
+    * binary semaphores. Try to avoid memory allocation when there are none. */
+   const VkSemaphore *signal_semaphores = &semaphore;
+   const uint64_t *signal_values = &next_point;
+   const uint32_t signal_count = semaphores.signal_semaphores_count + 1;
+
+   util::vector<VkSemaphore> signal_semaphores_vector{ util::allocator(dev->get_allocator(),
+                                                                       VK_SYSTEM_ALLOCATION_SCOPE_COMMAND) };
+   util::vector<uint64_t> signal_values_vector{ util::allocator(dev->get_allocator(),
+                                                                VK_SYSTEM_ALLOCATION_SCOPE_COMMAND) };
+   if (semaphores.signal_semaphores_count > 0)
+   {
+      if (!signal_semaphores_vector.try_resize(signal_count) || !signal_values_vector.try_resize(signal_count, 0))
+      {
+         return VK_ERROR_OUT_OF_HOST_MEMORY;
+      }
+      std::copy(semaphores.signal_semaphores, semaphores.signal_semaphores + semaphores.signal_semaphores_count,
+                signal_semaphores_vector.begin());
+      signal_semaphores_vector[signal_count - 1] = semaphore;
+      signal_values_vector[signal_count - 1] = next_point;
+      signal_semaphores = signal_semaphores_vector.data();
+      signal_values = signal_values_vector.data();
+   }
+
+   /* Submission order keeps the points in order on a single queue. On another queue, the payload also waits for the
+    * previous point, appended to the caller's wait semaphores. */
+   const VkSemaphore *wait_semaphores = semaphores.wait_semaphores;
+   uint32_t wait_count = semaphores.wait_semaphores_count;
+   util::vector<VkSemaphore> wait_semaphores_vector{ util::allocator(dev->get_allocator(),
+                                                                     VK_SYSTEM_ALLOCATION_SCOPE_COMMAND) };
+   util::vector<uint64_t> wait_values_vector{ util::allocator(dev->get_allocator(),
+                                                              VK_SYSTEM_ALLOCATION_SCOPE_COMMAND) };
+   if (last_queue != VK_NULL_HANDLE && last_queue != queue)
+   {
+      wait_count++;
+      if (!wait_semaphores_vector.try_resize(wait_count) || !wait_values_vector.try_resize(wait_count, 0))
+      {
+         return VK_ERROR_OUT_OF_HOST_MEMORY;
+      }
+      std::copy(semaphores.wait_semaphores, semaphores.wait_semaphores + semaphores.wait_semaphores_count,
+                wait_semaphores_vector.begin());
+      wait_semaphores_vector[wait_count - 1] = semaphore;
+      wait_values_vector[wait_count - 1] = last_point;
+      wait_semaphores = wait_semaphores_vector.data();
+   }
+
+   VkTimelineSemaphoreSubmitInfo timeline_info = {};
+   timeline_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+   timeline_info.pNext = submission_pnext;
+   timeline_info.waitSemaphoreValueCount = static_cast<uint32_t>(wait_values_vector.size());
+   timeline_info.pWaitSemaphoreValues = wait_values_vector.data();
+   timeline_info.signalSemaphoreValueCount = signal_count;
+   timeline_info.pSignalSemaphoreValues = signal_values;
+
+   const queue_submit_semaphores timeline_semaphores = { wait_semaphores, wait_count, signal_semaphores,
+                                                         signal_count };
+   TRY(sync_queue_submit(*dev, queue, VK_NULL_HANDLE, timeline_semaphores, &timeline_info));
+
+   last_queue = queue;
+   last_point = next_point;
+   point = next_point;
+   return VK_SUCCESS;
+}
+
+bool is_sync_fd_import_supported(layer::instance_private_data &instance, VkPhysicalDevice phys_dev)
+{
+   VkPhysicalDeviceExternalFenceInfoKHR external_fence_info = {};
+   external_fence_info.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_FENCE_INFO;
+   external_fence_info.handleType = VK_EXTERNAL_FENCE_HANDLE_TYPE_SYNC_FD_BIT;
+   VkExternalFencePropertiesKHR fence_properties = {};
+   fence_properties.sType = VK_STRUCTURE_TYPE_EXTERNAL_FENCE_PROPERTIES;
+   instance.disp.GetPhysicalDeviceExternalFencePropertiesKHR(phys_dev, &external_fence_info, &fence_properties);
+
+   VkPhysicalDeviceExternalSemaphoreInfoKHR external_semaphore_info = {};
+   external_semaphore_info.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_SEMAPHORE_INFO;
+   external_semaphore_info.handleType = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_SYNC_FD_BIT;
+   VkExternalSemaphorePropertiesKHR semaphore_properties = {};
+   semaphore_properties.sType = VK_STRUCTURE_TYPE_EXTERNAL_SEMAPHORE_PROPERTIES;
+   instance.disp.GetPhysicalDeviceExternalSemaphorePropertiesKHR(phys_dev, &external_semaphore_info,
+                                                                 &semaphore_properties);
+
+   return (fence_properties.externalFenceFeatures & VK_EXTERNAL_FENCE_FEATURE_IMPORTABLE_BIT_KHR) &&
+          (semaphore_properties.externalSemaphoreFeatures & VK_EXTERNAL_SEMAPHORE_FEATURE_IMPORTABLE_BIT_KHR);
+}
+
 VkResult sync_queue_submit(const layer::device_private_data &device, VkQueue queue, VkFence fence,
                            const queue_submit_semaphores &semaphores, const void *submission_pnext)
 {
@@ -184,6 +184,105 @@ private:
    sync_fd_fence_sync(layer::device_private_data &device, VkFence vk_fence);
 };
 
+/**
+ * Synchronization using a single Vulkan timeline semaphore, signalled with an increasing value per payload.
+ *
+ * Unlike @ref fence_sync, one object serves all the images of a swapchain and setting a payload does not need
+ * to reset anything: each payload gets its own point on the timeline, which can be waited on independently.
+ *
+ * The points must be signalled in increasing order, which submission order only guarantees on a single queue. A
+ * payload set on a different queue than the previous one therefore also waits for the previous point.
+ */
+class timeline_semaphore_sync
+{
+public:
+   /**
+    * Checks if a device can use timeline semaphores for synchronization.
+    *
+    * @param device The device private data to check support for.
+    *
+    * @return true if the timelineSemaphore feature is enabled and vkWaitSemaphores is available, false otherwise.
+    */
+   static bool is_supported(const layer::device_private_data &device);
+
+   /**
+    * Creates a new timeline semaphore synchronization object.
+    *
+    * @param device The device private data for which to create it.
+    *
+    * @return Empty optional on failure or initialized timeline semaphore.
+    */
+   static std::optional<timeline_semaphore_sync> create(layer::device_private_data &device);
+
+   timeline_semaphore_sync() = default;
+   timeline_semaphore_sync(const timeline_semaphore_sync &) = delete;
+   timeline_semaphore_sync &operator=(const timeline_semaphore_sync &) = delete;
+
+   timeline_semaphore_sync(timeline_semaphore_sync &&rhs);
+   timeline_semaphore_sync &operator=(timeline_semaphore_sync &&rhs);
+
+   ~timeline_semaphore_sync();
+
+   /**
+    * Waits for a payload to complete execution.
+    *
+    * @note This method is not threadsafe against other calls to it, but may be called while a payload is being set.
+    *
+    * @param point   The point returned when the payload was set, 0 for no payload.
+    * @param timeout Timeout for waiting in nanoseconds.
+    *
+    * @return VK_SUCCESS on success or if the point has already been reached.
+    *         Other error code on failure or timeout.
+    */
+   VkResult wait_payload(uint64_t point, uint64_t timeout);
+
+   /**
+    * Sets a new payload that signals the next point on the timeline once the wait semaphores are signalled.
+    *
+    * @note This method is not threadsafe against other calls to it.
+    *
+    * @param      queue            The Vulkan queue that may be used to submit synchronization commands.
+    * @param      semaphores       The wait and signal semaphores.
+    * @param      submission_pnext Chain of pointers to attach to the payload submission.
+    * @param[out] point            The point on the timeline signalled by the payload.
+    *
+    * @return VK_SUCCESS on success or other error code on failing to set the payload.
+    */
+   VkResult set_payload(VkQueue queue, const queue_submit_semaphores &semaphores, const void *submission_pnext,
+                        uint64_t &point);
+
+private:
+   /**
+    * Non-public constructor to initialize the object with valid data.
+    *
+    * @param device          The device private data for the semaphore.
+    * @param vk_semaphore    The created Vulkan timeline semaphore.
+    * @param wait_semaphores The vkWaitSemaphores entrypoint, core or from VK_KHR_timeline_semaphore.
+    */
+   timeline_semaphore_sync(layer::device_private_data &device, VkSemaphore vk_semaphore,
+                           PFN_vkWaitSemaphores wait_semaphores);
+
+   VkSemaphore semaphore{ VK_NULL_HANDLE };
+   /* Queue the last payload was submitted to. */
+   VkQueue last_queue{ VK_NULL_HANDLE };
+   /* Last point signalled by a payload, only updated by set_payload. */
+   uint64_t last_point{ 0 };
+   /* Highest point known to be reached, only updated by wait_payload. */
+   uint64_t completed_point{ 0 };
+   PFN_vkWaitSemaphores wait_semaphores_fn{ nullptr };
+   layer::device_private_data *dev{ nullptr };
+};
+
+/**
+ * @brief Check if a physical device can signal fences and semaphores by importing Sync FDs.
+ *
+ * @param instance The instance private data for the physical device.
+ * @param phys_dev The physical device to check support for.
+ *
+ * @return true if both fences and semaphores can import Sync FDs, false otherwise.
+ */
+bool is_sync_fd_import_supported(layer::instance_private_data &instance, VkPhysicalDevice phys_dev);
+
 /**
  * @brief Submit an empty queue operation for synchronization.
  *
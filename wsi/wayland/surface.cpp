@@ -32,6 +32,7 @@
 #include "wl_object_owner.hpp"
 #include "wl_helpers.hpp"
 #include "util/log.hpp"
+#include "util/trace.hpp"
 
 namespace wsi
 {
@@ -132,11 +133,19 @@ surface::surface(const init_parameters &params)
    , wayland_surface(params.surf)
    , supported_formats(params.allocator)
    , properties(this, params.allocator)
+   , presentation_clock_id(CLOCK_MONOTONIC)
    , last_frame_callback(nullptr)
    , present_pending(false)
 {
 }
 
+VWL_CAPI_CALL(void)
+presentation_clock_id_handler(void *data, wp_presentation *presentation, uint32_t clock_id) VWL_API_POST
+{
+   auto wsi_surface = reinterpret_cast<wsi::wayland::surface *>(data);
+   wsi_surface->presentation_clock_id = static_cast<clockid_t>(clock_id);
+}
+
 VWL_CAPI_CALL(void)
 surface_registry_handler(void *data, struct wl_registry *wl_registry, uint32_t name, const char *interface,
                          uint32_t version) VWL_API_POST
@@ -182,6 +191,13 @@ surface_registry_handler(void *data, struct wl_registry *wl_registry, uint32_t n
       }
 
       wsi_surface->presentation_time_interface.reset(wp_presentation_obj);
+
+      static const wp_presentation_listener presentation_listener = { presentation_clock_id_handler };
+      int res = wp_presentation_add_listener(wp_presentation_obj, &presentation_listener, wsi_surface);
+      if (res < 0)
+      {
+         WSI_LOG_ERROR("Failed to add wp_presentation listener.");
+      }
    }
 }
 
@@ -287,7 +303,8 @@ wsi::surface_properties &surface::get_properties()
 util::unique_ptr<swapchain_base> surface::allocate_swapchain(layer::device_private_data &dev_data,
                                                              const VkAllocationCallbacks *allocator)
 {
-   util::allocator alloc{ dev_data.get_allocator(), VK_SYSTEM_ALLOCATION_SCOPE_OBJECT, allocator };
+   util::allocator alloc{ dev_data.get_allocator(), VK_SYSTEM_ALLOCATION_SCOPE_OBJECT, allocator,
+                          util::memory_subsystem::swapchain };
    return util::unique_ptr<swapchain_base>(alloc.make_unique<swapchain>(dev_data, allocator, *this));
 }
 
@@ -298,6 +315,8 @@ static void frame_done(void *data, wl_callback *cb, uint32_t time)
    bool *present_pending = reinterpret_cast<bool *>(data);
    assert(present_pending);
 
+   util::trace::instant("wayland_frame_done");
+
    *present_pending = false;
 }
 
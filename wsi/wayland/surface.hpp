@@ -32,6 +32,7 @@
 #define __STDC_VERSION__ 0
 #endif
 #include <wayland-client.h>
+#include <ctime>
 
 #include "wsi/surface.hpp"
 #include "surface_properties.hpp"
@@ -111,6 +112,24 @@ public:
       return surface_sync_interface.get();
    }
 
+   /**
+    * @brief Returns a pointer to the Wayland wp_presentation interface obtained for the wayland surface.
+    *
+    * The raw pointer is valid for the lifetime of the surface.
+    */
+   wp_presentation *get_presentation_time_interface()
+   {
+      return presentation_time_interface.get();
+   }
+
+   /**
+    * @brief Returns the clock used by the compositor for the presentation timestamps.
+    */
+   clockid_t get_presentation_clock_id() const
+   {
+      return presentation_clock_id;
+   }
+
    /**
     * @brief Returns a reference to a list of DRM formats supported by the Wayland surface.
     *
@@ -146,6 +165,9 @@ private:
     */
    bool init();
 
+   friend void presentation_clock_id_handler(void *data, wp_presentation *presentation,
+                                             uint32_t clock_id) VWL_API_POST;
+
    friend void surface_registry_handler(void *data, struct wl_registry *wl_registry, uint32_t name,
                                         const char *interface, uint32_t version) VWL_API_POST;
 
@@ -176,6 +198,8 @@ private:
 
    /** Container for the wp_presentation interface binding */
    wayland_owner<wp_presentation> presentation_time_interface;
+   /** Clock of the presentation timestamps, announced by the compositor when wp_presentation is bound. */
+   clockid_t presentation_clock_id;
 
    /**
     * Container for a callback object for the latest frame done event.
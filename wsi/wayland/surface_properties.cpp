@@ -370,7 +370,8 @@ CreateWaylandSurfaceKHR(VkInstance instance, const VkWaylandSurfaceCreateInfoKHR
                         const VkAllocationCallbacks *pAllocator, VkSurfaceKHR *pSurface) VWL_API_POST
 {
    auto &instance_data = layer::instance_private_data::get(instance);
-   util::allocator allocator{ instance_data.get_allocator(), VK_SYSTEM_ALLOCATION_SCOPE_OBJECT, pAllocator };
+   util::allocator allocator{ instance_data.get_allocator(), VK_SYSTEM_ALLOCATION_SCOPE_OBJECT, pAllocator,
+                              util::memory_subsystem::surface };
    auto wsi_surface = surface::make_surface(allocator, pCreateInfo->display, pCreateInfo->surface);
    if (wsi_surface == nullptr)
    {
@@ -25,6 +25,7 @@
 #pragma once
 
 #include "wsi/surface_properties.hpp"
+#include "util/unordered_map.hpp"
 #include "util/unordered_set.hpp"
 #include "wsi/compatible_present_modes.hpp"
 
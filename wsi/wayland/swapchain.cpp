@@ -42,6 +42,7 @@
 #include "util/log.hpp"
 #include "util/helpers.hpp"
 #include "util/macros.hpp"
+#include "util/trace.hpp"
 #include "util/format_modifiers.hpp"
 
 namespace wsi
@@ -51,7 +52,7 @@ namespace wayland
 
 swapchain::swapchain(layer::device_private_data &dev_data, const VkAllocationCallbacks *pAllocator,
                      surface &wsi_surface)
-   : swapchain_base(dev_data, pAllocator)
+   : wsi::typed_swapchain<swapchain, wayland_image_data>(dev_data, pAllocator)
    , m_display(wsi_surface.get_wl_display())
    , m_surface(wsi_surface.get_wl_surface())
    , m_wsi_surface(&wsi_surface)
@@ -120,7 +121,7 @@ void swapchain::release_buffer(struct wl_buffer *wayl_buffer)
    uint32_t i;
    for (i = 0; i < m_swapchain_images.size(); i++)
    {
-      auto data = reinterpret_cast<wayland_image_data *>(m_swapchain_images[i].data);
+      auto data = get_image_data(i);
       if (data && data->buffer == wayl_buffer)
       {
          unpresent_image(i);
@@ -323,7 +324,7 @@ VkResult swapchain::allocate_wsialloc(VkImageCreateInfo &image_create_info, wayl
 }
 
 static VkResult fill_image_create_info(VkImageCreateInfo &image_create_info,
-                                       util::vector<VkSubresourceLayout> &image_plane_layouts,
+                                       wsi::plane_layouts &image_plane_layouts,
                                        VkImageDrmFormatModifierExplicitCreateInfoEXT &drm_mod_info,
                                        VkExternalMemoryImageCreateInfoKHR &external_info,
                                        wayland_image_data &image_data, uint64_t modifier)
@@ -388,11 +389,11 @@ VkResult swapchain::create_wl_buffer(const VkImageCreateInfo &image_create_info,
 
 VkResult swapchain::allocate_and_bind_swapchain_image(VkImageCreateInfo image_create_info, swapchain_image &image)
 {
-   std::unique_lock<std::recursive_mutex> image_status_lock(m_image_status_mutex);
+   util::unique_lock<util::recursive_mutex> image_status_lock(m_image_status_mutex);
    image.status = swapchain_image::FREE;
 
-   assert(image.data != nullptr);
-   auto image_data = static_cast<wayland_image_data *>(image.data);
+   assert(has_image_data(image));
+   auto image_data = get_image_data(image);
    TRY_LOG(allocate_image(image_create_info, image_data), "Failed to allocate image");
    image_status_lock.unlock();
 
@@ -415,12 +416,11 @@ VkResult swapchain::allocate_and_bind_swapchain_image(VkImageCreateInfo image_cr
 VkResult swapchain::create_swapchain_image(VkImageCreateInfo image_create_info, swapchain_image &image)
 {
    /* Create image_data */
-   auto image_data = m_allocator.create<wayland_image_data>(1, m_device, m_allocator);
+   auto image_data = create_image_data(image, m_device, m_allocator);
    if (image_data == nullptr)
    {
       return VK_ERROR_OUT_OF_HOST_MEMORY;
    }
-   image.data = image_data;
 
    if (m_image_create_info.format == VK_FORMAT_UNDEFINED)
    {
@@ -464,11 +464,80 @@ VkResult swapchain::create_swapchain_image(VkImageCreateInfo image_create_info,
    return m_device_data.disp.CreateImage(m_device, &m_image_create_info, get_allocation_callbacks(), &image.image);
 }
 
+static void release_presentation_feedback(presentation_feedback &feedback)
+{
+   if (feedback.feedback != nullptr)
+   {
+      wp_presentation_feedback_destroy(feedback.feedback);
+      feedback.feedback = nullptr;
+   }
+}
+
+static void presentation_feedback_sync_output(void *data, wp_presentation_feedback *feedback, wl_output *output)
+{
+   UNUSED(data);
+   UNUSED(feedback);
+   UNUSED(output);
+}
+
+static void presentation_feedback_presented(void *data, wp_presentation_feedback *feedback, uint32_t tv_sec_hi,
+                                            uint32_t tv_sec_lo, uint32_t tv_nsec, uint32_t refresh, uint32_t seq_hi,
+                                            uint32_t seq_lo, uint32_t flags)
+{
+   UNUSED(feedback);
+   UNUSED(refresh);
+   UNUSED(seq_hi);
+   UNUSED(seq_lo);
+   UNUSED(flags);
+
+   auto *presentation = reinterpret_cast<presentation_feedback *>(data);
+   if (presentation->clock_id == CLOCK_MONOTONIC)
+   {
+      uint64_t tv_sec = (static_cast<uint64_t>(tv_sec_hi) << 32) | tv_sec_lo;
+      presentation->statistics->record_present_complete(presentation->timestamps,
+                                                        tv_sec * util::NSEC_PER_SEC + tv_nsec);
+   }
+   release_presentation_feedback(*presentation);
+}
+
+static void presentation_feedback_discarded(void *data, wp_presentation_feedback *feedback)
+{
+   UNUSED(feedback);
+   release_presentation_feedback(*reinterpret_cast<presentation_feedback *>(data));
+}
+
+void swapchain::request_presentation_feedback(wayland_image_data &image_data, const present_timestamps &timestamps)
+{
+   /* A feedback still pending from a previous present of the image is not going to be measured. */
+   release_presentation_feedback(image_data.feedback);
+
+   image_data.feedback.feedback =
+      wp_presentation_feedback(m_wsi_surface->get_presentation_time_interface(), m_surface);
+   if (image_data.feedback.feedback == nullptr)
+   {
+      WSI_LOG_WARNING("Failed to request presentation feedback.");
+      return;
+   }
+
+   /* Dispatch the feedback events along with the buffer release events. */
+   wl_proxy_set_queue(reinterpret_cast<wl_proxy *>(image_data.feedback.feedback), m_buffer_queue);
+
+   image_data.feedback.statistics = &m_statistics;
+   image_data.feedback.timestamps = timestamps;
+   image_data.feedback.clock_id = m_wsi_surface->get_presentation_clock_id();
+
+   static const wp_presentation_feedback_listener feedback_listener = {
+      presentation_feedback_sync_output,
+      presentation_feedback_presented,
+      presentation_feedback_discarded,
+   };
+   wp_presentation_feedback_add_listener(image_data.feedback.feedback, &feedback_listener, &image_data.feedback);
+}
+
 void swapchain::present_image(const pending_present_request &pending_present)
 {
    int res;
-   wayland_image_data *image_data =
-      reinterpret_cast<wayland_image_data *>(m_swapchain_images[pending_present.image_index].data);
+   wayland_image_data *image_data = get_image_data(pending_present.image_index);
 
    /* if a frame is already pending, wait for a hint to present again */
    if (!m_wsi_surface->wait_next_frame_event())
@@ -501,6 +570,11 @@ void swapchain::present_image(const pending_present_request &pending_present)
       }
    }
 
+   if (swapchain_statistics::is_latency_measurement_enabled())
+   {
+      request_presentation_feedback(*image_data, m_swapchain_images[pending_present.image_index].timestamps);
+   }
+
    wl_surface_commit(m_surface);
    res = wl_display_flush(m_display);
    if (res < 0)
@@ -510,12 +584,13 @@ void swapchain::present_image(const pending_present_request &pending_present)
       set_error_state(VK_ERROR_SURFACE_LOST_KHR);
    }
 
+   util::trace::flow(util::trace::phase::flow_end, "present", this, pending_present.present_id);
    set_present_id(pending_present.present_id);
 }
 
 void swapchain::destroy_image(swapchain_image &image)
 {
-   std::unique_lock<std::recursive_mutex> image_status_lock(m_image_status_mutex);
+   util::unique_lock<util::recursive_mutex> image_status_lock(m_image_status_mutex);
 
    if (image.status != swapchain_image::INVALID)
    {
@@ -530,15 +605,15 @@ void swapchain::destroy_image(swapchain_image &image)
 
    image_status_lock.unlock();
 
-   if (image.data != nullptr)
+   if (has_image_data(image))
    {
-      auto image_data = reinterpret_cast<wayland_image_data *>(image.data);
+      auto image_data = get_image_data(image);
+      release_presentation_feedback(image_data->feedback);
       if (image_data->buffer != nullptr)
       {
          wl_buffer_destroy(image_data->buffer);
       }
-      m_allocator.destroy(1, image_data);
-      image.data = nullptr;
+      destroy_image_data(image);
    }
 }
 
@@ -601,7 +676,7 @@ VkResult swapchain::get_free_buffer(uint64_t *timeout)
 VkResult swapchain::image_set_present_payload(swapchain_image &image, VkQueue queue,
                                               const queue_submit_semaphores &semaphores, const void *submission_pnext)
 {
-   auto image_data = reinterpret_cast<wayland_image_data *>(image.data);
+   auto image_data = get_image_data(image);
    return image_data->present_fence.set_payload(queue, semaphores, submission_pnext);
 }
 
@@ -616,7 +691,7 @@ VkResult swapchain::bind_swapchain_image(VkDevice &device, const VkBindImageMemo
                                          const VkBindImageMemorySwapchainInfoKHR *bind_sc_info)
 {
    const wsi::swapchain_image &swapchain_image = m_swapchain_images[bind_sc_info->imageIndex];
-   auto image_data = reinterpret_cast<wayland_image_data *>(swapchain_image.data);
+   auto image_data = get_image_data(swapchain_image);
    return image_data->external_mem.bind_swapchain_image_memory(bind_image_mem_info->image);
 }
 
@@ -47,6 +47,17 @@ namespace wsi
 namespace wayland
 {
 
+/**
+ * @brief Presentation feedback requested for the last present of an image in latency measurement mode.
+ */
+struct presentation_feedback
+{
+   swapchain_statistics *statistics{ nullptr };
+   present_timestamps timestamps{};
+   wp_presentation_feedback *feedback{ nullptr };
+   clockid_t clock_id{ CLOCK_MONOTONIC };
+};
+
 struct wayland_image_data
 {
    wayland_image_data(const VkDevice &device, const util::allocator &allocator)
@@ -58,12 +69,13 @@ struct wayland_image_data
    external_memory external_mem;
    wl_buffer *buffer;
    sync_fd_fence_sync present_fence;
+   presentation_feedback feedback;
 };
 
 struct image_creation_parameters
 {
    wsialloc_format m_allocated_format;
-   util::vector<VkSubresourceLayout> m_image_layout;
+   wsi::plane_layouts m_image_layout;
    VkExternalMemoryImageCreateInfoKHR m_external_info;
    VkImageDrmFormatModifierExplicitCreateInfoEXT m_drm_mod_info;
 
@@ -78,7 +90,7 @@ struct image_creation_parameters
    }
 };
 
-class swapchain : public wsi::swapchain_base
+class swapchain final : public wsi::typed_swapchain<swapchain, wayland_image_data>
 {
 public:
    explicit swapchain(layer::device_private_data &dev_data, const VkAllocationCallbacks *allocator,
@@ -90,6 +102,8 @@ public:
    void release_buffer(struct wl_buffer *wl_buffer);
 
 protected:
+   friend class wsi::typed_swapchain<swapchain, wayland_image_data>;
+
    /**
     * @brief Initialize platform specifics.
     */
@@ -125,7 +139,7 @@ protected:
     *
     * @param pending_present Information on the pending present request.
     */
-   void present_image(const pending_present_request &pending_present) override;
+   void present_image(const pending_present_request &pending_present);
 
    /**
     * @brief Method to release a swapchain image
@@ -150,7 +164,7 @@ protected:
     *                        be set to 0 if the semaphore is now not expected
     *                        block.
     */
-   VkResult get_free_buffer(uint64_t *timeout) override;
+   VkResult get_free_buffer(uint64_t *timeout);
 
    /**
     * @brief Sets the present payload for a swapchain image.
@@ -163,9 +177,9 @@ protected:
     * @return VK_SUCCESS on success or an error code otherwise.
     */
    VkResult image_set_present_payload(swapchain_image &image, VkQueue queue, const queue_submit_semaphores &semaphores,
-                                      const void *submission_pnext) override;
+                                      const void *submission_pnext);
 
-   VkResult image_wait_present(swapchain_image &image, uint64_t timeout) override;
+   VkResult image_wait_present(swapchain_image &image, uint64_t timeout);
 
    /**
     * @brief Bind image to a swapchain
@@ -188,6 +202,14 @@ private:
                               util::vector<wsialloc_format> &importable_formats, wsialloc_format *allocated_format,
                               bool avoid_allocation);
 
+   /**
+    * @brief Request the presentation feedback of the next commit, to measure the latency of the present request.
+    *
+    * @param image_data The data of the presented image.
+    * @param timestamps The timestamps of the present request.
+    */
+   void request_presentation_feedback(wayland_image_data &image_data, const present_timestamps &timestamps);
+
    struct wl_display *m_display;
    struct wl_surface *m_surface;
    /** Raw pointer to the WSI Surface that this swapchain was created from. The Vulkan specification ensures that the
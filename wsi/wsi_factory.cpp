@@ -31,6 +31,7 @@
 #include "surface.hpp"
 
 #if BUILD_WSI_HEADLESS
+#include "headless/frame_capture.hpp"
 #include "headless/surface_properties.hpp"
 #endif
 
@@ -124,7 +125,12 @@ util::unique_ptr<swapchain_base> allocate_surface_swapchain(VkSurfaceKHR surface
    wsi::surface *wsi_surface = dev_data.instance_data.get_surface(surface);
    if (wsi_surface)
    {
-      return wsi_surface->allocate_swapchain(dev_data, pAllocator);
+      auto swapchain = wsi_surface->allocate_swapchain(dev_data, pAllocator);
+      if (swapchain != nullptr)
+      {
+         swapchain->set_object_size(swapchain.get_deleter().get_object_size());
+      }
+      return swapchain;
    }
    return nullptr;
 }
@@ -146,35 +152,15 @@ util::wsi_platform_set find_enabled_layer_platforms(const VkInstanceCreateInfo *
    return ret;
 }
 
-static VkResult get_available_device_extensions(VkPhysicalDevice physical_device,
-                                                util::extension_list &available_extensions)
-{
-   auto &instance_data = layer::instance_private_data::get(physical_device);
-   util::vector<VkExtensionProperties> properties{ available_extensions.get_allocator() };
-   uint32_t count = 0;
-   TRY_LOG(instance_data.disp.EnumerateDeviceExtensionProperties(physical_device, nullptr, &count, nullptr),
-           "Failed to enumurate properties of available physical device extensions");
-
-   if (!properties.try_resize(count))
-   {
-      return VK_ERROR_OUT_OF_HOST_MEMORY;
-   }
-
-   TRY_LOG(instance_data.disp.EnumerateDeviceExtensionProperties(physical_device, nullptr, &count, properties.data()),
-           "Failed to enumurate properties of available physical device extensions");
-   TRY_LOG_CALL(available_extensions.add(properties.data(), count));
-
-   return VK_SUCCESS;
-}
-
 VkResult add_device_extensions_required_by_layer(VkPhysicalDevice phys_dev,
                                                  const util::wsi_platform_set enabled_platforms,
                                                  util::extension_list &extensions_to_enable)
 {
    util::allocator allocator{ extensions_to_enable.get_allocator(), VK_SYSTEM_ALLOCATION_SCOPE_COMMAND };
 
-   util::extension_list available_device_extensions{ allocator };
-   TRY_LOG(get_available_device_extensions(phys_dev, available_device_extensions),
+   auto &instance_data = layer::instance_private_data::get(phys_dev);
+   const util::extension_list *available_device_extensions = nullptr;
+   TRY_LOG(instance_data.get_available_device_extensions(phys_dev, &available_device_extensions),
            "Failed to acquire available device extensions");
 
    /* Add optional extensions independent of winsys. */
@@ -191,13 +177,24 @@ VkResult add_device_extensions_required_by_layer(VkPhysicalDevice phys_dev,
 
       for (auto extension : optional_extensions)
       {
-         if (available_device_extensions.contains(extension))
+         if (available_device_extensions->contains(extension))
          {
             TRY_LOG_CALL(extensions_to_enable.add(extension));
          }
       }
    }
 
+#if BUILD_WSI_HEADLESS
+   /* Lets the headless capture copy the frames straight to the export file. */
+   if (enabled_platforms.contains(VK_ICD_WSI_PLATFORM_HEADLESS) && headless::frame_capture::is_export_enabled() &&
+       available_device_extensions->contains(VK_KHR_EXTERNAL_MEMORY_EXTENSION_NAME) &&
+       available_device_extensions->contains(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME))
+   {
+      TRY_LOG_CALL(extensions_to_enable.add(VK_KHR_EXTERNAL_MEMORY_EXTENSION_NAME));
+      TRY_LOG_CALL(extensions_to_enable.add(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME));
+   }
+#endif
+
    for (const auto &wsi_ext : supported_wsi_extensions)
    {
       /* Skip iterating over platforms not enabled in the instance. */
@@ -216,7 +213,7 @@ VkResult add_device_extensions_required_by_layer(VkPhysicalDevice phys_dev,
       TRY_LOG(props->get_required_device_extensions(extensions_required_by_layer),
               "Failed to acquire required device extensions");
 
-      bool supported = available_device_extensions.contains(extensions_required_by_layer);
+      bool supported = available_device_extensions->contains(extensions_required_by_layer);
       if (!supported)
       {
          /* Can we accept failure? The layer unconditionally advertises support for this platform and the loader uses
@@ -265,13 +262,31 @@ VkResult add_instance_extensions_required_by_layer(const util::wsi_platform_set
    return VK_SUCCESS;
 }
 
+void invalidate_surface_query_caches(const util::wsi_platform_set enabled_platforms)
+{
+   for (const auto &wsi_ext : supported_wsi_extensions)
+   {
+      if (!enabled_platforms.contains(wsi_ext.platform))
+      {
+         continue;
+      }
+
+      auto *props = get_surface_properties(wsi_ext.platform);
+      if (props != nullptr)
+      {
+         props->invalidate_query_cache();
+      }
+   }
+}
+
 void destroy_surface_swapchain(swapchain_base *swapchain, layer::device_private_data &dev_data,
                                const VkAllocationCallbacks *pAllocator)
 {
    assert(swapchain);
 
-   util::allocator alloc{ dev_data.get_allocator(), VK_SYSTEM_ALLOCATION_SCOPE_OBJECT, pAllocator };
-   alloc.destroy(1, swapchain);
+   util::allocator alloc{ dev_data.get_allocator(), VK_SYSTEM_ALLOCATION_SCOPE_OBJECT, pAllocator,
+                          util::memory_subsystem::swapchain };
+   alloc.destroy_sized(swapchain, swapchain->get_object_size());
 }
 
 PFN_vkVoidFunction get_proc_addr(const char *name, const layer::instance_private_data &instance_data)
@@ -110,6 +110,16 @@ VkResult add_device_extensions_required_by_layer(VkPhysicalDevice phys_dev,
 VkResult add_instance_extensions_required_by_layer(const util::wsi_platform_set enabled_platforms,
                                                    util::extension_list &extensions_to_enable);
 
+/**
+ * @brief Drop the cached surface query results of the enabled platforms.
+ *
+ * The caches are keyed by physical device handle, which may be reused by an instance created after the current
+ * one is destroyed.
+ *
+ * @param[in] enabled_platforms All the enabled platforms for the instance being destroyed.
+ */
+void invalidate_surface_query_caches(const util::wsi_platform_set enabled_platforms);
+
 /**
  * @brief Return a function pointer for surface specific functions.
  *
@@ -29,7 +29,6 @@
 #include <cstdlib>
 #include <cstring>
 
-#include <vector>
 #include <xcb/xcb.h>
 #include <X11/Xlib-xcb.h>
 #include <vulkan/vk_icd.h>
@@ -63,6 +62,7 @@ void surface_properties::populate_present_mode_compatibilities()
 surface_properties::surface_properties(surface *wsi_surface, const util::allocator &allocator)
    : specific_surface(wsi_surface)
    , m_supported_modes({ VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_MAILBOX_KHR })
+   , m_query_cache(allocator)
 {
    populate_present_mode_compatibilities();
 }
@@ -81,19 +81,26 @@ surface_properties &surface_properties::get_instance()
 VkResult surface_properties::get_surface_capabilities(VkPhysicalDevice physical_device,
                                                       VkSurfaceCapabilitiesKHR *surface_capabilities)
 {
-   /* Image count limits */
-   get_surface_capabilities_common(physical_device, surface_capabilities);
-   surface_capabilities->minImageCount = 4;
-
+   TRY_LOG_CALL(m_query_cache.get_surface_capabilities(
+      physical_device, surface_capabilities, [physical_device](VkSurfaceCapabilitiesKHR *capabilities) {
+         /* Image count limits */
+         get_surface_capabilities_common(physical_device, capabilities);
+         capabilities->minImageCount = 4;
+
+         /* Composite alpha */
+         capabilities->supportedCompositeAlpha = static_cast<VkCompositeAlphaFlagBitsKHR>(
+            VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR | VK_COMPOSITE_ALPHA_PRE_MULTIPLIED_BIT_KHR |
+            VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR);
+         return VK_SUCCESS;
+      }));
+
+   /* The window can be resized by the client at any time without the layer being notified, so the extent is
+    * never cached.
+    */
    int depth;
    specific_surface->get_size_and_depth(&surface_capabilities->currentExtent.width,
                                         &surface_capabilities->currentExtent.height, &depth);
 
-   /* Composite alpha */
-   surface_capabilities->supportedCompositeAlpha = static_cast<VkCompositeAlphaFlagBitsKHR>(
-      VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR | VK_COMPOSITE_ALPHA_PRE_MULTIPLIED_BIT_KHR |
-      VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR);
-
    return VK_SUCCESS;
 }
 
@@ -120,22 +127,25 @@ VkResult surface_properties::get_surface_capabilities(VkPhysicalDevice physical_
    return VK_SUCCESS;
 }
 
-std::vector<VkFormat> support_formats{ VK_FORMAT_B8G8R8A8_SRGB, VK_FORMAT_B8G8R8A8_UNORM };
+static constexpr std::array<VkFormat, 2> support_formats{ VK_FORMAT_B8G8R8A8_SRGB, VK_FORMAT_B8G8R8A8_UNORM };
 
 VkResult surface_properties::get_surface_formats(VkPhysicalDevice physical_device, uint32_t *surface_format_count,
                                                  VkSurfaceFormatKHR *surface_formats,
                                                  VkSurfaceFormat2KHR *extended_surface_formats)
 {
-   std::vector<surface_format_properties> formats;
-   for (auto &format : support_formats)
-   {
-      if (format != VK_FORMAT_UNDEFINED)
-      {
-         formats.insert(formats.begin(), (surface_format_properties){ format });
-      }
-   }
-   return surface_properties_formats_helper(formats.begin(), formats.end(), surface_format_count, surface_formats,
-                                            extended_surface_formats);
+   return m_query_cache.get_surface_formats(
+      physical_device, surface_format_count, surface_formats, extended_surface_formats,
+      [](util::vector<surface_format_properties> &formats) {
+         /* Formats are reported in the reverse order of support_formats. */
+         for (auto it = support_formats.rbegin(); it != support_formats.rend(); ++it)
+         {
+            if (!formats.try_push_back(surface_format_properties{ *it }))
+            {
+               return VK_ERROR_OUT_OF_HOST_MEMORY;
+            }
+         }
+         return VK_SUCCESS;
+      });
 }
 
 VkResult surface_properties::get_surface_present_modes(VkPhysicalDevice physical_device, VkSurfaceKHR surface,
@@ -171,6 +181,7 @@ VkResult surface_properties::get_required_device_extensions(util::extension_list
 static const char *required_instance_extensions[] = {
    VK_KHR_EXTERNAL_FENCE_CAPABILITIES_EXTENSION_NAME,
    VK_KHR_EXTERNAL_MEMORY_CAPABILITIES_EXTENSION_NAME,
+   VK_KHR_EXTERNAL_SEMAPHORE_CAPABILITIES_EXTENSION_NAME,
    VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME,
 };
 
@@ -186,7 +197,8 @@ CreateXcbSurfaceKHR(VkInstance instance, const VkXcbSurfaceCreateInfoKHR *pCreat
 {
 
    auto &instance_data = layer::instance_private_data::get(instance);
-   util::allocator allocator{ instance_data.get_allocator(), VK_SYSTEM_ALLOCATION_SCOPE_OBJECT, pAllocator };
+   util::allocator allocator{ instance_data.get_allocator(), VK_SYSTEM_ALLOCATION_SCOPE_OBJECT, pAllocator,
+                              util::memory_subsystem::surface };
 
    auto wsi_surface = surface::make_surface(allocator, pCreateInfo->connection, pCreateInfo->window);
    if (wsi_surface == nullptr)
@@ -339,6 +351,11 @@ void surface_properties::get_surface_present_scaling_and_gravity(
    scaling_capabilities->supportedPresentGravityY = 0;
 }
 
+void surface_properties::invalidate_query_cache()
+{
+   m_query_cache.invalidate();
+}
+
 bool surface_properties::is_compatible_present_modes(VkPresentModeKHR present_mode_a, VkPresentModeKHR present_mode_b)
 {
    return m_compatible_present_modes.is_compatible_present_modes(present_mode_a, present_mode_b);
@@ -26,6 +26,7 @@
 
 #include <wsi/surface_properties.hpp>
 #include <wsi/compatible_present_modes.hpp>
+#include <wsi/surface_query_cache.hpp>
 
 namespace wsi
 {
@@ -62,6 +63,8 @@ public:
 
    bool is_compatible_present_modes(VkPresentModeKHR present_mode_a, VkPresentModeKHR present_mode_b) override;
 
+   void invalidate_query_cache() override;
+
 #if VULKAN_WSI_LAYER_EXPERIMENTAL
    void get_present_timing_surface_caps(VkPresentTimingSurfaceCapabilitiesEXT *present_timing_surface_caps) override;
 #endif
@@ -79,6 +82,9 @@ private:
    /* Stores compatible presentation modes */
    compatible_present_modes<2> m_compatible_present_modes;
 
+   /* Cached results of the capability and format queries */
+   surface_query_cache m_query_cache;
+
    void populate_present_mode_compatibilities() override;
 
    void get_surface_present_scaling_and_gravity(VkSurfacePresentScalingCapabilitiesEXT *scaling_capabilities) override;
@@ -52,6 +52,8 @@
 
 #include "swapchain.hpp"
 #include "util/log.hpp"
+#include "util/memory_accounting.hpp"
+#include "util/trace.hpp"
 #include "wsi/swapchain_base.hpp"
 
 namespace wsi
@@ -59,43 +61,24 @@ namespace wsi
 namespace x11
 {
 
-struct pending_completion
-{
-   uint32_t serial;
-   uint64_t present_id;
-};
-
-struct x11_image_data
-{
-   /* Device memory backing the image. */
-   VkDeviceMemory memory{};
-   VkSubresourceLayout layout;
-
-   fence_sync present_fence;
-
-   xcb_pixmap_t pixmap;
-   AHardwareBuffer *ahb;
-   std::vector<pending_completion> pending_completions;
-};
-
 #define X11_SWAPCHAIN_MAX_PENDING_COMPLETIONS 128
 
 swapchain::swapchain(layer::device_private_data &dev_data, const VkAllocationCallbacks *pAllocator, surface *surface)
-   : wsi::swapchain_base(dev_data, pAllocator)
+   : wsi::typed_swapchain<swapchain, x11_image_data>(dev_data, pAllocator)
    , m_connection(surface->get_connection())
    , m_window(surface->get_window())
    , m_surface(surface)
    , m_send_sbc(0)
    , m_target_msc(0)
    , m_last_present_msc(0)
-   , m_thread_status_lock()
+   , m_thread_status_lock("x11_thread_status_lock")
    , m_thread_status_cond()
 {
 }
 
 swapchain::~swapchain()
 {
-   auto thread_status_lock = std::unique_lock<std::mutex>(m_thread_status_lock);
+   auto thread_status_lock = util::unique_lock<util::mutex>(m_thread_status_lock);
 
    if (m_present_event_thread_run)
    {
@@ -141,7 +124,7 @@ static uint32_t get_memory_type(VkPhysicalDeviceMemoryProperties2 memory_props,
 
 xcb_pixmap_t swapchain::create_pixmap(swapchain_image &image)
 {
-   auto data = reinterpret_cast<x11_image_data *>(image.data);
+   auto data = get_image_data(image);
 
    int fds[] = { -1, -1 };
    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0)
@@ -175,7 +158,7 @@ VkResult swapchain::allocate_and_bind_swapchain_image(VkImageCreateInfo image_cr
 {
    VkResult res = VK_SUCCESS;
    VkExternalMemoryHandleTypeFlags handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_ANDROID_HARDWARE_BUFFER_BIT_ANDROID;
-   const std::lock_guard<std::recursive_mutex> lock(m_image_status_mutex);
+   const util::lock_guard<util::recursive_mutex> lock(m_image_status_mutex);
 
    m_image_create_info = image_create;
    m_image_create_info.tiling = VK_IMAGE_TILING_LINEAR;
@@ -217,14 +200,16 @@ VkResult swapchain::allocate_and_bind_swapchain_image(VkImageCreateInfo image_cr
    memory_allocate_info.memoryTypeIndex = mem_type_idx;
 
    /* Create image_data */
-   x11_image_data *data = nullptr;
-   data = m_allocator.create<x11_image_data>(1);
-   if (data == nullptr)
+   x11_image_data *data = create_image_data(image, m_arena_allocator);
+   if (data == nullptr || !data->pending_completions.try_reserve(X11_SWAPCHAIN_MAX_PENDING_COMPLETIONS))
    {
+      if (data != nullptr)
+      {
+         destroy_image_data(image);
+      }
       m_device_data.disp.DestroyImage(m_device, image.image, get_allocation_callbacks());
       return VK_ERROR_OUT_OF_HOST_MEMORY;
    }
-   image.data = reinterpret_cast<void *>(data);
    image.status = wsi::swapchain_image::FREE;
 
    res = m_device_data.disp.AllocateMemory(m_device, &memory_allocate_info, get_allocation_callbacks(), &data->memory);
@@ -235,6 +220,12 @@ VkResult swapchain::allocate_and_bind_swapchain_image(VkImageCreateInfo image_cr
       return res;
    }
 
+   /* The allocation size is chosen by the implementation when exporting a hardware buffer. */
+   VkMemoryRequirements memory_requirements = {};
+   m_device_data.disp.GetImageMemoryRequirements(m_device, image.image, &memory_requirements);
+   data->memory_size = memory_requirements.size;
+   util::memory_accounting::record_device_allocation(util::device_memory_kind::hardware_buffer, data->memory_size);
+
    res = m_device_data.disp.BindImageMemory(m_device, image.image, data->memory, 0);
    assert(VK_SUCCESS == res);
    if (res != VK_SUCCESS)
@@ -244,14 +235,17 @@ VkResult swapchain::allocate_and_bind_swapchain_image(VkImageCreateInfo image_cr
       return res;
    }
 
-   /* Initialize presentation fence. */
-   auto present_fence = fence_sync::create(m_device_data);
-   if (!present_fence.has_value())
+   /* Initialize presentation fence, unless the presents are synchronized with the timeline semaphore. */
+   if (!m_present_timeline.has_value())
    {
-      destroy_image(image);
-      return VK_ERROR_OUT_OF_HOST_MEMORY;
+      auto present_fence = fence_sync::create(m_device_data);
+      if (!present_fence.has_value())
+      {
+         destroy_image(image);
+         return VK_ERROR_OUT_OF_HOST_MEMORY;
+      }
+      data->present_fence = std::move(present_fence.value());
    }
-   data->present_fence = std::move(present_fence.value());
 
    VkImageSubresource subres = {};
    subres.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
@@ -286,7 +280,7 @@ VkResult swapchain::create_swapchain_image(VkImageCreateInfo image_create_info,
 
 void swapchain::present_event_thread()
 {
-   auto thread_status_lock = std::unique_lock<std::mutex>(m_thread_status_lock);
+   auto thread_status_lock = util::unique_lock<util::mutex>(m_thread_status_lock);
    m_present_event_thread_run = true;
 
    while (m_present_event_thread_run)
@@ -298,7 +292,7 @@ void swapchain::present_event_thread()
          if (image.status == swapchain_image::INVALID)
             continue;
 
-         auto data = reinterpret_cast<x11_image_data *>(image.data);
+         auto data = get_image_data(image);
          if (data->pending_completions.size() != 0)
          {
             assume_forward_progress = true;
@@ -334,6 +328,7 @@ void swapchain::present_event_thread()
       case XCB_PRESENT_EVENT_CONFIGURE_NOTIFY:
       {
          auto config = reinterpret_cast<xcb_present_configure_notify_event_t *>(event);
+         m_surface->get_properties().invalidate_query_cache();
          if (config->pixmap_flags & (1 << 0))
          {
             set_error_state(VK_ERROR_SURFACE_LOST_KHR);
@@ -355,17 +350,24 @@ void swapchain::present_event_thread()
       case XCB_PRESENT_EVENT_COMPLETE_NOTIFY:
       {
          auto complete = reinterpret_cast<xcb_present_complete_notify_event_t *>(event);
+         WSI_TRACE_SCOPE("x11_complete_notify");
          if (complete->kind == XCB_PRESENT_COMPLETE_KIND_PIXMAP)
          {
             for (auto &image : m_swapchain_images)
             {
-               auto data = reinterpret_cast<x11_image_data *>(image.data);
+               auto data = get_image_data(image);
                auto iter = std::find_if(data->pending_completions.begin(), data->pending_completions.end(),
                                         [complete](auto &pending_completion) -> bool {
                                            return complete->serial == pending_completion.serial;
                                         });
                if (iter != data->pending_completions.end())
                {
+                  util::trace::flow(util::trace::phase::flow_end, "present", this, iter->present_id);
+                  if (swapchain_statistics::is_latency_measurement_enabled())
+                  {
+                     /* The UST of the X server is CLOCK_MONOTONIC in microseconds. */
+                     m_statistics.record_present_complete(iter->timestamps, complete->ust * util::NSEC_PER_USEC);
+                  }
                   set_present_id(iter->present_id);
                   data->pending_completions.erase(iter);
                   m_thread_status_cond.notify_all();
@@ -385,13 +387,14 @@ void swapchain::present_event_thread()
 
 void swapchain::present_image(const pending_present_request &pending_present)
 {
-   auto image_data = reinterpret_cast<x11_image_data *>(m_swapchain_images[pending_present.image_index].data);
-   auto thread_status_lock = std::unique_lock<std::mutex>(m_thread_status_lock);
+   auto image_data = get_image_data(pending_present.image_index);
+   auto thread_status_lock = util::unique_lock<util::mutex>(m_thread_status_lock);
 
    while (image_data->pending_completions.size() == X11_SWAPCHAIN_MAX_PENDING_COMPLETIONS)
    {
       if (!m_present_event_thread_run)
       {
+         m_statistics.record_dropped_frame();
          set_present_id(pending_present.present_id);
          return unpresent_image(pending_present.image_index);
       }
@@ -407,7 +410,12 @@ void swapchain::present_image(const pending_present_request &pending_present)
    xcb_discard_reply(m_connection, cookie.sequence);
    xcb_flush(m_connection);
 
-   image_data->pending_completions.push_back({ serial, pending_present.present_id });
+   /* Cannot fail as the vector is reserved to the maximum number of pending completions. */
+   pending_completion completion{ serial, pending_present.present_id,
+                                  m_swapchain_images[pending_present.image_index].timestamps };
+   bool pushed = image_data->pending_completions.try_push_back(completion);
+   (void)pushed;
+   assert(pushed);
    m_thread_status_cond.notify_all();
 
    if (m_present_mode == VK_PRESENT_MODE_FIFO_KHR)
@@ -432,7 +440,7 @@ bool swapchain::free_image_found()
       assert(pixmap.has_value());
       for (int i = 0; i < m_swapchain_images.size(); i++)
       {
-         auto data = reinterpret_cast<x11_image_data *>(m_swapchain_images[i].data);
+         auto data = get_image_data(i);
          if (data->pixmap == pixmap.value())
          {
             unpresent_image(i);
@@ -452,7 +460,7 @@ bool swapchain::free_image_found()
 
 VkResult swapchain::get_free_buffer(uint64_t *timeout)
 {
-   auto thread_status_lock = std::unique_lock<std::mutex>(m_thread_status_lock);
+   auto thread_status_lock = util::unique_lock<util::mutex>(m_thread_status_lock);
 
    if (*timeout == 0)
    {
@@ -488,9 +496,15 @@ VkResult swapchain::get_free_buffer(uint64_t *timeout)
    return VK_SUCCESS;
 }
 
+size_t swapchain::get_image_metadata_size() const
+{
+   return typed_swapchain::get_image_metadata_size() +
+          X11_SWAPCHAIN_MAX_PENDING_COMPLETIONS * sizeof(pending_completion);
+}
+
 void swapchain::destroy_image(wsi::swapchain_image &image)
 {
-   std::unique_lock<std::recursive_mutex> image_status_lock(m_image_status_mutex);
+   util::unique_lock<util::recursive_mutex> image_status_lock(m_image_status_mutex);
    if (image.status != wsi::swapchain_image::INVALID)
    {
       if (image.image != VK_NULL_HANDLE)
@@ -504,12 +518,13 @@ void swapchain::destroy_image(wsi::swapchain_image &image)
 
    image_status_lock.unlock();
 
-   if (image.data != nullptr)
+   if (has_image_data(image))
    {
-      auto data = reinterpret_cast<x11_image_data *>(image.data);
+      auto data = get_image_data(image);
       if (data->memory != VK_NULL_HANDLE)
       {
          m_device_data.disp.FreeMemory(m_device, data->memory, get_allocation_callbacks());
+         util::memory_accounting::record_device_free(util::device_memory_kind::hardware_buffer, data->memory_size);
          data->memory = VK_NULL_HANDLE;
       }
       if (data->ahb)
@@ -521,21 +536,28 @@ void swapchain::destroy_image(wsi::swapchain_image &image)
       {
          xcb_free_pixmap(m_connection, data->pixmap);
       }
-      m_allocator.destroy(1, data);
-      image.data = nullptr;
+      destroy_image_data(image);
    }
 }
 
 VkResult swapchain::image_set_present_payload(swapchain_image &image, VkQueue queue,
                                               const queue_submit_semaphores &semaphores, const void *submission_pnext)
 {
-   auto data = reinterpret_cast<x11_image_data *>(image.data);
+   auto data = get_image_data(image);
+   if (m_present_timeline.has_value())
+   {
+      return m_present_timeline->set_payload(queue, semaphores, submission_pnext, data->present_point);
+   }
    return data->present_fence.set_payload(queue, semaphores, submission_pnext);
 }
 
 VkResult swapchain::image_wait_present(swapchain_image &image, uint64_t timeout)
 {
-   auto data = reinterpret_cast<x11_image_data *>(image.data);
+   auto data = get_image_data(image);
+   if (m_present_timeline.has_value())
+   {
+      return m_present_timeline->wait_payload(data->present_point, timeout);
+   }
    return data->present_fence.wait_payload(timeout);
 }
 
@@ -545,7 +567,7 @@ VkResult swapchain::bind_swapchain_image(VkDevice &device, const VkBindImageMemo
    auto &device_data = layer::device_private_data::get(device);
 
    const wsi::swapchain_image &swapchain_image = m_swapchain_images[bind_sc_info->imageIndex];
-   VkDeviceMemory memory = reinterpret_cast<x11_image_data *>(swapchain_image.data)->memory;
+   VkDeviceMemory memory = get_image_data(swapchain_image)->memory;
 
    return device_data.disp.BindImageMemory(device, bind_image_mem_info->image, memory, 0);
 }
@@ -564,6 +586,15 @@ VkResult swapchain::init_platform(VkDevice device, const VkSwapchainCreateInfoKH
       return VK_ERROR_INITIALIZATION_FAILED;
    }
 
+   if (timeline_semaphore_sync::is_supported(m_device_data))
+   {
+      m_present_timeline = timeline_semaphore_sync::create(m_device_data);
+      if (!m_present_timeline.has_value())
+      {
+         return VK_ERROR_OUT_OF_HOST_MEMORY;
+      }
+   }
+
    auto eid = xcb_generate_id(m_connection);
    m_special_event = xcb_register_for_special_xge(m_connection, &xcb_present_id, eid, nullptr);
    xcb_present_select_input(m_connection, eid, m_window,
@@ -37,6 +37,7 @@
 #include <vulkan/vk_icd.h>
 #include <vulkan/vulkan.h>
 #include <wsi/swapchain_base.hpp>
+#include <util/ring_buffer.hpp>
 #include <xcb/xcb.h>
 #include <xcb/shm.h>
 #include <xcb/present.h>
@@ -50,13 +51,44 @@ namespace x11
 using pfnAHardwareBuffer_release = void (*)(AHardwareBuffer *);
 using pfnAHardwareBuffer_sendHandleToUnixSocket = int (*)(AHardwareBuffer *, int);
 
+struct pending_completion
+{
+   uint32_t serial;
+   uint64_t present_id;
+   present_timestamps timestamps;
+};
+
+struct x11_image_data
+{
+   x11_image_data(const util::allocator &allocator)
+      : pending_completions(allocator)
+   {
+   }
+
+   /* Device memory backing the image. */
+   VkDeviceMemory memory{};
+   /* Size of the device memory, for memory accounting. */
+   VkDeviceSize memory_size{};
+   VkSubresourceLayout layout{};
+
+   /* Present payload fence, only created when the swapchain cannot synchronize its presents with a timeline. */
+   fence_sync present_fence;
+   /* Point of the swapchain's present timeline signalled by the last present payload, 0 if none. */
+   uint64_t present_point{ 0 };
+
+   xcb_pixmap_t pixmap{};
+   AHardwareBuffer *ahb{};
+   /* Reserved to X11_SWAPCHAIN_MAX_PENDING_COMPLETIONS entries when the image is created. */
+   util::vector<pending_completion> pending_completions;
+};
+
 /**
  * @brief x11 swapchain class.
  *
  * This class is mostly empty, because all the swapchain stuff is handled by the swapchain class,
  * which we inherit. This class only provides a way to create an image and page-flip ops.
  */
-class swapchain : public wsi::swapchain_base
+class swapchain final : public wsi::typed_swapchain<swapchain, x11_image_data>
 {
 public:
    explicit swapchain(layer::device_private_data &dev_data, const VkAllocationCallbacks *pAllocator,
@@ -65,6 +97,8 @@ public:
    ~swapchain();
 
 protected:
+   friend class wsi::typed_swapchain<swapchain, x11_image_data>;
+
    /**
     * @brief Platform specific init
     */
@@ -99,7 +133,7 @@ protected:
     *
     * @param pending_present Information on the pending present request.
     */
-   void present_image(const pending_present_request &pending_present) override;
+   void present_image(const pending_present_request &pending_present);
 
    /**
     * @brief Method to release a swapchain image
@@ -108,6 +142,8 @@ protected:
     */
    void destroy_image(wsi::swapchain_image &image) override;
 
+   size_t get_image_metadata_size() const override;
+
    /**
     * @brief Sets the present payload for a swapchain image.
     *
@@ -119,9 +155,9 @@ protected:
     * @return VK_SUCCESS on success or an error code otherwise.
     */
    VkResult image_set_present_payload(swapchain_image &image, VkQueue queue, const queue_submit_semaphores &semaphores,
-                                      const void *submission_pnext) override;
+                                      const void *submission_pnext);
 
-   VkResult image_wait_present(swapchain_image &image, uint64_t timeout) override;
+   VkResult image_wait_present(swapchain_image &image, uint64_t timeout);
 
    /**
     * @brief Bind image to a swapchain
@@ -152,7 +188,7 @@ protected:
     *                        be set to 0 if the semaphore is now not expected
     *                        block.
     */
-   VkResult get_free_buffer(uint64_t *timeout) override;
+   VkResult get_free_buffer(uint64_t *timeout);
 
 private:
    xcb_connection_t *m_connection;
@@ -171,12 +207,15 @@ private:
    void present_event_thread();
    bool m_present_event_thread_run;
    std::thread m_present_event_thread;
-   std::mutex m_thread_status_lock;
-   std::condition_variable m_thread_status_cond;
+   util::mutex m_thread_status_lock;
+   util::condition_variable m_thread_status_cond;
    util::ring_buffer<xcb_pixmap_t, 6> m_free_buffer_pool;
 
    pfnAHardwareBuffer_release HardwareBuffer_release;
    pfnAHardwareBuffer_sendHandleToUnixSocket HardwareBuffer_sendHandleToUnixSocket;
+
+   /* Timeline semaphore signalled by the present payloads of all the images, empty when per-image fences are used. */
+   std::optional<timeline_semaphore_sync> m_present_timeline;
 };
 
 } /* namespace x11 */